@@ -1,6 +1,6 @@
-import 'package:flutter_dotenv/flutter_dotenv.dart';
-
-class AppConstants {
-  static String get supabaseUrl => dotenv.env['SUPABASE_URL'] ?? '';
-  static String get supabaseAnonKey => dotenv.env['SUPABASE_KEY'] ?? '';
+import 'package:flutter_dotenv/flutter_dotenv.dart';
+
+class AppConstants {
+  static String get supabaseUrl => dotenv.env['SUPABASE_URL'] ?? '';
+  static String get supabaseAnonKey => dotenv.env['SUPABASE_KEY'] ?? '';
 }
\ No newline at end of file
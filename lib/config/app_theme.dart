@@ -1,67 +1,67 @@
-import 'package:flutter/material.dart';
-
-class AppTheme {
-  // 1. Định nghĩa màu sắc chủ đạo
-  static const Color primaryColor = Color(0xFF1565C0); // Xanh đậm chuyên nghiệp
-  static const Color accentColor = Color(0xFF00B0FF);  // Xanh sáng
-  static const Color errorColor = Color(0xFFD32F2F);
-  static const Color successColor = Color(0xFF388E3C);
-
-  // 2. Tạo Theme Data
-  static ThemeData get lightTheme {
-    return ThemeData(
-      useMaterial3: true,
-      colorScheme: ColorScheme.fromSeed(
-        seedColor: primaryColor,
-        primary: primaryColor,
-        secondary: accentColor,
-        error: errorColor,
-      ),
-      
-      // Cấu hình thanh App Bar mặc định
-      appBarTheme: const AppBarTheme(
-        backgroundColor: primaryColor,
-        foregroundColor: Colors.white, // Màu chữ/icon
-        centerTitle: true,
-        elevation: 0,
-      ),
-
-      // Cấu hình Nút bấm (ElevatedButton)
-      elevatedButtonTheme: ElevatedButtonThemeData(
-        style: ElevatedButton.styleFrom(
-          backgroundColor: primaryColor,
-          foregroundColor: Colors.white,
-          padding: const EdgeInsets.symmetric(vertical: 12, horizontal: 24),
-          shape: RoundedRectangleBorder(
-            borderRadius: BorderRadius.circular(12), // Bo góc chuẩn
-          ),
-          textStyle: const TextStyle(fontWeight: FontWeight.bold, fontSize: 16),
-        ),
-      ),
-
-      // Cấu hình Ô nhập liệu (TextField) - CỰC KỲ QUAN TRỌNG
-      // Giúp bro bỏ bớt code decoration trong các màn hình Login/Register
-      inputDecorationTheme: InputDecorationTheme(
-        filled: true,
-        fillColor: Colors.grey.shade50,
-        contentPadding: const EdgeInsets.symmetric(horizontal: 16, vertical: 16),
-        border: OutlineInputBorder(
-          borderRadius: BorderRadius.circular(12),
-          borderSide: BorderSide(color: Colors.grey.shade300),
-        ),
-        enabledBorder: OutlineInputBorder(
-          borderRadius: BorderRadius.circular(12),
-          borderSide: BorderSide(color: Colors.grey.shade300),
-        ),
-        focusedBorder: OutlineInputBorder(
-          borderRadius: BorderRadius.circular(12),
-          borderSide: const BorderSide(color: primaryColor, width: 2),
-        ),
-        errorBorder: OutlineInputBorder(
-          borderRadius: BorderRadius.circular(12),
-          borderSide: const BorderSide(color: errorColor),
-        ),
-      ),
-    );
-  }
+import 'package:flutter/material.dart';
+
+class AppTheme {
+  // 1. Định nghĩa màu sắc chủ đạo
+  static const Color primaryColor = Color(0xFF1565C0); // Xanh đậm chuyên nghiệp
+  static const Color accentColor = Color(0xFF00B0FF);  // Xanh sáng
+  static const Color errorColor = Color(0xFFD32F2F);
+  static const Color successColor = Color(0xFF388E3C);
+
+  // 2. Tạo Theme Data
+  static ThemeData get lightTheme {
+    return ThemeData(
+      useMaterial3: true,
+      colorScheme: ColorScheme.fromSeed(
+        seedColor: primaryColor,
+        primary: primaryColor,
+        secondary: accentColor,
+        error: errorColor,
+      ),
+      
+      // Cấu hình thanh App Bar mặc định
+      appBarTheme: const AppBarTheme(
+        backgroundColor: primaryColor,
+        foregroundColor: Colors.white, // Màu chữ/icon
+        centerTitle: true,
+        elevation: 0,
+      ),
+
+      // Cấu hình Nút bấm (ElevatedButton)
+      elevatedButtonTheme: ElevatedButtonThemeData(
+        style: ElevatedButton.styleFrom(
+          backgroundColor: primaryColor,
+          foregroundColor: Colors.white,
+          padding: const EdgeInsets.symmetric(vertical: 12, horizontal: 24),
+          shape: RoundedRectangleBorder(
+            borderRadius: BorderRadius.circular(12), // Bo góc chuẩn
+          ),
+          textStyle: const TextStyle(fontWeight: FontWeight.bold, fontSize: 16),
+        ),
+      ),
+
+      // Cấu hình Ô nhập liệu (TextField) - CỰC KỲ QUAN TRỌNG
+      // Giúp bro bỏ bớt code decoration trong các màn hình Login/Register
+      inputDecorationTheme: InputDecorationTheme(
+        filled: true,
+        fillColor: Colors.grey.shade50,
+        contentPadding: const EdgeInsets.symmetric(horizontal: 16, vertical: 16),
+        border: OutlineInputBorder(
+          borderRadius: BorderRadius.circular(12),
+          borderSide: BorderSide(color: Colors.grey.shade300),
+        ),
+        enabledBorder: OutlineInputBorder(
+          borderRadius: BorderRadius.circular(12),
+          borderSide: BorderSide(color: Colors.grey.shade300),
+        ),
+        focusedBorder: OutlineInputBorder(
+          borderRadius: BorderRadius.circular(12),
+          borderSide: const BorderSide(color: primaryColor, width: 2),
+        ),
+        errorBorder: OutlineInputBorder(
+          borderRadius: BorderRadius.circular(12),
+          borderSide: const BorderSide(color: errorColor),
+        ),
+      ),
+    );
+  }
 }
\ No newline at end of file
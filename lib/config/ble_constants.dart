@@ -1,9 +1,17 @@
-class BleConstants {
-  // Service UUID (128-bit từ Firmware)
-  // Chuyển hết về chữ thường
-  static const String serviceUuid = "9ab14f55-35e9-368b-bf46-167610982cc9";
-  
-  // Characteristic UUID (16-bit từ Firmware 0x1632 -> Base UUID)
-  // Chuyển hết về chữ thường
-  static const String characteristicUuid = "00001632-0000-1000-8000-00805f9b34fb";
+class BleConstants {
+  // Service UUID (128-bit từ Firmware)
+  // Chuyển hết về chữ thường
+  static const String serviceUuid = "9ab14f55-35e9-368b-bf46-167610982cc9";
+  
+  // Characteristic UUID (16-bit từ Firmware 0x1632 -> Base UUID)
+  // Chuyển hết về chữ thường
+  static const String characteristicUuid = "00001632-0000-1000-8000-00805f9b34fb";
+
+  // Dịch vụ Bulk: nạp gallery / tải nhật ký qua BLE (giao thức khung trong ble_frame.h)
+  static const String bulkServiceUuid = "9ab11000-7e5a-219c-614f-7d0b1c528a3e";
+  // App ghi khung (Write Without Response)
+  static const String bulkRxUuid = "9ab11001-7e5a-219c-614f-7d0b1c528a3e";
+  // Lock gửi khung (Notify)
+  static const String bulkTxUuid = "9ab11002-7e5a-219c-614f-7d0b1c528a3e";
+  static const int bulkMtu = 517;
 }
\ No newline at end of file
@@ -1,25 +1,28 @@
-class AccessLog {
-  final int id;
-  final String deviceId;
-  final String? imageUrl;
-  final String description;
-  final DateTime createdAt;
-
-  AccessLog({
-    required this.id,
-    required this.deviceId,
-    this.imageUrl,
-    required this.description,
-    required this.createdAt,
-  });
-
-  factory AccessLog.fromJson(Map<String, dynamic> json) {
-    return AccessLog(
-      id: json['id'],
-      deviceId: json['device_id'],
-      imageUrl: json['image_url'], 
-      description: json['description'] ?? 'Hành động không xác định',
-      createdAt: DateTime.parse(json['created_at']),
-    );
-  }
+class AccessLog {
+  final int id;
+  final String deviceId;
+  final String? imageUrl;
+  final String description;
+  final DateTime createdAt;
+
+  AccessLog({
+    required this.id,
+    required this.deviceId,
+    this.imageUrl,
+    required this.description,
+    required this.createdAt,
+  });
+
+  // Người lạ trước cửa (khóa gom theo cụm, mỗi lần xuất hiện 1 dòng), không phải lượt mở cửa
+  bool get isUnknownVisitor => description.startsWith('Unknown Visitor');
+
+  factory AccessLog.fromJson(Map<String, dynamic> json) {
+    return AccessLog(
+      id: json['id'],
+      deviceId: json['device_id'],
+      imageUrl: json['image_url'], 
+      description: json['description'] ?? 'Hành động không xác định',
+      createdAt: DateTime.parse(json['created_at']),
+    );
+  }
 }
\ No newline at end of file
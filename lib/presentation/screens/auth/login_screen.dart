@@ -1,154 +1,154 @@
-import 'package:flutter/material.dart';
-import 'package:supabase_flutter/supabase_flutter.dart';
-import 'package:flutter_secure_storage/flutter_secure_storage.dart';
-import 'package:connectivity_plus/connectivity_plus.dart';
-import '../../../data/services/auth_service.dart';
-import '../home/home_screen.dart';
-import 'register_screen.dart';
-
-class LoginScreen extends StatefulWidget {
-  const LoginScreen({super.key});
-
-  @override
-  State<LoginScreen> createState() => _LoginScreenState();
-}
-
-class _LoginScreenState extends State<LoginScreen> {
-  final _authService = AuthService();
-  final _storage = const FlutterSecureStorage();
-  
-  final _emailController = TextEditingController();
-  final _passwordController = TextEditingController();
-  
-  bool _isLoading = false;
-  bool _rememberMe = false;
-  bool _isObscure = true; // Biến ẩn hiện mật khẩu
-
-  @override
-  void initState() {
-    super.initState();
-    _loadSavedCredentials();
-  }
-
-  Future<void> _loadSavedCredentials() async {
-    final savedEmail = await _storage.read(key: 'saved_email');
-    final savedPass = await _storage.read(key: 'saved_pass');
-    if (savedEmail != null && savedPass != null) {
-      setState(() {
-        _emailController.text = savedEmail;
-        _passwordController.text = savedPass;
-        _rememberMe = true;
-      });
-    }
-  }
-
-  Future<void> _handleLogin() async {
-    if (_emailController.text.isEmpty || _passwordController.text.isEmpty) {
-      ScaffoldMessenger.of(context).showSnackBar(
-        const SnackBar(content: Text('Vui lòng nhập đầy đủ thông tin'), backgroundColor: Colors.red),
-      );
-      return;
-    }
-
-    setState(() => _isLoading = true);
-    try {
-      await _authService.signIn(
-        _emailController.text.trim(),
-        _passwordController.text.trim(),
-      );
-
-      if (_rememberMe) {
-        await _storage.write(key: 'saved_email', value: _emailController.text.trim());
-        await _storage.write(key: 'saved_pass', value: _passwordController.text.trim());
-      } else {
-        await _storage.delete(key: 'saved_email');
-        await _storage.delete(key: 'saved_pass');
-      }
-
-      if (mounted) {
-        Navigator.of(context).pushReplacement(
-          MaterialPageRoute(builder: (_) => const HomeScreen()),
-        );
-      }
-    } on AuthException catch (e) {
-      if (mounted) ScaffoldMessenger.of(context).showSnackBar(SnackBar(content: Text(e.message), backgroundColor: Colors.red));
-    } catch (e) {
-      String msg = e.toString().contains('SocketException') ? 'Lỗi mạng.' : 'Lỗi: $e';
-      if (mounted) ScaffoldMessenger.of(context).showSnackBar(SnackBar(content: Text(msg), backgroundColor: Colors.red));
-    } finally {
-      if (mounted) setState(() => _isLoading = false);
-    }
-  }
-
-  Future<void> _handleOfflineMode() async {
-    final connectivityResult = await Connectivity().checkConnectivity();
-    if (connectivityResult.contains(ConnectivityResult.none)) {
-      if (mounted) {
-        Navigator.of(context).pushReplacement(MaterialPageRoute(builder: (_) => const HomeScreen()));
-        ScaffoldMessenger.of(context).showSnackBar(const SnackBar(content: Text('Chế độ Offline (Bluetooth)'), backgroundColor: Colors.orange));
-      }
-    } else {
-      ScaffoldMessenger.of(context).showSnackBar(const SnackBar(content: Text('Đang có mạng, vui lòng đăng nhập!'), backgroundColor: Colors.red));
-    }
-  }
-
-  @override
-  Widget build(BuildContext context) {
-    return Scaffold(
-      appBar: AppBar(title: const Text('Đăng Nhập')),
-      body: Center(
-        child: SingleChildScrollView(
-          padding: const EdgeInsets.all(24.0),
-          child: Column(
-            mainAxisAlignment: MainAxisAlignment.center,
-            children: [
-              Icon(Icons.lock_outline, size: 80, color: Theme.of(context).primaryColor),
-              const SizedBox(height: 30),
-              TextField(
-                controller: _emailController,
-                decoration: const InputDecoration(labelText: 'Email', prefixIcon: Icon(Icons.email)),
-                keyboardType: TextInputType.emailAddress,
-              ),
-              const SizedBox(height: 16),
-              TextField(
-                controller: _passwordController,
-                obscureText: _isObscure,
-                decoration: InputDecoration(
-                  labelText: 'Mật khẩu',
-                  prefixIcon: const Icon(Icons.lock),
-                  suffixIcon: IconButton(
-                    icon: Icon(_isObscure ? Icons.visibility_off : Icons.visibility),
-                    onPressed: () => setState(() => _isObscure = !_isObscure),
-                  ),
-                ),
-              ),
-              Row(children: [
-                Checkbox(value: _rememberMe, onChanged: (v) => setState(() => _rememberMe = v ?? false)),
-                const Text("Ghi nhớ tài khoản"),
-              ]),
-              const SizedBox(height: 20),
-              _isLoading
-                  ? const CircularProgressIndicator()
-                  : Column(children: [
-                      SizedBox(width: double.infinity, child: ElevatedButton(onPressed: _handleLogin, child: const Text('ĐĂNG NHẬP'))),
-                      const SizedBox(height: 16),
-                      SizedBox(
-                        width: double.infinity,
-                        child: OutlinedButton.icon(
-                          onPressed: _handleOfflineMode,
-                          icon: const Icon(Icons.bluetooth_searching),
-                          label: const Text('CHẾ ĐỘ OFFLINE'),
-                        ),
-                      ),
-                      TextButton(
-                        onPressed: () => Navigator.push(context, MaterialPageRoute(builder: (_) => const RegisterScreen())),
-                        child: const Text('Chưa có tài khoản? Đăng ký ngay'),
-                      ),
-                    ]),
-            ],
-          ),
-        ),
-      ),
-    );
-  }
+import 'package:flutter/material.dart';
+import 'package:supabase_flutter/supabase_flutter.dart';
+import 'package:flutter_secure_storage/flutter_secure_storage.dart';
+import 'package:connectivity_plus/connectivity_plus.dart';
+import '../../../data/services/auth_service.dart';
+import '../home/home_screen.dart';
+import 'register_screen.dart';
+
+class LoginScreen extends StatefulWidget {
+  const LoginScreen({super.key});
+
+  @override
+  State<LoginScreen> createState() => _LoginScreenState();
+}
+
+class _LoginScreenState extends State<LoginScreen> {
+  final _authService = AuthService();
+  final _storage = const FlutterSecureStorage();
+  
+  final _emailController = TextEditingController();
+  final _passwordController = TextEditingController();
+  
+  bool _isLoading = false;
+  bool _rememberMe = false;
+  bool _isObscure = true; // Biến ẩn hiện mật khẩu
+
+  @override
+  void initState() {
+    super.initState();
+    _loadSavedCredentials();
+  }
+
+  Future<void> _loadSavedCredentials() async {
+    final savedEmail = await _storage.read(key: 'saved_email');
+    final savedPass = await _storage.read(key: 'saved_pass');
+    if (savedEmail != null && savedPass != null) {
+      setState(() {
+        _emailController.text = savedEmail;
+        _passwordController.text = savedPass;
+        _rememberMe = true;
+      });
+    }
+  }
+
+  Future<void> _handleLogin() async {
+    if (_emailController.text.isEmpty || _passwordController.text.isEmpty) {
+      ScaffoldMessenger.of(context).showSnackBar(
+        const SnackBar(content: Text('Vui lòng nhập đầy đủ thông tin'), backgroundColor: Colors.red),
+      );
+      return;
+    }
+
+    setState(() => _isLoading = true);
+    try {
+      await _authService.signIn(
+        _emailController.text.trim(),
+        _passwordController.text.trim(),
+      );
+
+      if (_rememberMe) {
+        await _storage.write(key: 'saved_email', value: _emailController.text.trim());
+        await _storage.write(key: 'saved_pass', value: _passwordController.text.trim());
+      } else {
+        await _storage.delete(key: 'saved_email');
+        await _storage.delete(key: 'saved_pass');
+      }
+
+      if (mounted) {
+        Navigator.of(context).pushReplacement(
+          MaterialPageRoute(builder: (_) => const HomeScreen()),
+        );
+      }
+    } on AuthException catch (e) {
+      if (mounted) ScaffoldMessenger.of(context).showSnackBar(SnackBar(content: Text(e.message), backgroundColor: Colors.red));
+    } catch (e) {
+      String msg = e.toString().contains('SocketException') ? 'Lỗi mạng.' : 'Lỗi: $e';
+      if (mounted) ScaffoldMessenger.of(context).showSnackBar(SnackBar(content: Text(msg), backgroundColor: Colors.red));
+    } finally {
+      if (mounted) setState(() => _isLoading = false);
+    }
+  }
+
+  Future<void> _handleOfflineMode() async {
+    final connectivityResult = await Connectivity().checkConnectivity();
+    if (connectivityResult.contains(ConnectivityResult.none)) {
+      if (mounted) {
+        Navigator.of(context).pushReplacement(MaterialPageRoute(builder: (_) => const HomeScreen()));
+        ScaffoldMessenger.of(context).showSnackBar(const SnackBar(content: Text('Chế độ Offline (Bluetooth)'), backgroundColor: Colors.orange));
+      }
+    } else {
+      ScaffoldMessenger.of(context).showSnackBar(const SnackBar(content: Text('Đang có mạng, vui lòng đăng nhập!'), backgroundColor: Colors.red));
+    }
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    return Scaffold(
+      appBar: AppBar(title: const Text('Đăng Nhập')),
+      body: Center(
+        child: SingleChildScrollView(
+          padding: const EdgeInsets.all(24.0),
+          child: Column(
+            mainAxisAlignment: MainAxisAlignment.center,
+            children: [
+              Icon(Icons.lock_outline, size: 80, color: Theme.of(context).primaryColor),
+              const SizedBox(height: 30),
+              TextField(
+                controller: _emailController,
+                decoration: const InputDecoration(labelText: 'Email', prefixIcon: Icon(Icons.email)),
+                keyboardType: TextInputType.emailAddress,
+              ),
+              const SizedBox(height: 16),
+              TextField(
+                controller: _passwordController,
+                obscureText: _isObscure,
+                decoration: InputDecoration(
+                  labelText: 'Mật khẩu',
+                  prefixIcon: const Icon(Icons.lock),
+                  suffixIcon: IconButton(
+                    icon: Icon(_isObscure ? Icons.visibility_off : Icons.visibility),
+                    onPressed: () => setState(() => _isObscure = !_isObscure),
+                  ),
+                ),
+              ),
+              Row(children: [
+                Checkbox(value: _rememberMe, onChanged: (v) => setState(() => _rememberMe = v ?? false)),
+                const Text("Ghi nhớ tài khoản"),
+              ]),
+              const SizedBox(height: 20),
+              _isLoading
+                  ? const CircularProgressIndicator()
+                  : Column(children: [
+                      SizedBox(width: double.infinity, child: ElevatedButton(onPressed: _handleLogin, child: const Text('ĐĂNG NHẬP'))),
+                      const SizedBox(height: 16),
+                      SizedBox(
+                        width: double.infinity,
+                        child: OutlinedButton.icon(
+                          onPressed: _handleOfflineMode,
+                          icon: const Icon(Icons.bluetooth_searching),
+                          label: const Text('CHẾ ĐỘ OFFLINE'),
+                        ),
+                      ),
+                      TextButton(
+                        onPressed: () => Navigator.push(context, MaterialPageRoute(builder: (_) => const RegisterScreen())),
+                        child: const Text('Chưa có tài khoản? Đăng ký ngay'),
+                      ),
+                    ]),
+            ],
+          ),
+        ),
+      ),
+    );
+  }
 }
\ No newline at end of file
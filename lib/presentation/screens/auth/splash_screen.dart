@@ -1,75 +1,75 @@
-import 'package:flutter/material.dart';
-import 'package:connectivity_plus/connectivity_plus.dart';
-import '../../../data/services/auth_service.dart';
-import '../home/home_screen.dart';
-import 'login_screen.dart';
-
-class SplashScreen extends StatefulWidget {
-  const SplashScreen({super.key});
-
-  @override
-  State<SplashScreen> createState() => _SplashScreenState();
-}
-
-class _SplashScreenState extends State<SplashScreen> {
-  final _authService = AuthService();
-
-  @override
-  void initState() {
-    super.initState();
-    _checkSessionAndNetwork();
-  }
-
-  Future<void> _checkSessionAndNetwork() async {
-    await Future.delayed(const Duration(seconds: 2));
-
-    // 1. Kiểm tra mạng
-    final connectivityResult = await Connectivity().checkConnectivity();
-    bool isOffline = connectivityResult.contains(ConnectivityResult.none);
-
-    // 2. Kiểm tra phiên đăng nhập
-    bool isLoggedIn = await _authService.recoverSession();
-
-    if (!mounted) return;
-
-    if (isLoggedIn) {
-      if (isOffline) {
-        ScaffoldMessenger.of(context).showSnackBar(
-          const SnackBar(
-            content: Text('Chế độ Offline. Một số tính năng sẽ bị hạn chế.'),
-            backgroundColor: Colors.orange,
-          ),
-        );
-      }
-      Navigator.of(context).pushReplacement(
-        MaterialPageRoute(builder: (_) => const HomeScreen()),
-      );
-    } else {
-      Navigator.of(context).pushReplacement(
-        MaterialPageRoute(builder: (_) => const LoginScreen()),
-      );
-    }
-  }
-
-  @override
-  Widget build(BuildContext context) {
-    return Scaffold(
-      backgroundColor: Theme.of(context).primaryColor,
-      body: Center(
-        child: Column(
-          mainAxisAlignment: MainAxisAlignment.center,
-          children: const [
-            Icon(Icons.lock_person, size: 100, color: Colors.white),
-            SizedBox(height: 20),
-            Text(
-              "SMART LOCK",
-              style: TextStyle(fontSize: 24, color: Colors.white, fontWeight: FontWeight.bold),
-            ),
-            SizedBox(height: 20),
-            CircularProgressIndicator(color: Colors.white),
-          ],
-        ),
-      ),
-    );
-  }
+import 'package:flutter/material.dart';
+import 'package:connectivity_plus/connectivity_plus.dart';
+import '../../../data/services/auth_service.dart';
+import '../home/home_screen.dart';
+import 'login_screen.dart';
+
+class SplashScreen extends StatefulWidget {
+  const SplashScreen({super.key});
+
+  @override
+  State<SplashScreen> createState() => _SplashScreenState();
+}
+
+class _SplashScreenState extends State<SplashScreen> {
+  final _authService = AuthService();
+
+  @override
+  void initState() {
+    super.initState();
+    _checkSessionAndNetwork();
+  }
+
+  Future<void> _checkSessionAndNetwork() async {
+    await Future.delayed(const Duration(seconds: 2));
+
+    // 1. Kiểm tra mạng
+    final connectivityResult = await Connectivity().checkConnectivity();
+    bool isOffline = connectivityResult.contains(ConnectivityResult.none);
+
+    // 2. Kiểm tra phiên đăng nhập
+    bool isLoggedIn = await _authService.recoverSession();
+
+    if (!mounted) return;
+
+    if (isLoggedIn) {
+      if (isOffline) {
+        ScaffoldMessenger.of(context).showSnackBar(
+          const SnackBar(
+            content: Text('Chế độ Offline. Một số tính năng sẽ bị hạn chế.'),
+            backgroundColor: Colors.orange,
+          ),
+        );
+      }
+      Navigator.of(context).pushReplacement(
+        MaterialPageRoute(builder: (_) => const HomeScreen()),
+      );
+    } else {
+      Navigator.of(context).pushReplacement(
+        MaterialPageRoute(builder: (_) => const LoginScreen()),
+      );
+    }
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    return Scaffold(
+      backgroundColor: Theme.of(context).primaryColor,
+      body: Center(
+        child: Column(
+          mainAxisAlignment: MainAxisAlignment.center,
+          children: const [
+            Icon(Icons.lock_person, size: 100, color: Colors.white),
+            SizedBox(height: 20),
+            Text(
+              "SMART LOCK",
+              style: TextStyle(fontSize: 24, color: Colors.white, fontWeight: FontWeight.bold),
+            ),
+            SizedBox(height: 20),
+            CircularProgressIndicator(color: Colors.white),
+          ],
+        ),
+      ),
+    );
+  }
 }
\ No newline at end of file
@@ -0,0 +1,283 @@
+#include "access_stats.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "json_writer.h"
+
+static const char *TAG = "ACC_STATS";
+
+#define STATS_NVS_KEY   "acc_stats"
+#define STATS_VERSION   1
+
+typedef struct {
+    int16_t id;             // -1 = ô trống
+    uint16_t reserved;
+    uint32_t count;
+    uint32_t last_ts;
+} face_count_t;
+
+// Lưu nguyên struct vào NVS: đổi bố cục thì tăng STATS_VERSION
+typedef struct {
+    uint32_t version;
+    int32_t cur_day;        // Ngày địa phương (tính từ 1970) của ô mới nhất, 0 = chưa có
+    int32_t cur_hour;       // cur_day * 24 + giờ
+    uint16_t days[ACCESS_STATS_DAYS][EV_SRC_COUNT];     // Vòng: ô = ngày % DAYS
+    uint16_t hours[ACCESS_STATS_HOURS][EV_SRC_COUNT];   // Vòng: ô = giờ % HOURS
+    uint32_t hour_of_day[24];                           // Cộng dồn theo giờ trong ngày (giờ cao điểm)
+    uint32_t total[EV_SRC_COUNT];
+    uint32_t unknown;
+    uint32_t score_match[ACCESS_STATS_SCORE_BINS];
+    uint32_t score_reject[ACCESS_STATS_SCORE_BINS];
+    face_count_t faces[ACCESS_STATS_FACES];
+} access_stats_t;
+
+static access_stats_t s_stats;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_dirty_save = false;
+static bool s_dirty_publish = false;
+static int64_t s_last_save_ms = 0;
+static int64_t s_last_publish_ms = 0;
+
+static void _reset(access_stats_t *st) {
+    memset(st, 0, sizeof(*st));
+    st->version = STATS_VERSION;
+    for (int i = 0; i < ACCESS_STATS_FACES; i++) st->faces[i].id = -1;
+}
+
+// Số ngày kể từ 1970-01-01 của ngày dương lịch (y, m, d)
+static int32_t _days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static int _score_bin(float score) {
+    int b = (int)(score * ACCESS_STATS_SCORE_BINS);
+    if (b < 0) b = 0;
+    if (b >= ACCESS_STATS_SCORE_BINS) b = ACCESS_STATS_SCORE_BINS - 1;
+    return b;
+}
+
+// Đưa vòng tới ô `now`, xoá các ô bị vượt qua. Trả false nếu `key` đã rơi khỏi vòng.
+static bool _ring_advance(int32_t *cur, int32_t key, uint16_t (*ring)[EV_SRC_COUNT], int n) {
+    if (*cur == 0 || key - *cur >= n) {
+        if (*cur != 0 && key < *cur) return false;
+        if (key > *cur) {
+            memset(ring, 0, sizeof(uint16_t) * EV_SRC_COUNT * n);
+            *cur = key;
+        }
+        return true;
+    }
+    if (key <= *cur) return *cur - key < n;
+    for (int32_t k = *cur + 1; k <= key; k++) memset(ring[k % n], 0, sizeof(uint16_t) * EV_SRC_COUNT);
+    *cur = key;
+    return true;
+}
+
+static void _count_face(access_stats_t *st, int16_t id, uint32_t ts) {
+    face_count_t *slot = NULL, *least = &st->faces[0];
+    for (int i = 0; i < ACCESS_STATS_FACES; i++) {
+        face_count_t *f = &st->faces[i];
+        if (f->id == id) { slot = f; break; }
+        if (f->id < 0 || f->count < least->count) least = f;
+    }
+    if (!slot) {
+        // Hết chỗ: thay ô ít lượt nhất
+        slot = least;
+        slot->id = id;
+        slot->count = 0;
+    }
+    slot->count++;
+    slot->last_ts = ts;
+}
+
+void access_stats_record(const event_rec_t *r) {
+    if (r->source == EV_SRC_FACE && r->face_id < 0) {
+        // Người lạ: không phải lượt mở cửa
+        taskENTER_CRITICAL(&s_lock);
+        s_stats.unknown++;
+        s_dirty_save = true;
+        s_dirty_publish = true;
+        taskEXIT_CRITICAL(&s_lock);
+        access_stats_save_if_due();
+        return;
+    }
+    uint8_t src = r->source < EV_SRC_COUNT ? r->source : EV_SRC_REMOTE;
+    struct tm tm_local;
+    bool has_time = r->ts > 0;
+    if (has_time) {
+        time_t t = r->ts;
+        localtime_r(&t, &tm_local);
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    access_stats_t *st = &s_stats;
+    st->total[src]++;
+    if (has_time) {
+        int32_t day = _days_from_civil(tm_local.tm_year + 1900, tm_local.tm_mon + 1, tm_local.tm_mday);
+        int32_t hour = day * 24 + tm_local.tm_hour;
+        if (_ring_advance(&st->cur_day, day, st->days, ACCESS_STATS_DAYS)) {
+            uint16_t *c = &st->days[day % ACCESS_STATS_DAYS][src];
+            if (*c < UINT16_MAX) (*c)++;
+        }
+        if (_ring_advance(&st->cur_hour, hour, st->hours, ACCESS_STATS_HOURS)) {
+            uint16_t *c = &st->hours[hour % ACCESS_STATS_HOURS][src];
+            if (*c < UINT16_MAX) (*c)++;
+        }
+        st->hour_of_day[tm_local.tm_hour]++;
+    }
+    if (r->face_id >= 0) {
+        st->score_match[_score_bin(r->score)]++;
+        _count_face(st, r->face_id, r->ts);
+    }
+    s_dirty_save = true;
+    s_dirty_publish = true;
+    taskEXIT_CRITICAL(&s_lock);
+
+    access_stats_save_if_due();
+}
+
+void access_stats_unknown(float best_score) {
+    taskENTER_CRITICAL(&s_lock);
+    s_stats.score_reject[_score_bin(best_score)]++;
+    s_dirty_save = true;
+    s_dirty_publish = true;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void access_stats_save_if_due(void) {
+    int64_t now = esp_timer_get_time() / 1000;
+    access_stats_t snap;            // ~700 byte stack: chép nhanh trong khoá, ghi NVS ngoài khoá
+    taskENTER_CRITICAL(&s_lock);
+    bool due = s_dirty_save && (s_last_save_ms == 0 || now - s_last_save_ms >= ACCESS_STATS_SAVE_MS);
+    if (due) {
+        snap = s_stats;
+        s_dirty_save = false;
+        s_last_save_ms = now;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    if (!due) return;
+
+    nvs_handle_t h;
+    if (nvs_open("nvs", NVS_READWRITE, &h) != ESP_OK) return;
+    if (nvs_set_blob(h, STATS_NVS_KEY, &snap, sizeof(snap)) == ESP_OK) nvs_commit(h);
+    nvs_close(h);
+}
+
+bool access_stats_publish_due(void) {
+    int64_t now = esp_timer_get_time() / 1000;
+    taskENTER_CRITICAL(&s_lock);
+    bool due = s_dirty_publish && (s_last_publish_ms == 0 || now - s_last_publish_ms >= ACCESS_STATS_PUBLISH_MS);
+    if (due) {
+        s_dirty_publish = false;
+        s_last_publish_ms = now;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return due;
+}
+
+// Ngày dương lịch từ số ngày (nghịch đảo _days_from_civil)
+static void _civil_from_days(int32_t z, int *y, int *m, int *d) {
+    z += 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp + (mp < 10 ? 3 : -9);
+    *y = yoe + era * 400 + (*m <= 2);
+}
+
+// Mảng theo nguồn, cũ -> mới, kết thúc ở ô `cur`
+static void _ring_json(json_writer_t *w, const char *key, uint16_t (*ring)[EV_SRC_COUNT], int n, int32_t cur) {
+    jw_key(w, key);
+    jw_obj_begin(w);
+    for (int s = 0; s < EV_SRC_COUNT; s++) {
+        jw_key(w, event_source_name(s));
+        jw_arr_begin(w);
+        for (int i = n - 1; i >= 0; i--) {
+            int32_t k = cur - i;
+            jw_int(w, (cur == 0 || k < 0) ? 0 : ring[k % n][s]);
+        }
+        jw_arr_end(w);
+    }
+    jw_obj_end(w);
+}
+
+static void _u32_array(json_writer_t *w, const char *key, const uint32_t *v, int n) {
+    jw_key(w, key);
+    jw_arr_begin(w);
+    for (int i = 0; i < n; i++) jw_int(w, v[i]);
+    jw_arr_end(w);
+}
+
+size_t access_stats_json(char *buf, size_t len) {
+    access_stats_t snap;
+    taskENTER_CRITICAL(&s_lock);
+    snap = s_stats;
+    taskEXIT_CRITICAL(&s_lock);
+
+    json_writer_t w;
+    jw_init(&w, buf, len);
+    jw_obj_begin(&w);
+    jw_kv_int(&w, "v", STATS_VERSION);
+    char date[24];
+    int y = 1970, m = 1, d = 1;
+    if (snap.cur_day) _civil_from_days(snap.cur_day, &y, &m, &d);
+    snprintf(date, sizeof(date), "%04d-%02d-%02d", y, m, d);
+    jw_kv_str(&w, "day0", snap.cur_day ? date : NULL);
+    _ring_json(&w, "days", snap.days, ACCESS_STATS_DAYS, snap.cur_day);
+    if (snap.cur_hour) {
+        _civil_from_days(snap.cur_hour / 24, &y, &m, &d);
+        snprintf(date, sizeof(date), "%04d-%02d-%02dT%02d", y, m, d, (int)(snap.cur_hour % 24));
+    }
+    jw_kv_str(&w, "hour0", snap.cur_hour ? date : NULL);
+    _ring_json(&w, "hours", snap.hours, ACCESS_STATS_HOURS, snap.cur_hour);
+    _u32_array(&w, "hod", snap.hour_of_day, 24);
+    jw_key(&w, "total");
+    jw_obj_begin(&w);
+    for (int s = 0; s < EV_SRC_COUNT; s++) jw_kv_int(&w, event_source_name(s), snap.total[s]);
+    jw_obj_end(&w);
+    jw_kv_int(&w, "unknown", snap.unknown);
+    jw_key(&w, "faces");
+    jw_arr_begin(&w);
+    for (int i = 0; i < ACCESS_STATS_FACES; i++) {
+        if (snap.faces[i].id < 0) continue;
+        jw_obj_begin(&w);
+        jw_kv_int(&w, "id", snap.faces[i].id);
+        jw_kv_int(&w, "n", snap.faces[i].count);
+        jw_kv_int(&w, "last", snap.faces[i].last_ts);
+        jw_obj_end(&w);
+    }
+    jw_arr_end(&w);
+    jw_key(&w, "score");
+    jw_obj_begin(&w);
+    _u32_array(&w, "match", snap.score_match, ACCESS_STATS_SCORE_BINS);
+    _u32_array(&w, "reject", snap.score_reject, ACCESS_STATS_SCORE_BINS);
+    jw_obj_end(&w);
+    jw_obj_end(&w);
+    size_t n = 0;
+    return jw_finish(&w, &n) ? n : 0;
+}
+
+void access_stats_init(void) {
+    _reset(&s_stats);
+    nvs_handle_t h;
+    if (nvs_open("nvs", NVS_READONLY, &h) != ESP_OK) return;
+    access_stats_t loaded;
+    size_t sz = sizeof(loaded);
+    if (nvs_get_blob(h, STATS_NVS_KEY, &loaded, &sz) == ESP_OK && sz == sizeof(loaded) && loaded.version == STATS_VERSION) {
+        s_stats = loaded;
+        ESP_LOGI(TAG, "Loaded: face %lu, remote %lu, unknown %lu", (unsigned long)loaded.total[EV_SRC_FACE],
+                 (unsigned long)loaded.total[EV_SRC_REMOTE], (unsigned long)loaded.unknown);
+    }
+    nvs_close(h);
+}
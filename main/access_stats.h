@@ -0,0 +1,45 @@
+#ifndef ACCESS_STATS_H
+#define ACCESS_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "event_store.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// THỐNG KÊ TRUY CẬP TỔNG HỢP SẴN: cập nhật O(1) mỗi sự kiện trong 1 struct cố định (~700 byte).
+// Màn hình phân tích đọc bản tóm tắt (/stats hoặc bảng device_stats) thay vì kéo hàng nghìn dòng access_logs.
+#define ACCESS_STATS_DAYS          14          // Số ngày gần nhất (theo giờ địa phương)
+#define ACCESS_STATS_HOURS         24          // Số giờ gần nhất
+#define ACCESS_STATS_FACES         16          // Số face_id theo dõi riêng
+#define ACCESS_STATS_SCORE_BINS    10          // Histogram điểm 0.0 .. 1.0
+#define ACCESS_STATS_SAVE_MS       (5 * 60 * 1000)     // Ghi NVS tối đa 1 lần / khoảng này
+#define ACCESS_STATS_PUBLISH_MS    (15 * 60 * 1000)    // Đẩy lên cloud tối đa 1 lần / khoảng này
+
+// Nạp từ NVS (gọi sau nvs_flash_init)
+void access_stats_init(void);
+
+// Gộp 1 sự kiện đã ghi vào event_store
+void access_stats_record(const event_rec_t *r);
+
+// Có mặt người nhưng không khớp ai (điểm cao nhất dưới ngưỡng): chỉ histogram điểm.
+// Số người lạ đếm từ sự kiện người lạ (face_id -1) qua access_stats_record.
+void access_stats_unknown(float best_score);
+
+// Ghi NVS nếu có thay đổi và đã tới hạn
+void access_stats_save_if_due(void);
+
+// true nếu có thay đổi chưa đẩy lên cloud và đã tới hạn (tự đánh dấu lượt)
+bool access_stats_publish_due(void);
+
+// Bản tóm tắt JSON. Trả số byte, 0 nếu không đủ chỗ.
+size_t access_stats_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
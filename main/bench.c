@@ -0,0 +1,249 @@
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_app_desc.h"
+#include "perf_monitor.h"
+
+static const char *TAG = "BENCH";
+
+typedef struct {
+    const char *name;
+    bench_fn_t fn;
+    void *ctx;
+    uint32_t flags;
+} bench_entry_t;
+
+static bench_entry_t s_benches[BENCH_MAX];
+static int s_count = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_alloc_count = 0;
+
+typedef enum { JOB_IDLE = 0, JOB_RUNNING, JOB_DONE } job_state_t;
+static const char *JOB_STATE_NAMES[] = { "idle", "running", "done" };
+
+// Lượt chạy nền: task bench ghi, handler HTTP đọc (khoá mutex)
+static struct {
+    job_state_t state;
+    uint32_t iters;
+    uint32_t skip_flags;
+    int done;
+    int total;
+    char *results;          // Các bench_result_json nối bằng ',' (PSRAM, BENCH_JOB_RESULTS_MAX)
+    size_t len;
+    SemaphoreHandle_t mutex;
+} s_job;
+
+void bench_count_alloc(void) {
+    __atomic_fetch_add(&s_alloc_count, 1, __ATOMIC_RELAXED);
+}
+
+esp_err_t bench_register(const char *name, bench_fn_t fn, void *ctx) {
+    return bench_register_flags(name, fn, ctx, 0);
+}
+
+esp_err_t bench_register_flags(const char *name, bench_fn_t fn, void *ctx, uint32_t flags) {
+    esp_err_t err = ESP_ERR_NO_MEM;
+    taskENTER_CRITICAL(&s_lock);
+    bool dup = false;
+    for (int i = 0; i < s_count; i++) {
+        if (strcmp(s_benches[i].name, name) == 0) dup = true;
+    }
+    if (dup) {
+        err = ESP_ERR_INVALID_STATE;
+    } else if (s_count < BENCH_MAX) {
+        s_benches[s_count++] = (bench_entry_t){ name, fn, ctx, flags };
+        err = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return err;
+}
+
+uint32_t bench_flags(const char *name) {
+    for (int i = 0; i < s_count; i++) if (strcmp(s_benches[i].name, name) == 0) return s_benches[i].flags;
+    return 0;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+esp_err_t bench_run(const char *name, uint32_t iters, bench_result_t *out) {
+    bench_entry_t *b = NULL;
+    for (int i = 0; i < s_count; i++) if (strcmp(s_benches[i].name, name) == 0) b = &s_benches[i];
+    if (!b) return ESP_ERR_NOT_FOUND;
+    if (iters == 0) iters = 1;
+    if (iters > BENCH_MAX_ITERS) iters = BENCH_MAX_ITERS;
+    if ((b->flags & BENCH_F_MODEL) && iters > BENCH_MODEL_MAX_ITERS) iters = BENCH_MODEL_MAX_ITERS;
+
+    uint32_t *samples = (uint32_t *)heap_caps_malloc(iters * sizeof(uint32_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!samples) return ESP_ERR_NO_MEM;
+
+    // 1 vòng khởi động (cache, lazy init) không tính
+    b->fn(b->ctx);
+
+    uint64_t sum = 0;
+    uint32_t allocs0 = __atomic_load_n(&s_alloc_count, __ATOMIC_RELAXED);
+    int64_t t_start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iters; i++) {
+        uint32_t c0 = esp_cpu_get_cycle_count();
+        b->fn(b->ctx);
+        samples[i] = esp_cpu_get_cycle_count() - c0;
+        sum += samples[i];
+        // Nhường CPU để watchdog / các task khác không bị bỏ đói khi chạy dài
+        if ((i & 63) == 63) vTaskDelay(1);
+    }
+    perf_trace_record(name, t_start, esp_timer_get_time());
+    uint32_t allocs = __atomic_load_n(&s_alloc_count, __ATOMIC_RELAXED) - allocs0;
+
+    qsort(samples, iters, sizeof(uint32_t), cmp_u32);
+    float mhz = esp_rom_get_cpu_ticks_per_us();
+    out->iters = iters;
+    out->min_us = samples[0] / mhz;
+    out->p50_us = samples[iters / 2] / mhz;
+    out->p90_us = samples[(iters * 90) / 100] / mhz;
+    out->p99_us = samples[(iters * 99) / 100] / mhz;
+    out->max_us = samples[iters - 1] / mhz;
+    out->mean_us = (float)sum / iters / mhz;
+    out->allocs_per_iter = (float)allocs / iters;
+    heap_caps_free(samples);
+
+    ESP_LOGI(TAG, "%s: %lu iters, p50 %.2f us, p99 %.2f us, %.2f allocs/iter",
+             name, (unsigned long)iters, out->p50_us, out->p99_us, out->allocs_per_iter);
+    return ESP_OK;
+}
+
+size_t bench_result_json(const char *name, const bench_result_t *r, char *buf, size_t len) {
+    int n = snprintf(buf, len,
+                     "{\"name\":\"%s\",\"iters\":%lu,\"min_us\":%.2f,\"p50_us\":%.2f,\"p90_us\":%.2f,"
+                     "\"p99_us\":%.2f,\"max_us\":%.2f,\"mean_us\":%.2f,\"allocs\":%.2f}",
+                     name, (unsigned long)r->iters, r->min_us, r->p50_us, r->p90_us, r->p99_us, r->max_us, r->mean_us,
+                     r->allocs_per_iter);
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
+
+size_t bench_list_json(char *buf, size_t len) {
+    size_t off = snprintf(buf, len, "[");
+    for (int i = 0; i < s_count && off < len; i++) {
+        off += snprintf(buf + off, len - off, "%s\"%s\"", i ? "," : "", s_benches[i].name);
+    }
+    if (off < len) off += snprintf(buf + off, len - off, "]");
+    return off < len ? off : 0;
+}
+
+size_t bench_build_json(char *buf, size_t len) {
+    const esp_app_desc_t *app = esp_app_get_description();
+    char elf[17];
+    esp_app_get_elf_sha256(elf, sizeof(elf));
+    int n = snprintf(buf, len,
+                     "{\"project\":\"%s\",\"version\":\"%s\",\"idf\":\"%s\",\"built\":\"%s %s\",\"elf\":\"%s\",\"cpu_mhz\":%lu}",
+                     app->project_name, app->version, app->idf_ver, app->date, app->time, elf,
+                     (unsigned long)esp_rom_get_cpu_ticks_per_us());
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
+
+int bench_run_all(uint32_t iters, uint32_t skip_flags, bench_emit_t emit, void *arg) {
+    int done = 0;
+    char buf[256];
+    // Danh sách chỉ tăng, đọc số lượng 1 lần: benchmark đăng ký giữa chừng để lượt sau
+    int count = s_count;
+    for (int i = 0; i < count; i++) {
+        const bench_entry_t *b = &s_benches[i];
+        if (b->flags & skip_flags) continue;
+        bench_result_t r;
+        if (bench_run(b->name, iters, &r) != ESP_OK) continue;
+        size_t len = bench_result_json(b->name, &r, buf, sizeof(buf));
+        if (len) emit(buf, len, arg);
+        done++;
+    }
+    return done;
+}
+
+static void _job_emit(const char *json, size_t len, void *arg) {
+    xSemaphoreTake(s_job.mutex, portMAX_DELAY);
+    // Buffer đầy: bỏ kết quả, vẫn đếm là đã chạy
+    if (s_job.len + len + 1 < BENCH_JOB_RESULTS_MAX) {
+        if (s_job.len) s_job.results[s_job.len++] = ',';
+        memcpy(s_job.results + s_job.len, json, len);
+        s_job.len += len;
+    }
+    s_job.done++;
+    xSemaphoreGive(s_job.mutex);
+}
+
+static void bench_job_task(void *arg) {
+    int64_t t0 = esp_timer_get_time();
+    bench_run_all(s_job.iters, s_job.skip_flags, _job_emit, NULL);
+    xSemaphoreTake(s_job.mutex, portMAX_DELAY);
+    s_job.state = JOB_DONE;
+    xSemaphoreGive(s_job.mutex);
+    ESP_LOGI(TAG, "Job done: %d benches, %lld ms", s_job.done, (long long)(esp_timer_get_time() - t0) / 1000);
+    vTaskDelete(NULL);
+}
+
+esp_err_t bench_job_start(uint32_t iters, uint32_t skip_flags) {
+    if (!s_job.mutex) {
+        s_job.mutex = xSemaphoreCreateMutex();
+        s_job.results = (char *)heap_caps_malloc(BENCH_JOB_RESULTS_MAX, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!s_job.mutex || !s_job.results) return ESP_ERR_NO_MEM;
+    }
+    int total = 0;
+    int count = s_count;
+    for (int i = 0; i < count; i++) if (!(s_benches[i].flags & skip_flags)) total++;
+
+    xSemaphoreTake(s_job.mutex, portMAX_DELAY);
+    if (s_job.state == JOB_RUNNING) {
+        xSemaphoreGive(s_job.mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_job.state = JOB_RUNNING;
+    s_job.iters = iters;
+    s_job.skip_flags = skip_flags;
+    s_job.done = 0;
+    s_job.total = total;
+    s_job.len = 0;
+    xSemaphoreGive(s_job.mutex);
+
+    // Ưu tiên thấp, không ghim core: task AI / web server / bus vẫn chạy như thường trong lúc đo
+    if (xTaskCreate(bench_job_task, "bench_job", BENCH_JOB_STACK, NULL, BENCH_JOB_PRIORITY, NULL) != pdPASS) {
+        xSemaphoreTake(s_job.mutex, portMAX_DELAY);
+        s_job.state = JOB_IDLE;
+        xSemaphoreGive(s_job.mutex);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+bool bench_job_running(void) {
+    if (!s_job.mutex) return false;
+    xSemaphoreTake(s_job.mutex, portMAX_DELAY);
+    bool running = s_job.state == JOB_RUNNING;
+    xSemaphoreGive(s_job.mutex);
+    return running;
+}
+
+size_t bench_job_json(char *buf, size_t len) {
+    char build[256];
+    size_t build_len = bench_build_json(build, sizeof(build));
+    if (!s_job.mutex) {
+        int n = snprintf(buf, len, "{\"state\":\"idle\",\"done\":0,\"total\":0,\"build\":%s,\"iters\":0,\"results\":[]}",
+                         build_len ? build : "null");
+        return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+    }
+    xSemaphoreTake(s_job.mutex, portMAX_DELAY);
+    int n = snprintf(buf, len, "{\"state\":\"%s\",\"done\":%d,\"total\":%d,\"build\":%s,\"iters\":%lu,\"results\":[%.*s]}",
+                     JOB_STATE_NAMES[s_job.state], s_job.done, s_job.total, build_len ? build : "null",
+                     (unsigned long)s_job.iters, (int)s_job.len, s_job.results);
+    xSemaphoreGive(s_job.mutex);
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
@@ -0,0 +1,87 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Số benchmark đăng ký tối đa
+#define BENCH_MAX           40
+// Số vòng tối đa cho 1 lần chạy (mỗi vòng giữ 1 mẫu để tính phân vị)
+#define BENCH_MAX_ITERS     2000
+
+// 1 vòng đo. ctx do module đăng ký tự quản lý.
+typedef void (*bench_fn_t)(void *ctx);
+
+// Cờ benchmark
+#define BENCH_F_LOOPBACK    (1u << 0)   // Gửi request tới chính web server: không chạy được từ trong handler HTTP
+#define BENCH_F_MODEL       (1u << 1)   // Chạy model AI / giữ khoá model mỗi vòng: task AI phải chờ suốt lượt đo
+
+// Số vòng tối đa cho benchmark BENCH_F_MODEL (mỗi vòng tới hàng trăm ms)
+#define BENCH_MODEL_MAX_ITERS   20
+
+// LƯỢT CHẠY NỀN (cả bộ): task riêng ưu tiên thấp, kết quả gom vào buffer PSRAM để đọc dần
+#define BENCH_JOB_PRIORITY      1
+#define BENCH_JOB_STACK         10240   // Như task AI: benchmark model chạy trong task này
+#define BENCH_JOB_RESULTS_MAX   (BENCH_MAX * 192)
+#define BENCH_JOB_JSON_MAX      (BENCH_JOB_RESULTS_MAX + 512)
+
+typedef struct {
+    uint32_t iters;
+    float min_us;
+    float p50_us;
+    float p90_us;
+    float p99_us;
+    float max_us;
+    float mean_us;
+    float allocs_per_iter;   // Số lần cấp phát heap trung bình mỗi vòng (qua bench_count_alloc)
+} bench_result_t;
+
+// Module tự đăng ký benchmark của mình lúc khởi tạo
+esp_err_t bench_register(const char *name, bench_fn_t fn, void *ctx);
+esp_err_t bench_register_flags(const char *name, bench_fn_t fn, void *ctx, uint32_t flags);
+
+// Cờ của benchmark (0 nếu không có)
+uint32_t bench_flags(const char *name);
+
+// Bộ cấp phát có gắn đếm (vd. hook cJSON) gọi hàm này mỗi lần malloc
+void bench_count_alloc(void);
+
+// Chạy benchmark (chặn người gọi). Đo bằng bộ đếm chu kỳ CPU. BENCH_F_MODEL: iters <= BENCH_MODEL_MAX_ITERS.
+esp_err_t bench_run(const char *name, uint32_t iters, bench_result_t *out);
+
+// {"name":...,"iters":...,"min_us":...,"p50_us":...,...}
+size_t bench_result_json(const char *name, const bench_result_t *r, char *buf, size_t len);
+
+// ["tên 1","tên 2",...]
+size_t bench_list_json(char *buf, size_t len);
+
+// Bản build đang chạy, để so kết quả giữa các firmware:
+// {"project":..,"version":..,"idf":..,"built":..,"elf":..,"cpu_mhz":..}
+size_t bench_build_json(char *buf, size_t len);
+
+// Chạy lần lượt mọi benchmark (bỏ qua benchmark có cờ trong skip_flags), mỗi kết quả
+// (dạng bench_result_json) gọi emit 1 lần. Trả về số benchmark đã chạy.
+typedef void (*bench_emit_t)(const char *json, size_t len, void *arg);
+int bench_run_all(uint32_t iters, uint32_t skip_flags, bench_emit_t emit, void *arg);
+
+// Chạy bench_run_all trong task nền rồi trả ngay. ESP_ERR_INVALID_STATE nếu lượt trước chưa xong.
+esp_err_t bench_job_start(uint32_t iters, uint32_t skip_flags);
+
+// Lượt chạy nền đang chạy (người gọi khác không nên đo cùng lúc: benchmark dùng chung buffer tĩnh)
+bool bench_job_running(void);
+
+// Trạng thái + kết quả đã có của lượt chạy nền (buf: BENCH_JOB_JSON_MAX):
+// {"state":"idle|running|done","done":..,"total":..,"build":{..},"iters":..,"results":[..]}
+size_t bench_job_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
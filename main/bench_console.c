@@ -0,0 +1,182 @@
+#include "bench_console.h"
+#include "sdkconfig.h"
+
+#if CONFIG_BENCH_CONSOLE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_console.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "bench.h"
+#include "supabase_client.h"
+
+static const char *TAG = "BENCH_CON";
+
+static void _print_result(const char *json, size_t len, void *arg) {
+    printf("BENCH_RESULT %.*s\n", (int)len, json);
+    (*(int *)arg)++;
+}
+
+static int bench_cmd(int argc, char **argv) {
+    char buf[1024];
+    if (argc < 2) {
+        size_t len = bench_list_json(buf, sizeof(buf));
+        printf("%.*s\n", (int)len, buf);
+        return 0;
+    }
+    uint32_t iters = argc > 2 ? (uint32_t)atoi(argv[2]) : 200;
+    // Benchmark dùng chung buffer tĩnh: không đo chồng lên lượt chạy nền của /bench?name=all
+    if (bench_job_running()) {
+        printf("BENCH_ERROR %s busy\n", argv[1]);
+        return 1;
+    }
+    if (bench_build_json(buf, sizeof(buf))) printf("BENCH_BUILD %s\n", buf);
+
+    int n = 0;
+    if (strcmp(argv[1], "all") == 0) {
+        bench_run_all(iters, 0, _print_result, &n);
+    } else {
+        bench_result_t r;
+        esp_err_t err = bench_run(argv[1], iters, &r);
+        if (err != ESP_OK) {
+            printf("BENCH_ERROR %s %s\n", argv[1], esp_err_to_name(err));
+            return 1;
+        }
+        size_t len = bench_result_json(argv[1], &r, buf, sizeof(buf));
+        if (len) _print_result(buf, len, &n);
+    }
+    printf("BENCH_DONE %d\n", n);
+    return 0;
+}
+
+// CLOUD: mỗi thao tác đo trọn 1 lần gọi API (kể cả chờ lượt uplink_sched)
+#define CLOUD_RUNS_MAX      50
+#define CLOUD_FACE_ID       9999        // Dòng users thử trên mock
+
+static int cmp_i64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int cloud_cmd(int argc, char **argv) {
+    if (argc < 2) {
+        printf("cloud sync|poll|log|stats|face [n] | cloud image <bytes> [n]\n");
+        return 1;
+    }
+    if (strncmp(SUPABASE_URL, "http://", 7) != 0) {
+        printf("CLOUD_ERROR only against a plain-HTTP mock (SUPABASE_URL http://...)\n");
+        return 1;
+    }
+    const char *op = argv[1];
+    bool image = strcmp(op, "image") == 0;
+    size_t bytes = image && argc > 2 ? (size_t)atoi(argv[2]) : 0;
+    int runs = argc > (image ? 3 : 2) ? atoi(argv[image ? 3 : 2]) : 1;
+    if (runs < 1) runs = 1;
+    if (runs > CLOUD_RUNS_MAX) runs = CLOUD_RUNS_MAX;
+    if (image && bytes == 0) {
+        printf("CLOUD_ERROR image needs <bytes>\n");
+        return 1;
+    }
+    bool known = image || strcmp(op, "sync") == 0 || strcmp(op, "poll") == 0 || strcmp(op, "log") == 0 ||
+                 strcmp(op, "stats") == 0 || strcmp(op, "face") == 0;
+    if (!known) {
+        printf("CLOUD_ERROR unknown op %s\n", op);
+        return 1;
+    }
+
+    float *emb = NULL;
+    camera_fb_t fb = { 0 };
+    if (strcmp(op, "face") == 0) {
+        emb = (float *)heap_caps_malloc(FACE_EMBED_BYTES, MALLOC_CAP_SPIRAM);
+        if (!emb) return 1;
+        for (int i = 0; i < FACE_EMBED_DIM; i++) emb[i] = ((i * 37) % 200 - 100) / 1000.0f;
+    } else if (image) {
+        // Nội dung không quan trọng với mock: chỉ cỡ ảnh quyết định đường upload (thường / TUS)
+        fb.buf = (uint8_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+        if (!fb.buf) return 1;
+        for (size_t i = 0; i < bytes; i++) fb.buf[i] = (uint8_t)i;
+        fb.len = bytes;
+        fb.format = PIXFORMAT_JPEG;
+    }
+
+    int64_t ms[CLOUD_RUNS_MAX];
+    int fails = 0;
+    for (int i = 0; i < runs; i++) {
+        esp_err_t err = ESP_OK;
+        int64_t t0 = esp_timer_get_time();
+        // sync / poll không trả lỗi: xem status theo thao tác trên /__mock/stats
+        if (strcmp(op, "sync") == 0) supabase_sync_users();
+        else if (strcmp(op, "poll") == 0) check_remote_command();
+        else if (strcmp(op, "log") == 0) err = supabase_log_access(-1, 1.0f, NULL);
+        else if (strcmp(op, "stats") == 0) err = supabase_publish_stats();
+        else if (emb) err = supabase_upload_face(CLOUD_FACE_ID, emb, FACE_EMBED_DIM);
+        else {
+            char name[64];
+            snprintf(name, sizeof(name), "mock_%u_%d.jpg", (unsigned)bytes, i);
+            err = supabase_upload_image(&fb, name);
+        }
+        ms[i] = (esp_timer_get_time() - t0) / 1000;
+        if (err != ESP_OK) fails++;
+    }
+    heap_caps_free(emb);
+    heap_caps_free(fb.buf);
+
+    int64_t sum = 0;
+    for (int i = 0; i < runs; i++) sum += ms[i];
+    qsort(ms, runs, sizeof(ms[0]), cmp_i64);
+    printf("CLOUD_RESULT {\"op\":\"%s\",\"bytes\":%u,\"runs\":%d,\"fails\":%d,\"min_ms\":%lld,\"p50_ms\":%lld,"
+           "\"max_ms\":%lld,\"mean_ms\":%lld}\n",
+           op, (unsigned)bytes, runs, fails, ms[0], ms[runs / 2], ms[runs - 1], sum / runs);
+    return 0;
+}
+
+void bench_console_start(void) {
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "lock>";
+    // Benchmark model detect / feature chạy ngay trên task REPL: cần stack như task AI
+    repl_config.task_stack_size = 10240;
+    repl_config.task_priority = 2;
+
+    esp_err_t err = ESP_ERR_NOT_SUPPORTED;
+#if CONFIG_ESP_CONSOLE_UART_DEFAULT || CONFIG_ESP_CONSOLE_UART_CUSTOM
+    esp_console_dev_uart_config_t hw_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    err = esp_console_new_repl_uart(&hw_config, &repl_config, &repl);
+#elif CONFIG_ESP_CONSOLE_USB_CDC
+    esp_console_dev_usb_cdc_config_t hw_config = ESP_CONSOLE_DEV_CDC_CONFIG_DEFAULT();
+    err = esp_console_new_repl_usb_cdc(&hw_config, &repl_config, &repl);
+#elif CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG
+    esp_console_dev_usb_serial_jtag_config_t hw_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    err = esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl);
+#endif
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Console unavailable: %s", esp_err_to_name(err));
+        return;
+    }
+
+    const esp_console_cmd_t cmd = {
+        .command = "bench",
+        .help = "bench | bench <name> [iters] | bench all [iters]",
+        .hint = NULL,
+        .func = bench_cmd,
+    };
+    esp_console_cmd_register(&cmd);
+    const esp_console_cmd_t cloud = {
+        .command = "cloud",
+        .help = "cloud sync|poll|log|stats|face [n] | cloud image <bytes> [n]  (mock only)",
+        .hint = NULL,
+        .func = cloud_cmd,
+    };
+    esp_console_cmd_register(&cloud);
+    esp_console_start_repl(repl);
+    ESP_LOGI(TAG, "Serial bench console ready");
+}
+
+#else
+
+void bench_console_start(void) {}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef BENCH_CONSOLE_H
+#define BENCH_CONSOLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Lệnh "bench" trên cổng serial (chỉ khi bật CONFIG_BENCH_CONSOLE):
+//   bench                  -> danh sách
+//   bench <tên> [iters]    -> chạy 1 benchmark
+//   bench all [iters]      -> chạy cả bộ (kể cả benchmark loopback HTTP)
+// Mỗi kết quả in 1 dòng "BENCH_RESULT {json}", trước đó "BENCH_BUILD {json}", cuối "BENCH_DONE <n>"
+// -> tools/bench_compare.py đọc thẳng log serial.
+//
+// Lệnh "cloud <thao tác> [n]" (sync, poll, log, stats, face) và "cloud image <bytes> [n]":
+// chạy thao tác Supabase n lần, in "CLOUD_RESULT {json}" (thời gian phía khoá).
+// Chỉ chạy khi SUPABASE_URL là http:// -> máy chủ giả lập tools/supabase_mock.py, không bao giờ project thật.
+void bench_console_start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
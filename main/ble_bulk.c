@@ -0,0 +1,462 @@
+#include "ble_bulk.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_gap_ble_api.h"
+#include "esp_gatt_common_api.h"
+#include "ble_frame.h"
+#include "mem_pool.h"
+#include "event_store.h"
+#include "face_detect.h"
+#include "lan_auth.h"
+
+static const char *TAG = "BLE_BULK";
+
+
+// UUID dịch vụ bulk + 2 characteristic: RX (App ghi khung) và TX (Lock notify khung)
+static const uint8_t BULK_SERVICE_UUID[16] = {
+    0x3e, 0x8a, 0x52, 0x1c, 0x0b, 0x7d, 0x4f, 0x61, 0x9c, 0x21, 0x5a, 0x7e, 0x00, 0x10, 0xb1, 0x9a
+};
+static const uint8_t BULK_RX_UUID[16] = {
+    0x3e, 0x8a, 0x52, 0x1c, 0x0b, 0x7d, 0x4f, 0x61, 0x9c, 0x21, 0x5a, 0x7e, 0x01, 0x10, 0xb1, 0x9a
+};
+static const uint8_t BULK_TX_UUID[16] = {
+    0x3e, 0x8a, 0x52, 0x1c, 0x0b, 0x7d, 0x4f, 0x61, 0x9c, 0x21, 0x5a, 0x7e, 0x02, 0x10, 0xb1, 0x9a
+};
+
+#define BULK_NUM_HANDLE        8
+#define BULK_RETX_TIMEOUT_MS   2000    // Không có ACK -> gửi lại từ offset đã xác nhận
+#define BULK_AUTH_CMD          "ble_bulk"
+#define BULK_MAC_LEN           32
+
+// Bit thông báo cho task truyền
+#define BULK_EVT_PULL          (1 << 0)
+#define BULK_EVT_PUSH_DONE     (1 << 1)
+#define BULK_EVT_RESET         (1 << 2)    // BLE tắt: task tự giải phóng buffer (chỉ task đọc chúng)
+
+static esp_gatt_if_t s_gatts_if = ESP_GATT_IF_NONE;
+static uint16_t s_service_handle, s_rx_handle, s_tx_handle, s_cccd_handle;
+static uint16_t s_conn_id;
+static volatile bool s_connected = false;
+static volatile bool s_notify_on = false;
+static volatile bool s_congested = false;
+static volatile uint16_t s_mtu = 23;
+static TaskHandle_t s_task = NULL;
+static SemaphoreHandle_t s_reset_done = NULL;
+
+// Xác thực theo kết nối: challenge do lan_auth cấp, App ký bằng lan_key (xem ble_frame.h)
+static char s_challenge[LAN_AUTH_NONCE_LEN + 1];
+static volatile bool s_authed = false;
+
+// PUSH (App -> Lock)
+static ble_rx_t s_rx;
+static uint32_t s_rx_since_ack = 0;
+static int64_t s_rx_start_us = 0;
+
+// Push đủ dữ liệu: buffer chuyển từ task BTC sang task bulk (kiểm chữ ký + nạp gallery, task giải phóng)
+static struct {
+    uint8_t *volatile buf;      // NULL = task đã xử lý xong, BTC được giao push mới
+    uint32_t len;
+    uint8_t mac[BULK_MAC_LEN];
+    char nonce[LAN_AUTH_NONCE_LEN + 1];
+} s_apply;
+
+// PULL (Lock -> App): ảnh chụp nhật ký giữ tới khi App xác nhận đủ -> resume được sau khi mất kết nối
+static uint8_t *s_pull_buf = NULL;
+static uint32_t s_pull_total = 0;
+static uint32_t s_pull_crc = 0;
+static volatile uint32_t s_pull_acked = 0;
+static volatile bool s_pull_start_req = false;
+static int64_t s_pull_start_us = 0;
+
+static struct {
+    uint8_t op;
+    uint32_t bytes;
+    int64_t ms;
+    uint16_t mtu;
+    uint32_t retransmits;
+} s_last;
+static uint32_t s_retx = 0;
+
+static void bulk_send(uint8_t type, uint8_t op, uint32_t offset, const uint8_t *payload, uint16_t len) {
+    if (!s_connected || !s_notify_on) return;
+    uint8_t frame[BLE_BULK_LOCAL_MTU];
+    size_t n = ble_frame_encode(frame, sizeof(frame), type, op, offset, payload, len);
+    if (n) esp_ble_gatts_send_indicate(s_gatts_if, s_conn_id, s_tx_handle, n, frame, false);
+}
+
+static void bulk_send_ack(uint8_t op, uint32_t offset) {
+    uint8_t credit[2] = { BLE_BULK_WINDOW, 0 };
+    bulk_send(BLE_FRAME_ACK, op, offset, credit, sizeof(credit));
+}
+
+static void bulk_send_err(uint8_t op, ble_err_t err) {
+    uint8_t code = err;
+    bulk_send(BLE_FRAME_ERR, op, 0, &code, 1);
+}
+
+static void bulk_record(uint8_t op, uint32_t bytes, int64_t start_us) {
+    s_last.op = op;
+    s_last.bytes = bytes;
+    s_last.ms = (esp_timer_get_time() - start_us) / 1000;
+    s_last.mtu = s_mtu;
+    s_last.retransmits = s_retx;
+    ESP_LOGI(TAG, "%s %lu bytes in %lld ms (%.1f KB/s, MTU %u, retx %lu)",
+             op == BLE_OP_GALLERY_PUSH ? "Gallery push" : "Log pull", (unsigned long)bytes, s_last.ms,
+             s_last.ms > 0 ? bytes / 1.024f / s_last.ms : 0.0f, s_mtu, (unsigned long)s_retx);
+}
+
+// Dữ liệu App ghi vào RX (chạy trong task BTC: chỉ copy + ACK, việc nặng đẩy sang task bulk)
+static void bulk_on_push_frame(const ble_frame_t *f) {
+    ble_rx_result_t r = ble_rx_feed(&s_rx, f, BLE_BULK_MAX_PUSH);
+    switch (r) {
+    case BLE_RX_NEED_BUF: {
+        if (s_rx.buf) { mem_pool_free(s_rx.buf); ble_rx_attach(&s_rx, NULL, 0); }
+        uint8_t *buf = (uint8_t *)mem_pool_alloc(s_rx.total);
+        if (!buf) { ble_rx_reset(&s_rx); bulk_send_err(f->op, BLE_ERR_NO_MEM); return; }
+        ble_rx_attach(&s_rx, buf, s_rx.total);
+    }
+    // fall through
+    case BLE_RX_RESUMED:
+        if (r == BLE_RX_NEED_BUF || s_rx.received == 0) { s_rx_start_us = esp_timer_get_time(); s_retx = 0; }
+        s_rx_since_ack = 0;
+        bulk_send_ack(f->op, s_rx.received);
+        break;
+    case BLE_RX_CONTINUE:
+        if (f->type == BLE_FRAME_START) { s_rx_start_us = esp_timer_get_time(); s_retx = 0; bulk_send_ack(f->op, 0); break; }
+        // Trả credit khi đã tiêu nửa cửa sổ để App không phải dừng chờ
+        if (++s_rx_since_ack >= BLE_BULK_WINDOW / 2) { s_rx_since_ack = 0; bulk_send_ack(f->op, s_rx.received); }
+        break;
+    case BLE_RX_GAP:
+        s_retx++;
+        bulk_send_ack(f->op, s_rx.received);
+        break;
+    case BLE_RX_DONE:
+        bulk_record(f->op, s_rx.total, s_rx_start_us);
+        // END phải mang chữ ký; task bulk còn đang nạp push trước -> bỏ, App gửi lại
+        if (f->len != BULK_MAC_LEN || s_apply.buf || !s_task) {
+            bulk_send_err(f->op, f->len != BULK_MAC_LEN ? BLE_ERR_AUTH : BLE_ERR_STATE);
+            mem_pool_free(s_rx.buf);
+        } else {
+            memcpy(s_apply.mac, f->payload, BULK_MAC_LEN);
+            memcpy(s_apply.nonce, s_challenge, sizeof(s_apply.nonce));
+            s_apply.len = s_rx.total;
+            s_apply.buf = s_rx.buf;
+            xTaskNotify(s_task, BULK_EVT_PUSH_DONE, eSetBits);
+        }
+        ble_rx_attach(&s_rx, NULL, 0);
+        ble_rx_reset(&s_rx);
+        break;
+    case BLE_RX_ERROR:
+        ESP_LOGE(TAG, "Push error %d", s_rx.err);
+        bulk_send_err(f->op, s_rx.err);
+        break;
+    }
+}
+
+static void bulk_on_pull_frame(const ble_frame_t *f) {
+    if (f->type == BLE_FRAME_START) {
+        // offset = vị trí App muốn tiếp tục (0 = lấy ảnh chụp mới)
+        s_pull_acked = f->offset;
+        s_pull_start_req = true;
+        if (s_task) xTaskNotify(s_task, BULK_EVT_PULL, eSetBits);
+    } else if (f->type == BLE_FRAME_ACK) {
+        s_pull_acked = f->offset;
+        if (s_task) xTaskNotify(s_task, BULK_EVT_PULL, eSetBits);
+    }
+}
+
+// START: cấp challenge mới (huỷ xác thực cũ). DATA: ts(4) | sig hex(64) ký "ble_bulk|<ts>|<challenge>"
+static void bulk_on_auth_frame(const ble_frame_t *f) {
+    if (f->type == BLE_FRAME_START) {
+        s_authed = false;
+        lan_auth_issue_nonce(s_challenge);
+        bulk_send(BLE_FRAME_START, BLE_OP_AUTH, 0, (const uint8_t *)s_challenge, LAN_AUTH_NONCE_LEN);
+        return;
+    }
+    if (f->type != BLE_FRAME_DATA || f->len != 4 + 64 || !s_challenge[0]) { bulk_send_err(BLE_OP_AUTH, BLE_ERR_STATE); return; }
+    char sig[65];
+    memcpy(sig, f->payload + 4, 64);
+    sig[64] = '\0';
+    lan_auth_result_t r = lan_auth_verify(BULK_AUTH_CMD, (int64_t)ble_get_u32(f->payload), s_challenge, sig);
+    s_authed = (r == LAN_AUTH_OK);
+    if (s_authed) {
+        bulk_send_ack(BLE_OP_AUTH, 0);
+    } else {
+        ESP_LOGW(TAG, "Auth rejected: %s", lan_auth_result_name(r));
+        s_challenge[0] = '\0';
+        bulk_send_err(BLE_OP_AUTH, BLE_ERR_AUTH);
+    }
+}
+
+static void bulk_on_write(const uint8_t *data, uint16_t len) {
+    ble_frame_t f;
+    if (!ble_frame_decode(data, len, &f)) { bulk_send_err(0, BLE_ERR_BAD_FRAME); return; }
+    if (f.op == BLE_OP_AUTH) { bulk_on_auth_frame(&f); return; }
+    // Gallery ghi thẳng vào DB nhận diện, nhật ký lộ lịch ra vào: chỉ cho kết nối đã ký bằng lan_key
+    if (!s_authed) { bulk_send_err(f.op, BLE_ERR_AUTH); return; }
+    if (f.op == BLE_OP_GALLERY_PUSH) bulk_on_push_frame(&f);
+    else if (f.op == BLE_OP_LOG_PULL) bulk_on_pull_frame(&f);
+    else bulk_send_err(f.op, BLE_ERR_BAD_FRAME);
+}
+
+// Ảnh chụp nhật ký: các sự kiện mới nhất trong event_store dạng NDJSON, vừa 1 khối LARGE của pool
+typedef struct {
+    uint8_t *buf;
+    uint32_t len;
+} bulk_ndjson_t;
+
+static bool bulk_pull_visit(const event_rec_t *r, void *ctx) {
+    bulk_ndjson_t *out = (bulk_ndjson_t *)ctx;
+    size_t n = event_rec_json(r, (char *)out->buf + out->len, MEM_POOL_LARGE_SIZE - out->len);
+    if (n == 0) return false;
+    out->len += n;
+    return true;
+}
+
+static bool bulk_pull_snapshot(void) {
+    if (s_pull_buf) { mem_pool_free(s_pull_buf); s_pull_buf = NULL; }
+    s_pull_total = 0;
+    s_pull_buf = (uint8_t *)mem_pool_alloc(MEM_POOL_LARGE_SIZE);
+    if (!s_pull_buf) return false;
+    // BLE_BULK_PULL_EVENTS dòng (<= ~130 byte/dòng) luôn vừa khối -> không mất sự kiện mới nhất
+    bulk_ndjson_t out = { s_pull_buf, 0 };
+    event_store_query_recent(BLE_BULK_PULL_EVENTS, bulk_pull_visit, &out);
+    s_pull_total = out.len;
+    s_pull_crc = ble_crc32(0, s_pull_buf, s_pull_total);
+    return true;
+}
+
+// Chạy trên task bulk với buffer BTC đã giao (s_apply): kiểm chữ ký rồi mới ghi vào gallery
+static void bulk_apply_gallery(void) {
+    const uint32_t rec = 4 + FACE_EMBED_BYTES;
+    const uint8_t *buf = s_apply.buf;
+    uint32_t total = s_apply.len;
+    if (!buf) return;
+    if (!lan_auth_check_mac(s_apply.nonce, buf, total, s_apply.mac)) {
+        ESP_LOGW(TAG, "Gallery push rejected: bad signature");
+        bulk_send_err(BLE_OP_GALLERY_PUSH, BLE_ERR_AUTH);
+    } else if (total % rec != 0) {
+        bulk_send_err(BLE_OP_GALLERY_PUSH, BLE_ERR_BAD_FRAME);
+    } else {
+        float *emb = (float *)mem_pool_alloc(FACE_EMBED_BYTES);
+        if (!emb) {
+            bulk_send_err(BLE_OP_GALLERY_PUSH, BLE_ERR_NO_MEM);
+        } else {
+            int count = 0;
+            for (uint32_t off = 0; off < total; off += rec) {
+                int32_t face_id = (int32_t)ble_get_u32(buf + off);
+                memcpy(emb, buf + off + 4, FACE_EMBED_BYTES);
+                face_api_add_user_from_cloud(face_id, emb, FACE_EMBED_DIM);
+                count++;
+            }
+            mem_pool_free(emb);
+            face_api_save_db();
+            ESP_LOGI(TAG, "Loaded %d faces over BLE", count);
+            bulk_send_ack(BLE_OP_GALLERY_PUSH, total);
+        }
+    }
+    mem_pool_free(s_apply.buf);
+    s_apply.buf = NULL;
+}
+
+// Sau deinit_ble_server (BTC đã dừng): chỉ task này còn đụng tới buffer -> giải phóng ở đây
+static void bulk_free_all(void) {
+    if (s_rx.buf) mem_pool_free(s_rx.buf);
+    memset(&s_rx, 0, sizeof(s_rx));
+    if (s_apply.buf) { mem_pool_free(s_apply.buf); s_apply.buf = NULL; }
+    if (s_pull_buf) { mem_pool_free(s_pull_buf); s_pull_buf = NULL; }
+    s_pull_total = 0;
+    s_pull_start_req = false;
+    s_challenge[0] = '\0';
+}
+
+static void ble_bulk_task(void *pvParameters) {
+    uint32_t sent = 0;
+    bool pulling = false;
+    bool end_sent = false;
+    int64_t last_progress_us = 0;
+    uint32_t last_acked = 0;
+
+    while (1) {
+        uint32_t evt = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &evt, pulling ? pdMS_TO_TICKS(50) : portMAX_DELAY);
+
+        if (evt & BULK_EVT_RESET) {
+            bulk_free_all();
+            pulling = false;
+            xSemaphoreGive(s_reset_done);
+            continue;
+        }
+        if (evt & BULK_EVT_PUSH_DONE) bulk_apply_gallery();
+
+        if (s_pull_start_req) {
+            s_pull_start_req = false;
+            // Offset 0 hoặc không khớp ảnh chụp cũ -> chụp lại; ngược lại tiếp tục ảnh chụp cũ
+            if (s_pull_acked == 0 || !s_pull_buf || s_pull_acked > s_pull_total) {
+                s_pull_acked = 0;
+                if (!bulk_pull_snapshot()) { bulk_send_err(BLE_OP_LOG_PULL, BLE_ERR_NO_MEM); continue; }
+                s_pull_start_us = esp_timer_get_time();
+                s_retx = 0;
+            }
+            uint8_t info[8];
+            ble_put_u32(info, s_pull_total);
+            ble_put_u32(info + 4, s_pull_crc);
+            bulk_send(BLE_FRAME_START, BLE_OP_LOG_PULL, s_pull_acked, info, sizeof(info));
+            sent = s_pull_acked;
+            last_acked = s_pull_acked;
+            last_progress_us = esp_timer_get_time();
+            end_sent = false;
+            pulling = true;
+        }
+        if (!pulling) continue;
+        if (!s_connected) { pulling = false; continue; }   // Giữ ảnh chụp, App kết nối lại rồi resume
+
+        uint32_t acked = s_pull_acked;
+        if (acked >= s_pull_total) {
+            bulk_record(BLE_OP_LOG_PULL, s_pull_total, s_pull_start_us);
+            if (s_pull_buf) { mem_pool_free(s_pull_buf); s_pull_buf = NULL; }
+            s_pull_total = 0;
+            pulling = false;
+            continue;
+        }
+        int64_t now = esp_timer_get_time();
+        if (acked != last_acked) { last_acked = acked; last_progress_us = now; }
+        if (now - last_progress_us > BULK_RETX_TIMEOUT_MS * 1000LL) {
+            // Go-back-N: gửi lại từ offset App đã xác nhận
+            sent = acked;
+            end_sent = false;
+            s_retx++;
+            last_progress_us = now;
+        }
+        if (sent < acked) sent = acked;
+
+        // Gửi trong giới hạn cửa sổ; nghẽn thì chờ CONGEST_EVT
+        uint16_t chunk = s_mtu - 3 - BLE_FRAME_HDR_LEN;
+        while (sent < s_pull_total && !s_congested && s_connected &&
+               sent - acked < (uint32_t)chunk * BLE_BULK_WINDOW) {
+            uint16_t n = (s_pull_total - sent < chunk) ? s_pull_total - sent : chunk;
+            bulk_send(BLE_FRAME_DATA, BLE_OP_LOG_PULL, sent, s_pull_buf + sent, n);
+            sent += n;
+            acked = s_pull_acked;
+        }
+        if (sent == s_pull_total && !end_sent) {
+            bulk_send(BLE_FRAME_END, BLE_OP_LOG_PULL, sent, NULL, 0);
+            end_sent = true;
+        }
+    }
+}
+
+void ble_bulk_gatts_event(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param) {
+    if (event == ESP_GATTS_REG_EVT) {
+        if (param->reg.app_id != BLE_BULK_APP_ID || param->reg.status != ESP_GATT_OK) return;
+        s_gatts_if = gatts_if;
+        esp_gatt_srvc_id_t sid = { .is_primary = true, .id = { .inst_id = 0, .uuid = { .len = ESP_UUID_LEN_128 } } };
+        memcpy(sid.id.uuid.uuid.uuid128, BULK_SERVICE_UUID, 16);
+        esp_ble_gatts_create_service(gatts_if, &sid, BULK_NUM_HANDLE);
+        return;
+    }
+    if (gatts_if != s_gatts_if) return;
+
+    switch (event) {
+    case ESP_GATTS_CREATE_EVT: {
+        s_service_handle = param->create.service_handle;
+        esp_bt_uuid_t uuid = { .len = ESP_UUID_LEN_128 };
+        memcpy(uuid.uuid.uuid128, BULK_RX_UUID, 16);
+        esp_ble_gatts_add_char(s_service_handle, &uuid, ESP_GATT_PERM_WRITE_ENCRYPTED,
+                               ESP_GATT_CHAR_PROP_BIT_WRITE | ESP_GATT_CHAR_PROP_BIT_WRITE_NR, NULL, NULL);
+        break;
+    }
+    case ESP_GATTS_ADD_CHAR_EVT:
+        if (memcmp(param->add_char.char_uuid.uuid.uuid128, BULK_RX_UUID, 16) == 0) {
+            s_rx_handle = param->add_char.attr_handle;
+            esp_bt_uuid_t uuid = { .len = ESP_UUID_LEN_128 };
+            memcpy(uuid.uuid.uuid128, BULK_TX_UUID, 16);
+            esp_ble_gatts_add_char(s_service_handle, &uuid, ESP_GATT_PERM_READ_ENCRYPTED,
+                                   ESP_GATT_CHAR_PROP_BIT_NOTIFY, NULL, NULL);
+        } else {
+            s_tx_handle = param->add_char.attr_handle;
+            esp_bt_uuid_t cccd = { .len = ESP_UUID_LEN_16, .uuid = { .uuid16 = ESP_GATT_UUID_CHAR_CLIENT_CONFIG } };
+            esp_ble_gatts_add_char_descr(s_service_handle, &cccd,
+                                         ESP_GATT_PERM_READ_ENCRYPTED | ESP_GATT_PERM_WRITE_ENCRYPTED, NULL, NULL);
+        }
+        break;
+    case ESP_GATTS_ADD_CHAR_DESCR_EVT:
+        s_cccd_handle = param->add_char_descr.attr_handle;
+        esp_ble_gatts_start_service(s_service_handle);
+        break;
+    case ESP_GATTS_CONNECT_EVT: {
+        s_conn_id = param->connect.conn_id;
+        s_connected = true;
+        s_congested = false;
+        s_authed = false;
+        s_mtu = 23;
+        // Mã hoá liên kết (LE Secure Connections) trước khi App đọc/ghi được characteristic bulk
+        esp_ble_set_encryption(param->connect.remote_bda, ESP_BLE_SEC_ENCRYPT_NO_MITM);
+        // Gói LL dài + khoảng kết nối ngắn: nhiều byte hơn mỗi connection event
+        esp_ble_gap_set_pkt_data_len(param->connect.remote_bda, BLE_BULK_LL_OCTETS);
+        esp_ble_conn_update_params_t cp = { .min_int = 0x06, .max_int = 0x0C, .latency = 0, .timeout = 400 };
+        memcpy(cp.bda, param->connect.remote_bda, sizeof(esp_bd_addr_t));
+        esp_ble_gap_update_conn_params(&cp);
+        break;
+    }
+    case ESP_GATTS_MTU_EVT:
+        s_mtu = param->mtu.mtu;
+        ESP_LOGI(TAG, "MTU %u", s_mtu);
+        break;
+    case ESP_GATTS_CONGEST_EVT:
+        s_congested = param->congest.congested;
+        if (!s_congested && s_task) xTaskNotify(s_task, BULK_EVT_PULL, eSetBits);
+        break;
+    case ESP_GATTS_WRITE_EVT:
+        if (param->write.handle == s_cccd_handle && param->write.len == 2) {
+            s_notify_on = (param->write.value[0] & 0x01) != 0;
+        } else if (param->write.handle == s_rx_handle) {
+            bulk_on_write(param->write.value, param->write.len);
+        }
+        if (param->write.need_rsp) {
+            esp_ble_gatts_send_response(gatts_if, param->write.conn_id, param->write.trans_id, ESP_GATT_OK, NULL);
+        }
+        break;
+    case ESP_GATTS_DISCONNECT_EVT:
+        // Giữ phiên PUSH / ảnh chụp PULL để App kết nối lại và resume
+        s_connected = false;
+        s_notify_on = false;
+        s_authed = false;
+        if (s_task) xTaskNotify(s_task, BULK_EVT_PULL, eSetBits);
+        break;
+    default:
+        break;
+    }
+}
+
+void ble_bulk_init(void) {
+    if (!s_reset_done) s_reset_done = xSemaphoreCreateBinary();
+    if (!s_task) xTaskCreatePinnedToCore(ble_bulk_task, "ble_bulk", 4096, NULL, 4, &s_task, 0);
+}
+
+void ble_bulk_reset(void) {
+    s_gatts_if = ESP_GATT_IF_NONE;
+    s_connected = false;
+    s_notify_on = false;
+    s_authed = false;
+    if (!s_task) return;
+    // Task có thể đang gửi từ s_pull_buf / nạp s_apply.buf: nhờ task tự giải phóng rồi mới trả về
+    xSemaphoreTake(s_reset_done, 0);
+    xTaskNotify(s_task, BULK_EVT_RESET, eSetBits);
+    if (xSemaphoreTake(s_reset_done, pdMS_TO_TICKS(2000)) != pdTRUE) ESP_LOGW(TAG, "Reset not acknowledged");
+}
+
+size_t ble_bulk_stats_json(char *buf, size_t len) {
+    int n = snprintf(buf, len,
+                     "{\"op\":\"%s\",\"bytes\":%lu,\"ms\":%lld,\"kbps\":%.1f,\"mtu\":%u,\"retransmits\":%lu}",
+                     s_last.op == BLE_OP_GALLERY_PUSH ? "gallery_push" : s_last.op == BLE_OP_LOG_PULL ? "log_pull" : "none",
+                     (unsigned long)s_last.bytes, s_last.ms,
+                     s_last.ms > 0 ? s_last.bytes / 1.024f / s_last.ms : 0.0f, s_last.mtu,
+                     (unsigned long)s_last.retransmits);
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
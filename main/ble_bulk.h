@@ -0,0 +1,48 @@
+#ifndef BLE_BULK_H
+#define BLE_BULK_H
+
+#include <stddef.h>
+#include "esp_gatts_api.h"
+#include "face_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// DỊCH VỤ BLE BULK: nạp gallery / tải nhật ký khi không có Internet (giao thức khung: ble_frame.h).
+// - Chỉ tồn tại khi BLE bật: lúc provisioning hoặc WiFi mất kết nối (net_supervisor). Có IP thì BLE
+//   bị tắt để nhường sóng 2.4 GHz cho WiFi -> khi online App dùng LAN (/api/cmd) hoặc cloud.
+// - Liên kết mã hoá (LE Secure Connections, Just Works) chống nghe lén; khoá không có màn hình /
+//   bàn phím nên không chống MITM ở tầng BLE -> mỗi kết nối phải ký challenge bằng lan_key (op AUTH),
+//   push còn phải ký cả dữ liệu. Khoá chưa có lan_key: PUSH / PULL luôn bị từ chối.
+
+// App ID của dịch vụ bulk (dịch vụ provisioning dùng 0)
+#define BLE_BULK_APP_ID        1
+// MTU cục bộ đề nghị: 1 notify mang tối đa MTU - 3 byte
+#define BLE_BULK_LOCAL_MTU     517
+// Độ dài gói Link Layer (Data Length Extension)
+#define BLE_BULK_LL_OCTETS     251
+// Số khung được gửi trước khi phải chờ ACK (cửa sổ trượt)
+#define BLE_BULK_WINDOW        8
+// Giới hạn dữ liệu nạp gallery (bản ghi 4 + FACE_EMBED_DIM * 4 byte)
+#define BLE_BULK_MAX_PUSH      (16 * (4 + FACE_EMBED_BYTES))
+// Số sự kiện mới nhất gửi khi App kéo nhật ký (NDJSON từ event_store, vừa 1 khối 128 KB)
+#define BLE_BULK_PULL_EVENTS   960
+
+// Tạo task truyền (gọi trong init_ble_server)
+void ble_bulk_init(void);
+
+// Xử lý sự kiện GATTS (tự lọc theo gatts_if của dịch vụ bulk)
+void ble_bulk_gatts_event(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param);
+
+// BLE bị tắt (sau esp_bluedroid_deinit): task bulk huỷ phiên, tự giải phóng buffer; chờ tối đa 2 s
+void ble_bulk_reset(void);
+
+// Thống kê lần truyền gần nhất (byte, ms, KB/s) dạng JSON
+size_t ble_bulk_stats_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,114 @@
+#include "ble_frame.h"
+#include <string.h>
+
+uint32_t ble_get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void ble_put_u32(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; p[2] = (v >> 16) & 0xFF; p[3] = (v >> 24) & 0xFF;
+}
+
+size_t ble_frame_encode(uint8_t *out, size_t cap, uint8_t type, uint8_t op, uint32_t offset,
+                        const uint8_t *payload, uint16_t len) {
+    if (cap < (size_t)BLE_FRAME_HDR_LEN + len) return 0;
+    out[0] = type;
+    out[1] = op;
+    out[2] = len & 0xFF;
+    out[3] = len >> 8;
+    ble_put_u32(out + 4, offset);
+    if (len && payload) memcpy(out + BLE_FRAME_HDR_LEN, payload, len);
+    return BLE_FRAME_HDR_LEN + len;
+}
+
+bool ble_frame_decode(const uint8_t *in, size_t in_len, ble_frame_t *f) {
+    if (!in || in_len < BLE_FRAME_HDR_LEN) return false;
+    f->type = in[0];
+    f->op = in[1];
+    f->len = (uint16_t)(in[2] | (in[3] << 8));
+    f->offset = ble_get_u32(in + 4);
+    if ((size_t)BLE_FRAME_HDR_LEN + f->len != in_len) return false;
+    if (f->type < BLE_FRAME_START || f->type > BLE_FRAME_ERR) return false;
+    f->payload = in + BLE_FRAME_HDR_LEN;
+    return true;
+}
+
+// Bảng 16 phần tử (nibble): nhỏ gọn, đủ nhanh cho vài chục KB
+uint32_t ble_crc32(uint32_t crc, const uint8_t *data, size_t len) {
+    static const uint32_t T[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ T[crc & 0x0F];
+        crc = (crc >> 4) ^ T[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+void ble_rx_reset(ble_rx_t *rx) {
+    uint8_t *buf = rx->buf;
+    uint32_t cap = rx->cap;
+    memset(rx, 0, sizeof(*rx));
+    // Giữ buffer để phiên sau dùng lại
+    rx->buf = buf;
+    rx->cap = cap;
+}
+
+void ble_rx_attach(ble_rx_t *rx, uint8_t *buf, uint32_t cap) {
+    rx->buf = buf;
+    rx->cap = cap;
+}
+
+static ble_rx_result_t ble_rx_fail(ble_rx_t *rx, ble_err_t err) {
+    rx->err = err;
+    return BLE_RX_ERROR;
+}
+
+ble_rx_result_t ble_rx_feed(ble_rx_t *rx, const ble_frame_t *f, uint32_t max_total) {
+    switch (f->type) {
+    case BLE_FRAME_START: {
+        if (f->len != 8) return ble_rx_fail(rx, BLE_ERR_BAD_FRAME);
+        uint32_t total = ble_get_u32(f->payload);
+        uint32_t crc = ble_get_u32(f->payload + 4);
+        // Cùng dữ liệu với phiên đang dở (App kết nối lại) -> tiếp tục, không nhận lại từ đầu
+        if (rx->active && rx->op == f->op && rx->total == total && rx->crc == crc) {
+            rx->err = BLE_ERR_NONE;
+            return BLE_RX_RESUMED;
+        }
+        if (total == 0 || total > max_total) return ble_rx_fail(rx, BLE_ERR_TOO_LARGE);
+        ble_rx_reset(rx);
+        rx->op = f->op;
+        rx->total = total;
+        rx->crc = crc;
+        rx->active = true;
+        return (rx->buf && rx->cap >= total) ? BLE_RX_CONTINUE : BLE_RX_NEED_BUF;
+    }
+    case BLE_FRAME_DATA:
+        if (!rx->active || f->op != rx->op || !rx->buf || rx->cap < rx->total) return ble_rx_fail(rx, BLE_ERR_STATE);
+        // Khung vượt trước -> báo lỗ hổng; khung lặp (đã nhận hết) thì bỏ qua
+        if (f->offset > rx->received) return BLE_RX_GAP;
+        if ((uint64_t)f->offset + f->len <= rx->received) return BLE_RX_CONTINUE;
+        if ((uint64_t)f->offset + f->len > rx->total) return ble_rx_fail(rx, BLE_ERR_TOO_LARGE);
+        {
+            // Bên gửi lùi lại nhưng cắt khung khác: chỉ lấy phần sau rx->received
+            uint32_t skip = rx->received - f->offset;
+            memcpy(rx->buf + rx->received, f->payload + skip, f->len - skip);
+            rx->received = f->offset + f->len;
+        }
+        return BLE_RX_CONTINUE;
+    case BLE_FRAME_END:
+        if (!rx->active || f->op != rx->op) return ble_rx_fail(rx, BLE_ERR_STATE);
+        if (rx->received != rx->total) return BLE_RX_GAP;
+        if (ble_crc32(0, rx->buf, rx->total) != rx->crc) {
+            rx->active = false;
+            return ble_rx_fail(rx, BLE_ERR_CRC);
+        }
+        rx->active = false;
+        return BLE_RX_DONE;
+    default:
+        return ble_rx_fail(rx, BLE_ERR_BAD_FRAME);
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef BLE_FRAME_H
+#define BLE_FRAME_H
+
+// Giao thức khung cho dịch vụ BLE bulk (nạp gallery / tải nhật ký).
+// Module C thuần, không phụ thuộc ESP-IDF -> biên dịch được trên máy host.
+//
+// Khung (little-endian):  type(1) | op(1) | len(2) | offset(4) | payload(len)
+//   START  App -> Lock: payload = total(4) | crc32(4). Lock trả ACK với offset tiếp tục (resume).
+//          Với LOG_PULL App gửi START rỗng, Lock trả START kèm total/crc rồi gửi DATA.
+//   DATA   offset = vị trí byte đầu payload trong toàn bộ dữ liệu
+//   END    Bên gửi báo hết dữ liệu; bên nhận kiểm tra CRC rồi trả ACK (DONE) hoặc ERR
+//   ACK    offset = số byte đã nhận liên tục; len = 2, payload = credit(2) số khung được gửi tiếp
+//   ERR    payload = mã lỗi (1)
+//
+// Xác thực (op AUTH, bắt buộc trước PUSH / PULL, mỗi kết nối 1 lần):
+//   App START rỗng -> Lock START payload = challenge (LAN_AUTH_NONCE_LEN ký tự hex, dùng 1 lần)
+//   App DATA payload = ts(4) | sig(64 ký tự hex) với sig = HMAC-SHA256(lan_key, "ble_bulk|<ts>|<challenge>")
+//   Lock ACK (đã xác thực) hoặc ERR(AUTH)
+// GALLERY_PUSH: END của App mang payload = HMAC-SHA256(lan_key, challenge || dữ liệu) (32 byte),
+// push không ký / ký sai bị bỏ (CRC-32 chỉ chống lỗi truyền, không chống giả mạo).
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLE_FRAME_HDR_LEN   8
+
+typedef enum {
+    BLE_FRAME_START = 1,
+    BLE_FRAME_DATA  = 2,
+    BLE_FRAME_END   = 3,
+    BLE_FRAME_ACK   = 4,
+    BLE_FRAME_ERR   = 5,
+} ble_frame_type_t;
+
+typedef enum {
+    BLE_OP_GALLERY_PUSH = 1,    // App -> Lock: bản ghi {face_id(4) | embedding float[FACE_EMBED_DIM]}
+    BLE_OP_LOG_PULL     = 2,    // Lock -> App: nhật ký truy cập (NDJSON)
+    BLE_OP_AUTH         = 3,    // Challenge / chữ ký của phiên (xem trên)
+} ble_op_t;
+
+typedef enum {
+    BLE_ERR_NONE = 0,
+    BLE_ERR_BAD_FRAME,
+    BLE_ERR_TOO_LARGE,
+    BLE_ERR_NO_MEM,
+    BLE_ERR_CRC,
+    BLE_ERR_STATE,
+    BLE_ERR_AUTH,               // Chưa xác thực / chữ ký sai / khoá chưa có lan_key
+} ble_err_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t op;
+    uint16_t len;
+    uint32_t offset;
+    const uint8_t *payload;     // Trỏ vào buffer gốc, không copy
+} ble_frame_t;
+
+// Ghép khung vào out. Trả số byte, 0 nếu không đủ chỗ.
+size_t ble_frame_encode(uint8_t *out, size_t cap, uint8_t type, uint8_t op, uint32_t offset,
+                        const uint8_t *payload, uint16_t len);
+
+// Tách khung. false nếu ngắn hơn header hoặc len không khớp.
+bool ble_frame_decode(const uint8_t *in, size_t in_len, ble_frame_t *f);
+
+// CRC-32 (IEEE 802.3), gọi nối tiếp được: crc = ble_crc32(crc, ...), bắt đầu từ 0
+uint32_t ble_crc32(uint32_t crc, const uint8_t *data, size_t len);
+
+// Đọc / ghi số nguyên little-endian trong payload
+uint32_t ble_get_u32(const uint8_t *p);
+void ble_put_u32(uint8_t *p, uint32_t v);
+
+// GHÉP DỮ LIỆU PHÍA NHẬN (có resume): người dùng cấp buffer đủ lớn cho total
+typedef enum {
+    BLE_RX_CONTINUE = 0,    // Nhận tiếp
+    BLE_RX_NEED_BUF,        // START hợp lệ: cấp buffer >= total rồi gọi ble_rx_attach
+    BLE_RX_RESUMED,         // START trùng phiên dở dang: tiếp tục từ rx->received
+    BLE_RX_GAP,             // Khung lệch offset (mất gói): báo ACK(received) để bên gửi lùi lại
+    BLE_RX_DONE,            // Đủ dữ liệu, CRC đúng
+    BLE_RX_ERROR,           // Xem rx->err
+} ble_rx_result_t;
+
+typedef struct {
+    uint8_t op;
+    uint8_t *buf;
+    uint32_t cap;
+    uint32_t total;
+    uint32_t crc;
+    uint32_t received;
+    bool active;
+    ble_err_t err;
+} ble_rx_t;
+
+void ble_rx_reset(ble_rx_t *rx);
+void ble_rx_attach(ble_rx_t *rx, uint8_t *buf, uint32_t cap);
+// max_total: giới hạn kích thước chấp nhận cho phiên mới
+ble_rx_result_t ble_rx_feed(ble_rx_t *rx, const ble_frame_t *f, uint32_t max_total);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
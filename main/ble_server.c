@@ -1,199 +1,270 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "esp_system.h"
-#include "esp_log.h"
-#include "nvs_flash.h"
-#include "esp_bt.h"
-#include "esp_gap_ble_api.h"
-#include "esp_gatts_api.h"
-#include "esp_bt_defs.h"
-#include "esp_bt_main.h"
-#include "esp_gatt_common_api.h"
-#include "cJSON.h" 
-#include "wifi_manager.h" 
-#include "supabase_client.h"
-
-#define TAG "BLE_PROV"
-#define DEVICE_NAME "S3_SMART_LOCK_SETUP"
-
-// UUID Config 
-#define GATTS_SERVICE_UUID_TEST   0x9AB1 
-#define GATTS_CHAR_UUID_TEST      0x1632
-
-static uint8_t service_uuid128[16] = {
-    0xc9, 0x2c, 0x98, 0x10, 0x76, 0x16, 0x46, 0xbf,
-    0x8b, 0x36, 0xe9, 0x35, 0x55, 0x4f, 0xb1, 0x9a
-};
-
-static void gatts_profile_a_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param);
-
-#define GATTS_NUM_HANDLE_TEST     4
-#define PROFILE_NUM 1
-#define PROFILE_A_APP_ID 0
-
-struct gatts_profile_inst {
-    esp_gatts_cb_t gatts_cb;
-    uint16_t gatts_if;
-    uint16_t app_id;
-    uint16_t conn_id;
-    uint16_t service_handle;
-    esp_gatt_srvc_id_t service_id;
-    uint16_t char_handle;
-    esp_bt_uuid_t char_uuid;
-    esp_gatt_perm_t perm;
-    esp_gatt_char_prop_t property;
-    uint16_t descr_handle;
-    esp_bt_uuid_t descr_uuid;
-};
-
-static struct gatts_profile_inst gl_profile_tab[PROFILE_NUM] = {
-    [PROFILE_A_APP_ID] = {
-        .gatts_cb = gatts_profile_a_event_handler,
-        .gatts_if = ESP_GATT_IF_NONE,
-    },
-};
-
-static esp_ble_adv_data_t adv_data = {
-    .set_scan_rsp = false,
-    .include_name = true,
-    .include_txpower = false,
-    .min_interval = 0x0006,
-    .max_interval = 0x0010,
-    .appearance = 0x00,
-    .manufacturer_len = 0,
-    .p_manufacturer_data =  NULL,
-    .service_data_len = 0,
-    .p_service_data = NULL,
-    .service_uuid_len = sizeof(service_uuid128),
-    .p_service_uuid = service_uuid128,
-    .flag = (ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT),
-};
-
-static esp_ble_adv_params_t adv_params = {
-    .adv_int_min        = 0x20,
-    .adv_int_max        = 0x40,
-    .adv_type           = ADV_TYPE_IND,
-    .own_addr_type      = BLE_ADDR_TYPE_PUBLIC,
-    .channel_map        = ADV_CHNL_ALL,
-    .adv_filter_policy = ADV_FILTER_ALLOW_SCAN_ANY_CON_ANY,
-};
-
-// HÀM XỬ LÝ NHẬN DATA TỪ APP 
-void handle_write_event(esp_ble_gatts_cb_param_t *param) {
-    if (param->write.len > 0) {
-        char *data_str = (char *)malloc(param->write.len + 1);
-        if (!data_str) return;
-        
-        memcpy(data_str, param->write.value, param->write.len);
-        data_str[param->write.len] = '\0';
-        
-        ESP_LOGI(TAG, "Received Payload (%d bytes)", param->write.len);
-
-        cJSON *root = cJSON_Parse(data_str);
-        if (root == NULL) {
-            ESP_LOGE(TAG, "Invalid JSON");
-            free(data_str);
-            return;
-        }
-
-        // Lấy thông tin từ JSON
-        cJSON *ssid = cJSON_GetObjectItem(root, "ssid");
-        cJSON *pass = cJSON_GetObjectItem(root, "password");
-        cJSON *url  = cJSON_GetObjectItem(root, "url"); 
-        cJSON *key  = cJSON_GetObjectItem(root, "key"); 
-
-        if (cJSON_IsString(ssid)) {
-            ESP_LOGW(TAG, "WiFi Config Received: %s", ssid->valuestring);
-            // 1. Save WiFi
-            const char *pass_str = (cJSON_IsString(pass)) ? pass->valuestring : "";
-            wifi_save_config(ssid->valuestring, pass_str);
-
-            // 2. Save Database
-            if (cJSON_IsString(url) && cJSON_IsString(key)) {
-                ESP_LOGW(TAG, "Supabase Config Received!");
-                supabase_save_config(url->valuestring, key->valuestring);
-            }
-
-            ESP_LOGW(TAG, "All Config Saved! Restarting in 2s...");
-            
-            cJSON_Delete(root);
-            free(data_str);
-            vTaskDelay(pdMS_TO_TICKS(2000));
-            esp_restart();
-        }
-
-        cJSON_Delete(root);
-        free(data_str);
-    }
-}
-
-static void gatts_profile_a_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param) {
-    switch (event) {
-    case ESP_GATTS_REG_EVT:
-        esp_ble_gap_set_device_name(DEVICE_NAME);
-        esp_ble_gap_config_adv_data(&adv_data);
-        gl_profile_tab[PROFILE_A_APP_ID].service_id.is_primary = true;
-        gl_profile_tab[PROFILE_A_APP_ID].service_id.id.inst_id = 0x00;
-        gl_profile_tab[PROFILE_A_APP_ID].service_id.id.uuid.len = ESP_UUID_LEN_128;
-        memcpy(gl_profile_tab[PROFILE_A_APP_ID].service_id.id.uuid.uuid.uuid128, service_uuid128, 16);
-        esp_ble_gatts_create_service(gatts_if, &gl_profile_tab[PROFILE_A_APP_ID].service_id, GATTS_NUM_HANDLE_TEST);
-        break;
-    case ESP_GATTS_CREATE_EVT:
-        gl_profile_tab[PROFILE_A_APP_ID].service_handle = param->create.service_handle;
-        gl_profile_tab[PROFILE_A_APP_ID].char_uuid.len = ESP_UUID_LEN_16;
-        gl_profile_tab[PROFILE_A_APP_ID].char_uuid.uuid.uuid16 = GATTS_CHAR_UUID_TEST;
-        esp_ble_gatts_add_char(gl_profile_tab[PROFILE_A_APP_ID].service_handle, &gl_profile_tab[PROFILE_A_APP_ID].char_uuid,
-                               ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE,
-                               ESP_GATT_CHAR_PROP_BIT_READ | ESP_GATT_CHAR_PROP_BIT_WRITE, NULL, NULL);
-        break;
-    case ESP_GATTS_ADD_CHAR_EVT:
-        gl_profile_tab[PROFILE_A_APP_ID].char_handle = param->add_char.attr_handle;
-        esp_ble_gatts_start_service(gl_profile_tab[PROFILE_A_APP_ID].service_handle);
-        break;
-    case ESP_GATTS_CONNECT_EVT:
-        ESP_LOGI(TAG, "CONNECTED");
-        gl_profile_tab[PROFILE_A_APP_ID].conn_id = param->connect.conn_id;
-        break;
-    case ESP_GATTS_WRITE_EVT:
-        handle_write_event(param);
-        break;
-    case ESP_GATTS_DISCONNECT_EVT:
-        ESP_LOGI(TAG, "DISCONNECTED");
-        esp_ble_gap_start_advertising(&adv_params);
-        break;
-    default:
-        break;
-    }
-}
-
-static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
-    if (event == ESP_GAP_BLE_ADV_DATA_SET_COMPLETE_EVT) {
-        esp_ble_gap_start_advertising(&adv_params);
-    }
-}
-
-static void gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param) {
-    if (event == ESP_GATTS_REG_EVT) {
-        if (param->reg.status == ESP_GATT_OK) gl_profile_tab[param->reg.app_id].gatts_if = gatts_if;
-    }
-    if (gatts_if == ESP_GATT_IF_NONE || gatts_if == gl_profile_tab[0].gatts_if) {
-        if (gl_profile_tab[0].gatts_cb) gl_profile_tab[0].gatts_cb(event, gatts_if, param);
-    }
-}
-
-void init_ble_server(void) {
-    ESP_LOGI(TAG, "Initializing BLE Provisioning Server...");
-    ESP_ERROR_CHECK(esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT));
-    esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK(esp_bt_controller_init(&bt_cfg));
-    ESP_ERROR_CHECK(esp_bt_controller_enable(ESP_BT_MODE_BLE));
-    ESP_ERROR_CHECK(esp_bluedroid_init());
-    ESP_ERROR_CHECK(esp_bluedroid_enable());
-    ESP_ERROR_CHECK(esp_ble_gatts_register_callback(gatts_event_handler));
-    ESP_ERROR_CHECK(esp_ble_gap_register_callback(gap_event_handler));
-    ESP_ERROR_CHECK(esp_ble_gatts_app_register(PROFILE_A_APP_ID));
-    ESP_LOGI(TAG, "BLE Ready! Waiting for App...");
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "esp_bt.h"
+#include "esp_gap_ble_api.h"
+#include "esp_gatts_api.h"
+#include "esp_bt_defs.h"
+#include "esp_bt_main.h"
+#include "esp_gatt_common_api.h"
+#include "cJSON.h" 
+#include "wifi_manager.h" 
+#include "supabase_client.h"
+#include "ble_server.h"
+#include "net_supervisor.h"
+#include "ble_bulk.h"
+#include "lan_auth.h"
+
+#define TAG "BLE_PROV"
+#define DEVICE_NAME "S3_SMART_LOCK_SETUP"
+
+// UUID Config 
+#define GATTS_SERVICE_UUID_TEST   0x9AB1 
+#define GATTS_CHAR_UUID_TEST      0x1632
+
+static uint8_t service_uuid128[16] = {
+    0xc9, 0x2c, 0x98, 0x10, 0x76, 0x16, 0x46, 0xbf,
+    0x8b, 0x36, 0xe9, 0x35, 0x55, 0x4f, 0xb1, 0x9a
+};
+
+static void gatts_profile_a_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param);
+
+#define GATTS_NUM_HANDLE_TEST     4
+#define PROFILE_NUM 1
+#define PROFILE_A_APP_ID 0
+
+struct gatts_profile_inst {
+    esp_gatts_cb_t gatts_cb;
+    uint16_t gatts_if;
+    uint16_t app_id;
+    uint16_t conn_id;
+    uint16_t service_handle;
+    esp_gatt_srvc_id_t service_id;
+    uint16_t char_handle;
+    esp_bt_uuid_t char_uuid;
+    esp_gatt_perm_t perm;
+    esp_gatt_char_prop_t property;
+    uint16_t descr_handle;
+    esp_bt_uuid_t descr_uuid;
+};
+
+static struct gatts_profile_inst gl_profile_tab[PROFILE_NUM] = {
+    [PROFILE_A_APP_ID] = {
+        .gatts_cb = gatts_profile_a_event_handler,
+        .gatts_if = ESP_GATT_IF_NONE,
+    },
+};
+
+static esp_ble_adv_data_t adv_data = {
+    .set_scan_rsp = false,
+    .include_name = true,
+    .include_txpower = false,
+    .min_interval = 0x0006,
+    .max_interval = 0x0010,
+    .appearance = 0x00,
+    .manufacturer_len = 0,
+    .p_manufacturer_data =  NULL,
+    .service_data_len = 0,
+    .p_service_data = NULL,
+    .service_uuid_len = sizeof(service_uuid128),
+    .p_service_uuid = service_uuid128,
+    .flag = (ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT),
+};
+
+static esp_ble_adv_params_t adv_params = {
+    .adv_int_min        = 0x20,
+    .adv_int_max        = 0x40,
+    .adv_type           = ADV_TYPE_IND,
+    .own_addr_type      = BLE_ADDR_TYPE_PUBLIC,
+    .channel_map        = ADV_CHNL_ALL,
+    .adv_filter_policy = ADV_FILTER_ALLOW_SCAN_ANY_CON_ANY,
+};
+
+// HÀM XỬ LÝ NHẬN DATA TỪ APP 
+void handle_write_event(esp_ble_gatts_cb_param_t *param) {
+    if (param->write.len > 0) {
+        char *data_str = (char *)malloc(param->write.len + 1);
+        if (!data_str) return;
+        
+        memcpy(data_str, param->write.value, param->write.len);
+        data_str[param->write.len] = '\0';
+        
+        ESP_LOGI(TAG, "Received Payload (%d bytes)", param->write.len);
+
+        cJSON *root = cJSON_Parse(data_str);
+        if (root == NULL) {
+            ESP_LOGE(TAG, "Invalid JSON");
+            free(data_str);
+            return;
+        }
+
+        // Lấy thông tin từ JSON
+        cJSON *ssid = cJSON_GetObjectItem(root, "ssid");
+        cJSON *pass = cJSON_GetObjectItem(root, "password");
+        cJSON *url  = cJSON_GetObjectItem(root, "url"); 
+        cJSON *key  = cJSON_GetObjectItem(root, "key"); 
+        cJSON *lan_key = cJSON_GetObjectItem(root, "lan_key");
+        cJSON *lan_key_sig = cJSON_GetObjectItem(root, "lan_key_sig");
+
+        // Khoá ký lệnh LAN (/api/cmd) có thể gửi riêng hoặc cùng cấu hình WiFi.
+        // Lần đầu nhận thẳng; đổi khoá cần "lan_key_sig" ký bằng khoá cũ (xem lan_auth.h)
+        if (cJSON_IsString(lan_key)) {
+            esp_err_t err = lan_auth_save_key_hex(lan_key->valuestring,
+                                                  cJSON_IsString(lan_key_sig) ? lan_key_sig->valuestring : NULL);
+            ESP_LOGW(TAG, "LAN key %s", err == ESP_OK ? "saved" :
+                     err == ESP_ERR_INVALID_STATE ? "rejected (already provisioned, rekey not signed)" :
+                     "invalid (need 64 hex chars)");
+        }
+
+        if (cJSON_IsString(ssid)) {
+            ESP_LOGW(TAG, "WiFi Config Received: %s", ssid->valuestring);
+            // 1. Save WiFi
+            const char *pass_str = (cJSON_IsString(pass)) ? pass->valuestring : "";
+            wifi_save_config(ssid->valuestring, pass_str);
+
+            // 2. Save Database
+            if (cJSON_IsString(url) && cJSON_IsString(key)) {
+                ESP_LOGW(TAG, "Supabase Config Received!");
+                supabase_save_config(url->valuestring, key->valuestring);
+            }
+
+            // Không khởi động lại: supervisor nạp cấu hình mới và thử kết nối, nhận diện vẫn chạy
+            ESP_LOGW(TAG, "All Config Saved! Reconnecting...");
+            net_supervisor_config_changed();
+        }
+
+        cJSON_Delete(root);
+        free(data_str);
+    }
+}
+
+static void gatts_profile_a_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param) {
+    switch (event) {
+    case ESP_GATTS_REG_EVT:
+        esp_ble_gap_set_device_name(DEVICE_NAME);
+        esp_ble_gap_config_adv_data(&adv_data);
+        gl_profile_tab[PROFILE_A_APP_ID].service_id.is_primary = true;
+        gl_profile_tab[PROFILE_A_APP_ID].service_id.id.inst_id = 0x00;
+        gl_profile_tab[PROFILE_A_APP_ID].service_id.id.uuid.len = ESP_UUID_LEN_128;
+        memcpy(gl_profile_tab[PROFILE_A_APP_ID].service_id.id.uuid.uuid.uuid128, service_uuid128, 16);
+        esp_ble_gatts_create_service(gatts_if, &gl_profile_tab[PROFILE_A_APP_ID].service_id, GATTS_NUM_HANDLE_TEST);
+        break;
+    case ESP_GATTS_CREATE_EVT:
+        gl_profile_tab[PROFILE_A_APP_ID].service_handle = param->create.service_handle;
+        gl_profile_tab[PROFILE_A_APP_ID].char_uuid.len = ESP_UUID_LEN_16;
+        gl_profile_tab[PROFILE_A_APP_ID].char_uuid.uuid.uuid16 = GATTS_CHAR_UUID_TEST;
+        esp_ble_gatts_add_char(gl_profile_tab[PROFILE_A_APP_ID].service_handle, &gl_profile_tab[PROFILE_A_APP_ID].char_uuid,
+                               ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE,
+                               ESP_GATT_CHAR_PROP_BIT_READ | ESP_GATT_CHAR_PROP_BIT_WRITE, NULL, NULL);
+        break;
+    case ESP_GATTS_ADD_CHAR_EVT:
+        gl_profile_tab[PROFILE_A_APP_ID].char_handle = param->add_char.attr_handle;
+        esp_ble_gatts_start_service(gl_profile_tab[PROFILE_A_APP_ID].service_handle);
+        break;
+    case ESP_GATTS_CONNECT_EVT:
+        ESP_LOGI(TAG, "CONNECTED");
+        gl_profile_tab[PROFILE_A_APP_ID].conn_id = param->connect.conn_id;
+        break;
+    case ESP_GATTS_WRITE_EVT:
+        handle_write_event(param);
+        break;
+    case ESP_GATTS_DISCONNECT_EVT:
+        ESP_LOGI(TAG, "DISCONNECTED");
+        esp_ble_gap_start_advertising(&adv_params);
+        break;
+    default:
+        break;
+    }
+}
+
+static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
+    switch (event) {
+    case ESP_GAP_BLE_ADV_DATA_SET_COMPLETE_EVT:
+        esp_ble_gap_start_advertising(&adv_params);
+        break;
+    case ESP_GAP_BLE_SEC_REQ_EVT:
+        // App xin ghép đôi: chấp nhận (Just Works), quyền dữ liệu do chữ ký lan_key quyết định
+        esp_ble_gap_security_rsp(param->ble_security.ble_req.bd_addr, true);
+        break;
+    case ESP_GAP_BLE_AUTH_CMPL_EVT:
+        ESP_LOGI(TAG, "Link encryption %s", param->ble_security.auth_cmpl.success ? "on" : "failed");
+        break;
+    default:
+        break;
+    }
+}
+
+// Ghép đôi LE Secure Connections không MITM (khoá không có màn hình / bàn phím): mã hoá cho dịch vụ bulk
+static void ble_set_security(void) {
+    esp_ble_auth_req_t auth_req = ESP_LE_AUTH_REQ_SC_BOND;
+    esp_ble_io_cap_t iocap = ESP_IO_CAP_NONE;
+    uint8_t key_size = 16;
+    uint8_t init_key = ESP_BLE_ENC_KEY_MASK | ESP_BLE_ID_KEY_MASK;
+    uint8_t rsp_key = ESP_BLE_ENC_KEY_MASK | ESP_BLE_ID_KEY_MASK;
+    esp_ble_gap_set_security_param(ESP_BLE_SM_AUTHEN_REQ_MODE, &auth_req, sizeof(auth_req));
+    esp_ble_gap_set_security_param(ESP_BLE_SM_IOCAP_MODE, &iocap, sizeof(iocap));
+    esp_ble_gap_set_security_param(ESP_BLE_SM_MAX_KEY_SIZE, &key_size, sizeof(key_size));
+    esp_ble_gap_set_security_param(ESP_BLE_SM_SET_INIT_KEY, &init_key, sizeof(init_key));
+    esp_ble_gap_set_security_param(ESP_BLE_SM_SET_RSP_KEY, &rsp_key, sizeof(rsp_key));
+}
+
+static void gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param) {
+    if (event == ESP_GATTS_REG_EVT) {
+        // Dịch vụ bulk có gatts_if riêng
+        if (param->reg.app_id == BLE_BULK_APP_ID) { ble_bulk_gatts_event(event, gatts_if, param); return; }
+        if (param->reg.status == ESP_GATT_OK) gl_profile_tab[param->reg.app_id].gatts_if = gatts_if;
+    }
+    if (gatts_if == ESP_GATT_IF_NONE || gatts_if == gl_profile_tab[0].gatts_if) {
+        if (gl_profile_tab[0].gatts_cb) gl_profile_tab[0].gatts_cb(event, gatts_if, param);
+    }
+    ble_bulk_gatts_event(event, gatts_if, param);
+}
+
+static bool s_ble_running = false;
+static bool s_classic_released = false;
+
+bool ble_server_is_running(void) { return s_ble_running; }
+
+void init_ble_server(void) {
+    if (s_ble_running) return;
+    ESP_LOGI(TAG, "Initializing BLE Provisioning Server...");
+    // Bộ nhớ Classic BT chỉ giải phóng được 1 lần
+    if (!s_classic_released) {
+        ESP_ERROR_CHECK(esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT));
+        s_classic_released = true;
+    }
+    esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_bt_controller_init(&bt_cfg));
+    ESP_ERROR_CHECK(esp_bt_controller_enable(ESP_BT_MODE_BLE));
+    ESP_ERROR_CHECK(esp_bluedroid_init());
+    ESP_ERROR_CHECK(esp_bluedroid_enable());
+    ESP_ERROR_CHECK(esp_ble_gatts_register_callback(gatts_event_handler));
+    ESP_ERROR_CHECK(esp_ble_gap_register_callback(gap_event_handler));
+    ble_set_security();
+    ESP_ERROR_CHECK(esp_ble_gatts_app_register(PROFILE_A_APP_ID));
+
+    // Dịch vụ bulk: nạp gallery / tải nhật ký khi không có Internet (chỉ sống cùng BLE, xem ble_bulk.h)
+    ble_bulk_init();
+    esp_ble_gatt_set_local_mtu(BLE_BULK_LOCAL_MTU);
+    ESP_ERROR_CHECK(esp_ble_gatts_app_register(BLE_BULK_APP_ID));
+    s_ble_running = true;
+    ESP_LOGI(TAG, "BLE Ready! Waiting for App...");
+}
+
+void deinit_ble_server(void) {
+    if (!s_ble_running) return;
+    esp_ble_gap_stop_advertising();
+    esp_bluedroid_disable();
+    esp_bluedroid_deinit();
+    esp_bt_controller_disable();
+    esp_bt_controller_deinit();
+    gl_profile_tab[PROFILE_A_APP_ID].gatts_if = ESP_GATT_IF_NONE;
+    ble_bulk_reset();
+    s_ble_running = false;
+    ESP_LOGI(TAG, "BLE Provisioning stopped");
 }
\ No newline at end of file
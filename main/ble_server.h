@@ -0,0 +1,22 @@
+#ifndef BLE_SERVER_H
+#define BLE_SERVER_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bật BLE provisioning (nhận SSID/Pass + cấu hình Supabase từ App)
+void init_ble_server(void);
+
+// Tắt BLE, trả RAM + sóng cho WiFi khi đã online
+void deinit_ble_server(void);
+
+bool ble_server_is_running(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
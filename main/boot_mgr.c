@@ -0,0 +1,128 @@
+#include "boot_mgr.h"
+#include <stdio.h>
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "perf_monitor.h"
+
+static const char *TAG = "BOOT";
+
+typedef struct {
+    const boot_stage_t *def;
+    int id;
+    esp_err_t result;
+    int64_t start_us;
+    int64_t end_us;
+} boot_stage_state_t;
+
+static boot_stage_state_t s_state[BOOT_MAX_STAGES];
+static int s_count = 0;
+static EventGroupHandle_t s_done = NULL;   // Bit i = bước i đã kết thúc (thành công hoặc lỗi)
+static int64_t s_milestones[BOOT_MS_COUNT];
+static const char *MILESTONE_NAMES[BOOT_MS_COUNT] = { "first_frame", "first_unlock_ready", "cloud_synced" };
+
+static void boot_stage_task(void *pvParameters) {
+    boot_stage_state_t *st = (boot_stage_state_t *)pvParameters;
+    const boot_stage_t *def = st->def;
+
+    // 1. Chờ các bước phụ thuộc
+    if (def->deps) {
+        xEventGroupWaitBits(s_done, def->deps, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+
+    bool deps_ok = true;
+    for (int i = 0; i < s_count; i++) {
+        if ((def->deps & BOOT_DEP(i)) && s_state[i].result != ESP_OK) deps_ok = false;
+    }
+
+    // 2. Chạy bước
+    st->start_us = esp_timer_get_time();
+    if (deps_ok) {
+        st->result = def->fn();
+    } else {
+        st->result = ESP_ERR_INVALID_STATE;
+        ESP_LOGW(TAG, "Skip '%s' (dependency failed)", def->name);
+    }
+    st->end_us = esp_timer_get_time();
+    perf_trace_record(def->name, st->start_us, st->end_us);
+
+    if (deps_ok) {
+        ESP_LOGI(TAG, "'%s' %s in %lld ms", def->name, st->result == ESP_OK ? "done" : "FAILED",
+                 (st->end_us - st->start_us) / 1000);
+    }
+    xEventGroupSetBits(s_done, BOOT_DEP(st->id));
+    vTaskDelete(NULL);
+}
+
+void boot_start(const boot_stage_t *stages, int count) {
+    if (count > BOOT_MAX_STAGES) count = BOOT_MAX_STAGES;
+    if (!s_done) s_done = xEventGroupCreate();
+    s_count = count;
+
+    // Khởi tạo toàn bộ trạng thái trước khi tạo task (task đọc kết quả của nhau)
+    for (int i = 0; i < count; i++) {
+        s_state[i].def = &stages[i];
+        s_state[i].id = i;
+        s_state[i].result = ESP_ERR_NOT_FINISHED;
+    }
+    for (int i = 0; i < count; i++) {
+        if (xTaskCreatePinnedToCore(boot_stage_task, stages[i].name, stages[i].stack, &s_state[i],
+                                    stages[i].priority, NULL, stages[i].core) != pdPASS) {
+            ESP_LOGE(TAG, "Cannot create task for '%s'", stages[i].name);
+            s_state[i].result = ESP_ERR_NO_MEM;
+            xEventGroupSetBits(s_done, BOOT_DEP(i));
+        }
+    }
+}
+
+bool boot_wait(uint32_t stage_mask, TickType_t timeout) {
+    if (!s_done) return false;
+    EventBits_t bits = xEventGroupWaitBits(s_done, stage_mask, pdFALSE, pdTRUE, timeout);
+    if ((bits & stage_mask) != stage_mask) return false;
+    for (int i = 0; i < s_count; i++) {
+        if ((stage_mask & BOOT_DEP(i)) && s_state[i].result != ESP_OK) return false;
+    }
+    return true;
+}
+
+bool boot_stage_ok(int id) {
+    if (!s_done || id < 0 || id >= s_count) return false;
+    return (xEventGroupGetBits(s_done) & BOOT_DEP(id)) && s_state[id].result == ESP_OK;
+}
+
+bool boot_stage_done(int id) {
+    if (!s_done || id < 0 || id >= s_count) return false;
+    return (xEventGroupGetBits(s_done) & BOOT_DEP(id)) != 0;
+}
+
+bool boot_all_done(void) {
+    if (!s_done) return false;
+    EventBits_t all = (EventBits_t)((1UL << s_count) - 1);
+    return (xEventGroupGetBits(s_done) & all) == all;
+}
+
+void boot_milestone(boot_milestone_t ms) {
+    if (ms >= BOOT_MS_COUNT || s_milestones[ms]) return;
+    s_milestones[ms] = esp_timer_get_time();
+    ESP_LOGI(TAG, "Milestone %s at %lld ms", MILESTONE_NAMES[ms], s_milestones[ms] / 1000);
+}
+
+size_t boot_profile_json(char *buf, size_t len) {
+    size_t off = snprintf(buf, len, "{\"stages\":[");
+    for (int i = 0; i < s_count && off < len; i++) {
+        boot_stage_state_t *st = &s_state[i];
+        off += snprintf(buf + off, len - off,
+                        "%s{\"name\":\"%s\",\"result\":\"%s\",\"start_ms\":%lld,\"end_ms\":%lld}",
+                        i ? "," : "", st->def->name,
+                        st->result == ESP_ERR_NOT_FINISHED ? "running" : esp_err_to_name(st->result),
+                        st->start_us / 1000, st->end_us / 1000);
+    }
+    for (int m = 0; m < BOOT_MS_COUNT && off < len; m++) {
+        // -1 = mốc chưa xảy ra
+        off += snprintf(buf + off, len - off, "%s\"%s_ms\":%lld", m ? "," : "],",
+                        MILESTONE_NAMES[m], s_milestones[m] ? s_milestones[m] / 1000 : -1LL);
+    }
+    if (off < len) off += snprintf(buf + off, len - off, "}");
+    return off < len ? off : 0;
+}
@@ -0,0 +1,65 @@
+#ifndef BOOT_MGR_H
+#define BOOT_MGR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tối đa số bước khởi động (mỗi bước 1 bit trong event group)
+#define BOOT_MAX_STAGES 16
+
+#define BOOT_DEP(id)    (1UL << (id))
+
+typedef esp_err_t (*boot_fn_t)(void);
+
+// Khai báo 1 bước khởi động. Bước chỉ chạy khi mọi bước trong deps đã xong và thành công;
+// nếu 1 dependency lỗi thì bước này bị bỏ qua (ESP_ERR_INVALID_STATE).
+typedef struct {
+    const char *name;
+    boot_fn_t fn;
+    uint32_t deps;          // Bitmask BOOT_DEP(id) của các bước phụ thuộc
+    uint32_t stack;
+    UBaseType_t priority;
+    BaseType_t core;        // tskNO_AFFINITY nếu không ghim
+} boot_stage_t;
+
+// Các mốc thời gian quan trọng được đo trong profile khởi động
+typedef enum {
+    BOOT_MS_FIRST_FRAME = 0,      // Frame đầu tiên được chụp
+    BOOT_MS_FIRST_UNLOCK_READY,   // Lần nhận diện đầu tiên với gallery đã nạp -> đã có thể mở cửa
+    BOOT_MS_CLOUD_SYNCED,         // Đồng bộ user từ cloud xong
+    BOOT_MS_COUNT
+} boot_milestone_t;
+
+// Chạy song song các bước (mỗi bước 1 task riêng), không chặn người gọi
+void boot_start(const boot_stage_t *stages, int count);
+
+// Chờ các bước (bitmask) xong. Trả true nếu tất cả xong và thành công.
+bool boot_wait(uint32_t stage_mask, TickType_t timeout);
+
+// Bước đã chạy xong và thành công chưa
+bool boot_stage_ok(int id);
+
+// Bước đã kết thúc (thành công hoặc lỗi) chưa
+bool boot_stage_done(int id);
+
+// Mọi bước đã kết thúc chưa
+bool boot_all_done(void);
+
+// Ghi nhận mốc (chỉ lần đầu có hiệu lực)
+void boot_milestone(boot_milestone_t ms);
+
+// Profile khởi động dạng JSON (thời gian bắt đầu/kết thúc từng bước, các mốc)
+size_t boot_profile_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,156 @@
+#include "camera_ctrl.h"
+#include "camera_init.h"
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "http_server.h"
+
+static const char *TAG = "CAM_CTRL";
+
+typedef struct {
+    const char *name;
+    framesize_t size;
+    int quality;        // JPEG quality (số càng nhỏ ảnh càng đẹp, càng nặng)
+    int xclk_mhz;
+    int interval_ms;    // Nghỉ giữa 2 lần chạy AI
+} cam_profile_t;
+
+static cam_profile_t s_profiles[CAM_MODE_COUNT] = {
+    [CAM_MODE_IDLE]   = { "idle",   FRAMESIZE_QVGA, 15, 10, 500 },
+    [CAM_MODE_ACTIVE] = { "active", FRAMESIZE_VGA,  12, 20, 10  },
+    [CAM_MODE_STREAM] = { "stream", FRAMESIZE_QVGA, 12, 20, 100 },
+};
+
+// Đầu vào (ghi từ task AI / HTTP)
+static volatile int64_t s_last_face_ms = 0;
+static volatile int s_viewers = 0;
+static float s_latency_ema_us = 0;
+static volatile uint32_t s_frames = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Trạng thái hiện tại
+static volatile cam_mode_t s_mode = CAM_MODE_IDLE;
+static bool s_degraded = false;        // ACTIVE nhưng đã hạ xuống QVGA vì AI không theo kịp
+static framesize_t s_cur_size = FRAMESIZE_INVALID;
+static int s_cur_quality = -1;
+static int s_cur_xclk = -1;
+static float s_fps = 0;
+
+void camera_ctrl_report_frame(int faces, int64_t pipeline_us) {
+    taskENTER_CRITICAL(&s_lock);
+    s_latency_ema_us = (s_latency_ema_us == 0) ? pipeline_us : s_latency_ema_us * 0.8f + pipeline_us * 0.2f;
+    s_frames++;
+    if (faces > 0) s_last_face_ms = esp_timer_get_time() / 1000;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void camera_ctrl_set_viewers(int viewers) { s_viewers = viewers; }
+
+void camera_ctrl_set_stream_pref(int framesize, int quality) {
+    taskENTER_CRITICAL(&s_lock);
+    // Không cho người xem vượt quá độ phân giải đã cấp phát frame buffer
+    if (framesize >= 0 && framesize <= CAMERA_MAX_FRAMESIZE) s_profiles[CAM_MODE_STREAM].size = (framesize_t)framesize;
+    if (quality >= 10 && quality <= 63) s_profiles[CAM_MODE_STREAM].quality = quality;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+int camera_ctrl_frame_interval_ms(void) { return s_profiles[s_mode].interval_ms; }
+
+cam_mode_t camera_ctrl_get_mode(void) { return s_mode; }
+
+// Chỉ ghi thanh ghi sensor khi giá trị thực sự thay đổi, giữ mutex để không đổi giữa lúc đang lấy frame
+static void camera_ctrl_apply(framesize_t size, int quality, int xclk_mhz) {
+    if (size == s_cur_size && quality == s_cur_quality && xclk_mhz == s_cur_xclk) return;
+    sensor_t *s = esp_camera_sensor_get();
+    if (!s || !xCameraMutex) return;
+    if (xSemaphoreTake(xCameraMutex, pdMS_TO_TICKS(1000)) != pdTRUE) return;
+
+    if (xclk_mhz != s_cur_xclk && s->set_xclk) {
+        if (s->set_xclk(s, LEDC_TIMER_0, xclk_mhz) == 0) s_cur_xclk = xclk_mhz;
+    }
+    if (size != s_cur_size) {
+        if (s->set_framesize(s, size) == 0) s_cur_size = size;
+    }
+    if (quality != s_cur_quality) {
+        if (s->set_quality(s, quality) == 0) s_cur_quality = quality;
+    }
+    xSemaphoreGive(xCameraMutex);
+}
+
+static void camera_ctrl_task(void *pvParameters) {
+    uint32_t last_frames = 0;
+    int64_t last_fps_ms = esp_timer_get_time() / 1000;
+
+    while (1) {
+        int64_t now = esp_timer_get_time() / 1000;
+
+        taskENTER_CRITICAL(&s_lock);
+        float latency_ms = s_latency_ema_us / 1000.0f;
+        uint32_t frames = s_frames;
+        cam_profile_t stream = s_profiles[CAM_MODE_STREAM];
+        taskEXIT_CRITICAL(&s_lock);
+
+        if (now - last_fps_ms >= 1000) {
+            s_fps = (frames - last_frames) * 1000.0f / (now - last_fps_ms);
+            last_frames = frames;
+            last_fps_ms = now;
+        }
+
+        // 1. Chọn chế độ theo sự hiện diện và người xem
+        cam_mode_t mode;
+        if (s_last_face_ms && now - s_last_face_ms < CAM_ACTIVE_HOLD_MS) mode = CAM_MODE_ACTIVE;
+        else if (s_viewers > 0) mode = CAM_MODE_STREAM;
+        else mode = CAM_MODE_IDLE;
+
+        // 2. Hạ / nâng độ phân giải ACTIVE theo độ trễ pipeline (có trễ để tránh dao động)
+        if (mode == CAM_MODE_ACTIVE) {
+            if (!s_degraded && latency_ms > CAM_LATENCY_BUDGET_MS) s_degraded = true;
+            else if (s_degraded && latency_ms < CAM_LATENCY_BUDGET_MS * 0.6f) s_degraded = false;
+        }
+
+        const cam_profile_t *p = &s_profiles[mode];
+        framesize_t size = p->size;
+        int quality = p->quality;
+        if (mode == CAM_MODE_ACTIVE && s_degraded) size = FRAMESIZE_QVGA;
+        if (mode == CAM_MODE_STREAM) {
+            size = stream.size;
+            quality = stream.quality;
+            // Nhiều người xem -> giảm dung lượng mỗi frame
+            if (s_viewers > 1 && quality < 40) quality += 5;
+        }
+
+        if (mode != s_mode) {
+            ESP_LOGI(TAG, "Mode %s -> %s (latency %.0f ms, viewers %d)",
+                     s_profiles[s_mode].name, p->name, latency_ms, s_viewers);
+            s_mode = mode;
+            char msg[64];
+            snprintf(msg, sizeof(msg), "{\"type\":\"camera\",\"mode\":\"%s\"}", p->name);
+            ws_send_message(msg);
+        }
+        camera_ctrl_apply(size, quality, p->xclk_mhz);
+
+        vTaskDelay(pdMS_TO_TICKS(CAM_CTRL_PERIOD_MS));
+    }
+}
+
+size_t camera_ctrl_status_json(char *buf, size_t len) {
+    taskENTER_CRITICAL(&s_lock);
+    float latency_ms = s_latency_ema_us / 1000.0f;
+    taskEXIT_CRITICAL(&s_lock);
+    int n = snprintf(buf, len,
+                     "{\"mode\":\"%s\",\"framesize\":%d,\"quality\":%d,\"xclk_mhz\":%d,\"interval_ms\":%d,"
+                     "\"degraded\":%s,\"latency_ms\":%.1f,\"fps\":%.1f,\"viewers\":%d}",
+                     s_profiles[s_mode].name, s_cur_size, s_cur_quality, s_cur_xclk,
+                     camera_ctrl_frame_interval_ms(), s_degraded ? "true" : "false",
+                     latency_ms, s_fps, s_viewers);
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
+
+void camera_ctrl_init(void) {
+    // Áp dụng profile IDLE ngay (camera được init ở độ phân giải lớn nhất)
+    camera_ctrl_apply(s_profiles[CAM_MODE_IDLE].size, s_profiles[CAM_MODE_IDLE].quality, s_profiles[CAM_MODE_IDLE].xclk_mhz);
+    xTaskCreatePinnedToCore(camera_ctrl_task, "cam_ctrl", 3072, NULL, 2, NULL, 0);
+}
@@ -0,0 +1,53 @@
+#ifndef CAMERA_CTRL_H
+#define CAMERA_CTRL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Các chế độ chụp do bộ điều khiển tự chọn
+typedef enum {
+    CAM_MODE_IDLE = 0,   // Không có ai: QVGA, XCLK thấp, 2 fps -> tiết kiệm điện
+    CAM_MODE_ACTIVE,     // Có mặt người: VGA cho ảnh bằng chứng, chạy nhanh nhất có thể
+    CAM_MODE_STREAM,     // Có người xem stream nhưng không có mặt người
+    CAM_MODE_COUNT
+} cam_mode_t;
+
+// Thời gian giữ chế độ ACTIVE sau khi mất mặt người (ms)
+#define CAM_ACTIVE_HOLD_MS      3000
+// Độ trễ pipeline (decode + detect + feature) tối đa trước khi hạ độ phân giải ACTIVE
+#define CAM_LATENCY_BUDGET_MS   450
+// Chu kỳ đánh giá chế độ (ms)
+#define CAM_CTRL_PERIOD_MS      250
+
+// Khởi động task điều khiển (gọi sau init_camera)
+void camera_ctrl_init(void);
+
+// AI báo kết quả mỗi frame: số mặt người và thời gian xử lý (us)
+void camera_ctrl_report_frame(int faces, int64_t pipeline_us);
+
+// HTTP báo số người đang xem stream
+void camera_ctrl_set_viewers(int viewers);
+
+// Tuỳ chọn của người xem stream (/control) - chỉ áp dụng ở chế độ STREAM
+void camera_ctrl_set_stream_pref(int framesize, int quality);
+
+// Khoảng nghỉ giữa 2 lần chạy AI theo chế độ hiện tại (ms)
+int camera_ctrl_frame_interval_ms(void);
+
+cam_mode_t camera_ctrl_get_mode(void);
+
+// Trạng thái dạng JSON cho GET /camera
+size_t camera_ctrl_status_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,110 +1,342 @@
-#include "camera_init.h"
-#include "camera_config.h"
-#include "esp_log.h"
-
-static const char *TAG = "CAMERA";
-
-// Khởi tạo Camera 
-esp_err_t init_camera(void)
-{
-    ESP_LOGI(TAG, "Initializing camera...");
-
-    // 1. TẠO RA BIẾN CẤU HÌNH CAMERA
-    camera_config_t camera_config = {
-        .pin_pwdn = CAM_PIN_PWDN,
-        .pin_reset = CAM_PIN_RESET,
-        .pin_xclk = CAM_PIN_XCLK,
-        .pin_sccb_sda = CAM_PIN_SIOD,
-        .pin_sccb_scl = CAM_PIN_SIOC,
-
-        .pin_d7 = CAM_PIN_D7,
-        .pin_d6 = CAM_PIN_D6,
-        .pin_d5 = CAM_PIN_D5,
-        .pin_d4 = CAM_PIN_D4,
-        .pin_d3 = CAM_PIN_D3,
-        .pin_d2 = CAM_PIN_D2,
-        .pin_d1 = CAM_PIN_D1,
-        .pin_d0 = CAM_PIN_D0,
-        .pin_vsync = CAM_PIN_VSYNC,
-        .pin_href = CAM_PIN_HREF,
-        .pin_pclk = CAM_PIN_PCLK,
-
-        // Cấu hình chung
-        .xclk_freq_hz = 16500000,
-        .ledc_timer = LEDC_TIMER_0,
-        .ledc_channel = LEDC_CHANNEL_0,
-        .pixel_format = PIXFORMAT_JPEG,
-        .frame_size = FRAMESIZE_QVGA,
-        .jpeg_quality = 12,
-        .fb_count = 2,
-        .grab_mode = CAMERA_GRAB_WHEN_EMPTY,
-        .fb_location = CAMERA_FB_IN_PSRAM, // Bắt buộc dùng PSRAM
-    };
-
-    // 2. Khởi tạo camera với cấu hình vừa tạo
-    esp_err_t err = esp_camera_init(&camera_config);
-    if (err != ESP_OK)
-    {
-        ESP_LOGE(TAG, "Camera init failed with error 0x%x", err);
-        return err;
-    }
-
-    // 3. Lấy sensor
-    sensor_t *s = esp_camera_sensor_get();
-    if (s == NULL)
-    {
-        ESP_LOGE(TAG, "Failed to get camera sensor");
-        return ESP_FAIL;
-    }
-
-    // 4. In thông tin sensor
-    ESP_LOGI(TAG, "Camera sensor detected: PID=0x%02x VER=0x%02x MIDH=0x%02x MIDL=0x%02x",
-             s->id.PID, s->id.VER, s->id.MIDH, s->id.MIDL);
-
-    // 5. Áp dụng TẤT CẢ các cài đặt tùy chỉnh
-    s->set_vflip(s, 0);
-    s->set_hmirror(s, 0);
-    s->set_brightness(s, 1);
-    s->set_contrast(s, 1);
-    s->set_saturation(s, 0);
-    s->set_special_effect(s, 0);
-    s->set_whitebal(s, 1);
-    s->set_awb_gain(s, 1);
-    s->set_wb_mode(s, 0);
-    s->set_exposure_ctrl(s, 1);
-    s->set_aec2(s, 0);
-    s->set_gain_ctrl(s, 1);
-    s->set_agc_gain(s, 0);
-    s->set_gainceiling(s, (gainceiling_t)0);
-    s->set_bpc(s, 0);
-    s->set_wpc(s, 1);
-    s->set_raw_gma(s, 1);
-    s->set_lenc(s, 1);
-    s->set_dcw(s, 1);
-    s->set_colorbar(s, 0);
-
-    ESP_LOGI(TAG, "Camera initialized successfully");
-    return ESP_OK;
-}
-
-// Hàm 2: Hủy khởi tạo Camera 
-void deinit_camera(void)
-{
-    ESP_LOGI(TAG, "Deinitializing camera...");
-    esp_camera_deinit();
-}
-
-// Hàm 3: Chụp ảnh 
-camera_fb_t* capture_image(void)
-{
-    camera_fb_t *fb = esp_camera_fb_get();
-
-    if(!fb)
-    {
-        ESP_LOGE(TAG, "Camera capture failed");
-        return NULL;
-    }
-    
-    // Hàm gọi sẽ chịu trách nhiệm return(fb)
-    return fb;
-}
\ No newline at end of file
+#include "camera_init.h"
+#include "camera_config.h"
+#include "esp_log.h"
+#include "img_converters.h"
+#include "esp_jpg_decode.h"
+#include <string.h>
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "perf_monitor.h"
+#include "boot_mgr.h"
+#include "bench.h"
+#include "esp_heap_caps.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "CAMERA";
+
+static uint32_t s_frame_seq = 0;
+
+// Thống kê photon -> decision
+typedef struct {
+    uint32_t count;
+    int64_t last_us;
+    int64_t min_us;
+    int64_t max_us;
+    int64_t sum_us;
+    uint32_t last_seq;
+    uint32_t skipped;     // Frame driver đã chụp nhưng không được xử lý (theo seq)
+} frame_age_stats_t;
+
+static frame_age_stats_t s_age = { 0 };
+static portMUX_TYPE s_age_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void _bench_decode(void *ctx);
+
+// Khởi tạo Camera 
+esp_err_t init_camera(void)
+{
+    ESP_LOGI(TAG, "Initializing camera...");
+
+    // 1. TẠO RA BIẾN CẤU HÌNH CAMERA
+    camera_config_t camera_config = {
+        .pin_pwdn = CAM_PIN_PWDN,
+        .pin_reset = CAM_PIN_RESET,
+        .pin_xclk = CAM_PIN_XCLK,
+        .pin_sccb_sda = CAM_PIN_SIOD,
+        .pin_sccb_scl = CAM_PIN_SIOC,
+
+        .pin_d7 = CAM_PIN_D7,
+        .pin_d6 = CAM_PIN_D6,
+        .pin_d5 = CAM_PIN_D5,
+        .pin_d4 = CAM_PIN_D4,
+        .pin_d3 = CAM_PIN_D3,
+        .pin_d2 = CAM_PIN_D2,
+        .pin_d1 = CAM_PIN_D1,
+        .pin_d0 = CAM_PIN_D0,
+        .pin_vsync = CAM_PIN_VSYNC,
+        .pin_href = CAM_PIN_HREF,
+        .pin_pclk = CAM_PIN_PCLK,
+
+        // Cấu hình chung
+        .xclk_freq_hz = 16500000,
+        .ledc_timer = LEDC_TIMER_0,
+        .ledc_channel = LEDC_CHANNEL_0,
+        .pixel_format = PIXFORMAT_JPEG,
+        // Cấp phát frame buffer theo độ phân giải lớn nhất, camera_ctrl sẽ hạ xuống khi cần
+        .frame_size = CAMERA_MAX_FRAMESIZE,
+        .jpeg_quality = 12,
+        .fb_count = CAMERA_FB_COUNT,
+        .grab_mode = CAMERA_GRAB_MODE,
+        .fb_location = CAMERA_FB_IN_PSRAM, // Bắt buộc dùng PSRAM
+    };
+
+    // 2. Khởi tạo camera với cấu hình vừa tạo
+    esp_err_t err = esp_camera_init(&camera_config);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Camera init failed with error 0x%x", err);
+        return err;
+    }
+
+    // 3. Lấy sensor
+    sensor_t *s = esp_camera_sensor_get();
+    if (s == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to get camera sensor");
+        return ESP_FAIL;
+    }
+
+    // 4. In thông tin sensor
+    ESP_LOGI(TAG, "Camera sensor detected: PID=0x%02x VER=0x%02x MIDH=0x%02x MIDL=0x%02x",
+             s->id.PID, s->id.VER, s->id.MIDH, s->id.MIDL);
+
+    // 5. Áp dụng TẤT CẢ các cài đặt tùy chỉnh
+    s->set_vflip(s, 0);
+    s->set_hmirror(s, 0);
+    s->set_brightness(s, 1);
+    s->set_contrast(s, 1);
+    s->set_saturation(s, 0);
+    s->set_special_effect(s, 0);
+    s->set_whitebal(s, 1);
+    s->set_awb_gain(s, 1);
+    s->set_wb_mode(s, 0);
+    s->set_exposure_ctrl(s, 1);
+    s->set_aec2(s, 0);
+    s->set_gain_ctrl(s, 1);
+    s->set_agc_gain(s, 0);
+    s->set_gainceiling(s, (gainceiling_t)0);
+    s->set_bpc(s, 0);
+    s->set_wpc(s, 1);
+    s->set_raw_gma(s, 1);
+    s->set_lenc(s, 1);
+    s->set_dcw(s, 1);
+    s->set_colorbar(s, 0);
+
+    ESP_LOGI(TAG, "Camera initialized successfully");
+    bench_register("jpeg_decode", _bench_decode, NULL);
+    bench_register("jpeg_decode_roi", _bench_decode, (void *)1);
+    return ESP_OK;
+}
+
+// Hàm 2: Hủy khởi tạo Camera 
+void deinit_camera(void)
+{
+    ESP_LOGI(TAG, "Deinitializing camera...");
+    esp_camera_deinit();
+}
+
+// Hàm 3: Chụp ảnh 
+camera_fb_t* capture_image(void)
+{
+    camera_fb_t *fb = esp_camera_fb_get();
+
+    if(!fb)
+    {
+        ESP_LOGE(TAG, "Camera capture failed");
+        return NULL;
+    }
+    
+    // Hàm gọi sẽ chịu trách nhiệm return(fb)
+    return fb;
+}
+
+bool camera_frame_get(camera_frame_t *frame)
+{
+    frame->fb = esp_camera_fb_get();
+    if (!frame->fb) {
+        ESP_LOGE(TAG, "Camera capture failed");
+        return false;
+    }
+    // Driver đóng dấu thời gian bằng esp_timer lúc nhận xong frame (VSYNC)
+    frame->capture_us = (int64_t)frame->fb->timestamp.tv_sec * 1000000LL + frame->fb->timestamp.tv_usec;
+    frame->seq = __atomic_add_fetch(&s_frame_seq, 1, __ATOMIC_RELAXED);
+    if (frame->seq == 1) boot_milestone(BOOT_MS_FIRST_FRAME);
+    return true;
+}
+
+void camera_frame_return(camera_frame_t *frame)
+{
+    if (frame->fb) esp_camera_fb_return(frame->fb);
+    frame->fb = NULL;
+}
+
+int64_t camera_frame_age_us(const camera_frame_t *frame)
+{
+    return esp_timer_get_time() - frame->capture_us;
+}
+
+void camera_record_decision(const camera_frame_t *frame)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t age = now - frame->capture_us;
+    // Hiện trên timeline Chrome Trace: từ lúc chụp tới lúc quyết định
+    perf_trace_record("photon_to_decision", frame->capture_us, now);
+
+    taskENTER_CRITICAL(&s_age_lock);
+    if (s_age.count == 0 || age < s_age.min_us) s_age.min_us = age;
+    if (age > s_age.max_us) s_age.max_us = age;
+    s_age.sum_us += age;
+    s_age.last_us = age;
+    s_age.count++;
+    if (s_age.last_seq && frame->seq > s_age.last_seq + 1) s_age.skipped += frame->seq - s_age.last_seq - 1;
+    s_age.last_seq = frame->seq;
+    taskEXIT_CRITICAL(&s_age_lock);
+}
+
+size_t camera_frame_stats_json(char *buf, size_t len)
+{
+    taskENTER_CRITICAL(&s_age_lock);
+    frame_age_stats_t a = s_age;
+    taskEXIT_CRITICAL(&s_age_lock);
+
+    int n = snprintf(buf, len,
+                     "{\"fb_count\":%d,\"grab_latest\":%s,\"frames\":%lu,\"decisions\":%lu,\"not_decided\":%lu,"
+                     "\"age_ms\":{\"last\":%.1f,\"min\":%.1f,\"avg\":%.1f,\"max\":%.1f}}",
+                     CAMERA_FB_COUNT, CAMERA_GRAB_MODE == CAMERA_GRAB_LATEST ? "true" : "false",
+                     (unsigned long)s_frame_seq, (unsigned long)a.count, (unsigned long)a.skipped,
+                     a.last_us / 1000.0, a.min_us / 1000.0,
+                     a.count ? (a.sum_us / (double)a.count) / 1000.0 : 0.0, a.max_us / 1000.0);
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
+
+// Hàm 4: Giải nén cho AI
+typedef struct {
+    const camera_fb_t *fb;
+    uint8_t *out;
+    size_t out_len;
+    int width;           // Kích thước ảnh ra (= vùng cắt)
+    int height;
+    camera_rect_t crop;  // Vùng cắt theo pixel sau khi thu nhỏ
+} rgb_decoder_t;
+
+static size_t _jpg_read(void *arg, size_t index, uint8_t *buf, size_t len)
+{
+    rgb_decoder_t *d = (rgb_decoder_t *)arg;
+    if (buf) memcpy(buf, d->fb->buf + index, len);
+    return len;
+}
+
+static bool _rgb_write(void *arg, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t *data)
+{
+    rgb_decoder_t *d = (rgb_decoder_t *)arg;
+    camera_rect_t *c = &d->crop;
+    if (!data) {
+        if (x == 0 && y == 0) {
+            // Bắt đầu: w x h là cả ảnh sau khi scale -> kẹp vùng cắt vào trong, kiểm tra kích thước
+            if (c->w <= 0 || c->w > w) { c->x = 0; c->w = w; }
+            if (c->h <= 0 || c->h > h) { c->y = 0; c->h = h; }
+            if (c->x + c->w > w) c->x = w - c->w;
+            if (c->y + c->h > h) c->y = h - c->h;
+            d->width = c->w;
+            d->height = c->h;
+            return (size_t)c->w * c->h * 3 <= d->out_len;
+        }
+        return true;
+    }
+
+    // Phần giao giữa khối vừa giải nén và vùng cắt; ngoài vùng thì bỏ
+    int x0 = x > c->x ? x : c->x;
+    int x1 = (x + w) < (c->x + c->w) ? (x + w) : (c->x + c->w);
+    int y0 = y > c->y ? y : c->y;
+    int y1 = (y + h) < (c->y + c->h) ? (y + h) : (c->y + c->h);
+    if (x0 >= x1 || y0 >= y1) return true;
+
+    // Đảo byte giống fmt2rgb888 để ảnh vào AI không đổi
+    size_t stride = d->width * 3;
+    for (int iy = y0; iy < y1; iy++) {
+        const uint8_t *src = data + ((size_t)(iy - y) * w + (x0 - x)) * 3;
+        uint8_t *o = d->out + (size_t)(iy - c->y) * stride + (x0 - c->x) * 3;
+        for (int ix = 0; ix < (x1 - x0) * 3; ix += 3) {
+            o[ix] = src[ix + 2];
+            o[ix + 1] = src[ix + 1];
+            o[ix + 2] = src[ix];
+        }
+    }
+    return true;
+}
+
+bool camera_decode_rgb888(const camera_fb_t *fb, uint8_t *out, size_t out_len, int *out_w, int *out_h)
+{
+    int shift = 0;
+    return camera_decode_rgb888_roi(fb, NULL, out, out_len, out_w, out_h, &shift);
+}
+
+bool camera_decode_rgb888_roi(const camera_fb_t *fb, const camera_rect_t *roi, uint8_t *out, size_t out_len,
+                              int *out_w, int *out_h, int *out_shift)
+{
+    if (!fb || !out) return false;
+    camera_rect_t r = roi ? *roi : (camera_rect_t){ 0, 0, fb->width, fb->height };
+
+    if (fb->format != PIXFORMAT_JPEG) {
+        // Ảnh thô: chuyển cả frame rồi dồn vùng cắt lên đầu buffer (cùng buffer, chép tiến an toàn)
+        if ((size_t)fb->width * fb->height * 3 > out_len) return false;
+        if (!fmt2rgb888(fb->buf, fb->len, fb->format, out)) return false;
+        if (r.x < 0 || r.y < 0 || r.w <= 0 || r.h <= 0 || r.x + r.w > fb->width || r.y + r.h > fb->height) {
+            r = (camera_rect_t){ 0, 0, fb->width, fb->height };
+        }
+        for (int y = 0; y < r.h; y++) {
+            memmove(out + (size_t)y * r.w * 3, out + ((size_t)(r.y + y) * fb->width + r.x) * 3, (size_t)r.w * 3);
+        }
+        *out_w = r.w;
+        *out_h = r.h;
+        *out_shift = 0;
+        return true;
+    }
+
+    // Chọn tỉ lệ nhỏ nhất để VÙNG CẮT vừa khung AI (cả frame VGA -> 1/2; vùng <= QVGA -> giữ nguyên)
+    jpg_scale_t scale = JPG_SCALE_NONE;
+    int shift = 0;
+    int w = r.w, h = r.h;
+    while ((w > CAMERA_AI_WIDTH || h > CAMERA_AI_HEIGHT) && scale < JPG_SCALE_MAX) {
+        scale = (jpg_scale_t)(scale + 1);
+        shift++;
+        w >>= 1;
+        h >>= 1;
+    }
+
+    rgb_decoder_t d = { .fb = fb, .out = out, .out_len = out_len, .width = 0, .height = 0,
+                        .crop = { r.x >> shift, r.y >> shift, w, h } };
+    if (esp_jpg_decode(fb->len, scale, _jpg_read, _rgb_write, &d) != ESP_OK) return false;
+    *out_w = d.width;
+    *out_h = d.height;
+    *out_shift = shift;
+    return true;
+}
+
+// BENCHMARK GIẢI NÉN: frame thật chụp 1 lần ở vòng khởi động (ảnh tổng hợp nén quá tốt, đo sai).
+// ctx != NULL: chỉ vùng giữa cỡ khung AI, như khi face_roi thu hẹp vùng nhận diện.
+static struct {
+    camera_fb_t fb;
+    uint8_t *rgb;
+} s_bench;
+
+static bool _bench_prepare(void) {
+    if (s_bench.rgb) return true;
+    if (!xCameraMutex || xSemaphoreTake(xCameraMutex, pdMS_TO_TICKS(1000)) != pdTRUE) return false;
+    camera_fb_t *fb = esp_camera_fb_get();
+    if (fb) {
+        s_bench.fb = *fb;
+        s_bench.fb.buf = (uint8_t *)heap_caps_malloc(fb->len, MALLOC_CAP_SPIRAM);
+        if (s_bench.fb.buf) memcpy(s_bench.fb.buf, fb->buf, fb->len);
+        esp_camera_fb_return(fb);
+    }
+    xSemaphoreGive(xCameraMutex);
+    if (!fb || !s_bench.fb.buf) return false;
+    s_bench.rgb = (uint8_t *)heap_caps_malloc(CAMERA_AI_WIDTH * CAMERA_AI_HEIGHT * 3, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_bench.rgb) {
+        heap_caps_free(s_bench.fb.buf);
+        s_bench.fb.buf = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void _bench_decode(void *ctx) {
+    if (!_bench_prepare()) return;
+    int w, h, shift;
+    camera_rect_t roi = { (s_bench.fb.width - CAMERA_AI_WIDTH) / 2, (s_bench.fb.height - CAMERA_AI_HEIGHT) / 2,
+                          CAMERA_AI_WIDTH, CAMERA_AI_HEIGHT };
+    camera_decode_rgb888_roi(&s_bench.fb, ctx ? &roi : NULL, s_bench.rgb, CAMERA_AI_WIDTH * CAMERA_AI_HEIGHT * 3,
+                             &w, &h, &shift);
+}
@@ -1,15 +1,73 @@
-#ifndef CAMERA_INIT_H
-#define CAMERA_INIT_H
-
-#include "esp_err.h"
-#include "esp_camera.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
-
-esp_err_t init_camera(void);
-void deinit_camera(void);
-camera_fb_t* capture_image(void);
-
-extern SemaphoreHandle_t xCameraMutex;
-
+#ifndef CAMERA_INIT_H
+#define CAMERA_INIT_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Độ phân giải lớn nhất có thể chọn lúc chạy (frame buffer được cấp phát theo kích thước này)
+#define CAMERA_MAX_FRAMESIZE   FRAMESIZE_VGA
+// Kích thước ảnh đầu vào cố định của AI, không phụ thuộc độ phân giải chụp
+#define CAMERA_AI_WIDTH        320
+#define CAMERA_AI_HEIGHT       240
+
+// Số frame buffer trong vòng (PSRAM). Với GRAB_LATEST cần >= 2:
+// driver luôn ghi đè frame cũ nhất nên người đọc nhận frame mới nhất thay vì frame đã chờ sẵn.
+#ifndef CAMERA_FB_COUNT
+#define CAMERA_FB_COUNT        3
+#endif
+#ifndef CAMERA_GRAB_MODE
+#define CAMERA_GRAB_MODE       CAMERA_GRAB_LATEST
+#endif
+
+// Frame kèm số thứ tự và thời điểm chụp (cùng gốc thời gian với esp_timer_get_time)
+typedef struct {
+    camera_fb_t *fb;
+    uint32_t seq;
+    int64_t capture_us;
+} camera_frame_t;
+
+esp_err_t init_camera(void);
+void deinit_camera(void);
+camera_fb_t* capture_image(void);
+
+// Lấy frame mới nhất kèm metadata. Trả false nếu camera lỗi.
+bool camera_frame_get(camera_frame_t *frame);
+void camera_frame_return(camera_frame_t *frame);
+
+// Tuổi của frame tính tới hiện tại (us)
+int64_t camera_frame_age_us(const camera_frame_t *frame);
+
+// Ghi nhận thời điểm ra quyết định cho frame (photon -> decision)
+void camera_record_decision(const camera_frame_t *frame);
+
+// Thống kê tuổi frame lúc ra quyết định dạng JSON
+size_t camera_frame_stats_json(char *buf, size_t len);
+
+// Giải nén JPEG -> RGB888 (cùng thứ tự byte với fmt2rgb888), tự thu nhỏ 1/2, 1/4, 1/8
+// để vừa CAMERA_AI_WIDTH x CAMERA_AI_HEIGHT. out phải chứa được w*h*3 bytes.
+bool camera_decode_rgb888(const camera_fb_t *fb, uint8_t *out, size_t out_len, int *out_w, int *out_h);
+
+// Vùng chữ nhật theo pixel của frame chụp
+typedef struct {
+    int x, y, w, h;
+} camera_rect_t;
+
+// Như trên nhưng chỉ giữ vùng roi (NULL = cả frame). Tỉ lệ thu nhỏ chọn theo cỡ vùng, không theo cỡ frame:
+// vùng càng nhỏ thì càng ít bị thu nhỏ. *out_shift = số lần chia 2 (0..3) từ frame chụp sang ảnh ra.
+bool camera_decode_rgb888_roi(const camera_fb_t *fb, const camera_rect_t *roi, uint8_t *out, size_t out_len,
+                              int *out_w, int *out_h, int *out_shift);
+
+extern SemaphoreHandle_t xCameraMutex;
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif 
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "event_bus.h"
+#include <stdio.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "bench.h"
+
+static const char *TAG = "EVENT_BUS";
+
+// Ring MPMC giới hạn (Vyukov): mỗi ô có số thứ tự riêng, đầu ghi / đầu đọc chỉ tiến bằng CAS.
+// seq == pos: ô trống chờ ghi lượt pos. seq == pos + 1: đã có dữ liệu chờ đọc lượt pos.
+typedef struct {
+    atomic_uint seq;
+    bus_event_t ev;
+} bus_cell_t;
+
+static bus_cell_t s_ring[EVENT_BUS_RING_LEN];
+static atomic_uint s_enq;
+static atomic_uint s_deq;
+static atomic_uint s_pub_seq;
+
+typedef struct {
+    uint32_t mask;
+    bus_handler_t fn;
+    void *ctx;
+    const char *name;
+    uint32_t calls;
+    uint32_t max_us;
+} bus_sub_t;
+
+static bus_sub_t s_subs[EVENT_BUS_MAX_SUBS];
+static atomic_int s_sub_count;
+static TaskHandle_t s_task = NULL;
+
+static atomic_uint s_published;
+static atomic_uint s_dropped;
+static atomic_uint s_by_type[BUS_EV_TYPE_COUNT];
+static uint32_t s_max_latency_us = 0;       // publish -> bắt đầu phát (chỉ task bus ghi)
+
+static const char *TYPE_NAMES[BUS_EV_TYPE_COUNT] = { "face_matched", "visitor", "door_state", "command", "enroll_request", "ping" };
+
+// limit: số ô tối đa được chiếm (tính cả ô sắp ghi); sự kiện thường dừng trước phần dành riêng
+static bool _ring_push(const bus_event_t *ev, unsigned limit) {
+    unsigned pos = atomic_load_explicit(&s_enq, memory_order_relaxed);
+    for (;;) {
+        bus_cell_t *c = &s_ring[pos & (EVENT_BUS_RING_LEN - 1)];
+        unsigned seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+        int dif = (int)(seq - pos);
+        if (dif == 0) {
+            if (pos - atomic_load_explicit(&s_deq, memory_order_relaxed) >= limit) return false;
+            if (atomic_compare_exchange_weak_explicit(&s_enq, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                c->ev = *ev;
+                atomic_store_explicit(&c->seq, pos + 1, memory_order_release);
+                return true;
+            }
+        } else if (dif < 0) {
+            return false;   // Đầy: ô này chưa được đọc từ vòng trước
+        } else {
+            pos = atomic_load_explicit(&s_enq, memory_order_relaxed);
+        }
+    }
+}
+
+static bool _ring_pop(bus_event_t *out) {
+    unsigned pos = atomic_load_explicit(&s_deq, memory_order_relaxed);
+    for (;;) {
+        bus_cell_t *c = &s_ring[pos & (EVENT_BUS_RING_LEN - 1)];
+        unsigned seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+        int dif = (int)(seq - (pos + 1));
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&s_deq, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                *out = c->ev;
+                atomic_store_explicit(&c->seq, pos + EVENT_BUS_RING_LEN, memory_order_release);
+                return true;
+            }
+        } else if (dif < 0) {
+            return false;   // Rỗng
+        } else {
+            pos = atomic_load_explicit(&s_deq, memory_order_relaxed);
+        }
+    }
+}
+
+static void event_bus_task(void *pvParameters) {
+    bus_event_t ev;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (_ring_pop(&ev)) {
+            int64_t t0 = esp_timer_get_time();
+            uint32_t lat = (uint32_t)(t0 - ev.ts_us);
+            if (lat > s_max_latency_us) s_max_latency_us = lat;
+            int n = atomic_load_explicit(&s_sub_count, memory_order_acquire);
+            for (int i = 0; i < n; i++) {
+                bus_sub_t *s = &s_subs[i];
+                if (!(s->mask & BUS_MASK(ev.type))) continue;
+                int64_t h0 = esp_timer_get_time();
+                s->fn(&ev, s->ctx);
+                uint32_t us = (uint32_t)(esp_timer_get_time() - h0);
+                s->calls++;
+                if (us > s->max_us) s->max_us = us;
+            }
+        }
+    }
+}
+
+// BENCHMARK: publish -> task bus -> handler đánh thức lại người gọi (đường mặt khớp -> lock_ctrl)
+static void _bench_pong(const bus_event_t *ev, void *ctx) {
+    xTaskNotifyGive((TaskHandle_t)ev->ping.task);
+}
+
+static void _bench_dispatch(void *ctx) {
+    bus_event_t ev = { .type = BUS_EV_PING };
+    ev.ping.task = xTaskGetCurrentTaskHandle();
+    if (event_bus_publish(&ev)) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+}
+
+void event_bus_init(void) {
+    if (s_task) return;
+    for (unsigned i = 0; i < EVENT_BUS_RING_LEN; i++) atomic_init(&s_ring[i].seq, i);
+    // Ưu tiên trên task AI: mở cửa không phải chờ frame kế tiếp
+    if (xTaskCreatePinnedToCore(event_bus_task, "event_bus", 4096, NULL, 6, &s_task, tskNO_AFFINITY) != pdPASS) {
+        s_task = NULL;
+        ESP_LOGE(TAG, "Task create failed");
+        return;
+    }
+    event_bus_subscribe(BUS_MASK(BUS_EV_PING), _bench_pong, NULL, "bench");
+    bench_register("bus_dispatch", _bench_dispatch, NULL);
+}
+
+esp_err_t event_bus_subscribe(uint32_t mask, bus_handler_t fn, void *ctx, const char *name) {
+    static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    if (!fn) return ESP_ERR_INVALID_ARG;
+    taskENTER_CRITICAL(&lock);
+    int n = atomic_load_explicit(&s_sub_count, memory_order_relaxed);
+    if (n == EVENT_BUS_MAX_SUBS) {
+        taskEXIT_CRITICAL(&lock);
+        ESP_LOGE(TAG, "Too many subscribers (%s)", name);
+        return ESP_ERR_NO_MEM;
+    }
+    s_subs[n] = (bus_sub_t){ .mask = mask, .fn = fn, .ctx = ctx, .name = name, .calls = 0, .max_us = 0 };
+    // Ghi xong ô rồi mới tăng số lượng: task bus không bao giờ thấy ô dở
+    atomic_store_explicit(&s_sub_count, n + 1, memory_order_release);
+    taskEXIT_CRITICAL(&lock);
+    return ESP_OK;
+}
+
+bool event_bus_publish(bus_event_t *ev) {
+    if (ev->type >= BUS_EV_TYPE_COUNT) return false;
+    ev->seq = atomic_fetch_add_explicit(&s_pub_seq, 1, memory_order_relaxed) + 1;
+    ev->ts_us = esp_timer_get_time();
+    bool opens_door = ev->type == BUS_EV_FACE_MATCHED || ev->type == BUS_EV_COMMAND;
+    unsigned limit = opens_door ? EVENT_BUS_RING_LEN : EVENT_BUS_RING_LEN - EVENT_BUS_RESERVED;
+    if (!s_task || !_ring_push(ev, limit)) {
+        atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+        return false;
+    }
+    atomic_fetch_add_explicit(&s_published, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s_by_type[ev->type], 1, memory_order_relaxed);
+    xTaskNotifyGive(s_task);
+    return true;
+}
+
+size_t event_bus_stats_json(char *buf, size_t len) {
+    int n = snprintf(buf, len, "{\"published\":%u,\"dropped\":%u,\"max_latency_us\":%lu,\"by_type\":{",
+                     atomic_load(&s_published), atomic_load(&s_dropped), (unsigned long)s_max_latency_us);
+    size_t off = (n > 0 && (size_t)n < len) ? n : 0;
+    for (int i = 0; off && i < BUS_EV_TYPE_COUNT; i++) {
+        n = snprintf(buf + off, len - off, "%s\"%s\":%u", i ? "," : "", TYPE_NAMES[i], atomic_load(&s_by_type[i]));
+        off = (n > 0 && (size_t)n < len - off) ? off + n : 0;
+    }
+    if (off) {
+        n = snprintf(buf + off, len - off, "},\"subs\":[");
+        off = (n > 0 && (size_t)n < len - off) ? off + n : 0;
+    }
+    int subs = atomic_load(&s_sub_count);
+    for (int i = 0; off && i < subs; i++) {
+        const bus_sub_t *s = &s_subs[i];
+        n = snprintf(buf + off, len - off, "%s{\"name\":\"%s\",\"mask\":%lu,\"calls\":%lu,\"max_us\":%lu}",
+                     i ? "," : "", s->name ? s->name : "?", (unsigned long)s->mask,
+                     (unsigned long)s->calls, (unsigned long)s->max_us);
+        off = (n > 0 && (size_t)n < len - off) ? off + n : 0;
+    }
+    if (off == 0 || off + 3 > len) return 0;
+    buf[off++] = ']';
+    buf[off++] = '}';
+    buf[off] = '\0';
+    return off;
+}
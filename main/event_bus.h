@@ -0,0 +1,73 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// BUS SỰ KIỆN: module phát sự kiện có kiểu, không gọi thẳng module khác.
+// publish: ghi vào ring MPMC cố định (lock-free, không cấp heap, không chặn; đầy thì bỏ + đếm).
+// EVENT_BUS_RESERVED ô cuối chỉ dành cho sự kiện mở cửa (FACE_MATCHED, COMMAND): WS / visitor dồn
+// ứ không làm rơi lệnh mở; người publish lệnh mở vẫn phải xử lý false (hiếm, nhưng không bỏ qua).
+// 1 task phát lại cho các subscriber theo mask -> thêm người nghe (WS, thống kê...) không đụng đường nóng.
+// Handler chạy trên task bus: phải ngắn, việc lâu thì chuyển sang task riêng.
+#define EVENT_BUS_RING_LEN     32       // Luỹ thừa của 2
+#define EVENT_BUS_MAX_SUBS     8
+#define EVENT_BUS_RESERVED     4        // Ô chỉ sự kiện mở cửa được dùng
+
+typedef enum {
+    BUS_EV_FACE_MATCHED = 0,    // Nhận diện khớp -> mở cửa
+    BUS_EV_VISITOR,             // Người lạ mới / quay lại (visitor_cache)
+    BUS_EV_DOOR_STATE,          // Chốt mở / khoá lại
+    BUS_EV_COMMAND,             // Lệnh mở cửa (App, LAN, web, nút EXIT)
+    BUS_EV_ENROLL_REQUEST,      // Yêu cầu học mặt mới
+    BUS_EV_PING,                // Benchmark bus_dispatch: đo publish -> handler
+    BUS_EV_TYPE_COUNT
+} bus_ev_type_t;
+
+#define BUS_MASK(t)        (1u << (t))
+#define BUS_MASK_ALL       ((1u << BUS_EV_TYPE_COUNT) - 1)
+
+typedef enum { BUS_DOOR_OPEN = 0, BUS_DOOR_LOCKED } bus_door_state_t;
+typedef enum { BUS_CMD_OPEN = 0 } bus_cmd_t;
+
+#define BUS_SRC_BUTTON     0xFF     // Nguồn lệnh: ev_source_t, hoặc nút EXIT
+
+typedef struct {
+    uint8_t type;               // bus_ev_type_t
+    uint32_t seq;               // Thứ tự publish (bus tự điền)
+    int64_t ts_us;              // esp_timer lúc publish (bus tự điền)
+    union {
+        struct { int16_t id; float score; uint32_t frame; int32_t age_ms; } face;
+        struct { uint32_t id; float score; uint32_t frame; } visitor;
+        struct { uint8_t state; } door;                         // bus_door_state_t
+        struct { uint8_t cmd; uint8_t source; int32_t ref; } command;   // ref: id lệnh cloud, -1 nếu không có
+        struct { int32_t user_id; } enroll;                     // -1 = /enroll web (cấp ID local)
+        struct { void *task; } ping;                            // Task chờ được đánh thức
+    };
+} bus_event_t;
+
+typedef void (*bus_handler_t)(const bus_event_t *ev, void *ctx);
+
+// Tạo ring + task phát (gọi sớm trong app_main, trước mọi module publish / subscribe)
+void event_bus_init(void);
+
+// Đăng ký lúc khởi động; không huỷ được. name: tên ngắn cho thống kê.
+esp_err_t event_bus_subscribe(uint32_t mask, bus_handler_t fn, void *ctx, const char *name);
+
+// Không chặn, gọi được từ mọi task. false nếu ring đầy (sự kiện bị bỏ, người gọi quyết định báo lỗi / thử lại).
+bool event_bus_publish(bus_event_t *ev);
+
+// {"published":..,"dropped":..,"max_latency_us":..,"by_type":{..},"subs":[{"name":..,"calls":..,"max_us":..},...]}
+size_t event_bus_stats_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,479 @@
+#include "event_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "esp_heap_caps.h"
+#include "json_writer.h"
+#include "bench.h"
+
+static const char *TAG = "EVENTS";
+
+#define EV_REC_SIZE     sizeof(event_rec_t)
+#define EV_IDX_SLOTS    (EVENT_SEG_RECORDS / EVENT_INDEX_EVERY)
+#define EV_MAX_SEGS     (EVENT_STORE_MAX_BYTES / (EVENT_SEG_RECORDS * sizeof(event_rec_t)))
+#define EV_READ_BATCH   32
+
+_Static_assert(sizeof(event_rec_t) == 24, "event_rec_t phải đúng 24 byte");
+
+typedef struct {
+    uint32_t num;           // Số thứ tự file: <base><num>.bin
+    uint32_t first_seq;
+    uint32_t count;
+    uint32_t last_ts;
+    bool sealed;            // Đầy hoặc đuôi file hỏng -> không ghi thêm
+    uint32_t idx_ts[EV_IDX_SLOTS];
+} ev_seg_t;
+
+// 1 kho = 1 dãy segment. base = NULL -> kho ảo sinh bản ghi theo công thức (benchmark 100k)
+typedef struct {
+    const char *base;
+    ev_seg_t *segs;
+    int max_segs;
+    int nsegs;
+    FILE *active;
+    uint32_t next_seq;
+    uint32_t last_ts;
+    SemaphoreHandle_t mutex;
+} ev_store_t;
+
+static ev_seg_t s_main_segs[EV_MAX_SEGS];
+static ev_store_t s_main = { "ev_", s_main_segs, EV_MAX_SEGS, 0, NULL, 0, 0, NULL };
+
+static const char *SOURCE_NAMES[EV_SRC_COUNT] = { "face", "remote", "lan", "web" };
+
+const char *event_source_name(uint8_t src) {
+    return src < EV_SRC_COUNT ? SOURCE_NAMES[src] : "unknown";
+}
+
+void event_snapshot_name(uint32_t snap, char *out, size_t len) {
+    snprintf(out, len, "ev_%08lx.jpg", (unsigned long)snap);
+}
+
+static void _seg_path(const ev_store_t *st, uint32_t num, char *out, size_t len) {
+    snprintf(out, len, EVENT_STORE_DIR "/%s%05lu.bin", st->base, (unsigned long)num);
+}
+
+// ĐỌC: mỗi segment mở 1 lần, đọc theo lô
+typedef struct {
+    const ev_store_t *st;
+    const ev_seg_t *seg;
+    FILE *f;
+} ev_reader_t;
+
+// Kho ảo: 1 sự kiện mỗi 30 s kể từ 2025-01-01
+#define EV_SYNTH_T0       1735689600u
+#define EV_SYNTH_STEP_S   30u
+
+static void _synth_rec(uint32_t seq, event_rec_t *r) {
+    r->ts = EV_SYNTH_T0 + seq * EV_SYNTH_STEP_S;
+    r->seq = seq;
+    r->uptime_s = seq * EV_SYNTH_STEP_S;
+    r->snap = seq * 2654435761u;
+    r->score = 0.5f + (seq % 50) / 100.0f;
+    r->face_id = (seq % 7 == 0) ? -1 : (int16_t)(seq % 10);
+    r->source = (seq % 7 == 0) ? EV_SRC_REMOTE : EV_SRC_FACE;
+    r->flags = EV_FLAG_SNAPSHOT;
+}
+
+static bool _reader_open(ev_reader_t *rd, const ev_store_t *st, const ev_seg_t *seg) {
+    rd->st = st;
+    rd->seg = seg;
+    rd->f = NULL;
+    if (!st->base) return true;
+    char path[48];
+    _seg_path(st, seg->num, path, sizeof(path));
+    rd->f = fopen(path, "rb");
+    return rd->f != NULL;
+}
+
+static uint32_t _reader_read(ev_reader_t *rd, uint32_t idx, event_rec_t *out, uint32_t n) {
+    if (idx >= rd->seg->count) return 0;
+    if (n > rd->seg->count - idx) n = rd->seg->count - idx;
+    if (!rd->st->base) {
+        for (uint32_t i = 0; i < n; i++) _synth_rec(rd->seg->first_seq + idx + i, &out[i]);
+        return n;
+    }
+    if (fseek(rd->f, (long)idx * EV_REC_SIZE, SEEK_SET) != 0) return 0;
+    return fread(out, EV_REC_SIZE, n, rd->f);
+}
+
+static void _reader_close(ev_reader_t *rd) {
+    if (rd->f) fclose(rd->f);
+    rd->f = NULL;
+}
+
+// NẠP KHO TỪ SPIFFS
+static int _cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static bool _seg_load(ev_store_t *st, ev_seg_t *seg) {
+    char path[48];
+    _seg_path(st, seg->num, path, sizeof(path));
+    struct stat sb;
+    if (stat(path, &sb) != 0) return false;
+    seg->count = sb.st_size / EV_REC_SIZE;
+    // Đuôi lẻ = mất điện giữa lúc ghi: giữ phần nguyên vẹn, ghi tiếp sang segment mới
+    seg->sealed = (sb.st_size % EV_REC_SIZE) != 0 || seg->count >= EVENT_SEG_RECORDS;
+    if (seg->count > EVENT_SEG_RECORDS) seg->count = EVENT_SEG_RECORDS;
+    if (seg->count == 0) { remove(path); return false; }
+
+    ev_reader_t rd;
+    if (!_reader_open(&rd, st, seg)) return false;
+    event_rec_t r;
+    bool ok = true;
+    for (uint32_t k = 0; ok && k * EVENT_INDEX_EVERY < seg->count; k++) {
+        ok = _reader_read(&rd, k * EVENT_INDEX_EVERY, &r, 1) == 1;
+        if (k == 0) seg->first_seq = r.seq;
+        seg->idx_ts[k] = r.ts;
+    }
+    if (ok) ok = _reader_read(&rd, seg->count - 1, &r, 1) == 1;
+    seg->last_ts = r.ts;
+    _reader_close(&rd);
+    return ok;
+}
+
+static void _drop_oldest(ev_store_t *st) {
+    if (st->nsegs == 0) return;
+    if (st->base) {
+        char path[48];
+        _seg_path(st, st->segs[0].num, path, sizeof(path));
+        remove(path);
+    }
+    st->nsegs--;
+    memmove(&st->segs[0], &st->segs[1], st->nsegs * sizeof(ev_seg_t));
+}
+
+static esp_err_t _store_open(ev_store_t *st) {
+    if (!st->mutex) st->mutex = xSemaphoreCreateMutex();
+    DIR *dir = opendir(EVENT_STORE_DIR);
+    if (!dir) return ESP_ERR_INVALID_STATE;
+    uint32_t nums[64];
+    int n = 0;
+    size_t base_len = strlen(st->base);
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL && n < 64) {
+        if (strncmp(de->d_name, st->base, base_len) != 0) continue;
+        char *end = NULL;
+        unsigned long num = strtoul(de->d_name + base_len, &end, 10);
+        if (end && strcmp(end, ".bin") == 0) nums[n++] = num;
+    }
+    closedir(dir);
+    qsort(nums, n, sizeof(uint32_t), _cmp_u32);
+
+    st->nsegs = 0;
+    for (int i = 0; i < n; i++) {
+        if (st->nsegs == st->max_segs) _drop_oldest(st);
+        ev_seg_t *seg = &st->segs[st->nsegs];
+        memset(seg, 0, sizeof(*seg));
+        seg->num = nums[i];
+        if (_seg_load(st, seg)) st->nsegs++;
+    }
+    if (st->nsegs > 0) {
+        ev_seg_t *last = &st->segs[st->nsegs - 1];
+        st->next_seq = last->first_seq + last->count;
+        st->last_ts = last->last_ts;
+    }
+    return ESP_OK;
+}
+
+// GHI
+static esp_err_t _store_append(ev_store_t *st, event_rec_t *r) {
+    ev_seg_t *cur = st->nsegs ? &st->segs[st->nsegs - 1] : NULL;
+    if (!cur || cur->sealed || cur->count >= EVENT_SEG_RECORDS) {
+        uint32_t num = cur ? cur->num + 1 : 1;
+        if (st->active) { fclose(st->active); st->active = NULL; }
+        if (cur) cur->sealed = true;
+        while (st->nsegs >= st->max_segs) _drop_oldest(st);
+        cur = &st->segs[st->nsegs++];
+        memset(cur, 0, sizeof(*cur));
+        cur->num = num;
+        cur->first_seq = st->next_seq;
+    }
+    // Giữ theo tuổi: bỏ segment cũ (không bao giờ bỏ segment đang ghi)
+    while (st->nsegs > 1 && r->ts > EVENT_STORE_MAX_AGE_S && st->segs[0].last_ts < r->ts - EVENT_STORE_MAX_AGE_S) {
+        _drop_oldest(st);
+    }
+    cur = &st->segs[st->nsegs - 1];
+
+    if (!st->active) {
+        char path[48];
+        _seg_path(st, cur->num, path, sizeof(path));
+        st->active = fopen(path, "ab");
+        if (!st->active) return ESP_FAIL;
+    }
+    r->seq = st->next_seq;
+    if (fwrite(r, EV_REC_SIZE, 1, st->active) != 1) {
+        // Không chắc đuôi file còn thẳng hàng -> sang segment mới ở lần sau
+        cur->sealed = true;
+        fclose(st->active);
+        st->active = NULL;
+        return ESP_FAIL;
+    }
+    fflush(st->active);
+    fsync(fileno(st->active));
+    if (cur->count % EVENT_INDEX_EVERY == 0) cur->idx_ts[cur->count / EVENT_INDEX_EVERY] = r->ts;
+    cur->count++;
+    cur->last_ts = r->ts;
+    st->last_ts = r->ts;
+    st->next_seq++;
+    return ESP_OK;
+}
+
+static esp_err_t _append_event(ev_store_t *st, ev_source_t src, int face_id, float score, time_t ts, bool snapshot, event_rec_t *out) {
+    if (!st->mutex) return ESP_ERR_INVALID_STATE;
+    event_rec_t r = {
+        .ts = 0, .seq = 0, .uptime_s = (uint32_t)(esp_timer_get_time() / 1000000),
+        .snap = 0, .score = score, .face_id = (int16_t)face_id, .source = (uint8_t)src, .flags = 0,
+    };
+    if (snapshot) {
+        r.snap = esp_random() | 1;
+        r.flags |= EV_FLAG_SNAPSHOT;
+    }
+    xSemaphoreTake(st->mutex, portMAX_DELAY);
+    // ts không giảm để chỉ mục tìm nhị phân được
+    r.ts = (uint32_t)(ts > 0 ? ts : 0);
+    if (r.ts < st->last_ts || r.ts == 0) {
+        r.ts = st->last_ts;
+        r.flags |= EV_FLAG_TS_APPROX;
+    }
+    esp_err_t err = _store_append(st, &r);
+    xSemaphoreGive(st->mutex);
+    if (err == ESP_OK && out) *out = r;
+    return err;
+}
+
+// TRUY VẤN: chỉ giữ mutex lúc chép metadata segment, đọc file/gọi callback ngoài khoá
+typedef struct {
+    uint32_t from_ts, to_ts;
+    uint32_t limit;
+    uint32_t n;
+    event_visit_fn fn;
+    void *ctx;
+} ev_query_t;
+
+// Chép segment đầu tiên có num > after_num. start_idx: vị trí bắt đầu đọc.
+typedef bool (*ev_seg_pick_fn)(const ev_store_t *st, const ev_query_t *q, uint32_t after_num, ev_seg_t *out, uint32_t *start_idx);
+
+static int _first_seg_after(const ev_store_t *st, uint32_t after_num) {
+    int lo = 0, hi = st->nsegs;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (st->segs[mid].num <= after_num) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+static bool _pick_by_ts(const ev_store_t *st, const ev_query_t *q, uint32_t after_num, ev_seg_t *out, uint32_t *start_idx) {
+    int i = _first_seg_after(st, after_num);
+    if (after_num == 0) {
+        // Segment đầu tiên có bản ghi >= from_ts
+        int lo = 0, hi = st->nsegs;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (st->segs[mid].last_ts < q->from_ts) lo = mid + 1; else hi = mid;
+        }
+        i = lo;
+    }
+    for (; i < st->nsegs && st->segs[i].count == 0; i++) {}
+    if (i >= st->nsegs || st->segs[i].idx_ts[0] > q->to_ts) return false;
+    *out = st->segs[i];
+    // Khối chỉ mục cuối cùng còn < from_ts: mọi bản ghi trước nó đều < from_ts
+    uint32_t slots = (out->count + EVENT_INDEX_EVERY - 1) / EVENT_INDEX_EVERY;
+    uint32_t lo = 0, hi = slots;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (out->idx_ts[mid] < q->from_ts) lo = mid + 1; else hi = mid;
+    }
+    *start_idx = (lo > 0 ? lo - 1 : 0) * EVENT_INDEX_EVERY;
+    return true;
+}
+
+static bool _pick_by_seq(const ev_store_t *st, const ev_query_t *q, uint32_t after_num, ev_seg_t *out, uint32_t *start_idx) {
+    // q->from_ts mang from_seq
+    int i = _first_seg_after(st, after_num);
+    for (; i < st->nsegs; i++) {
+        const ev_seg_t *s = &st->segs[i];
+        if (s->count && s->first_seq + s->count > q->from_ts) break;
+    }
+    if (i >= st->nsegs) return false;
+    *out = st->segs[i];
+    *start_idx = q->from_ts > out->first_seq ? q->from_ts - out->first_seq : 0;
+    return true;
+}
+
+static int _store_query(ev_store_t *st, ev_query_t *q, ev_seg_pick_fn pick, bool by_seq) {
+    if (!st->mutex) return 0;
+    ev_seg_t seg;
+    uint32_t after = 0, start = 0;
+    event_rec_t batch[EV_READ_BATCH];
+    bool done = false;
+    while (!done && q->n < q->limit) {
+        xSemaphoreTake(st->mutex, portMAX_DELAY);
+        bool got = pick(st, q, after, &seg, &start);
+        xSemaphoreGive(st->mutex);
+        if (!got) break;
+        after = seg.num;
+
+        ev_reader_t rd;
+        if (!_reader_open(&rd, st, &seg)) continue;
+        for (uint32_t idx = start; !done && idx < seg.count; ) {
+            uint32_t got_n = _reader_read(&rd, idx, batch, EV_READ_BATCH);
+            if (got_n == 0) break;
+            idx += got_n;
+            for (uint32_t i = 0; i < got_n; i++) {
+                const event_rec_t *r = &batch[i];
+                if (!by_seq) {
+                    if (r->ts < q->from_ts) continue;
+                    if (r->ts > q->to_ts) { done = true; break; }
+                }
+                if (!q->fn(r, q->ctx) || ++q->n >= q->limit) { done = true; break; }
+            }
+        }
+        _reader_close(&rd);
+    }
+    return q->n;
+}
+
+int event_store_query(uint32_t from_ts, uint32_t to_ts, uint32_t limit, event_visit_fn fn, void *ctx) {
+    ev_query_t q = { from_ts, to_ts, limit, 0, fn, ctx };
+    return _store_query(&s_main, &q, _pick_by_ts, false);
+}
+
+int event_store_query_recent(uint32_t count, event_visit_fn fn, void *ctx) {
+    uint32_t next = s_main.next_seq;
+    ev_query_t q = { next > count ? next - count : 0, 0, count, 0, fn, ctx };
+    return _store_query(&s_main, &q, _pick_by_seq, true);
+}
+
+esp_err_t event_store_append(ev_source_t src, int face_id, float score, time_t ts, bool snapshot, event_rec_t *out) {
+    return _append_event(&s_main, src, face_id, score, ts, snapshot, out);
+}
+
+size_t event_rec_json(const event_rec_t *r, char *buf, size_t len) {
+    json_writer_t w;
+    jw_init(&w, buf, len);
+    jw_obj_begin(&w);
+    jw_kv_int(&w, "seq", r->seq);
+    jw_kv_int(&w, "ts", r->ts);
+    jw_kv_int(&w, "up_s", r->uptime_s);
+    jw_kv_str(&w, "src", event_source_name(r->source));
+    jw_kv_int(&w, "face_id", r->face_id);
+    jw_kv_float(&w, "score", r->score, 3);
+    jw_key(&w, "img");
+    if (r->flags & EV_FLAG_SNAPSHOT) {
+        char name[24];
+        event_snapshot_name(r->snap, name, sizeof(name));
+        jw_str(&w, name);
+    } else {
+        jw_null(&w);
+    }
+    if (r->flags & EV_FLAG_TS_APPROX) { jw_key(&w, "approx"); jw_bool(&w, true); }
+    jw_obj_end(&w);
+    // Ký tự xuống dòng NDJSON
+    if (!w.overflow && w.len + 2 <= w.cap) w.buf[w.len++] = '\n';
+    else w.overflow = true;
+    size_t n = 0;
+    return jw_finish(&w, &n) ? n : 0;
+}
+
+size_t event_store_stats_json(char *buf, size_t len) {
+    uint32_t events = 0, first_seq = 0, first_ts = 0;
+    int segs = 0;
+    if (s_main.mutex) xSemaphoreTake(s_main.mutex, portMAX_DELAY);
+    segs = s_main.nsegs;
+    for (int i = 0; i < s_main.nsegs; i++) events += s_main.segs[i].count;
+    if (segs) { first_seq = s_main.segs[0].first_seq; first_ts = s_main.segs[0].idx_ts[0]; }
+    uint32_t next_seq = s_main.next_seq, last_ts = s_main.last_ts;
+    if (s_main.mutex) xSemaphoreGive(s_main.mutex);
+    int n = snprintf(buf, len,
+                     "{\"events\":%lu,\"segments\":%d,\"bytes\":%lu,\"first_seq\":%lu,\"next_seq\":%lu,"
+                     "\"first_ts\":%lu,\"last_ts\":%lu}",
+                     (unsigned long)events, segs, (unsigned long)(events * EV_REC_SIZE), (unsigned long)first_seq,
+                     (unsigned long)next_seq, (unsigned long)first_ts, (unsigned long)last_ts);
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
+
+// BENCHMARK
+// event_insert: ghi thật xuống flash (kho riêng evb_, 2 segment xoay vòng)
+// event_query: cửa sổ 1 giờ gần nhất trên kho thật
+// event_query_100k: kho ảo 100k sự kiện (chỉ mục dựng như kho thật, bản ghi sinh theo công thức)
+//                   -> đo tìm nhị phân + duyệt cửa sổ 1 giờ ở vị trí ngẫu nhiên
+#define EV_BENCH_SYNTH_EVENTS  100000
+
+static ev_seg_t s_bench_ins_segs[2];
+static ev_store_t s_bench_ins = { "evb_", s_bench_ins_segs, 2, 0, NULL, 0, 0, NULL };
+static ev_store_t s_bench_synth = { NULL, NULL, 0, 0, NULL, 0, 0, NULL };
+static uint32_t s_bench_rng = 1;
+
+static bool _bench_visit(const event_rec_t *r, void *ctx) {
+    (*(uint32_t *)ctx)++;
+    return true;
+}
+
+static void _bench_insert(void *ctx) {
+    if (!s_bench_ins.mutex && _store_open(&s_bench_ins) != ESP_OK) return;
+    _append_event(&s_bench_ins, EV_SRC_FACE, 1, 0.9f, time(NULL), true, NULL);
+}
+
+static void _bench_query(void *ctx) {
+    uint32_t hits = 0;
+    uint32_t to = s_main.last_ts;
+    event_store_query(to > 3600 ? to - 3600 : 0, to, 500, _bench_visit, &hits);
+}
+
+static bool _bench_synth_build(void) {
+    if (s_bench_synth.mutex) return true;
+    int nsegs = (EV_BENCH_SYNTH_EVENTS + EVENT_SEG_RECORDS - 1) / EVENT_SEG_RECORDS;
+    s_bench_synth.segs = (ev_seg_t *)heap_caps_calloc(nsegs, sizeof(ev_seg_t), MALLOC_CAP_SPIRAM);
+    if (!s_bench_synth.segs) return false;
+    s_bench_synth.max_segs = nsegs;
+    event_rec_t r;
+    for (int i = 0; i < nsegs; i++) {
+        ev_seg_t *seg = &s_bench_synth.segs[i];
+        seg->num = i + 1;
+        seg->first_seq = i * EVENT_SEG_RECORDS;
+        seg->count = EV_BENCH_SYNTH_EVENTS - seg->first_seq < EVENT_SEG_RECORDS ? EV_BENCH_SYNTH_EVENTS - seg->first_seq : EVENT_SEG_RECORDS;
+        seg->sealed = true;
+        for (uint32_t k = 0; k * EVENT_INDEX_EVERY < seg->count; k++) {
+            _synth_rec(seg->first_seq + k * EVENT_INDEX_EVERY, &r);
+            seg->idx_ts[k] = r.ts;
+        }
+        _synth_rec(seg->first_seq + seg->count - 1, &r);
+        seg->last_ts = r.ts;
+    }
+    s_bench_synth.nsegs = nsegs;
+    s_bench_synth.next_seq = EV_BENCH_SYNTH_EVENTS;
+    s_bench_synth.mutex = xSemaphoreCreateMutex();
+    return s_bench_synth.mutex != NULL;
+}
+
+static void _bench_query_synth(void *ctx) {
+    if (!_bench_synth_build()) return;
+    s_bench_rng = s_bench_rng * 1103515245u + 12345u;
+    uint32_t from = EV_SYNTH_T0 + (s_bench_rng >> 8) % (EV_BENCH_SYNTH_EVENTS * EV_SYNTH_STEP_S);
+    uint32_t hits = 0;
+    ev_query_t q = { from, from + 3600, 500, 0, _bench_visit, &hits };
+    _store_query(&s_bench_synth, &q, _pick_by_ts, false);
+}
+
+esp_err_t event_store_init(void) {
+    if (s_main.mutex) return ESP_OK;
+    esp_err_t err = _store_open(&s_main);
+    if (err != ESP_OK) { ESP_LOGE(TAG, "Open Fail: %s", esp_err_to_name(err)); return err; }
+    ESP_LOGI(TAG, "%d segments, next seq %lu, last ts %lu", s_main.nsegs,
+             (unsigned long)s_main.next_seq, (unsigned long)s_main.last_ts);
+    bench_register("event_insert", _bench_insert, NULL);
+    bench_register("event_query", _bench_query, NULL);
+    bench_register("event_query_100k", _bench_query_synth, NULL);
+    return ESP_OK;
+}
@@ -0,0 +1,76 @@
+#ifndef EVENT_STORE_H
+#define EVENT_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// KHO SỰ KIỆN TRÊN SPIFFS: bản ghi cố định, chỉ ghi nối, chia file segment.
+// Mỗi segment giữ chỉ mục thưa (ts của mỗi EVENT_INDEX_EVERY bản ghi) trong RAM
+// -> truy vấn theo khoảng thời gian = tìm nhị phân segment + chỉ mục, rồi đọc tuần tự.
+#define EVENT_STORE_DIR          "/spiffs"
+#define EVENT_SEG_RECORDS        2048                      // Bản ghi / segment (48 KB)
+#define EVENT_INDEX_EVERY        64
+#define EVENT_STORE_MAX_BYTES    (768 * 1024)              // Giữ theo dung lượng: bỏ segment cũ nhất
+#define EVENT_STORE_MAX_AGE_S    (90 * 24 * 3600)          // Giữ theo tuổi
+#define EVENT_QUERY_MAX          5000                      // Số dòng tối đa 1 lần /events
+
+typedef enum {
+    EV_SRC_FACE = 0,        // Nhận diện khuôn mặt
+    EV_SRC_REMOTE,          // Lệnh từ App qua Supabase
+    EV_SRC_LAN,             // /api/cmd có chữ ký
+    EV_SRC_WEB,             // /open trên web nội bộ
+    EV_SRC_COUNT
+} ev_source_t;
+
+#define EV_FLAG_TS_APPROX   0x01    // Chưa có giờ SNTP / đồng hồ lùi: ts mượn từ bản ghi trước
+#define EV_FLAG_SNAPSHOT    0x02    // Có ảnh bằng chứng (tên ảnh suy từ snap)
+
+typedef struct __attribute__((packed)) {
+    uint32_t ts;            // Unix s, không giảm trong toàn kho
+    uint32_t seq;           // Tăng dần qua các lần khởi động
+    uint32_t uptime_s;
+    uint32_t snap;          // Mã ảnh bằng chứng, 0 = không có
+    float score;
+    int16_t face_id;        // -1 = không phải khuôn mặt (source FACE + -1 = người lạ)
+    uint8_t source;         // ev_source_t
+    uint8_t flags;
+} event_rec_t;              // 24 byte
+
+// false = dừng duyệt
+typedef bool (*event_visit_fn)(const event_rec_t *r, void *ctx);
+
+// Gọi sau khi mount SPIFFS: nạp segment + dựng chỉ mục
+esp_err_t event_store_init(void);
+
+// Ghi 1 sự kiện (ts = 0 nếu chưa đồng bộ giờ). out nhận seq/snap đã cấp, có thể NULL.
+esp_err_t event_store_append(ev_source_t src, int face_id, float score, time_t ts, bool snapshot, event_rec_t *out);
+
+// Sự kiện có from_ts <= ts <= to_ts, cũ -> mới. Trả số bản ghi đã duyệt.
+int event_store_query(uint32_t from_ts, uint32_t to_ts, uint32_t limit, event_visit_fn fn, void *ctx);
+
+// `count` sự kiện mới nhất, cũ -> mới
+int event_store_query_recent(uint32_t count, event_visit_fn fn, void *ctx);
+
+// Tên ảnh trên Storage: ev_<snap hex>.jpg
+void event_snapshot_name(uint32_t snap, char *out, size_t len);
+
+const char *event_source_name(uint8_t src);
+
+// 1 dòng NDJSON (kèm '\n'). Trả số byte, 0 nếu không đủ chỗ.
+size_t event_rec_json(const event_rec_t *r, char *buf, size_t len);
+
+// {"events":..,"segments":..,"bytes":..,"first_seq":..,"next_seq":..,"first_ts":..,"last_ts":..}
+size_t event_store_stats_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
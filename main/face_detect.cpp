@@ -1,294 +1,1052 @@
-#include "face_detect.h"
-#include "esp_log.h"
-#include "esp_timer.h"
-#include "esp_heap_caps.h"
-#include "img_converters.h"
-#include "nvs_flash.h"
-#include "nvs.h"
-#include <vector>
-#include <list> 
-#include <math.h>
-#include <cstring> 
-
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/semphr.h"
-#include "esp_camera.h"
-
-// Thư viện AI
-#include "human_face_detect.hpp"       
-#include "human_face_recognition.hpp"
-#include "dl_image_define.hpp"
-
-#include "global_state.h" // Để đọc biến cờ
-
-extern "C" {
-    #include "http_server.h" 
-    #include "lock_ctrl.h" 
-    #include "supabase_client.h"
-}
-
-static const char *TAG = "FACE_AI";
-#define FACE_MATCH_THRESHOLD 0.35f 
-#define MAX_FACES 10
-#define LOG_COOLDOWN_MS 30000 
-
-extern SemaphoreHandle_t xCameraMutex;
-
-static HumanFaceDetect *detector = nullptr; 
-static HumanFaceFeat *feat_extractor = nullptr;
-static bool is_enrolling = false;
-static bool ai_enabled = true;
-static int64_t last_log_time = 0;
-
-typedef struct {
-    float embedding[512];
-    int id;
-    bool valid;
-} face_record_t;
-
-static face_record_t face_db[MAX_FACES];
-static int next_id = 1;
-
-// MATH UTILS 
-static void normalize_vector(float *v, int len) {
-    float sum = 0.0;
-    for (int i = 0; i < len; i++) sum += v[i] * v[i];
-    float magnitude = sqrt(sum);
-    if (magnitude > 0) {
-        for (int i = 0; i < len; i++) v[i] /= magnitude;
-    }
-}
-
-static float dot_product(float *v1, float *v2, int len) {
-    float dot = 0.0;
-    for (int i = 0; i < len; i++) dot += v1[i] * v2[i];
-    return dot; 
-}
-
-// DB UTILS 
-void save_db() {
-    nvs_handle_t handle;
-    if (nvs_open("face_store", NVS_READWRITE, &handle) == ESP_OK) {
-        nvs_set_blob(handle, "db_data", face_db, sizeof(face_db));
-        nvs_set_i32(handle, "next_id", next_id);
-        nvs_commit(handle);
-        nvs_close(handle);
-        ESP_LOGI(TAG, "DB Saved");
-    }
-}
-
-void load_db() {
-    nvs_handle_t handle;
-    if (nvs_open("face_store", NVS_READONLY, &handle) == ESP_OK) {
-        size_t size = sizeof(face_db);
-        nvs_get_blob(handle, "db_data", face_db, &size);
-        nvs_get_i32(handle, "next_id", (int32_t*)&next_id);
-        nvs_close(handle);
-        ESP_LOGI(TAG, "DB Loaded. Next ID: %d", next_id);
-    } else {
-        for(int i=0; i<MAX_FACES; i++) face_db[i].valid = false;
-        next_id = 1;
-    }
-}
-
-// Hàm đồng bộ từ Cloud về RAM
-extern "C" void face_api_add_user_from_cloud(int face_id, float *embedding_buffer, int len) {
-    if (len != 512) return;
-    int slot = -1;
-    for(int i=0; i<MAX_FACES; i++) { if (face_db[i].valid && face_db[i].id == face_id) { slot = i; break; } }
-    if (slot == -1) { for(int i=0; i<MAX_FACES; i++) { if (!face_db[i].valid) { slot = i; break; } } }
-
-    if (slot != -1) {
-        normalize_vector(embedding_buffer, 512);
-        memcpy(face_db[slot].embedding, embedding_buffer, 512 * sizeof(float));
-        face_db[slot].id = face_id;
-        face_db[slot].valid = true;
-        if (face_id >= next_id) next_id = face_id + 1;
-        ESP_LOGI(TAG, "Synced User ID: %d -> Slot: %d", face_id, slot);
-    }
-}
-
-// BRIDGE FUNCTION
-extern "C" bool app_extract_face_feature(camera_fb_t *fb, float *out_buf) {
-    if (!detector || !feat_extractor || !fb) return false;
-
-    // Convert JPG -> RGB888
-    uint8_t *rgb_buf = (uint8_t *)heap_caps_malloc(fb->width * fb->height * 3, MALLOC_CAP_SPIRAM);
-    if (!rgb_buf) {
-        ESP_LOGE(TAG, "Bridge: Alloc RGB Failed");
-        return false;
-    }
-
-    bool success = false;
-    // Chuyển đổi định dạng ảnh
-    if (fmt2rgb888(fb->buf, fb->len, fb->format, rgb_buf)) {
-        dl::image::img_t img;
-        img.data = rgb_buf;
-        img.width = fb->width;
-        img.height = fb->height;
-        img.pix_type = dl::image::DL_IMAGE_PIX_TYPE_RGB888;
-
-        // Chạy AI Detect
-        std::list<dl::detect::result_t> faces = detector->run(img);
-        if (faces.size() > 0) {
-            // Lấy khuôn mặt đầu tiên (lớn nhất)
-            auto &face = faces.front(); 
-            // Chạy AI Recognition
-            auto feat_tensor = feat_extractor->run(img, face.keypoint);
-            if (feat_tensor) {
-                // Copy kết quả ra buffer output
-                memcpy(out_buf, feat_tensor->data, 512 * sizeof(float));
-                normalize_vector(out_buf, 512);
-                success = true;
-            }
-        }
-    }
-    free(rgb_buf);
-    return success;
-}
-
-// LOGIC NHẬN DIỆN 
-void handle_enrollment(float *feature) {
-    int slot = -1;
-    for(int i=0; i<MAX_FACES; i++) if(!face_db[i].valid) { slot=i; break; }
-    
-    if (slot != -1) {
-        normalize_vector(feature, 512); 
-        memcpy(face_db[slot].embedding, feature, 512 * sizeof(float));
-        face_db[slot].id = next_id;
-        face_db[slot].valid = true;
-        ESP_LOGW(TAG, "ENROLL SUCCESS! Saved ID: %d", next_id);
-        
-        char msg[64];
-        snprintf(msg, sizeof(msg), "{\"type\":\"alert\",\"msg\":\"Success ID %d\"}", next_id);
-
-        supabase_upload_face(next_id, feature, 512);
-        next_id++;
-        save_db();
-        is_enrolling = false; 
-    } else {
-        ESP_LOGE(TAG, "Database Full!");
-        is_enrolling = false;
-    }
-}
-
-void handle_recognition(float *feature, camera_fb_t *fb) {
-    float max_score = 0.0f;
-    int matched_id = -1;
-    
-    normalize_vector(feature, 512);
-
-    for (int i = 0; i < MAX_FACES; i++) {
-        if (face_db[i].valid) {
-            float score = dot_product(feature, face_db[i].embedding, 512);
-            if (score > max_score) { 
-                max_score = score; 
-                matched_id = face_db[i].id; 
-            }
-        }
-    }
-
-    if (max_score > FACE_MATCH_THRESHOLD) {
-        ESP_LOGW(TAG, "MATCH ID: %d (Score: %.2f) -> OPEN DOOR!", matched_id, max_score);
-        lock_open_door(); 
-
-        int64_t now = esp_timer_get_time() / 1000;
-        if (now - last_log_time > LOG_COOLDOWN_MS) {
-            ESP_LOGI(TAG, "Sending Log...");
-            char img_name[64] = {0};
-            if (fb) {
-                supabase_upload_image(fb, img_name);
-            }
-            supabase_log_access(matched_id, max_score, img_name);
-            last_log_time = now;
-        }
-        vTaskDelay(pdMS_TO_TICKS(3000)); 
-    }
-}
-
-// TASK CHÍNH
-void face_recognition_task(void *pvParameters) {
-    ESP_LOGI(TAG, "AI Task Started");
-    size_t rgb_buf_len = 320 * 240 * 3; 
-    uint8_t *rgb_buf = (uint8_t *)heap_caps_malloc(rgb_buf_len, MALLOC_CAP_SPIRAM);
-
-    if (!rgb_buf) { ESP_LOGE(TAG, "Alloc RGB Fail"); vTaskDelete(NULL); }
-    
-    while (1) {
-        // KIỂM TRA CỜ "G_IS_ENROLLING"
-        if (g_is_enrolling) {
-            // Nếu Supabase đang Enroll, task này sẽ ngủ 100ms liên tục để nhả Camera
-            vTaskDelay(pdMS_TO_TICKS(100)); 
-            continue; // Bỏ qua vòng lặp này
-        }
-
-        if (!ai_enabled) { vTaskDelay(pdMS_TO_TICKS(1000)); continue; }
-
-        if (xSemaphoreTake(xCameraMutex, pdMS_TO_TICKS(500)) == pdTRUE) {
-            camera_fb_t *fb = esp_camera_fb_get();
-            
-            if (fb) {
-                // ---> ĐÃ THÊM: Lọc ảnh lỗi (< 2KB) để tránh crash JPEG decoder
-                if (fb->len < 2048) {
-                    ESP_LOGW(TAG, "Frame corrupted (%d bytes), skipping...", fb->len);
-                    esp_camera_fb_return(fb);
-                    xSemaphoreGive(xCameraMutex);
-                    vTaskDelay(pdMS_TO_TICKS(50));
-                    continue;
-                }
-
-                if (fb->width * fb->height * 3 > rgb_buf_len) {
-                     esp_camera_fb_return(fb);
-                     xSemaphoreGive(xCameraMutex);
-                     continue;
-                }
-
-                if (fmt2rgb888(fb->buf, fb->len, fb->format, rgb_buf)) {
-                    dl::image::img_t img;
-                    img.data = rgb_buf;
-                    img.width = fb->width; img.height = fb->height;
-                    img.pix_type = dl::image::DL_IMAGE_PIX_TYPE_RGB888;
-
-                    std::list<dl::detect::result_t> faces = detector->run(img);
-
-                    if (faces.size() > 0) {
-                        for (auto &face : faces) {
-                            auto feat_tensor = feat_extractor->run(img, face.keypoint);
-                            if (feat_tensor) {
-                                if (is_enrolling) {
-                                    handle_enrollment((float*)feat_tensor->data);
-                                } else {
-                                    handle_recognition((float*)feat_tensor->data, fb);
-                                }
-                            }
-                        }
-                    }
-                }
-                esp_camera_fb_return(fb); 
-            }
-            xSemaphoreGive(xCameraMutex); 
-        }
-        vTaskDelay(pdMS_TO_TICKS(200)); 
-    }
-    free(rgb_buf);
-}
-
-extern "C" void init_face_detection(void) {
-    detector = new HumanFaceDetect(); 
-    feat_extractor = new HumanFaceFeat();
-    if (detector && feat_extractor) {
-        ESP_LOGI(TAG, "AI Initialized");
-        load_db();
-    } else {
-        ESP_LOGE(TAG, "AI Init Failed");
-    }
-}
-
-extern "C" void start_face_recognition_task(void) {
-    xTaskCreatePinnedToCore(face_recognition_task, "face_ai_task", 10240, NULL, 5, NULL, 1);
-}
-
-extern "C" void start_enrollment(void) { is_enrolling = true; ESP_LOGW(TAG, ">>> START ENROLLING MODE <<<"); }
-extern "C" void set_ai_enable(bool enable) { ai_enabled = enable; }
+#include "face_detect.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "img_converters.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include <new>
+#include <vector>
+#include <list> 
+#include <math.h>
+#include <cstring> 
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_camera.h"
+
+// Thư viện AI
+#include "human_face_detect.hpp"       
+#include "human_face_recognition.hpp"
+#include "dl_image_define.hpp"
+
+#include "perf_monitor.h"
+#include "mem_pool.h"
+#include "camera_init.h"
+#include "camera_ctrl.h"
+#include "boot_mgr.h"
+#include "face_thumb.h"
+#include "access_stats.h"
+#include "bench.h"
+#include "face_roi.h"
+#include "face_model.h"
+#include "visitor_cache.h"
+#include "event_bus.h"
+
+extern "C" {
+    #include "http_server.h" 
+    #include "supabase_client.h"
+    #include "wifi_manager.h"
+}
+
+static const char *TAG = "FACE_AI";
+#define FACE_MATCH_THRESHOLD 0.35f 
+#define MAX_FACES 10
+#define LOG_COOLDOWN_MS 30000 
+#define MATCH_COOLDOWN_MS 3000      // Cùng 1 người: mở cửa / báo App tối đa 1 lần / khoảng này
+// Model feature chọn lúc biên dịch (menuconfig)
+#if defined(CONFIG_FACE_FEAT_MODEL_MBF)
+#define FACE_FEAT_MODEL_TYPE HumanFaceFeat::MBF_S8_V1
+#else
+#define FACE_FEAT_MODEL_TYPE HumanFaceFeat::MFN_S8_V1
+#endif
+
+extern SemaphoreHandle_t xCameraMutex;
+
+static HumanFaceDetect *detector = nullptr; 
+static HumanFaceFeat *feat_extractor = nullptr;
+static HumanFaceFeat *feat_extractor2 = nullptr;   // Bản model thứ 2 cho worker core 0
+static bool ai_enabled = true;
+static int64_t last_log_time = 0;
+
+// Bản ghi gallery theo số chiều embedding lúc biên dịch (DIM = 512 giữ nguyên layout blob NVS cũ)
+template <int DIM>
+struct FaceRecord {
+    float embedding[DIM];
+    int id;
+    bool valid;
+};
+
+typedef FaceRecord<FACE_EMBED_DIM> face_record_t;
+
+static face_record_t face_db[MAX_FACES];
+static int next_id = 1;
+// Bảo vệ face_db: đồng bộ cloud chạy nền song song với nhận diện
+static SemaphoreHandle_t db_mutex = NULL;
+// Khoá model (detector, đặc trưng) + buffer batch: task AI, enroll và benchmark không chạy chồng lên nhau
+static SemaphoreHandle_t s_feat_mutex = NULL;
+
+// MATH UTILS: số vòng lặp là hằng lúc biên dịch -> compiler unroll, không kiểm tra độ dài lúc chạy
+template <int DIM>
+static inline void normalize_vector(float *v) {
+    float sum = 0.0;
+    for (int i = 0; i < DIM; i++) sum += v[i] * v[i];
+    float magnitude = sqrt(sum);
+    if (magnitude > 0) {
+        for (int i = 0; i < DIM; i++) v[i] /= magnitude;
+    }
+}
+
+template <int DIM>
+static inline float dot_product(const float *v1, const float *v2) {
+    float dot = 0.0;
+    for (int i = 0; i < DIM; i++) dot += v1[i] * v2[i];
+    return dot; 
+}
+
+// Đầu ra model phải đúng FACE_EMBED_DIM (Kconfig); sai thì báo 1 lần và bỏ
+static bool feat_dim_ok(dl::TensorBase *t) {
+    static bool warned = false;
+    if (t->get_size() == FACE_EMBED_DIM) return true;
+    if (!warned) {
+        ESP_LOGE(TAG, "Model output %d dims != FACE_EMBED_DIM %d (check menuconfig)", t->get_size(), FACE_EMBED_DIM);
+        warned = true;
+    }
+    return false;
+}
+
+// MẪU GỐC (anchor) của từng slot: embedding lúc enroll / trên cloud, lượng tử int8 (v ~ q * scale).
+// Mẫu trong face_db được học dần nhưng phải luôn giống mẫu gốc >= FACE_ADAPT_ANCHOR_MIN.
+typedef struct {
+    float scale;
+    int8_t q[FACE_EMBED_DIM];
+} face_anchor_t;
+
+static face_anchor_t s_anchor[MAX_FACES];
+
+// Trạng thái học của từng slot (chỉ RAM)
+typedef struct {
+    int64_t last_ms;        // Lần thử cập nhật gần nhất
+    uint32_t updates;
+    bool cloud_dirty;       // Mẫu đã học chưa đẩy lên cloud
+} face_adapt_slot_t;
+
+static face_adapt_slot_t s_adapt[MAX_FACES];
+static struct {
+    uint32_t updates, drift_rejects, rate_limited, ambiguous;
+    uint32_t saves, uploads, upload_fails;
+} s_adapt_stats;
+static bool s_adapt_nvs_dirty = false;
+static int64_t s_adapt_last_save_ms = 0;
+static int64_t s_adapt_last_upload_ms = 0;
+static float s_adapt_tmp[FACE_EMBED_DIM];   // Mẫu ứng viên: chỉ task AI dùng, khi giữ s_feat_mutex
+
+// Gọi khi giữ db_mutex (hoặc lúc khởi động)
+static void anchor_set(int slot, const float *v) {
+    float max_abs = 0.0f;
+    for (int i = 0; i < FACE_EMBED_DIM; i++) max_abs = fmaxf(max_abs, fabsf(v[i]));
+    face_anchor_t *a = &s_anchor[slot];
+    a->scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+    for (int i = 0; i < FACE_EMBED_DIM; i++) a->q[i] = (int8_t)lroundf(v[i] / a->scale);
+    s_adapt[slot] = { 0, 0, false };
+}
+
+static float anchor_sim(int slot, const float *v) {
+    const face_anchor_t *a = &s_anchor[slot];
+    float dot = 0.0f;
+    for (int i = 0; i < FACE_EMBED_DIM; i++) dot += v[i] * a->q[i];
+    return dot * a->scale;
+}
+
+// Cùng embedding đã có (sai số lượng tử) -> không phải enroll lại
+#define ANCHOR_SAME_SIM 0.995f
+
+// DB UTILS 
+void save_db() {
+    xSemaphoreTake(db_mutex, portMAX_DELAY);
+    nvs_handle_t handle;
+    if (nvs_open("face_store", NVS_READWRITE, &handle) == ESP_OK) {
+        nvs_set_blob(handle, "db_data", face_db, sizeof(face_db));
+        nvs_set_blob(handle, "db_anchor", s_anchor, sizeof(s_anchor));
+        nvs_set_str(handle, "db_model", FACE_FEAT_MODEL_NAME);
+        nvs_set_i32(handle, "next_id", next_id);
+        nvs_commit(handle);
+        nvs_close(handle);
+        s_adapt_nvs_dirty = false;
+        s_adapt_last_save_ms = esp_timer_get_time() / 1000;
+        ESP_LOGI(TAG, "DB Saved");
+    }
+    xSemaphoreGive(db_mutex);
+}
+
+void load_db() {
+    nvs_handle_t handle;
+    bool anchors = false;
+    if (nvs_open("face_store", NVS_READONLY, &handle) == ESP_OK) {
+        // Gallery của model / số chiều khác không so được với embedding mới -> bỏ, chờ đồng bộ / học lại
+        char model[16] = FACE_FEAT_MODEL_NAME;   // Bản cũ chưa ghi tên: coi như model mặc định
+        size_t mlen = sizeof(model);
+        nvs_get_str(handle, "db_model", model, &mlen);
+        size_t size = 0;
+        bool same = strcmp(model, FACE_FEAT_MODEL_NAME) == 0 &&
+                    nvs_get_blob(handle, "db_data", NULL, &size) == ESP_OK && size == sizeof(face_db);
+        if (same) {
+            nvs_get_blob(handle, "db_data", face_db, &size);
+            size = sizeof(s_anchor);
+            anchors = nvs_get_blob(handle, "db_anchor", s_anchor, &size) == ESP_OK && size == sizeof(s_anchor);
+            nvs_get_i32(handle, "next_id", (int32_t*)&next_id);
+            ESP_LOGI(TAG, "DB Loaded. Next ID: %d", next_id);
+        } else {
+            ESP_LOGW(TAG, "DB from model %s (%u bytes) != %s x %d, ignored", model, (unsigned)size,
+                     FACE_FEAT_MODEL_NAME, FACE_EMBED_DIM);
+            nvs_get_i32(handle, "next_id", (int32_t*)&next_id);
+        }
+        nvs_close(handle);
+    } else {
+        for(int i=0; i<MAX_FACES; i++) face_db[i].valid = false;
+        next_id = 1;
+    }
+    // Gallery cũ chưa có mẫu gốc: lấy mẫu hiện tại làm gốc
+    if (!anchors) {
+        for (int i = 0; i < MAX_FACES; i++) if (face_db[i].valid) anchor_set(i, face_db[i].embedding);
+    }
+}
+
+// Hàm đồng bộ từ Cloud về RAM
+extern "C" void face_api_add_user_from_cloud(int face_id, float *embedding_buffer, int len) {
+    if (len != FACE_EMBED_DIM) return;
+    xSemaphoreTake(db_mutex, portMAX_DELAY);
+    int slot = -1;
+    for(int i=0; i<MAX_FACES; i++) { if (face_db[i].valid && face_db[i].id == face_id) { slot = i; break; } }
+    if (slot == -1) { for(int i=0; i<MAX_FACES; i++) { if (!face_db[i].valid) { slot = i; break; } } }
+
+    if (slot != -1) {
+        normalize_vector<FACE_EMBED_DIM>(embedding_buffer);
+        // Đồng bộ lại đúng embedding gốc: giữ mẫu đã học. Embedding khác (enroll lại) -> mẫu + gốc mới
+        bool same = face_db[slot].valid && face_db[slot].id == face_id &&
+                    anchor_sim(slot, embedding_buffer) >= ANCHOR_SAME_SIM;
+        if (!same) {
+            memcpy(face_db[slot].embedding, embedding_buffer, FACE_EMBED_BYTES);
+            anchor_set(slot, embedding_buffer);
+        }
+        face_db[slot].id = face_id;
+        face_db[slot].valid = true;
+        if (face_id >= next_id) next_id = face_id + 1;
+        ESP_LOGI(TAG, "Synced User ID: %d -> Slot: %d%s", face_id, slot, same ? " (kept adapted)" : "");
+    }
+    xSemaphoreGive(db_mutex);
+}
+
+// Mẫu đã học trên cloud (sau khi mất NVS): chỉ nhận khi local chưa học gì và vẫn gần mẫu gốc
+extern "C" void face_api_adapted_from_cloud(int face_id, float *embedding_buffer, int len) {
+    if (len != FACE_EMBED_DIM) return;
+    normalize_vector<FACE_EMBED_DIM>(embedding_buffer);
+    xSemaphoreTake(db_mutex, portMAX_DELAY);
+    for (int i = 0; i < MAX_FACES; i++) {
+        if (!face_db[i].valid || face_db[i].id != face_id) continue;
+        if (anchor_sim(i, face_db[i].embedding) >= ANCHOR_SAME_SIM &&
+            anchor_sim(i, embedding_buffer) >= FACE_ADAPT_ANCHOR_MIN) {
+            memcpy(face_db[i].embedding, embedding_buffer, FACE_EMBED_BYTES);
+            s_adapt_nvs_dirty = true;
+            ESP_LOGI(TAG, "Adapted template for ID %d restored from cloud", face_id);
+        }
+        break;
+    }
+    xSemaphoreGive(db_mutex);
+}
+
+// Lưu gallery xuống flash sau khi nạp hàng loạt (BLE bulk)
+extern "C" void face_api_save_db(void) {
+    save_db();
+}
+
+// BATCH: mọi mặt trong 1 frame -> trích đặc trưng 1 lượt, so gallery 1 lượt, 1 quyết định
+typedef struct {
+    int n;
+    const std::vector<int> *kpt[FACE_BATCH_MAX];
+    const std::vector<int> *box[FACE_BATCH_MAX];
+    bool ok[FACE_BATCH_MAX];
+    int id[FACE_BATCH_MAX];
+    float score[FACE_BATCH_MAX];
+    float second[FACE_BATCH_MAX];      // Điểm của người giống thứ 2 (độ tách biệt cho cập nhật mẫu)
+    uint32_t visitor[FACE_BATCH_MAX];  // Id người lạ cần báo (0 = không: quen, hoặc đã báo trong cửa sổ)
+} face_batch_t;
+
+// Embedding của batch đang xử lý [FACE_BATCH_MAX][FACE_EMBED_DIM], giữ suốt vòng đời (PSRAM)
+static float (*s_batch_feat)[FACE_EMBED_DIM] = nullptr;
+
+// Worker core 0: nhận các mặt lẻ (1, 3, ...) trong khi task AI làm các mặt chẵn
+static TaskHandle_t s_feat_worker = NULL;
+static SemaphoreHandle_t s_feat_done = NULL;
+static face_batch_t *s_job = nullptr;
+static const dl::image::img_t *s_job_img = nullptr;
+
+// Thống kê theo cỡ batch (1..FACE_BATCH_MAX mặt/frame)
+typedef struct {
+    uint32_t frames;
+    uint32_t faces;
+    uint64_t us;        // Trích đặc trưng + so gallery
+} batch_bucket_t;
+
+static batch_bucket_t s_batch_stats[FACE_BATCH_MAX];
+static uint32_t s_batch_dropped = 0;   // Mặt vượt quá FACE_BATCH_MAX (bỏ qua)
+
+static bool extract_one(HumanFaceFeat *model, const dl::image::img_t &img, const std::vector<int> &kpt, float *out) {
+    auto feat_tensor = model->run(img, kpt);
+    if (!feat_tensor || !feat_dim_ok(feat_tensor)) return false;
+    memcpy(out, feat_tensor->data, FACE_EMBED_BYTES);
+    normalize_vector<FACE_EMBED_DIM>(out);
+    return true;
+}
+
+static void feat_worker_task(void *pvParameters) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (int i = 1; i < s_job->n; i += 2) {
+            s_job->ok[i] = extract_one(feat_extractor2, *s_job_img, *s_job->kpt[i], s_batch_feat[i]);
+        }
+        xSemaphoreGive(s_feat_done);
+    }
+}
+
+static void extract_batch(face_batch_t *b, const dl::image::img_t &img) {
+    if (s_feat_worker && b->n >= 2) {
+        s_job = b;
+        s_job_img = &img;
+        xTaskNotifyGive(s_feat_worker);
+        for (int i = 0; i < b->n; i += 2) b->ok[i] = extract_one(feat_extractor, img, *b->kpt[i], s_batch_feat[i]);
+        xSemaphoreTake(s_feat_done, portMAX_DELAY);
+    } else {
+        for (int i = 0; i < b->n; i++) b->ok[i] = extract_one(feat_extractor, img, *b->kpt[i], s_batch_feat[i]);
+    }
+}
+
+// 1 lượt qua gallery: mỗi bản ghi được đọc 1 lần và so với cả batch
+static void match_gallery(const face_record_t *db, face_batch_t *b) {
+    for (int i = 0; i < b->n; i++) { b->id[i] = -1; b->score[i] = 0.0f; b->second[i] = 0.0f; }
+
+    for (int g = 0; g < MAX_FACES; g++) {
+        if (!db[g].valid) continue;
+        for (int i = 0; i < b->n; i++) {
+            if (!b->ok[i]) continue;
+            float score = dot_product<FACE_EMBED_DIM>(s_batch_feat[i], db[g].embedding);
+            if (score > b->score[i]) {
+                b->second[i] = b->score[i];
+                b->score[i] = score;
+                b->id[i] = db[g].id;
+            } else if (score > b->second[i]) {
+                b->second[i] = score;
+            }
+        }
+    }
+}
+
+static void match_batch(face_batch_t *b) {
+    xSemaphoreTake(db_mutex, portMAX_DELAY);
+    match_gallery(face_db, b);
+    xSemaphoreGive(db_mutex);
+}
+
+// Gọi khi đang giữ s_feat_mutex. Trả về thời gian xử lý (us).
+static int64_t run_batch(face_batch_t *b, const dl::image::img_t &img) {
+    int64_t t0 = esp_timer_get_time();
+    {
+        PERF_SCOPE("feature");
+        extract_batch(b, img);
+    }
+    {
+        PERF_SCOPE("match");
+        match_batch(b);
+    }
+    int64_t us = esp_timer_get_time() - t0;
+    if (b->n > 0) {
+        batch_bucket_t *st = &s_batch_stats[b->n - 1];
+        st->frames++;
+        st->faces += b->n;
+        st->us += us;
+    }
+    return us;
+}
+
+// CẬP NHẬT MẪU: gọi trong task AI khi giữ s_feat_mutex (s_batch_feat còn embedding của frame)
+static void adapt_templates(const face_batch_t *b) {
+    int64_t now = esp_timer_get_time() / 1000;
+    for (int i = 0; i < b->n; i++) {
+        if (!b->ok[i] || b->score[i] < FACE_ADAPT_MIN_SCORE) continue;
+        // Gần 2 người cùng lúc: không chắc là ai -> không học
+        if (b->score[i] - b->second[i] < FACE_ADAPT_MARGIN) { s_adapt_stats.ambiguous++; continue; }
+
+        xSemaphoreTake(db_mutex, portMAX_DELAY);
+        int slot = -1;
+        for (int g = 0; g < MAX_FACES; g++) {
+            if (face_db[g].valid && face_db[g].id == b->id[i]) { slot = g; break; }
+        }
+        face_adapt_slot_t *st = slot >= 0 ? &s_adapt[slot] : nullptr;
+        if (st && st->last_ms && now - st->last_ms < FACE_ADAPT_USER_MS) {
+            s_adapt_stats.rate_limited++;
+        } else if (st) {
+            const float *e = s_batch_feat[i];
+            float *t = face_db[slot].embedding;
+            for (int k = 0; k < FACE_EMBED_DIM; k++) s_adapt_tmp[k] = (1.0f - FACE_ADAPT_ALPHA) * t[k] + FACE_ADAPT_ALPHA * e[k];
+            normalize_vector<FACE_EMBED_DIM>(s_adapt_tmp);
+            st->last_ms = now;   // Bị từ chối cũng tính lượt: không thử lại mỗi frame
+            if (anchor_sim(slot, s_adapt_tmp) < FACE_ADAPT_ANCHOR_MIN) {
+                s_adapt_stats.drift_rejects++;
+            } else {
+                memcpy(t, s_adapt_tmp, FACE_EMBED_BYTES);
+                st->updates++;
+                st->cloud_dirty = true;
+                s_adapt_nvs_dirty = true;
+                s_adapt_stats.updates++;
+            }
+        }
+        xSemaphoreGive(db_mutex);
+    }
+}
+
+// ENROLL: việc gửi cho pipeline đang chạy. Mỗi frame có mặt góp embedding của mặt lớn nhất
+// (đã tính sẵn cho nhận diện) -> không suy luận thêm, không dừng nhận diện người khác.
+typedef enum { ENROLL_IDLE = 0, ENROLL_ACTIVE, ENROLL_DONE } enroll_state_t;
+
+typedef struct {
+    enroll_state_t state;
+    int frames;
+    float *sum;               // Buffer của người gọi: tổng embedding, chuẩn hoá khi xong
+    camera_fb_t *photo;       // != NULL: copy JPEG frame đầu tiên của lượt gom
+    int64_t start_us;
+} enroll_job_t;
+
+// Job chỉ được đọc/ghi khi giữ s_feat_mutex (task AI gom trong lúc giữ mutex này)
+static enroll_job_t s_enroll = { ENROLL_IDLE, 0, nullptr, nullptr, 0 };
+static SemaphoreHandle_t s_enroll_done = NULL;
+static TaskHandle_t s_local_enroll_task = NULL;
+
+static void enroll_drop_photo(void) {
+    if (s_enroll.photo && s_enroll.photo->buf) {
+        heap_caps_free(s_enroll.photo->buf);
+        s_enroll.photo->buf = NULL;
+        s_enroll.photo->len = 0;
+    }
+}
+
+// Gọi khi đang giữ s_feat_mutex, ngay sau run_batch
+static void enroll_feed(const face_batch_t *b, const camera_frame_t *frame) {
+    if (s_enroll.state != ENROLL_ACTIVE) return;
+
+    int pick = -1, best_area = 0;
+    for (int i = 0; i < b->n; i++) {
+        const std::vector<int> &box = *b->box[i];
+        int area = (box[2] - box[0]) * (box[3] - box[1]);
+        if (b->ok[i] && area > best_area) { best_area = area; pick = i; }
+    }
+    if (pick < 0) return;
+    const float *e = s_batch_feat[pick];
+
+    // Mặt lớn nhất không còn giống các frame trước (người khác bước vào) -> gom lại từ đầu
+    if (s_enroll.frames > 0) {
+        float norm = sqrtf(dot_product<FACE_EMBED_DIM>(s_enroll.sum, s_enroll.sum));
+        if (norm > 0 && dot_product<FACE_EMBED_DIM>(e, s_enroll.sum) / norm < FACE_ENROLL_MIN_SIM) s_enroll.frames = 0;
+    }
+
+    if (s_enroll.frames == 0) {
+        memcpy(s_enroll.sum, e, FACE_EMBED_BYTES);
+        if (s_enroll.photo) {
+            enroll_drop_photo();
+            camera_fb_t *fb = frame->fb;
+            s_enroll.photo->buf = (uint8_t *)heap_caps_malloc(fb->len, MALLOC_CAP_SPIRAM);
+            if (s_enroll.photo->buf) {
+                memcpy(s_enroll.photo->buf, fb->buf, fb->len);
+                s_enroll.photo->len = fb->len;
+                s_enroll.photo->width = fb->width;
+                s_enroll.photo->height = fb->height;
+                s_enroll.photo->format = fb->format;
+            }
+        }
+    } else {
+        for (int i = 0; i < FACE_EMBED_DIM; i++) s_enroll.sum[i] += e[i];
+    }
+
+    if (++s_enroll.frames >= FACE_ENROLL_FRAMES) {
+        normalize_vector<FACE_EMBED_DIM>(s_enroll.sum);
+        s_enroll.state = ENROLL_DONE;
+        xSemaphoreGive(s_enroll_done);
+    }
+}
+
+extern "C" esp_err_t face_enroll(uint32_t timeout_ms, float *embedding, camera_fb_t *photo) {
+    if (!embedding) return ESP_ERR_INVALID_ARG;
+    if (!s_enroll_done || !s_batch_feat) return ESP_ERR_INVALID_STATE;
+    if (photo) memset(photo, 0, sizeof(*photo));
+
+    xSemaphoreTake(s_feat_mutex, portMAX_DELAY);
+    if (s_enroll.state != ENROLL_IDLE) {
+        xSemaphoreGive(s_feat_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_enroll_done, 0);   // Bỏ tín hiệu cũ (nếu job trước vừa xong đúng lúc huỷ)
+    s_enroll = { ENROLL_ACTIVE, 0, embedding, photo, esp_timer_get_time() };
+    xSemaphoreGive(s_feat_mutex);
+    ESP_LOGW(TAG, ">>> ENROLL JOB SUBMITTED <<<");
+
+    xSemaphoreTake(s_enroll_done, pdMS_TO_TICKS(timeout_ms));
+
+    xSemaphoreTake(s_feat_mutex, portMAX_DELAY);
+    bool ok = (s_enroll.state == ENROLL_DONE);
+    int frames = s_enroll.frames;
+    int64_t ms = (esp_timer_get_time() - s_enroll.start_us) / 1000;
+    if (!ok) enroll_drop_photo();
+    s_enroll = { ENROLL_IDLE, 0, nullptr, nullptr, 0 };
+    xSemaphoreGive(s_feat_mutex);
+
+    if (ok) ESP_LOGW(TAG, "ENROLL: %d frames in %lld ms", frames, ms);
+    else ESP_LOGE(TAG, "ENROLL: timeout (%d/%d frames)", frames, FACE_ENROLL_FRAMES);
+    return ok ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+// Thêm mặt mới vào gallery local với ID kế tiếp. Trả về ID, -1 nếu đầy.
+static int gallery_add_new(const float *embedding) {
+    xSemaphoreTake(db_mutex, portMAX_DELAY);
+    int id = -1;
+    for (int i = 0; i < MAX_FACES; i++) {
+        if (face_db[i].valid) continue;
+        memcpy(face_db[i].embedding, embedding, FACE_EMBED_BYTES);
+        anchor_set(i, embedding);
+        face_db[i].id = id = next_id++;
+        face_db[i].valid = true;
+        break;
+    }
+    xSemaphoreGive(db_mutex);
+    return id;
+}
+
+// Enroll từ web (/enroll): chạy ngoài task AI để upload cloud không chặn nhận diện
+static void local_enroll_task(void *pvParameters) {
+    float *emb = (float *)mem_pool_alloc(FACE_EMBED_BYTES);
+    esp_err_t err = emb ? face_enroll(FACE_ENROLL_TIMEOUT_MS, emb, NULL) : ESP_ERR_NO_MEM;
+    int id = (err == ESP_OK) ? gallery_add_new(emb) : -1;
+
+    char msg[96];
+    if (id >= 0) {
+        ESP_LOGW(TAG, "ENROLL SUCCESS! Saved ID: %d", id);
+        snprintf(msg, sizeof(msg), "{\"type\":\"enroll\",\"state\":\"success\",\"id\":%d}", id);
+        ws_send_message(msg);
+        supabase_upload_face(id, emb, FACE_EMBED_DIM);
+        save_db();
+    } else {
+        const char *why = (err == ESP_OK) ? "Database full" : (err == ESP_ERR_TIMEOUT ? "No face" : "Busy");
+        ESP_LOGE(TAG, "Enroll failed: %s", why);
+        snprintf(msg, sizeof(msg), "{\"type\":\"enroll\",\"state\":\"failed\",\"msg\":\"%s\"}", why);
+        ws_send_message(msg);
+    }
+    mem_pool_free(emb);
+    s_local_enroll_task = NULL;
+    vTaskDelete(NULL);
+}
+
+// ENROLL không có user_id (web /enroll): cấp ID kế tiếp, lưu gallery, đẩy lên cloud. Không chặn task bus.
+static void enroll_bus_handler(const bus_event_t *ev, void *ctx) {
+    if (ev->enroll.user_id >= 0 || s_local_enroll_task) return;
+    if (xTaskCreatePinnedToCore(local_enroll_task, "enroll", 6144, NULL, 4, &s_local_enroll_task, 0) != pdPASS) {
+        s_local_enroll_task = NULL;
+        ws_send_message("{\"type\":\"enroll\",\"state\":\"failed\",\"msg\":\"No memory\"}");
+        return;
+    }
+    ws_send_message("{\"type\":\"enroll\",\"state\":\"started\"}");
+}
+
+// NGƯỜI LẠ: gom embedding mặt không khớp vào cụm, chỉ cụm mới / quay lại sau cửa sổ mới thành sự kiện.
+// Gọi trong s_feat_mutex (s_batch_feat còn nguyên embedding của frame)
+static void observe_visitors(face_batch_t *b) {
+    int64_t now = esp_timer_get_time() / 1000;
+    for (int i = 0; i < b->n; i++) {
+        b->visitor[i] = 0;
+        if (!b->ok[i] || b->score[i] > FACE_MATCH_THRESHOLD) continue;
+        visitor_hit_t hit;
+        if (visitor_cache_observe(s_batch_feat[i], now, &hit) && hit.event) b->visitor[i] = hit.id;
+    }
+}
+
+// 1 ảnh thumbnail + 1 dòng log (face_id = -1) cho mỗi sự kiện người lạ; frame gốc không gửi
+static void handle_visitors(const face_batch_t *b, const camera_frame_t *frame, const dl::image::img_t &img) {
+    for (int i = 0; i < b->n; i++) {
+        if (!b->visitor[i]) continue;
+        const std::vector<int> &box = *b->box[i];
+        ESP_LOGW(TAG, "UNKNOWN VISITOR #%lu (Score: %.2f)", (unsigned long)b->visitor[i], b->score[i]);
+
+        bus_event_t ev = {};
+        ev.type = BUS_EV_VISITOR;
+        ev.visitor.id = b->visitor[i];
+        ev.visitor.score = b->score[i];
+        ev.visitor.frame = frame->seq;
+        event_bus_publish(&ev);
+
+        uint8_t *thumb = NULL;
+        size_t thumb_len = 0;
+        face_box_t fb_box = { 0, 0, 0, 0 };
+        if (box.size() >= 4) fb_box = { box[0], box[1], box[2], box[3] };
+        if (face_thumb_encode((const uint8_t *)img.data, img.width, img.height, fb_box, frame->fb->len, &thumb, &thumb_len)) {
+            supabase_log_access_thumb(-1, b->score[i], thumb, thumb_len, NULL);
+        } else {
+            supabase_log_access_async(EV_SRC_FACE, -1, b->score[i], NULL);
+        }
+    }
+}
+
+// Lần mở cửa gần nhất của từng người (chỉ task AI dùng). Không dừng task: người khác vẫn được nhận diện ngay
+typedef struct {
+    int id;
+    int64_t last_ms;        // 0 = trống
+} match_cooldown_t;
+
+static match_cooldown_t s_match_cd[MAX_FACES];
+
+// true nếu id vừa mở cửa chưa quá MATCH_COOLDOWN_MS; ngược lại ghi nhận now cho id (đầy -> thay mục cũ nhất)
+static bool match_cooling_down(int id, int64_t now) {
+    int slot = -1, oldest = 0;
+    for (int i = 0; i < MAX_FACES; i++) {
+        if (s_match_cd[i].last_ms && s_match_cd[i].id == id) { slot = i; break; }
+        if (s_match_cd[i].last_ms < s_match_cd[oldest].last_ms) oldest = i;
+    }
+    if (slot >= 0 && now - s_match_cd[slot].last_ms < MATCH_COOLDOWN_MS) return true;
+    if (slot < 0) slot = oldest;
+    s_match_cd[slot].id = id;
+    s_match_cd[slot].last_ms = now;
+    return false;
+}
+
+// Huỷ ghi nhận của match_cooling_down (lệnh mở không gửi được -> frame sau thử lại ngay)
+static void match_cooldown_forget(int id) {
+    for (int i = 0; i < MAX_FACES; i++) {
+        if (s_match_cd[i].last_ms && s_match_cd[i].id == id) s_match_cd[i].last_ms = 0;
+    }
+}
+
+// 1 quyết định cho cả frame: mặt khớp tốt nhất (nếu vượt ngưỡng) mở cửa.
+// Trả về true nếu đã mở cửa (và đã ghi nhận thời điểm quyết định cho frame)
+bool handle_recognition(const face_batch_t *b, const camera_frame_t *frame, const dl::image::img_t &img) {
+    camera_fb_t *fb = frame->fb;
+    int best = -1;
+    for (int i = 0; i < b->n; i++) {
+        if (b->ok[i] && (best < 0 || b->score[i] > b->score[best])) best = i;
+    }
+    if (best < 0) return false;
+    float max_score = b->score[best];
+    int matched_id = b->id[best];
+    const std::vector<int> &box = *b->box[best];
+
+    if (max_score > FACE_MATCH_THRESHOLD) {
+        int64_t now = esp_timer_get_time() / 1000;
+        // Người vừa được mở cửa vẫn đứng trước camera: không mở / báo lại, frame tính là không quyết định
+        if (match_cooling_down(matched_id, now)) return false;
+
+        ESP_LOGW(TAG, "MATCH ID: %d (Score: %.2f) -> OPEN DOOR!", matched_id, max_score);
+        // lock_ctrl mở cửa, WS báo App: không chờ người nghe nào
+        bus_event_t ev = {};
+        ev.type = BUS_EV_FACE_MATCHED;
+        ev.face.id = matched_id;
+        ev.face.score = max_score;
+        ev.face.frame = frame->seq;
+        ev.face.age_ms = camera_frame_age_us(frame) / 1000;
+        if (!event_bus_publish(&ev)) {
+            ESP_LOGE(TAG, "Bus đầy, bỏ frame này");
+            match_cooldown_forget(matched_id);
+            return false;
+        }
+
+        camera_record_decision(frame);
+
+        // Chỉ copy vào outbox: ghi nhật ký local ngay, gửi cloud khi có mạng -> online hay offline đều như nhau
+        if (now - last_log_time > LOG_COOLDOWN_MS) {
+            ESP_LOGI(TAG, "Queue Log...");
+            // Ảnh bằng chứng: thumbnail vùng mặt; frame gốc chỉ gửi kèm theo lịch thưa
+            uint8_t *thumb = NULL;
+            size_t thumb_len = 0;
+            face_box_t thumb_box = { 0, 0, 0, 0 };
+            if (box.size() >= 4) thumb_box = { box[0], box[1], box[2], box[3] };
+            if (face_thumb_encode((const uint8_t *)img.data, img.width, img.height, thumb_box, fb->len, &thumb, &thumb_len)) {
+                supabase_log_access_thumb(matched_id, max_score, thumb, thumb_len, face_thumb_want_full_frame() ? fb : NULL);
+            } else {
+                supabase_log_access_async(EV_SRC_FACE, matched_id, max_score, fb);
+            }
+            last_log_time = now;
+        }
+        return true;
+    }
+    // Mặt lạ: histogram điểm (điểm cao nhất của frame); log/ảnh chỉ theo sự kiện của visitor_cache
+    access_stats_unknown(max_score);
+    return false;
+}
+
+// TASK CHÍNH
+void face_recognition_task(void *pvParameters) {
+    ESP_LOGI(TAG, "AI Task Started");
+    size_t rgb_buf_len = MEM_POOL_RGB_SIZE; 
+    // Giữ 1 khối RGB của pool suốt vòng đời task
+    uint8_t *rgb_buf = (uint8_t *)mem_pool_alloc(rgb_buf_len);
+
+    if (!rgb_buf) { ESP_LOGE(TAG, "Alloc RGB Fail"); vTaskDelete(NULL); }
+    
+    while (1) {
+        if (!ai_enabled) { vTaskDelay(pdMS_TO_TICKS(1000)); continue; }
+
+        camera_frame_t frame = { NULL, 0, 0 };
+        bool got = false;
+        if (xSemaphoreTake(xCameraMutex, pdMS_TO_TICKS(500)) == pdTRUE) {
+            // Chỉ giữ mutex lúc lấy frame: với nhiều frame buffer, stream/enroll lấy frame khác song song
+            got = camera_frame_get(&frame);
+            xSemaphoreGive(xCameraMutex);
+        }
+
+        if (got) {
+            camera_fb_t *fb = frame.fb;
+
+            // ---> ĐÃ THÊM: Lọc ảnh lỗi (< 2KB) để tránh crash JPEG decoder
+            if (fb->len < 2048) {
+                ESP_LOGW(TAG, "Frame corrupted (%d bytes), skipping...", fb->len);
+                camera_frame_return(&frame);
+                vTaskDelay(pdMS_TO_TICKS(50));
+                continue;
+            }
+
+            // Chỉ giải nén vùng lối vào (ROI); cỡ ảnh vào detector suy ra từ cỡ vùng, tối đa khung AI
+            face_roi_cfg_t roi_cfg;
+            face_roi_get(&roi_cfg);
+            camera_rect_t roi;
+            face_roi_rect(&roi_cfg, fb->width, fb->height, &roi);
+
+            PERF_TRACE_BEGIN(t_decode);
+            int img_w = 0, img_h = 0, shift = 0;
+            bool decoded = camera_decode_rgb888_roi(fb, &roi, rgb_buf, rgb_buf_len, &img_w, &img_h, &shift);
+            PERF_TRACE_END(t_decode, "decode");
+
+            if (decoded) {
+                dl::image::img_t img;
+                img.data = rgb_buf;
+                img.width = img_w; img.height = img_h;
+                img.pix_type = dl::image::DL_IMAGE_PIX_TYPE_RGB888;
+
+                xSemaphoreTake(s_feat_mutex, portMAX_DELAY);
+                PERF_TRACE_BEGIN(t_detect);
+                std::list<dl::detect::result_t> faces = detector->run(img);
+                PERF_TRACE_END(t_detect, "detect");
+                xSemaphoreGive(s_feat_mutex);
+                int64_t detect_us = esp_timer_get_time() - t_detect;
+
+                // Lọc theo cỡ mặt (quy về pixel frame chụp): người xa ngoài hành lang không cần nhận diện
+                int too_small = 0, too_big = 0;
+                for (auto it = faces.begin(); it != faces.end();) {
+                    int check = face_roi_size_check(&roi_cfg, (it->box[2] - it->box[0]) << shift, fb->width);
+                    if (check == 0) { ++it; continue; }
+                    if (check < 0) too_small++; else too_big++;
+                    it = faces.erase(it);
+                }
+                face_roi_report(img_w, img_h, detect_us, faces.size() + too_small + too_big, too_small, too_big);
+                int face_count = faces.size();
+                // Chỉ tính thời gian AI (decode + detect + feature), không tính xử lý kết quả
+                int64_t pipeline_us = esp_timer_get_time() - t_decode;
+
+                bool decided = false;
+                if (face_count > 0) {
+                    face_batch_t batch;
+                    batch.n = 0;
+                    for (auto &face : faces) {
+                        if (batch.n == FACE_BATCH_MAX) { s_batch_dropped++; continue; }
+                        batch.kpt[batch.n] = &face.keypoint;
+                        batch.box[batch.n] = &face.box;
+                        batch.n++;
+                    }
+
+                    xSemaphoreTake(s_feat_mutex, portMAX_DELAY);
+                    pipeline_us += run_batch(&batch, img);
+                    // Có job enroll thì dùng luôn embedding vừa tính, nhận diện vẫn chạy bình thường
+                    enroll_feed(&batch, &frame);
+                    adapt_templates(&batch);
+                    observe_visitors(&batch);
+                    xSemaphoreGive(s_feat_mutex);
+                    handle_visitors(&batch, &frame, img);
+                    decided = handle_recognition(&batch, &frame, img);
+                }
+                // Không mở cửa cũng là 1 quyết định cho frame này
+                if (!decided) camera_record_decision(&frame);
+                // Gallery local đã nạp từ trước khi task chạy -> từ giờ đã có thể mở cửa
+                boot_milestone(BOOT_MS_FIRST_UNLOCK_READY);
+                // Báo cho bộ điều khiển camera: có người hay không + AI tốn bao lâu
+                camera_ctrl_report_frame(face_count, pipeline_us);
+            }
+            camera_frame_return(&frame); 
+        }
+        // Nhịp chạy do camera_ctrl quyết định (IDLE chậm, có người thì nhanh)
+        vTaskDelay(pdMS_TO_TICKS(camera_ctrl_frame_interval_ms())); 
+    }
+    mem_pool_free(rgb_buf);
+}
+
+// BENCHMARK: N mặt giống nhau trên ảnh tổng hợp cỡ khung AI (ctx = N). faces/s = N / mean_us
+static const char *BATCH_BENCH_NAMES[FACE_BATCH_MAX] = {
+    "face_batch_1", "face_batch_2", "face_batch_3", "face_batch_4", "face_batch_5"
+};
+static uint8_t *s_bench_rgb = nullptr;
+// Mặt mẫu nhúng trong firmware (RGB888 80x100), dán vào frame tại BENCH_BOX.
+// Mắt trái, khoé miệng trái, mũi, mắt phải, khoé miệng phải: khớp hình vẽ của tools/make_bench_face.py
+extern const uint8_t bench_face_start[] asm("_binary_bench_face_rgb_start");
+extern const uint8_t bench_face_end[] asm("_binary_bench_face_rgb_end");
+static const std::vector<int> BENCH_KPT = { 145, 105, 148, 145, 160, 125, 175, 105, 172, 145 };
+static const std::vector<int> BENCH_BOX = { 120, 70, 200, 170 };
+
+// Frame tổng hợp cỡ khung AI (nền xám + mặt mẫu), tạo 1 lần, dùng chung cho mọi benchmark model
+static bool _bench_img(dl::image::img_t *img) {
+    if (!s_bench_rgb) {
+        int face_w = BENCH_BOX[2] - BENCH_BOX[0], face_h = BENCH_BOX[3] - BENCH_BOX[1];
+        if (bench_face_end - bench_face_start != face_w * face_h * 3) {
+            ESP_LOGE(TAG, "bench_face.rgb size mismatch");
+            return false;
+        }
+        s_bench_rgb = (uint8_t *)heap_caps_malloc(CAMERA_AI_WIDTH * CAMERA_AI_HEIGHT * 3, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!s_bench_rgb) return false;
+        // Nền dải sáng dọc: có cạnh nhẹ như tường thật nhưng không có gì giống mặt
+        for (int y = 0; y < CAMERA_AI_HEIGHT; y++) {
+            memset(s_bench_rgb + y * CAMERA_AI_WIDTH * 3, 90 + y * 80 / CAMERA_AI_HEIGHT, CAMERA_AI_WIDTH * 3);
+        }
+        for (int y = 0; y < face_h; y++) {
+            memcpy(s_bench_rgb + ((BENCH_BOX[1] + y) * CAMERA_AI_WIDTH + BENCH_BOX[0]) * 3,
+                   bench_face_start + y * face_w * 3, face_w * 3);
+        }
+    }
+    img->data = s_bench_rgb;
+    img->width = CAMERA_AI_WIDTH; img->height = CAMERA_AI_HEIGHT;
+    img->pix_type = dl::image::DL_IMAGE_PIX_TYPE_RGB888;
+    return true;
+}
+
+static void _bench_batch(void *ctx) {
+    dl::image::img_t img;
+    if (!_bench_img(&img)) return;
+
+    face_batch_t batch;
+    batch.n = (int)(intptr_t)ctx;
+    for (int i = 0; i < batch.n; i++) { batch.kpt[i] = &BENCH_KPT; batch.box[i] = &BENCH_BOX; }
+    xSemaphoreTake(s_feat_mutex, portMAX_DELAY);
+    run_batch(&batch, img);
+    xSemaphoreGive(s_feat_mutex);
+}
+
+// BENCHMARK SO KHỚP: 1 mặt với gallery tổng hợp đầy MAX_FACES (không phụ thuộc số người đã enroll)
+static face_record_t *s_bench_db = nullptr;
+
+static void _bench_match(void *ctx) {
+    if (!s_bench_db) {
+        // RAM trong như face_db thật; thiếu thì PSRAM (chậm hơn, số đo sẽ bi quan)
+        s_bench_db = (face_record_t *)heap_caps_malloc(MAX_FACES * sizeof(face_record_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!s_bench_db) s_bench_db = (face_record_t *)heap_caps_malloc(MAX_FACES * sizeof(face_record_t), MALLOC_CAP_SPIRAM);
+        if (!s_bench_db) return;
+        for (int g = 0; g < MAX_FACES; g++) {
+            for (int i = 0; i < FACE_EMBED_DIM; i++) s_bench_db[g].embedding[i] = (float)(((i + 1) * (g + 3) * 37) % 200 - 100);
+            normalize_vector<FACE_EMBED_DIM>(s_bench_db[g].embedding);
+            s_bench_db[g].id = g + 1;
+            s_bench_db[g].valid = true;
+        }
+    }
+    face_batch_t batch;
+    batch.n = 1;
+    batch.ok[0] = true;
+    xSemaphoreTake(s_feat_mutex, portMAX_DELAY);
+    memcpy(s_batch_feat[0], s_bench_db[MAX_FACES / 2].embedding, FACE_EMBED_BYTES);
+    match_gallery(s_bench_db, &batch);
+    xSemaphoreGive(s_feat_mutex);
+}
+
+// Chuẩn hoá tại chỗ: vector đã chuẩn hoá tốn đúng bằng vector thô
+static float *s_bench_vec = nullptr;
+
+static void _bench_normalize(void *ctx) {
+    if (!s_bench_vec) {
+        s_bench_vec = (float *)heap_caps_malloc(FACE_EMBED_BYTES, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!s_bench_vec) return;
+        for (int i = 0; i < FACE_EMBED_DIM; i++) s_bench_vec[i] = (float)((i * 37) % 200 - 100);
+    }
+    normalize_vector<FACE_EMBED_DIM>(s_bench_vec);
+}
+
+// BENCHMARK MODEL: từng model detect / feature trên frame mặt mẫu -> chọn cặp nhanh nhất đủ chính xác.
+// Model đang dùng chạy chung bản của task AI (khoá s_feat_mutex); model khác tạo riêng ở lần chạy đầu.
+typedef struct {
+    const char *name;
+    HumanFaceFeat::model_type_t type;
+    HumanFaceFeat *model;
+} feat_bench_t;
+
+static feat_bench_t s_feat_bench[] = {
+#if !defined(CONFIG_FACE_FEAT_MODEL_MBF) || (CONFIG_FACE_MODEL_BENCH_ALL && CONFIG_FLASH_HUMAN_FACE_FEAT_MFN_S8_V1)
+    { "model_feat_mfn_s8_v1", HumanFaceFeat::MFN_S8_V1, nullptr },
+#endif
+#if defined(CONFIG_FACE_FEAT_MODEL_MBF) || (CONFIG_FACE_MODEL_BENCH_ALL && CONFIG_FLASH_HUMAN_FACE_FEAT_MBF_S8_V1)
+    { "model_feat_mbf_s8_v1", HumanFaceFeat::MBF_S8_V1, nullptr },
+#endif
+};
+
+static void _bench_detect(void *ctx) {
+    dl::image::img_t img;
+    if (!_bench_img(&img)) return;
+    xSemaphoreTake(s_feat_mutex, portMAX_DELAY);
+    detector->run(img);
+    xSemaphoreGive(s_feat_mutex);
+}
+
+static void _bench_feat(void *ctx) {
+    feat_bench_t *b = (feat_bench_t *)ctx;
+    dl::image::img_t img;
+    if (!_bench_img(&img)) return;
+    if (b->type == FACE_FEAT_MODEL_TYPE) {
+        xSemaphoreTake(s_feat_mutex, portMAX_DELAY);
+        feat_extractor->run(img, BENCH_KPT);
+        xSemaphoreGive(s_feat_mutex);
+        return;
+    }
+    if (!b->model) b->model = new HumanFaceFeat(b->type);
+    if (b->model) b->model->run(img, BENCH_KPT);
+}
+
+extern "C" size_t face_batch_stats_json(char *buf, size_t len) {
+    int n = snprintf(buf, len, "{\"model\":\"%s\",\"dim\":%d,\"max\":%d,\"dual_core\":%s,\"dropped\":%lu,\"by_size\":[",
+                     FACE_FEAT_MODEL_NAME, FACE_EMBED_DIM, FACE_BATCH_MAX, s_feat_worker ? "true" : "false",
+                     (unsigned long)s_batch_dropped);
+    if (n <= 0 || (size_t)n >= len) return 0;
+    size_t off = n;
+    for (int i = 0; i < FACE_BATCH_MAX; i++) {
+        const batch_bucket_t *st = &s_batch_stats[i];
+        float fps = st->us ? (float)st->faces * 1e6f / (float)st->us : 0.0f;
+        n = snprintf(buf + off, len - off, "%s{\"faces\":%d,\"frames\":%lu,\"avg_us\":%lu,\"faces_per_s\":%.1f}",
+                     i ? "," : "", i + 1, (unsigned long)st->frames,
+                     (unsigned long)(st->frames ? st->us / st->frames : 0), fps);
+        if (n <= 0 || (size_t)n >= len - off) return 0;
+        off += n;
+    }
+    if (off + 3 > len) return 0;
+    buf[off++] = ']';
+    buf[off++] = '}';
+    buf[off] = '\0';
+    return off;
+}
+
+extern "C" void face_adapt_persist_if_due(bool online) {
+    if (!db_mutex) return;
+    int64_t now = esp_timer_get_time() / 1000;
+    if (s_adapt_nvs_dirty && (s_adapt_last_save_ms == 0 || now - s_adapt_last_save_ms >= FACE_ADAPT_SAVE_MS)) {
+        save_db();
+        s_adapt_stats.saves++;
+    }
+    if (!online || (s_adapt_last_upload_ms != 0 && now - s_adapt_last_upload_ms < FACE_ADAPT_UPLOAD_MS)) return;
+
+    float *emb = nullptr;
+    for (int i = 0; i < MAX_FACES; i++) {
+        // Chép ra ngoài khoá: upload chậm không được chặn nhận diện
+        xSemaphoreTake(db_mutex, portMAX_DELAY);
+        int id = -1;
+        if (face_db[i].valid && s_adapt[i].cloud_dirty) {
+            if (!emb) emb = (float *)mem_pool_alloc(FACE_EMBED_BYTES);
+            if (emb) {
+                memcpy(emb, face_db[i].embedding, FACE_EMBED_BYTES);
+                id = face_db[i].id;
+                s_adapt[i].cloud_dirty = false;
+            }
+        }
+        xSemaphoreGive(db_mutex);
+        if (id < 0) continue;
+
+        s_adapt_last_upload_ms = now;
+        if (supabase_upload_face_adapted(id, emb, FACE_EMBED_DIM) == ESP_OK) {
+            s_adapt_stats.uploads++;
+        } else {
+            // Để lần sau (nếu slot chưa đổi chủ); mạng lỗi thì dừng lượt này
+            s_adapt_stats.upload_fails++;
+            xSemaphoreTake(db_mutex, portMAX_DELAY);
+            if (face_db[i].valid && face_db[i].id == id) s_adapt[i].cloud_dirty = true;
+            xSemaphoreGive(db_mutex);
+            break;
+        }
+    }
+    if (emb) mem_pool_free(emb);
+}
+
+extern "C" size_t face_adapt_stats_json(char *buf, size_t len) {
+    if (!db_mutex) {
+        // Chưa nạp DB: trả null (0 dành cho tràn buf)
+        int n = snprintf(buf, len, "null");
+        return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+    }
+    int n = snprintf(buf, len, "{\"updates\":%lu,\"drift_rejects\":%lu,\"rate_limited\":%lu,\"ambiguous\":%lu,"
+                     "\"saves\":%lu,\"uploads\":%lu,\"upload_fails\":%lu,\"users\":[",
+                     (unsigned long)s_adapt_stats.updates, (unsigned long)s_adapt_stats.drift_rejects,
+                     (unsigned long)s_adapt_stats.rate_limited, (unsigned long)s_adapt_stats.ambiguous,
+                     (unsigned long)s_adapt_stats.saves, (unsigned long)s_adapt_stats.uploads,
+                     (unsigned long)s_adapt_stats.upload_fails);
+    if (n <= 0 || (size_t)n >= len) return 0;
+    size_t off = n;
+    bool first = true;
+    xSemaphoreTake(db_mutex, portMAX_DELAY);
+    for (int i = 0; i < MAX_FACES; i++) {
+        if (!face_db[i].valid) continue;
+        n = snprintf(buf + off, len - off, "%s{\"id\":%d,\"updates\":%lu,\"anchor_sim\":%.3f}",
+                     first ? "" : ",", face_db[i].id, (unsigned long)s_adapt[i].updates,
+                     anchor_sim(i, face_db[i].embedding));
+        if (n <= 0 || (size_t)n >= len - off) { off = 0; break; }
+        off += n;
+        first = false;
+    }
+    xSemaphoreGive(db_mutex);
+    if (off == 0 || off + 3 > len) return 0;
+    buf[off++] = ']';
+    buf[off++] = '}';
+    buf[off] = '\0';
+    return off;
+}
+
+extern "C" esp_err_t init_face_detection(void) {
+    if (!db_mutex) db_mutex = xSemaphoreCreateMutex();
+    if (!s_feat_mutex) s_feat_mutex = xSemaphoreCreateMutex();
+    if (!s_enroll_done) s_enroll_done = xSemaphoreCreateBinary();
+    if (!db_mutex || !s_feat_mutex || !s_enroll_done) {
+        ESP_LOGE(TAG, "AI Init Failed (sync objects)");
+        return ESP_ERR_NO_MEM;
+    }
+    detector = new (std::nothrow) HumanFaceDetect();
+    feat_extractor = new (std::nothrow) HumanFaceFeat(FACE_FEAT_MODEL_TYPE);
+    s_batch_feat = (float (*)[FACE_EMBED_DIM])heap_caps_malloc(FACE_BATCH_MAX * FACE_EMBED_BYTES, MALLOC_CAP_SPIRAM);
+    if (detector && feat_extractor && s_batch_feat) {
+        ESP_LOGI(TAG, "AI Initialized");
+        load_db();
+        face_thumb_init();
+        visitor_cache_init();
+        event_bus_subscribe(BUS_MASK(BUS_EV_ENROLL_REQUEST), enroll_bus_handler, NULL, "local_enroll");
+#if CONFIG_FACE_FEAT_DUAL_CORE
+        // Thiếu RAM cho bản model thứ 2 -> vẫn chạy, chỉ là tuần tự trên core 1
+        feat_extractor2 = new (std::nothrow) HumanFaceFeat(FACE_FEAT_MODEL_TYPE);
+        s_feat_done = xSemaphoreCreateBinary();
+        if (feat_extractor2 && s_feat_done &&
+            xTaskCreatePinnedToCore(feat_worker_task, "face_feat_w", 8192, NULL, 5, &s_feat_worker, 0) == pdPASS) {
+            ESP_LOGI(TAG, "Feature worker on core 0");
+        } else {
+            s_feat_worker = NULL;
+            ESP_LOGW(TAG, "Feature worker unavailable, single core");
+        }
+#endif
+        // Model / khoá s_feat_mutex mỗi vòng: task AI chờ trong lúc đo -> ít vòng (BENCH_MODEL_MAX_ITERS)
+        for (int i = 0; i < FACE_BATCH_MAX; i++) {
+            bench_register_flags(BATCH_BENCH_NAMES[i], _bench_batch, (void *)(intptr_t)(i + 1), BENCH_F_MODEL);
+        }
+        bench_register_flags("model_detect_msrmnp_s8_v1", _bench_detect, NULL, BENCH_F_MODEL);
+        bench_register_flags("face_match", _bench_match, NULL, BENCH_F_MODEL);
+        bench_register("face_normalize", _bench_normalize, NULL);
+        for (size_t i = 0; i < sizeof(s_feat_bench) / sizeof(s_feat_bench[0]); i++) {
+            bench_register_flags(s_feat_bench[i].name, _bench_feat, &s_feat_bench[i], BENCH_F_MODEL);
+        }
+        return ESP_OK;
+    }
+    // Thiếu model / RAM: dọn phần đã cấp, boot_mgr bỏ qua các bước cần AI (nhận diện, sync gallery)
+    ESP_LOGE(TAG, "AI Init Failed");
+    delete detector;
+    delete feat_extractor;
+    heap_caps_free(s_batch_feat);
+    detector = nullptr;
+    feat_extractor = nullptr;
+    s_batch_feat = nullptr;
+    return ESP_ERR_NO_MEM;
+}
+
+extern "C" void start_face_recognition_task(void) {
+    xTaskCreatePinnedToCore(face_recognition_task, "face_ai_task", 10240, NULL, 5, NULL, 1);
+}
+
+extern "C" void set_ai_enable(bool enable) { ai_enabled = enable; }
 extern "C" uint8_t* run_face_detect_and_draw(camera_fb_t *fb, size_t *out_len) { return nullptr; }
\ No newline at end of file
@@ -1,27 +1,63 @@
-#pragma once
-#include "esp_err.h"
-#include "esp_camera.h"
-#include <stdbool.h>
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-// Khởi tạo AI và load dữ liệu khuôn mặt từ Flash (NVS)
-void init_face_detection(void);
-
-// Hàm này cho Web Stream dùng (Chỉ trả về NULL để stream nhẹ hơn)
-uint8_t* run_face_detect_and_draw(camera_fb_t *fb, size_t *out_len);
-
-// Bắt đầu chế độ học khuôn mặt mới
-void start_enrollment(void);
-
-// Hàm khởi động Task AI chạy ngầm 24/7
-void start_face_recognition_task(void);
-
-// Bật/Tắt AI 
-void set_ai_enable(bool enable);
-
-#ifdef __cplusplus
-}
+#pragma once
+#include "esp_err.h"
+#include "esp_camera.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Khởi tạo AI và load dữ liệu khuôn mặt từ Flash (NVS). ESP_ERR_NO_MEM: không tạo được model / buffer
+esp_err_t init_face_detection(void);
+
+// Hàm này cho Web Stream dùng (Chỉ trả về NULL để stream nhẹ hơn)
+uint8_t* run_face_detect_and_draw(camera_fb_t *fb, size_t *out_len);
+
+// ENROLL: gửi việc cho pipeline nhận diện đang chạy, gom embedding của mặt lớn nhất
+// qua FACE_ENROLL_FRAMES frame live (lấy trung bình). Nhận diện người khác không dừng.
+#define FACE_ENROLL_FRAMES      3
+#define FACE_ENROLL_TIMEOUT_MS  10000
+#define FACE_ENROLL_MIN_SIM     0.5f     // Dưới ngưỡng giống frame trước -> coi là người khác, gom lại
+
+// Chặn người gọi tới khi xong hoặc hết giờ. embedding: FACE_EMBED_DIM float (đã chuẩn hoá khi trả về).
+// photo != NULL: nhận bản copy JPEG của frame dùng để enroll (heap_caps_free(photo->buf)).
+// ESP_ERR_TIMEOUT: không thấy mặt đủ frame. ESP_ERR_INVALID_STATE: đang có job khác.
+esp_err_t face_enroll(uint32_t timeout_ms, float *embedding, camera_fb_t *photo);
+
+// Hàm khởi động Task AI chạy ngầm 24/7
+void start_face_recognition_task(void);
+
+// Bật/Tắt AI 
+void set_ai_enable(bool enable);
+
+// Gallery local cho cloud sync / BLE bulk: thêm hoặc ghi đè mẫu của face_id, mẫu đã học từ cloud, ghi NVS
+void face_api_add_user_from_cloud(int face_id, float *embedding_buffer, int len);
+void face_api_adapted_from_cloud(int face_id, float *embedding_buffer, int len);
+void face_api_save_db(void);
+
+// Số mặt tối đa xử lý chung 1 batch trong 1 frame (thừa thì bỏ qua)
+#define FACE_BATCH_MAX 5
+
+// {"model":"mfn_s8_v1","dim":512,"max":5,"dual_core":..,"dropped":..,"by_size":[{"faces":1,"frames":..,"avg_us":..,"faces_per_s":..},...]}
+size_t face_batch_stats_json(char *buf, size_t len);
+
+// CẬP NHẬT MẪU: khớp rất chắc -> kéo mẫu của người đó về phía embedding mới (EMA).
+// Mẫu không được lệch quá xa mẫu gốc lúc enroll; lưu NVS / cloud theo lịch thưa.
+#define FACE_ADAPT_MIN_SCORE    0.60f    // Chỉ học từ lần khớp vượt ngưỡng này (ngưỡng mở cửa 0.35)
+#define FACE_ADAPT_MARGIN       0.10f    // Hơn người giống thứ 2 ít nhất chừng này
+#define FACE_ADAPT_ALPHA        0.05f    // Trọng số embedding mới trong EMA
+#define FACE_ADAPT_ANCHOR_MIN   0.80f    // cos(mẫu mới, mẫu gốc) tối thiểu, thấp hơn -> bỏ cập nhật
+#define FACE_ADAPT_USER_MS      (60 * 1000)              // Mỗi người tối đa 1 cập nhật / khoảng này
+#define FACE_ADAPT_SAVE_MS      (30 * 60 * 1000)         // Ghi NVS tối đa 1 lần / khoảng này
+#define FACE_ADAPT_UPLOAD_MS    (6 * 60 * 60 * 1000)     // Đẩy mẫu đã học lên cloud tối đa 1 lần / khoảng này
+
+// Gọi định kỳ từ net_supervisor: ghi NVS khi tới hạn; online thì đẩy mẫu đã học lên cloud
+void face_adapt_persist_if_due(bool online);
+
+// {"updates":..,"drift_rejects":..,"rate_limited":..,"ambiguous":..,"saves":..,"uploads":..,"upload_fails":..,
+//  "users":[{"id":..,"updates":..,"anchor_sim":..},...]}
+size_t face_adapt_stats_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
 #endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef FACE_MODEL_H
+#define FACE_MODEL_H
+
+#include "sdkconfig.h"
+
+// MODEL NHẬN DIỆN: chọn trong menuconfig -> "Smart Lock AI"
+#ifdef CONFIG_FACE_EMBED_DIM
+#define FACE_EMBED_DIM         CONFIG_FACE_EMBED_DIM
+#else
+#define FACE_EMBED_DIM         512
+#endif
+#define FACE_EMBED_BYTES       (FACE_EMBED_DIM * sizeof(float))
+
+// Tên model feature, lưu kèm gallery NVS để nhận ra gallery của model khác
+#if defined(CONFIG_FACE_FEAT_MODEL_MBF)
+#define FACE_FEAT_MODEL_NAME   "mbf_s8_v1"
+#else
+#define FACE_FEAT_MODEL_NAME   "mfn_s8_v1"
+#endif
+
+#endif
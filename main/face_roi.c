@@ -0,0 +1,125 @@
+#include "face_roi.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "nvs.h"
+
+static const char *TAG = "FACE_ROI";
+
+#define FACE_ROI_NVS_KEY   "face_roi"
+#define FACE_ROI_MIN_PCT   5          // Vùng nhỏ nhất mỗi chiều (%)
+
+static face_roi_cfg_t s_cfg = { 0, 0, 100, 100, FACE_ROI_DEFAULT_MIN_FACE, FACE_ROI_DEFAULT_MAX_FACE };
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Thống kê detector (ghi từ task AI, đọc từ HTTP)
+typedef struct {
+    int in_w, in_h;
+    uint32_t frames;
+    int64_t last_us;
+    int64_t max_us;
+    int64_t sum_us;
+    uint32_t faces;
+    uint32_t too_small;
+    uint32_t too_big;
+} roi_stats_t;
+
+static roi_stats_t s_stats = { 0 };
+
+static bool _valid(const face_roi_cfg_t *c) {
+    return c->w >= FACE_ROI_MIN_PCT && c->h >= FACE_ROI_MIN_PCT &&
+           c->x + c->w <= 100 && c->y + c->h <= 100 &&
+           c->max_face <= 100 && c->min_face < c->max_face;
+}
+
+void face_roi_init(void) {
+    nvs_handle_t h;
+    if (nvs_open("nvs", NVS_READONLY, &h) == ESP_OK) {
+        face_roi_cfg_t c;
+        size_t len = sizeof(c);
+        if (nvs_get_blob(h, FACE_ROI_NVS_KEY, &c, &len) == ESP_OK && len == sizeof(c) && _valid(&c)) s_cfg = c;
+        nvs_close(h);
+    }
+    ESP_LOGI(TAG, "ROI %u,%u %ux%u%%, face %u-%u%%", s_cfg.x, s_cfg.y, s_cfg.w, s_cfg.h, s_cfg.min_face, s_cfg.max_face);
+}
+
+void face_roi_get(face_roi_cfg_t *out) {
+    taskENTER_CRITICAL(&s_lock);
+    *out = s_cfg;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t face_roi_set(const face_roi_cfg_t *cfg) {
+    if (!_valid(cfg)) return ESP_ERR_INVALID_ARG;
+    nvs_handle_t h;
+    esp_err_t err = nvs_open("nvs", NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+    err = nvs_set_blob(h, FACE_ROI_NVS_KEY, cfg, sizeof(*cfg));
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    if (err != ESP_OK) return err;
+
+    taskENTER_CRITICAL(&s_lock);
+    s_cfg = *cfg;
+    s_stats.frames = 0;
+    s_stats.sum_us = 0;
+    s_stats.max_us = 0;
+    taskEXIT_CRITICAL(&s_lock);
+    ESP_LOGI(TAG, "ROI set %u,%u %ux%u%%, face %u-%u%%", cfg->x, cfg->y, cfg->w, cfg->h, cfg->min_face, cfg->max_face);
+    return ESP_OK;
+}
+
+void face_roi_rect(const face_roi_cfg_t *cfg, int frame_w, int frame_h, camera_rect_t *out) {
+    out->x = frame_w * cfg->x / 100;
+    out->y = frame_h * cfg->y / 100;
+    out->w = frame_w * cfg->w / 100;
+    out->h = frame_h * cfg->h / 100;
+    if (out->w < 8) out->w = 8;
+    if (out->h < 8) out->h = 8;
+    if (out->x + out->w > frame_w) out->x = frame_w - out->w;
+    if (out->y + out->h > frame_h) out->y = frame_h - out->h;
+    if (out->x < 0) { out->x = 0; out->w = frame_w; }
+    if (out->y < 0) { out->y = 0; out->h = frame_h; }
+}
+
+int face_roi_size_check(const face_roi_cfg_t *cfg, int face_w, int frame_w) {
+    if (frame_w <= 0) return 0;
+    // So sánh nhân chéo, không chia -> không làm tròn mất mặt ở biên
+    if (face_w * 100 < cfg->min_face * frame_w) return -1;
+    if (face_w * 100 > cfg->max_face * frame_w) return 1;
+    return 0;
+}
+
+void face_roi_report(int in_w, int in_h, int64_t detect_us, int faces, int too_small, int too_big) {
+    taskENTER_CRITICAL(&s_lock);
+    s_stats.in_w = in_w;
+    s_stats.in_h = in_h;
+    s_stats.frames++;
+    s_stats.last_us = detect_us;
+    s_stats.sum_us += detect_us;
+    if (detect_us > s_stats.max_us) s_stats.max_us = detect_us;
+    s_stats.faces += faces;
+    s_stats.too_small += too_small;
+    s_stats.too_big += too_big;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+size_t face_roi_json(char *buf, size_t len) {
+    face_roi_cfg_t c;
+    roi_stats_t st;
+    taskENTER_CRITICAL(&s_lock);
+    c = s_cfg;
+    st = s_stats;
+    taskEXIT_CRITICAL(&s_lock);
+
+    int n = snprintf(buf, len,
+                     "{\"cfg\":{\"x\":%u,\"y\":%u,\"w\":%u,\"h\":%u,\"min_face\":%u,\"max_face\":%u},"
+                     "\"input\":{\"w\":%d,\"h\":%d},\"frames\":%lu,"
+                     "\"detect_us\":{\"last\":%lld,\"avg\":%lld,\"max\":%lld},"
+                     "\"faces\":{\"seen\":%lu,\"too_small\":%lu,\"too_big\":%lu}}",
+                     c.x, c.y, c.w, c.h, c.min_face, c.max_face, st.in_w, st.in_h, (unsigned long)st.frames,
+                     st.last_us, st.frames ? st.sum_us / st.frames : 0, st.max_us,
+                     (unsigned long)st.faces, (unsigned long)st.too_small, (unsigned long)st.too_big);
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
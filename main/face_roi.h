@@ -0,0 +1,49 @@
+#ifndef FACE_ROI_H
+#define FACE_ROI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "camera_init.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// CẤU HÌNH VÙNG NHẬN DIỆN (lưu NVS, theo từng khoá)
+// Vùng tính theo % khung hình chụp -> không đổi khi camera chuyển QVGA/VGA.
+// Kích thước mặt = bề rộng khung mặt theo % bề rộng khung hình.
+typedef struct {
+    uint8_t x, y, w, h;          // Vùng lối vào cửa (mặc định cả khung: 0,0,100,100)
+    uint8_t min_face;            // Mặt nhỏ hơn (người ở xa, hành lang) -> bỏ qua
+    uint8_t max_face;            // Mặt lớn hơn (quá sát / nhận nhầm) -> bỏ qua
+} face_roi_cfg_t;
+
+#define FACE_ROI_DEFAULT_MIN_FACE   0
+#define FACE_ROI_DEFAULT_MAX_FACE   100
+
+// Nạp cấu hình từ NVS (gọi sau nvs_flash_init)
+void face_roi_init(void);
+
+void face_roi_get(face_roi_cfg_t *out);
+// Kiểm tra hợp lệ rồi lưu NVS. ESP_ERR_INVALID_ARG nếu vùng/kích thước sai.
+esp_err_t face_roi_set(const face_roi_cfg_t *cfg);
+
+// Đổi vùng % -> pixel cho frame w x h (luôn nằm trong frame, w/h >= 8)
+void face_roi_rect(const face_roi_cfg_t *cfg, int frame_w, int frame_h, camera_rect_t *out);
+
+// face_w: bề rộng mặt theo pixel của frame chụp. < 0 quá nhỏ, > 0 quá lớn, 0 hợp lệ
+int face_roi_size_check(const face_roi_cfg_t *cfg, int face_w, int frame_w);
+
+// AI báo mỗi frame: cỡ ảnh vào detector, thời gian detect, số mặt tìm thấy / bị lọc theo cỡ
+void face_roi_report(int in_w, int in_h, int64_t detect_us, int faces, int too_small, int too_big);
+
+// {"cfg":{...},"input":{"w":..,"h":..},"detect_us":{"last":..,"avg":..,"max":..},"faces":{...}}
+size_t face_roi_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,203 @@
+#include "face_thumb.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "img_converters.h"
+#include "camera_init.h"
+#include "perf_monitor.h"
+#include "bench.h"
+
+static const char *TAG = "FACE_THUMB";
+
+typedef struct {
+    uint8_t *rgb;           // FACE_THUMB_SIZE^2 * 3
+    uint8_t *jpg;           // FACE_THUMB_JPG_MAX
+    size_t jpg_len;
+} thumb_work_t;
+
+static thumb_work_t s_work;
+static SemaphoreHandle_t s_work_mutex = NULL;
+static int64_t s_last_full_ms = 0;
+
+static struct {
+    uint32_t thumbs;
+    uint32_t fails;
+    uint64_t bytes;
+    uint64_t ref_bytes;
+    uint32_t last_bytes;
+    uint32_t last_us;
+} s_stats;
+
+static bool _work_alloc(thumb_work_t *w) {
+    w->rgb = (uint8_t *)heap_caps_malloc(FACE_THUMB_SIZE * FACE_THUMB_SIZE * 3, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    w->jpg = (uint8_t *)heap_caps_malloc(FACE_THUMB_JPG_MAX, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    w->jpg_len = 0;
+    return w->rgb && w->jpg;
+}
+
+// Khung vuông quanh mặt, nới lề, kẹp trong ảnh
+static bool _crop_rect(int w, int h, face_box_t b, int *cx, int *cy, int *side) {
+    int bw = b.x2 - b.x1, bh = b.y2 - b.y1;
+    if (bw <= 0 || bh <= 0) return false;
+    int s = (bw > bh ? bw : bh);
+    s += s * 2 * FACE_THUMB_MARGIN_PCT / 100;
+    if (s > w) s = w;
+    if (s > h) s = h;
+    int x = (b.x1 + b.x2) / 2 - s / 2;
+    int y = (b.y1 + b.y2) / 2 - s / 2;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x + s > w) x = w - s;
+    if (y + s > h) y = h - s;
+    *cx = x; *cy = y; *side = s;
+    return s >= 8;
+}
+
+// Thu nhỏ song tuyến tính (fixed-point 16.16) vùng side x side -> FACE_THUMB_SIZE^2
+static void _scale(const uint8_t *rgb, int w, int x0, int y0, int side, uint8_t *out) {
+    const int n = FACE_THUMB_SIZE;
+    uint32_t step = ((uint32_t)(side - 1) << 16) / (n > 1 ? n - 1 : 1);
+    for (int oy = 0; oy < n; oy++) {
+        uint32_t fy = oy * step;
+        int sy = y0 + (fy >> 16);
+        uint32_t wy = (fy >> 8) & 0xFF;
+        int sy1 = (sy + 1 < y0 + side) ? sy + 1 : sy;
+        const uint8_t *r0 = rgb + (size_t)sy * w * 3;
+        const uint8_t *r1 = rgb + (size_t)sy1 * w * 3;
+        for (int ox = 0; ox < n; ox++) {
+            uint32_t fx = ox * step;
+            int sx = x0 + (fx >> 16);
+            uint32_t wx = (fx >> 8) & 0xFF;
+            int sx1 = (sx + 1 < x0 + side) ? sx + 1 : sx;
+            for (int c = 0; c < 3; c++) {
+                uint32_t top = r0[sx * 3 + c] * (256 - wx) + r0[sx1 * 3 + c] * wx;
+                uint32_t bot = r1[sx * 3 + c] * (256 - wx) + r1[sx1 * 3 + c] * wx;
+                *out++ = (uint8_t)((top * (256 - wy) + bot * wy) >> 16);
+            }
+        }
+    }
+}
+
+static size_t _jpg_out(void *arg, size_t index, const void *data, size_t len) {
+    thumb_work_t *w = (thumb_work_t *)arg;
+    if (!data) return 0;
+    if (index + len > FACE_THUMB_JPG_MAX) return 0;   // Quá cỡ -> fmt2jpg_cb báo lỗi
+    memcpy(w->jpg + index, data, len);
+    w->jpg_len = index + len;
+    return len;
+}
+
+static bool _encode(thumb_work_t *work, const uint8_t *rgb, int w, int h, face_box_t box) {
+    int x, y, side;
+    if (!_crop_rect(w, h, box, &x, &y, &side)) return false;
+    _scale(rgb, w, x, y, side, work->rgb);
+    work->jpg_len = 0;
+    return fmt2jpg_cb(work->rgb, FACE_THUMB_SIZE * FACE_THUMB_SIZE * 3, FACE_THUMB_SIZE, FACE_THUMB_SIZE,
+                      PIXFORMAT_RGB888, FACE_THUMB_QUALITY, _jpg_out, work);
+}
+
+bool face_thumb_encode(const uint8_t *rgb, int w, int h, face_box_t box, size_t ref_len,
+                       uint8_t **out_jpg, size_t *out_len) {
+    if (!s_work_mutex || !rgb) return false;
+    xSemaphoreTake(s_work_mutex, portMAX_DELAY);
+    PERF_TRACE_BEGIN(t_thumb);
+    bool ok = _encode(&s_work, rgb, w, h, box);
+    uint8_t *jpg = NULL;
+    if (ok) {
+        // Chỉ giữ đúng số byte JPEG trong outbox
+        jpg = (uint8_t *)heap_caps_malloc(s_work.jpg_len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (jpg) memcpy(jpg, s_work.jpg, s_work.jpg_len);
+        ok = jpg != NULL;
+    }
+    size_t len = s_work.jpg_len;
+    PERF_TRACE_END(t_thumb, "face_thumb");
+    xSemaphoreGive(s_work_mutex);
+
+    if (!ok) { s_stats.fails++; return false; }
+    s_stats.thumbs++;
+    s_stats.bytes += len;
+    s_stats.ref_bytes += ref_len;
+    s_stats.last_bytes = len;
+    s_stats.last_us = (uint32_t)(esp_timer_get_time() - t_thumb);
+    ESP_LOGI(TAG, "Thumb %u B (frame %u B), %lu us", (unsigned)len, (unsigned)ref_len, (unsigned long)s_stats.last_us);
+    *out_jpg = jpg;
+    *out_len = len;
+    return true;
+}
+
+bool face_thumb_want_full_frame(void) {
+    if (FACE_FULL_FRAME_EVERY_MS == 0) return false;
+    int64_t now = esp_timer_get_time() / 1000;
+    if (s_last_full_ms != 0 && now - s_last_full_ms < FACE_FULL_FRAME_EVERY_MS) return false;
+    s_last_full_ms = now;
+    return true;
+}
+
+// BENCHMARK: ảnh tổng hợp cỡ khung AI, mặt ở giữa. Số byte thumbnail / cả khung xem ở stats.
+typedef struct {
+    uint8_t *rgb;
+    thumb_work_t work;
+    size_t thumb_bytes;     // Kết quả vòng gần nhất, xuất trong stats
+    size_t frame_bytes;
+} thumb_bench_t;
+
+static thumb_bench_t s_bench;
+
+static bool _bench_prepare(void) {
+    if (s_bench.rgb) return true;
+    s_bench.rgb = (uint8_t *)heap_caps_malloc(CAMERA_AI_WIDTH * CAMERA_AI_HEIGHT * 3, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_bench.rgb || !_work_alloc(&s_bench.work)) return false;
+    for (int y = 0; y < CAMERA_AI_HEIGHT; y++) {
+        for (int x = 0; x < CAMERA_AI_WIDTH; x++) {
+            uint8_t *p = s_bench.rgb + ((size_t)y * CAMERA_AI_WIDTH + x) * 3;
+            p[0] = (uint8_t)(x * 255 / CAMERA_AI_WIDTH);
+            p[1] = (uint8_t)(y * 255 / CAMERA_AI_HEIGHT);
+            p[2] = (uint8_t)((x ^ y) & 0xFF);
+        }
+    }
+    return true;
+}
+
+static void _bench_thumb(void *ctx) {
+    if (!_bench_prepare()) return;
+    face_box_t box = { 120, 70, 200, 170 };
+    if (_encode(&s_bench.work, s_bench.rgb, CAMERA_AI_WIDTH, CAMERA_AI_HEIGHT, box)) s_bench.thumb_bytes = s_bench.work.jpg_len;
+}
+
+static size_t _bench_count_out(void *arg, size_t index, const void *data, size_t len) {
+    if (data) *(size_t *)arg = index + len;
+    return len;
+}
+
+// Mốc so sánh: nén lại cả khung AI cùng chất lượng
+static void _bench_frame(void *ctx) {
+    if (!_bench_prepare()) return;
+    size_t n = 0;
+    fmt2jpg_cb(s_bench.rgb, CAMERA_AI_WIDTH * CAMERA_AI_HEIGHT * 3, CAMERA_AI_WIDTH, CAMERA_AI_HEIGHT,
+               PIXFORMAT_RGB888, FACE_THUMB_QUALITY, _bench_count_out, &n);
+    s_bench.frame_bytes = n;
+}
+
+size_t face_thumb_stats_json(char *buf, size_t len) {
+    uint64_t saved = s_stats.ref_bytes > s_stats.bytes ? s_stats.ref_bytes - s_stats.bytes : 0;
+    int n = snprintf(buf, len,
+                     "{\"thumbs\":%lu,\"bytes\":%llu,\"ref_bytes\":%llu,\"saved_bytes\":%llu,"
+                     "\"last_bytes\":%lu,\"last_us\":%lu,\"fails\":%lu,\"bench\":{\"thumb_bytes\":%u,\"frame_bytes\":%u}}",
+                     (unsigned long)s_stats.thumbs, (unsigned long long)s_stats.bytes,
+                     (unsigned long long)s_stats.ref_bytes, (unsigned long long)saved,
+                     (unsigned long)s_stats.last_bytes, (unsigned long)s_stats.last_us, (unsigned long)s_stats.fails,
+                     (unsigned)s_bench.thumb_bytes, (unsigned)s_bench.frame_bytes);
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
+
+void face_thumb_init(void) {
+    if (s_work_mutex) return;
+    if (!_work_alloc(&s_work)) { ESP_LOGE(TAG, "Alloc Fail"); return; }
+    s_work_mutex = xSemaphoreCreateMutex();
+    bench_register("face_thumb", _bench_thumb, NULL);
+    bench_register("face_thumb_frame", _bench_frame, NULL);
+}
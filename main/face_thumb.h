@@ -0,0 +1,44 @@
+#ifndef FACE_THUMB_H
+#define FACE_THUMB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Ảnh bằng chứng cho access log: cắt vùng mặt từ ảnh RGB của AI, thu nhỏ, nén JPEG lại.
+// Nhỏ hơn nhiều so với cả frame QVGA/VGA -> upload nhanh, tốn ít PSRAM trong outbox.
+#define FACE_THUMB_SIZE           96        // Cạnh ảnh vuông sau khi thu nhỏ (px)
+#define FACE_THUMB_QUALITY        70        // Chất lượng fmt2jpg (1..100, cao = đẹp/nặng)
+#define FACE_THUMB_MARGIN_PCT     30        // Nới khung mặt mỗi phía (% cạnh khung)
+#define FACE_THUMB_JPG_MAX        (16 * 1024)
+// Gửi kèm cả frame gốc tối đa 1 lần mỗi chu kỳ này (ms). 0 = không bao giờ.
+#define FACE_FULL_FRAME_EVERY_MS  (10 * 60 * 1000)
+
+// Khung mặt theo toạ độ ảnh RGB (x2, y2 không bao gồm)
+typedef struct {
+    int x1, y1, x2, y2;
+} face_box_t;
+
+// Cấp buffer làm việc + đăng ký benchmark
+void face_thumb_init(void);
+
+// rgb: ảnh RGB888 (thứ tự byte như fmt2rgb888) w x h.
+// Thành công: *out_jpg cấp trong PSRAM (heap_caps_free), ref_len = cỡ frame gốc để thống kê byte tiết kiệm.
+bool face_thumb_encode(const uint8_t *rgb, int w, int h, face_box_t box, size_t ref_len,
+                       uint8_t **out_jpg, size_t *out_len);
+
+// true nếu đã tới lượt gửi kèm frame gốc (tự đánh dấu lượt)
+bool face_thumb_want_full_frame(void);
+
+// {"thumbs":..,"bytes":..,"ref_bytes":..,"saved_bytes":..,"last_bytes":..,"last_us":..,"fails":..,"bench":{..}}
+size_t face_thumb_stats_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,9 +0,0 @@
-#ifndef GLOBAL_STATE_H
-#define GLOBAL_STATE_H
-
-#include <stdbool.h>
-
-// Biến cờ báo hiệu hệ thống đang bận đăng ký
-extern volatile bool g_is_enrolling; 
-
-#endif
\ No newline at end of file
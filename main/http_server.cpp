@@ -1,219 +1,954 @@
-#include "http_server.h"
-#include "camera_init.h"
-#include "esp_http_server.h"
-#include "esp_log.h"
-#include "esp_camera.h"
-#include "face_detect.h"
-#include "lock_ctrl.h"
-#include "freertos/semphr.h"
-
-extern "C" {
-    #include "supabase_client.h" 
-}
-
-static const char *TAG = "HTTP";
-static httpd_handle_t server = NULL;
-
-// Biến Mutex toàn cục
-extern SemaphoreHandle_t xCameraMutex;
-
-static const char* INDEX_HTML = R"rawliteral(
-<!DOCTYPE html>
-<html lang="en">
-<head><meta charset="UTF-8"><meta name="viewport" content="width=device-width,initial-scale=1">
-<title>S3 Smart Lock</title>
-<style>
-body{background:#1a1a2e;color:#fff;font-family:sans-serif;text-align:center;margin:0;padding:20px}
-img{max-width:100%;border:2px solid #e94560;border-radius:8px}
-button{padding:15px 30px;margin:10px;border:none;border-radius:50px;cursor:pointer;color:#fff;font-size:16px;font-weight:bold;transition:0.3s}
-.b1{background:#0f3460}.b1:hover{background:#16213e}
-.b2{background:#e94560}.b2:hover{background:#c02739}
-.b3{background:#00b894}.b3:hover{background:#008c72}
-.ctrl{margin-top:20px;background:#16213e;padding:15px;border-radius:10px;display:inline-block}
-input{margin:5px} label{font-weight:bold}
-</style></head>
-<body>
-<h1>🔐 AI Smart Lock System</h1>
-<img id="stream" src=""><br>
-<div class="ctrl">
-  <button class="b1" onclick="t()">📺 Stream ON/OFF</button>
-  <button class="b2" onclick="e()">👤 Enroll New Face</button>
-  <button class="b3" onclick="o()">🔓 Open Door</button>
-</div><br>
-<div class="ctrl">
-  <label>Brightness (-2 to 2):</label> <input type="range" min="-2" max="2" value="0" onchange="c('brightness',this.value)"><br>
-  <label>Quality (10-63):</label> <input type="range" min="10" max="63" value="12" onchange="c('quality',this.value)">
-</div>
-<script>
-var s=false,u=location.origin+"/stream",i=document.getElementById("stream");
-function t(){if(!s){i.src=u;s=true}else{i.src="";s=false}}
-function e(){if(confirm("Enroll Mode: Look at camera!"))fetch("/enroll").then(r=>alert("Enroll Started..."))}
-function o(){fetch("/open").then(r=>alert("Door command sent!"))}
-function c(v,val){fetch("/control?var="+v+"&val="+val);} 
-window.onload=t;
-</script></body></html>
-)rawliteral";
-
-static esp_err_t cmd_handler(httpd_req_t *req) {
-    char* buf;
-    size_t buf_len;
-    char variable[32] = {0,};
-    char value[32] = {0,};
-
-    buf_len = httpd_req_get_url_query_len(req) + 1;
-    if (buf_len > 1) {
-        buf = (char*)malloc(buf_len);
-        if (!buf) {
-            httpd_resp_send_500(req);
-            return ESP_FAIL;
-        }
-        if (httpd_req_get_url_query_str(req, buf, buf_len) == ESP_OK) {
-            if (httpd_query_key_value(buf, "var", variable, sizeof(variable)) == ESP_OK &&
-                httpd_query_key_value(buf, "val", value, sizeof(value)) == ESP_OK) {
-            } else {
-                free(buf);
-                httpd_resp_send_404(req);
-                return ESP_FAIL;
-            }
-        }
-        free(buf);
-    } else {
-        httpd_resp_send_404(req);
-        return ESP_FAIL;
-    }
-
-    int val = atoi(value);
-    sensor_t *s = esp_camera_sensor_get();
-    int res = 0;
-
-    if (!strcmp(variable, "framesize")) {
-        if (s->pixformat == PIXFORMAT_JPEG) res = s->set_framesize(s, (framesize_t)val);
-    }
-    else if (!strcmp(variable, "quality")) res = s->set_quality(s, val);
-    else if (!strcmp(variable, "contrast")) res = s->set_contrast(s, val);
-    else if (!strcmp(variable, "brightness")) res = s->set_brightness(s, val);
-    else if (!strcmp(variable, "saturation")) res = s->set_saturation(s, val);
-    
-    if (res) {
-        return httpd_resp_send_500(req);
-    }
-
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    return httpd_resp_send(req, NULL, 0);
-}
-
-static esp_err_t index_handler(httpd_req_t *req) {
-    httpd_resp_set_type(req, "text/html");
-    return httpd_resp_send(req, INDEX_HTML, HTTPD_RESP_USE_STRLEN);
-}
-
-static esp_err_t enroll_handler(httpd_req_t *req) {
-    start_enrollment(); 
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_send(req, "OK", 2);
-    return ESP_OK;
-}
-
-static esp_err_t open_handler(httpd_req_t *req) {
-    lock_open_door(); 
-    supabase_log_access(-1, 1.0f, NULL); 
-    httpd_resp_send(req, "Door Opened", HTTPD_RESP_USE_STRLEN);
-    return ESP_OK;
-}
-
-// STREAM HANDLER
-#define PART_BOUNDARY "123456789000000000000987654321"
-static const char* _STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=" PART_BOUNDARY;
-static const char* _STREAM_BOUNDARY = "\r\n--" PART_BOUNDARY "\r\n";
-static const char* _STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
-
-static esp_err_t stream_handler(httpd_req_t *req) {
-    camera_fb_t *fb = NULL;
-    esp_err_t res = ESP_OK;
-    char part_buf[64];
-
-    res = httpd_resp_set_type(req, _STREAM_CONTENT_TYPE);
-    if (res != ESP_OK) return res;
-
-    while (true) {
-        // Logic Mutex: Xin khóa trong 20ms
-        if (xSemaphoreTake(xCameraMutex, pdMS_TO_TICKS(20)) == pdTRUE) {
-            
-            fb = esp_camera_fb_get(); // Đã có khóa, lấy ảnh
-            
-            if (!fb) {
-                ESP_LOGE(TAG, "Camera capture failed");
-                xSemaphoreGive(xCameraMutex); // Trả khóa ngay
-                res = ESP_FAIL;
-            } else {
-                // Gửi Boundary
-                if (res == ESP_OK) res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, strlen(_STREAM_BOUNDARY));
-                // Gửi Header
-                if (res == ESP_OK) {
-                    size_t hlen = snprintf(part_buf, 64, _STREAM_PART, fb->len);
-                    res = httpd_resp_send_chunk(req, part_buf, hlen);
-                }
-                // Gửi Ảnh
-                if (res == ESP_OK) res = httpd_resp_send_chunk(req, (const char *)fb->buf, fb->len);
-
-                // Dùng xong trả ảnh & trả khóa
-                esp_camera_fb_return(fb);
-                xSemaphoreGive(xCameraMutex); 
-            }
-        } else {
-            // Không lấy được khóa 
-            vTaskDelay(pdMS_TO_TICKS(10));
-            continue;
-        }
-
-        if (res != ESP_OK) break;
-    }
-    return res;
-}
-
-extern "C" esp_err_t start_http_server(void) {
-    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.server_port = 80;
-    config.stack_size = 8192;
-
-    if (httpd_start(&server, &config) == ESP_OK) {
-        // Khai báo đầy đủ các trường
-        httpd_uri_t index_uri = {
-            .uri = "/", .method = HTTP_GET, .handler = index_handler, .user_ctx = NULL,
-            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
-        };
-        httpd_register_uri_handler(server, &index_uri);
-        
-        httpd_uri_t enroll_uri = {
-            .uri = "/enroll", .method = HTTP_GET, .handler = enroll_handler, .user_ctx = NULL,
-            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
-        };
-        httpd_register_uri_handler(server, &enroll_uri);
-
-        httpd_uri_t open_uri = {
-            .uri = "/open", .method = HTTP_GET, .handler = open_handler, .user_ctx = NULL,
-            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
-        };
-        httpd_register_uri_handler(server, &open_uri);
-        
-        httpd_uri_t stream_uri = {
-            .uri = "/stream", .method = HTTP_GET, .handler = stream_handler, .user_ctx = NULL,
-            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
-        };
-        httpd_register_uri_handler(server, &stream_uri);
-
-        httpd_uri_t cmd_uri = {
-            .uri = "/control", .method = HTTP_GET, .handler = cmd_handler, .user_ctx = NULL,
-            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
-        };
-        httpd_register_uri_handler(server, &cmd_uri);
-
-        return ESP_OK;
-    }
-    return ESP_FAIL;
-}
-
-extern "C" void stop_http_server(void) { if (server) httpd_stop(server); }
-extern "C" void ws_send_message(char *msg) { 
-    ESP_LOGI(TAG, "WS Msg: %s", msg); 
+#include "http_server.h"
+#include "camera_init.h"
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "esp_camera.h"
+#include "face_detect.h"
+#include "event_bus.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "lwip/sockets.h"
+#include "perf_monitor.h"
+#include "mem_pool.h"
+#include "camera_ctrl.h"
+#include "boot_mgr.h"
+#include "net_supervisor.h"
+#include "lan_auth.h"
+#include "bench.h"
+#include "face_thumb.h"
+#include "event_store.h"
+#include "access_stats.h"
+#include "face_roi.h"
+#include "visitor_cache.h"
+#include "ws_queue.h"
+#include "cJSON.h"
+
+extern "C" {
+    #include "supabase_client.h" 
+}
+
+static const char *TAG = "HTTP";
+static httpd_handle_t server = NULL;
+
+// Biến Mutex toàn cục
+extern SemaphoreHandle_t xCameraMutex;
+
+static const char* INDEX_HTML = R"rawliteral(
+<!DOCTYPE html>
+<html lang="en">
+<head><meta charset="UTF-8"><meta name="viewport" content="width=device-width,initial-scale=1">
+<title>S3 Smart Lock</title>
+<style>
+body{background:#1a1a2e;color:#fff;font-family:sans-serif;text-align:center;margin:0;padding:20px}
+img{max-width:100%;border:2px solid #e94560;border-radius:8px}
+button{padding:15px 30px;margin:10px;border:none;border-radius:50px;cursor:pointer;color:#fff;font-size:16px;font-weight:bold;transition:0.3s}
+.b1{background:#0f3460}.b1:hover{background:#16213e}
+.b2{background:#e94560}.b2:hover{background:#c02739}
+.ctrl{margin-top:20px;background:#16213e;padding:15px;border-radius:10px;display:inline-block}
+input{margin:5px} label{font-weight:bold}
+</style></head>
+<body>
+<h1>🔐 AI Smart Lock System</h1>
+<div id="st">⚪ Connecting...</div>
+<img id="stream" src=""><br>
+<div class="ctrl">
+  <button class="b1" onclick="t()">📺 Stream ON/OFF</button>
+  <button class="b2" onclick="e()">👤 Enroll New Face</button>
+</div><br>
+<div class="ctrl">
+  <label>Brightness (-2 to 2):</label> <input type="range" min="-2" max="2" value="0" onchange="c('brightness',this.value)"><br>
+  <label>Quality (10-63):</label> <input type="range" min="10" max="63" value="12" onchange="c('quality',this.value)">
+</div><br>
+<div class="ctrl" id="ev" style="text-align:left;font-size:13px;min-width:300px"></div>
+<script>
+var s=false,u=location.origin+"/stream",i=document.getElementById("stream");
+function t(){if(!s){i.src=u;s=true}else{i.src="";s=false}}
+function e(){if(confirm("Enroll Mode: Look at camera!"))fetch("/enroll").then(r=>alert("Enroll Started..."))}
+function c(v,val){fetch("/control?var="+v+"&val="+val);} 
+function l(m){var d=document.getElementById("ev");d.innerHTML=new Date().toLocaleTimeString()+" "+m+"<br>"+d.innerHTML.split("<br>").slice(0,9).join("<br>")}
+function w(){var k=new WebSocket("ws://"+location.host+"/ws"),st=document.getElementById("st");
+k.onmessage=function(m){var j=JSON.parse(m.data);
+if(j.type=="lock")st.innerHTML=j.state=="open"?"🟢 Door OPEN":"🔴 Door LOCKED";
+else if(j.type=="face")l("👤 Match ID "+j.id+" ("+j.score.toFixed(2)+")");
+else if(j.type=="enroll")l("📝 Enroll "+j.state+(j.id?" ID "+j.id:""));
+else if(j.type=="alert")l("⚠️ "+j.msg);
+else if(j.type=="camera")l("📷 Camera "+j.mode);
+else if(j.type=="net")l("📶 Network "+j.state);
+else if(j.type=="metrics")document.title="S3 Smart Lock | heap "+(j.heap/1024|0)+"K";};
+k.onclose=function(){st.innerHTML="⚪ Reconnecting...";setTimeout(w,2000)};}
+window.onload=function(){t();w()};
+</script></body></html>
+)rawliteral";
+
+static esp_err_t cmd_handler(httpd_req_t *req) {
+    char* buf;
+    size_t buf_len;
+    char variable[32] = {0,};
+    char value[32] = {0,};
+
+    buf_len = httpd_req_get_url_query_len(req) + 1;
+    if (buf_len > 1) {
+        buf = (char*)malloc(buf_len);
+        if (!buf) {
+            httpd_resp_send_500(req);
+            return ESP_FAIL;
+        }
+        if (httpd_req_get_url_query_str(req, buf, buf_len) == ESP_OK) {
+            if (httpd_query_key_value(buf, "var", variable, sizeof(variable)) == ESP_OK &&
+                httpd_query_key_value(buf, "val", value, sizeof(value)) == ESP_OK) {
+            } else {
+                free(buf);
+                httpd_resp_send_404(req);
+                return ESP_FAIL;
+            }
+        }
+        free(buf);
+    } else {
+        httpd_resp_send_404(req);
+        return ESP_FAIL;
+    }
+
+    int val = atoi(value);
+    sensor_t *s = esp_camera_sensor_get();
+    int res = 0;
+
+    // framesize/quality chỉ là tuỳ chọn cho người xem stream, không ghi thẳng vào sensor
+    // để không ảnh hưởng nhận diện (camera_ctrl quyết định theo chế độ)
+    if (!strcmp(variable, "framesize")) {
+        if (s->pixformat == PIXFORMAT_JPEG) camera_ctrl_set_stream_pref(val, -1);
+    }
+    else if (!strcmp(variable, "quality")) camera_ctrl_set_stream_pref(-1, val);
+    else if (!strcmp(variable, "contrast")) res = s->set_contrast(s, val);
+    else if (!strcmp(variable, "brightness")) res = s->set_brightness(s, val);
+    else if (!strcmp(variable, "saturation")) res = s->set_saturation(s, val);
+    
+    if (res) {
+        return httpd_resp_send_500(req);
+    }
+
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    return httpd_resp_send(req, NULL, 0);
+}
+
+static esp_err_t index_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "text/html");
+    return httpd_resp_send(req, INDEX_HTML, HTTPD_RESP_USE_STRLEN);
+}
+
+// false: bus đầy, lệnh không tới lock_ctrl -> người gọi trả 503 để App thử lại
+static bool publish_open(uint8_t source) {
+    bus_event_t ev = {};
+    ev.type = BUS_EV_COMMAND;
+    ev.command.cmd = BUS_CMD_OPEN;
+    ev.command.source = source;
+    ev.command.ref = -1;
+    return event_bus_publish(&ev);
+}
+
+static esp_err_t enroll_handler(httpd_req_t *req) {
+    bus_event_t ev = {};
+    ev.type = BUS_EV_ENROLL_REQUEST;
+    ev.enroll.user_id = -1;
+    event_bus_publish(&ev); 
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_send(req, "OK", 2);
+    return ESP_OK;
+}
+
+static esp_err_t open_handler(httpd_req_t *req) {
+    // Mở cửa trong LAN phải qua /api/cmd đã ký (trừ khi build bật LAN_ALLOW_UNSIGNED_OPEN)
+    if (!LAN_ALLOW_UNSIGNED_OPEN) {
+        httpd_resp_set_status(req, "403 Forbidden");
+        return httpd_resp_send(req, "Use signed /api/cmd", HTTPD_RESP_USE_STRLEN);
+    }
+    if (!publish_open(EV_SRC_WEB)) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_send(req, "Busy, retry", HTTPD_RESP_USE_STRLEN);
+    }
+    supabase_log_access_async(EV_SRC_WEB, -1, 1.0f, NULL); 
+    httpd_resp_send(req, "Door Opened", HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+}
+
+// STREAM HANDLER
+#define PART_BOUNDARY "123456789000000000000987654321"
+static const char* _STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=" PART_BOUNDARY;
+static const char* _STREAM_BOUNDARY = "\r\n--" PART_BOUNDARY "\r\n";
+static const char* _STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
+
+// Số người xem stream cùng lúc (mỗi người 1 task riêng, không giữ worker của httpd)
+#define STREAM_MAX_CLIENTS 2
+static int s_stream_count = 0;
+static portMUX_TYPE s_stream_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_err_t stream_loop(httpd_req_t *req) {
+    camera_fb_t *fb = NULL;
+    esp_err_t res = ESP_OK;
+    char part_buf[64];
+
+    res = httpd_resp_set_type(req, _STREAM_CONTENT_TYPE);
+    if (res != ESP_OK) return res;
+
+    while (true) {
+        // Logic Mutex: Xin khóa trong 20ms
+        if (xSemaphoreTake(xCameraMutex, pdMS_TO_TICKS(20)) == pdTRUE) {
+            
+            camera_frame_t frame;
+            bool got = camera_frame_get(&frame); // Đã có khóa, lấy frame mới nhất
+            xSemaphoreGive(xCameraMutex); // Trả khóa ngay, gửi ảnh không cần giữ camera
+            fb = frame.fb;
+            
+            if (!got) {
+                res = ESP_FAIL;
+            } else {
+                // Gửi Boundary
+                if (res == ESP_OK) res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, strlen(_STREAM_BOUNDARY));
+                // Gửi Header
+                if (res == ESP_OK) {
+                    size_t hlen = snprintf(part_buf, 64, _STREAM_PART, fb->len);
+                    res = httpd_resp_send_chunk(req, part_buf, hlen);
+                }
+                // Gửi Ảnh
+                if (res == ESP_OK) res = httpd_resp_send_chunk(req, (const char *)fb->buf, fb->len);
+
+                // Dùng xong trả ảnh
+                camera_frame_return(&frame);
+            }
+        } else {
+            // Không lấy được khóa 
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+
+        if (res != ESP_OK) break;
+    }
+    return res;
+}
+
+static void stream_task(void *pvParameters) {
+    httpd_req_t *req = (httpd_req_t *)pvParameters;
+    stream_loop(req);
+    httpd_req_async_handler_complete(req);
+
+    taskENTER_CRITICAL(&s_stream_lock);
+    s_stream_count--;
+    taskEXIT_CRITICAL(&s_stream_lock);
+    camera_ctrl_set_viewers(s_stream_count);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t stream_handler(httpd_req_t *req) {
+    // HTTP có thể lên trước camera (khởi động song song)
+    if (!xCameraMutex) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_send(req, "Camera not ready", HTTPD_RESP_USE_STRLEN);
+    }
+
+    taskENTER_CRITICAL(&s_stream_lock);
+    bool full = (s_stream_count >= STREAM_MAX_CLIENTS);
+    if (!full) s_stream_count++;
+    taskEXIT_CRITICAL(&s_stream_lock);
+
+    if (full) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_send(req, "Too many viewers", HTTPD_RESP_USE_STRLEN);
+    }
+
+    // Tách request khỏi worker của httpd -> các handler khác vẫn phục vụ bình thường
+    httpd_req_t *async_req = NULL;
+    if (httpd_req_async_handler_begin(req, &async_req) == ESP_OK &&
+        xTaskCreatePinnedToCore(stream_task, "mjpeg_stream", 4096, async_req, 4, NULL, 0) == pdPASS) {
+        camera_ctrl_set_viewers(s_stream_count);
+        return ESP_OK;
+    }
+
+    ESP_LOGE(TAG, "Cannot start stream task");
+    if (async_req) httpd_req_async_handler_complete(async_req);
+    taskENTER_CRITICAL(&s_stream_lock);
+    s_stream_count--;
+    taskEXIT_CRITICAL(&s_stream_lock);
+    return httpd_resp_send_500(req);
+}
+
+// WEBSOCKET (/ws): đẩy sự kiện khóa, nhận diện, đăng ký, metrics
+#define WS_METRICS_PERIOD_MS  5000
+#define WS_RETRY_MS           20    // Client chậm: thử lại sau khoảng này
+
+static TaskHandle_t s_ws_task = NULL;
+
+// Kiểm tra socket có gửi được ngay không (không chặn)
+static bool ws_socket_writable(int fd) {
+    fd_set wfds;
+    FD_ZERO(&wfds);
+    FD_SET(fd, &wfds);
+    struct timeval tv = { 0, 0 };
+    return select(fd + 1, NULL, &wfds, NULL, &tv) > 0;
+}
+
+static void ws_push_metrics(void) {
+    char msg[192];
+    snprintf(msg, sizeof(msg),
+             "{\"type\":\"metrics\",\"uptime\":%lld,\"heap\":%u,\"psram\":%u,\"ws\":%d,\"ws_dropped\":%lu,\"streams\":%d}",
+             esp_timer_get_time() / 1000000,
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+             ws_queue_clients(), (unsigned long)ws_queue_dropped(), s_stream_count);
+    ws_send_message(msg);
+}
+
+// BENCHMARK: 1 request GET /perf/bus qua socket loopback (kết nối + parse + handler + gửi trả).
+// Chạy từ console serial: gọi trong handler thì task httpd đang bận, không ai trả lời.
+static void _bench_http_loopback(void *ctx) {
+    static const char REQ[] = "GET /perf/bus HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    int s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s < 0) return;
+    struct timeval tv = { 1, 0 };
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    // Đóng bằng RST (khi bật CONFIG_LWIP_SO_LINGER): hàng trăm vòng không để lại pcb TIME_WAIT
+    struct linger lg = { 1, 0 };
+    setsockopt(s, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(80);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) == 0 && send(s, REQ, sizeof(REQ) - 1, 0) > 0) {
+        // Server giữ kết nối: đọc tới hết header + Content-Length byte body
+        char buf[1536];
+        int got = 0, need = -1;
+        while ((need < 0 || got < need) && got < (int)sizeof(buf) - 1) {
+            int r = recv(s, buf + got, sizeof(buf) - 1 - got, 0);
+            if (r <= 0) break;
+            got += r;
+            buf[got] = 0;
+            char *hdr_end = need < 0 ? strstr(buf, "\r\n\r\n") : NULL;
+            if (hdr_end) {
+                char *cl = strstr(buf, "Content-Length: ");
+                need = (int)(hdr_end + 4 - buf) + (cl ? atoi(cl + 16) : 0);
+            }
+        }
+    }
+    close(s);
+}
+
+// Cầu nối bus -> WebSocket: giữ nguyên định dạng tin App / web đang đọc
+static void ws_bus_handler(const bus_event_t *ev, void *ctx) {
+    char msg[128];
+    switch (ev->type) {
+    case BUS_EV_FACE_MATCHED:
+        snprintf(msg, sizeof(msg), "{\"type\":\"face\",\"id\":%d,\"score\":%.2f,\"frame\":%lu,\"age_ms\":%ld}",
+                 ev->face.id, ev->face.score, (unsigned long)ev->face.frame, (long)ev->face.age_ms);
+        break;
+    case BUS_EV_VISITOR:
+        snprintf(msg, sizeof(msg), "{\"type\":\"visitor\",\"id\":%lu,\"score\":%.2f,\"frame\":%lu}",
+                 (unsigned long)ev->visitor.id, ev->visitor.score, (unsigned long)ev->visitor.frame);
+        break;
+    case BUS_EV_DOOR_STATE:
+        snprintf(msg, sizeof(msg), "{\"type\":\"lock\",\"state\":\"%s\"}",
+                 ev->door.state == BUS_DOOR_OPEN ? "open" : "locked");
+        break;
+    case BUS_EV_COMMAND:
+        snprintf(msg, sizeof(msg), "{\"type\":\"command\",\"cmd\":\"open\",\"source\":\"%s\",\"ref\":%ld}",
+                 ev->command.source == BUS_SRC_BUTTON ? "button" : event_source_name(ev->command.source),
+                 (long)ev->command.ref);
+        break;
+    default:
+        return;
+    }
+    ws_send_message(msg);
+}
+
+// Task gửi duy nhất: rút hàng đợi từng client, bỏ qua client đang nghẽn
+static void ws_sender_task(void *pvParameters) {
+    char msg[WS_MSG_MAX_LEN];
+    int64_t last_metrics = 0;
+    bool pending = false;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(pending ? WS_RETRY_MS : WS_METRICS_PERIOD_MS));
+        pending = false;
+
+        int64_t now = esp_timer_get_time() / 1000;
+        if (now - last_metrics >= WS_METRICS_PERIOD_MS) {
+            last_metrics = now;
+            if (ws_queue_clients() > 0) ws_push_metrics();
+        }
+
+        for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+            while (true) {
+                int fd;
+                uint32_t seq = 0;
+                size_t len = ws_queue_peek(i, &fd, msg, &seq);
+                if (fd < 0 || len == 0) break;
+
+                if (httpd_ws_get_fd_info(server, fd) != HTTPD_WS_CLIENT_WEBSOCKET) {
+                    ws_queue_remove(fd);
+                    break;
+                }
+                if (!ws_socket_writable(fd)) {
+                    // TCP window đầy: giữ lại, các client khác vẫn được gửi
+                    pending = true;
+                    break;
+                }
+
+                httpd_ws_frame_t frame;
+                memset(&frame, 0, sizeof(frame));
+                frame.final = true;
+                frame.type = HTTPD_WS_TYPE_TEXT;
+                frame.payload = (uint8_t *)msg;
+                frame.len = len;
+                if (httpd_ws_send_frame_async(server, fd, &frame) != ESP_OK) {
+                    ws_queue_remove(fd);
+                    break;
+                }
+
+                // Tin đã bị người phát đẩy ra trong lúc gửi -> không pop nhầm tin đầu mới
+                ws_queue_pop(i, fd, seq);
+            }
+        }
+    }
+}
+
+static esp_err_t ws_handler(httpd_req_t *req) {
+    if (req->method == HTTP_GET) {
+        // Handshake xong -> đăng ký client
+        ws_queue_add(httpd_req_to_sockfd(req));
+        ESP_LOGI(TAG, "WS client connected (fd %d)", httpd_req_to_sockfd(req));
+        return ESP_OK;
+    }
+
+    // Client hiện chỉ nhận; đọc bỏ payload để giữ kết nối sạch
+    uint8_t buf[128];
+    httpd_ws_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret != ESP_OK) return ret;
+    if (frame.len > sizeof(buf)) return ESP_ERR_INVALID_SIZE;
+    frame.payload = buf;
+    return httpd_ws_recv_frame(req, &frame, frame.len);
+}
+
+static void http_close_fn(httpd_handle_t hd, int sockfd) {
+    ws_queue_remove(sockfd);
+    close(sockfd);
+}
+
+// Trả JSON trạng thái (quy ước *_json: json_writer.h). len == 0 -> 500 thay vì body rỗng / JSON hỏng
+static esp_err_t send_status_json(httpd_req_t *req, const char *buf, size_t len) {
+    if (len == 0) {
+        ESP_LOGE(TAG, "Status JSON truncated (%s)", req->uri);
+        return httpd_resp_send_500(req);
+    }
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    return httpd_resp_send(req, buf, len);
+}
+
+// PERF HANDLERS
+static esp_err_t perf_tasks_handler(httpd_req_t *req) {
+    char *buf = (char *)malloc(4096);
+    if (!buf) return httpd_resp_send_500(req);
+    size_t len = perf_tasks_to_json(buf, 4096);
+    esp_err_t res = send_status_json(req, buf, len);
+    free(buf);
+    return res;
+}
+
+static int perf_chunk_writer(void *ctx, const char *data, size_t len) {
+    return httpd_resp_send_chunk((httpd_req_t *)ctx, data, len) == ESP_OK ? 0 : -1;
+}
+
+// Mở file JSON tải về bằng chrome://tracing hoặc ui.perfetto.dev
+static esp_err_t perf_trace_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"trace.json\"");
+    if (perf_trace_export(perf_chunk_writer, req) != ESP_OK) {
+        return httpd_resp_send_500(req);
+    }
+
+    // ?clear=1 -> xoá ring buffer sau khi xuất
+    char query[32];
+    char val[4];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "clear", val, sizeof(val)) == ESP_OK && val[0] == '1') {
+        perf_trace_clear();
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Ghép {"key":<json>,...} từ các hàm *_json (0 khi tràn). Trả 0 nếu bất kỳ phần nào tràn.
+typedef size_t (*status_json_fn)(char *buf, size_t len);
+typedef struct {
+    const char *key;
+    status_json_fn fn;
+} status_section_t;
+
+static size_t status_sections_json(char *buf, size_t len, const status_section_t *secs, int count) {
+    size_t off = 0;
+    for (int i = 0; i < count; i++) {
+        int n = snprintf(buf + off, len - off, "%c\"%s\":", i ? ',' : '{', secs[i].key);
+        if (n <= 0 || (size_t)n >= len - off) return 0;
+        off += n;
+        size_t part = secs[i].fn(buf + off, len - off);
+        if (part == 0) return 0;
+        off += part;
+    }
+    if (off + 2 > len) return 0;
+    buf[off++] = '}';
+    buf[off] = '\0';
+    return off;
+}
+
+#define CAMERA_STATUS_JSON_MAX  4096    // 6 phần, adapt/batch có danh sách theo user / cỡ lô
+
+static esp_err_t camera_status_handler(httpd_req_t *req) {
+    static const status_section_t SECTIONS[] = {
+        { "ctrl", camera_ctrl_status_json },
+        { "frames", camera_frame_stats_json },
+        { "thumb", face_thumb_stats_json },
+        { "batch", face_batch_stats_json },
+        { "visitors", visitor_cache_stats_json },
+        { "adapt", face_adapt_stats_json },
+    };
+    char *buf = (char *)malloc(CAMERA_STATUS_JSON_MAX);
+    if (!buf) return httpd_resp_send_500(req);
+    size_t len = status_sections_json(buf, CAMERA_STATUS_JSON_MAX, SECTIONS, sizeof(SECTIONS) / sizeof(SECTIONS[0]));
+    esp_err_t res = send_status_json(req, buf, len);
+    free(buf);
+    return res;
+}
+
+static esp_err_t boot_handler(httpd_req_t *req) {
+    char buf[768];
+    size_t len = boot_profile_json(buf, sizeof(buf));
+    return send_status_json(req, buf, len);
+}
+
+// LAN CONTROL API: GET /api/nonce -> challenge, rồi
+// POST /api/cmd {"cmd":"open","ts":<unix s>,"nonce":"<challenge>","sig":"<hex HMAC-SHA256>"}
+// Mở relay ngay khi chữ ký hợp lệ, log đi qua outbox (không chờ mạng)
+static esp_err_t api_send_json(httpd_req_t *req, const char *status, const char *json) {
+    httpd_resp_set_status(req, status);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    return httpd_resp_send(req, json, HTTPD_RESP_USE_STRLEN);
+}
+
+static esp_err_t api_nonce_handler(httpd_req_t *req) {
+    if (!lan_auth_has_key()) return api_send_json(req, "503 Service Unavailable", "{\"ok\":false,\"error\":\"no_key\"}");
+    char nonce[LAN_AUTH_NONCE_LEN + 1];
+    lan_auth_issue_nonce(nonce);
+    char resp[96];
+    snprintf(resp, sizeof(resp), "{\"ok\":true,\"nonce\":\"%s\",\"ttl_ms\":%d}", nonce, LAN_AUTH_CHALLENGE_TTL_MS);
+    return api_send_json(req, "200 OK", resp);
+}
+
+// Đọc body JSON của request ký (/api/cmd, POST /roi). NULL: body rỗng / quá dài / không phải JSON;
+// *sock_err = true nếu mất kết nối (handler trả ESP_FAIL thay vì trả lời)
+static cJSON *api_recv_json(httpd_req_t *req, bool *sock_err) {
+    char body[256];
+    *sock_err = false;
+    if (req->content_len <= 0 || req->content_len >= sizeof(body)) return NULL;
+    int got = 0;
+    while (got < (int)req->content_len) {
+        int r = httpd_req_recv(req, body + got, req->content_len - got);
+        if (r == HTTPD_SOCK_ERR_TIMEOUT) continue;
+        if (r <= 0) {
+            *sock_err = true;
+            return NULL;
+        }
+        got += r;
+    }
+    body[got] = 0;
+    return cJSON_Parse(body);
+}
+
+// Kiểm chữ ký của cmd bằng các trường ts/nonce/sig trong body
+static lan_auth_result_t api_verify(const cJSON *root, const char *cmd) {
+    cJSON *ts = cJSON_GetObjectItem(root, "ts");
+    cJSON *nonce = cJSON_GetObjectItem(root, "nonce");
+    cJSON *sig = cJSON_GetObjectItem(root, "sig");
+    if (!cmd || !cJSON_IsNumber(ts) || !cJSON_IsString(nonce) || !cJSON_IsString(sig)) return LAN_AUTH_BAD_REQUEST;
+    PERF_TRACE_BEGIN(t_verify);
+    lan_auth_result_t res = lan_auth_verify(cmd, (int64_t)ts->valuedouble, nonce->valuestring, sig->valuestring);
+    PERF_TRACE_END(t_verify, "lan_verify");
+    return res;
+}
+
+static esp_err_t api_send_auth_error(httpd_req_t *req, lan_auth_result_t res) {
+    char resp[96];
+    ESP_LOGW(TAG, "LAN cmd rejected: %s", lan_auth_result_name(res));
+    snprintf(resp, sizeof(resp), "{\"ok\":false,\"error\":\"%s\"}", lan_auth_result_name(res));
+    const char *status = res == LAN_AUTH_BAD_REQUEST ? "400 Bad Request"
+                       : res == LAN_AUTH_NO_KEY ? "503 Service Unavailable"
+                       : res == LAN_AUTH_REPLAY ? "409 Conflict" : "401 Unauthorized";
+    return api_send_json(req, status, resp);
+}
+
+static esp_err_t api_cmd_handler(httpd_req_t *req) {
+    int64_t t0 = esp_timer_get_time();
+    bool sock_err;
+    cJSON *root = api_recv_json(req, &sock_err);
+    if (sock_err) return ESP_FAIL;
+    if (!root) return api_send_json(req, "400 Bad Request", "{\"ok\":false,\"error\":\"bad_request\"}");
+    cJSON *cmd = cJSON_GetObjectItem(root, "cmd");
+    lan_auth_result_t res = api_verify(root, cJSON_IsString(cmd) ? cmd->valuestring : NULL);
+
+    char resp[96];
+    esp_err_t ret;
+    if (res != LAN_AUTH_OK) {
+        ret = api_send_auth_error(req, res);
+    } else if (strcmp(cmd->valuestring, "open") == 0 && !publish_open(EV_SRC_LAN)) {
+        // Nonce đã dùng: App ký lại với nonce mới rồi gửi lại
+        ret = api_send_json(req, "503 Service Unavailable", "{\"ok\":false,\"error\":\"busy\"}");
+    } else if (strcmp(cmd->valuestring, "open") == 0) {
+        int64_t us = esp_timer_get_time() - t0;
+        supabase_log_access_async(EV_SRC_LAN, -1, 1.0f, NULL);
+        snprintf(resp, sizeof(resp), "{\"ok\":true,\"cmd\":\"open\",\"us\":%lld}", us);
+        ret = api_send_json(req, "200 OK", resp);
+    } else {
+        ret = api_send_json(req, "400 Bad Request", "{\"ok\":false,\"error\":\"unknown_cmd\"}");
+    }
+    cJSON_Delete(root);
+    return ret;
+}
+
+// GET /bench -> danh sách, /bench?name=x&iters=n -> chạy và trả phân vị (us)
+// /bench?name=all&iters=n -> chạy cả bộ trong task nền (bỏ benchmark loopback), trả 202 ngay;
+// /bench?job=1 -> {"state":..,"done":..,"total":..,"build":{..},"iters":n,"results":[..]} (hỏi lại tới khi state = done)
+static esp_err_t bench_handler(httpd_req_t *req) {
+    char query[64], name[32] = {0}, iters_str[8] = {0}, job[4];
+    char buf[1024];
+    size_t len;
+    bool has_query = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK;
+    if (has_query && httpd_query_key_value(query, "job", job, sizeof(job)) == ESP_OK) {
+        char *doc = (char *)heap_caps_malloc(BENCH_JOB_JSON_MAX, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!doc) return httpd_resp_send_500(req);
+        len = bench_job_json(doc, BENCH_JOB_JSON_MAX);
+        esp_err_t res = send_status_json(req, doc, len);
+        heap_caps_free(doc);
+        return res;
+    }
+    if (has_query && httpd_query_key_value(query, "name", name, sizeof(name)) == ESP_OK) {
+        uint32_t iters = 200;
+        if (httpd_query_key_value(query, "iters", iters_str, sizeof(iters_str)) == ESP_OK) iters = atoi(iters_str);
+        if (strcmp(name, "all") == 0) {
+            // Cả bộ mất hàng chục giây: không giữ worker httpd, model không bị khoá liền một mạch
+            esp_err_t err = bench_job_start(iters, BENCH_F_LOOPBACK);
+            if (err == ESP_ERR_INVALID_STATE) return api_send_json(req, "409 Conflict", "{\"ok\":false,\"error\":\"busy\"}");
+            if (err != ESP_OK) return httpd_resp_send_500(req);
+            return api_send_json(req, "202 Accepted", "{\"ok\":true,\"state\":\"running\",\"poll\":\"/bench?job=1\"}");
+        }
+        // Handler đang chiếm task httpd: benchmark tự gọi web server sẽ không bao giờ được trả lời
+        if (bench_flags(name) & BENCH_F_LOOPBACK) {
+            httpd_resp_set_status(req, "409 Conflict");
+            return httpd_resp_sendstr(req, "Loopback bench: run from serial console");
+        }
+        // Benchmark dùng chung buffer tĩnh: không đo chồng lên lượt chạy nền
+        if (bench_job_running()) return api_send_json(req, "409 Conflict", "{\"ok\":false,\"error\":\"busy\"}");
+        bench_result_t r;
+        esp_err_t err = bench_run(name, iters, &r);
+        if (err == ESP_ERR_NOT_FOUND) return httpd_resp_send_404(req);
+        if (err != ESP_OK) return httpd_resp_send_500(req);
+        len = bench_result_json(name, &r, buf, sizeof(buf));
+    } else {
+        len = bench_list_json(buf, sizeof(buf));
+    }
+    return send_status_json(req, buf, len);
+}
+
+// EVENT STORE: GET /events?from=<unix>&to=<unix>&limit=N  |  ?recent=N  |  ?stats=1
+// Trả NDJSON (1 sự kiện / dòng), gom thành chunk ~1 KB
+typedef struct {
+    httpd_req_t *req;
+    size_t len;
+    bool failed;
+    char buf[1024];
+} events_stream_t;
+
+static bool events_flush(events_stream_t *es) {
+    if (es->len && httpd_resp_send_chunk(es->req, es->buf, es->len) != ESP_OK) es->failed = true;
+    es->len = 0;
+    return !es->failed;
+}
+
+static bool events_visit(const event_rec_t *r, void *ctx) {
+    events_stream_t *es = (events_stream_t *)ctx;
+    size_t n = event_rec_json(r, es->buf + es->len, sizeof(es->buf) - es->len);
+    if (n == 0) {
+        if (!events_flush(es)) return false;
+        n = event_rec_json(r, es->buf, sizeof(es->buf));
+    }
+    es->len += n;
+    return true;
+}
+
+static uint32_t query_u32(const char *query, const char *key, uint32_t def) {
+    char val[16];
+    if (httpd_query_key_value(query, key, val, sizeof(val)) != ESP_OK) return def;
+    return strtoul(val, NULL, 10);
+}
+
+static esp_err_t events_handler(httpd_req_t *req) {
+    char query[96] = {0};
+    httpd_req_get_url_query_str(req, query, sizeof(query));
+
+    if (query_u32(query, "stats", 0)) {
+        char buf[256];
+        size_t len = event_store_stats_json(buf, sizeof(buf));
+        return send_status_json(req, buf, len);
+    }
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    events_stream_t *es = (events_stream_t *)malloc(sizeof(events_stream_t));
+    if (!es) return httpd_resp_send_500(req);
+    es->req = req;
+    es->len = 0;
+    es->failed = false;
+    httpd_resp_set_type(req, "application/x-ndjson");
+
+    uint32_t limit = query_u32(query, "limit", 200);
+    if (limit > EVENT_QUERY_MAX) limit = EVENT_QUERY_MAX;
+    uint32_t recent = query_u32(query, "recent", 0);
+    if (recent) {
+        event_store_query_recent(recent > EVENT_QUERY_MAX ? EVENT_QUERY_MAX : recent, events_visit, es);
+    } else {
+        event_store_query(query_u32(query, "from", 0), query_u32(query, "to", UINT32_MAX), limit, events_visit, es);
+    }
+    events_flush(es);
+    bool failed = es->failed;
+    free(es);
+    if (failed) return ESP_FAIL;
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Bản tóm tắt thống kê cho màn hình phân tích (cùng nội dung đẩy lên device_stats)
+static esp_err_t stats_handler(httpd_req_t *req) {
+    char *buf = (char *)malloc(SUPABASE_STATS_JSON_MAX);
+    if (!buf) return httpd_resp_send_500(req);
+    size_t len = access_stats_json(buf, SUPABASE_STATS_JSON_MAX);
+    esp_err_t res = send_status_json(req, buf, len);
+    free(buf);
+    return res;
+}
+
+// GET /roi: xem cấu hình + thời gian detect (chỉ đọc)
+static esp_err_t roi_handler(httpd_req_t *req) {
+    char buf[384];
+    size_t len = face_roi_json(buf, sizeof(buf));
+    return send_status_json(req, buf, len);
+}
+
+// POST /roi {"x":10,"y":0,"w":80,"h":100,"min":12,"max":60,"ts":..,"nonce":..,"sig":..}: đổi cấu hình (lưu NVS).
+// Ký như /api/cmd với cmd = "roi:x,y,w,h,min,max" nên chữ ký gắn với đúng các giá trị gửi kèm; đủ cả 6 khoá
+// (App GET /roi trước rồi sửa khoá cần đổi)
+static esp_err_t roi_post_handler(httpd_req_t *req) {
+    static const char *KEYS[] = { "x", "y", "w", "h", "min", "max" };
+    bool sock_err;
+    cJSON *root = api_recv_json(req, &sock_err);
+    if (sock_err) return ESP_FAIL;
+    if (!root) return api_send_json(req, "400 Bad Request", "{\"ok\":false,\"error\":\"bad_request\"}");
+
+    face_roi_cfg_t cfg;
+    uint8_t *fields[] = { &cfg.x, &cfg.y, &cfg.w, &cfg.h, &cfg.min_face, &cfg.max_face };
+    int v[6];
+    for (int i = 0; i < 6; i++) {
+        cJSON *item = cJSON_GetObjectItem(root, KEYS[i]);
+        if (!cJSON_IsNumber(item)) {
+            cJSON_Delete(root);
+            return api_send_json(req, "400 Bad Request", "{\"ok\":false,\"error\":\"bad_request\"}");
+        }
+        v[i] = item->valueint;
+    }
+    char cmd[48];
+    snprintf(cmd, sizeof(cmd), "roi:%d,%d,%d,%d,%d,%d", v[0], v[1], v[2], v[3], v[4], v[5]);
+    lan_auth_result_t res = api_verify(root, cmd);
+    cJSON_Delete(root);
+    if (res != LAN_AUTH_OK) return api_send_auth_error(req, res);
+
+    for (int i = 0; i < 6; i++) {
+        if (v[i] < 0 || v[i] > 100) return api_send_json(req, "400 Bad Request", "{\"ok\":false,\"error\":\"range\"}");
+        *fields[i] = (uint8_t)v[i];
+    }
+    esp_err_t err = face_roi_set(&cfg);
+    if (err == ESP_ERR_INVALID_ARG) return api_send_json(req, "400 Bad Request", "{\"ok\":false,\"error\":\"invalid\"}");
+    if (err != ESP_OK) return httpd_resp_send_500(req);
+
+    char buf[384];
+    size_t len = face_roi_json(buf, sizeof(buf));
+    return send_status_json(req, buf, len);
+}
+
+static esp_err_t net_handler(httpd_req_t *req) {
+    char buf[2048];
+    size_t len = net_supervisor_status_json(buf, sizeof(buf));
+    return send_status_json(req, buf, len);
+}
+
+static esp_err_t bus_handler(httpd_req_t *req) {
+    char buf[768];
+    size_t len = event_bus_stats_json(buf, sizeof(buf));
+    return send_status_json(req, buf, len);
+}
+
+static esp_err_t mem_handler(httpd_req_t *req) {
+    char buf[1536];
+    size_t len = mem_pool_report_json(buf, sizeof(buf));
+    return send_status_json(req, buf, len);
+}
+
+extern "C" esp_err_t start_http_server(void) {
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = 80;
+    config.stack_size = 8192;
+    config.max_uri_handlers = 20;
+    config.close_fn = http_close_fn;
+    // Stream chạy trong task riêng nên cần thêm socket cho người xem + websocket
+    config.max_open_sockets = 7;
+    config.lru_purge_enable = true;
+
+    ws_queue_init();
+
+    if (httpd_start(&server, &config) == ESP_OK) {
+        // Khai báo đầy đủ các trường
+        httpd_uri_t index_uri = {
+            .uri = "/", .method = HTTP_GET, .handler = index_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &index_uri);
+        
+        httpd_uri_t enroll_uri = {
+            .uri = "/enroll", .method = HTTP_GET, .handler = enroll_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &enroll_uri);
+
+        httpd_uri_t open_uri = {
+            .uri = "/open", .method = HTTP_GET, .handler = open_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &open_uri);
+        
+        httpd_uri_t stream_uri = {
+            .uri = "/stream", .method = HTTP_GET, .handler = stream_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &stream_uri);
+
+        httpd_uri_t cmd_uri = {
+            .uri = "/control", .method = HTTP_GET, .handler = cmd_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &cmd_uri);
+
+        httpd_uri_t perf_tasks_uri = {
+            .uri = "/perf/tasks", .method = HTTP_GET, .handler = perf_tasks_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &perf_tasks_uri);
+
+        httpd_uri_t perf_trace_uri = {
+            .uri = "/perf/trace", .method = HTTP_GET, .handler = perf_trace_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &perf_trace_uri);
+
+        httpd_uri_t mem_uri = {
+            .uri = "/perf/mem", .method = HTTP_GET, .handler = mem_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &mem_uri);
+
+        httpd_uri_t camera_uri = {
+            .uri = "/camera", .method = HTTP_GET, .handler = camera_status_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &camera_uri);
+
+        httpd_uri_t boot_uri = {
+            .uri = "/perf/boot", .method = HTTP_GET, .handler = boot_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &boot_uri);
+
+        httpd_uri_t net_uri = {
+            .uri = "/net", .method = HTTP_GET, .handler = net_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &net_uri);
+
+        httpd_uri_t api_cmd_uri = {
+            .uri = "/api/cmd", .method = HTTP_POST, .handler = api_cmd_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &api_cmd_uri);
+
+        httpd_uri_t api_nonce_uri = {
+            .uri = "/api/nonce", .method = HTTP_GET, .handler = api_nonce_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &api_nonce_uri);
+
+        httpd_uri_t bench_uri = {
+            .uri = "/bench", .method = HTTP_GET, .handler = bench_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &bench_uri);
+
+        httpd_uri_t events_uri = {
+            .uri = "/events", .method = HTTP_GET, .handler = events_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &events_uri);
+
+        httpd_uri_t stats_uri = {
+            .uri = "/stats", .method = HTTP_GET, .handler = stats_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &stats_uri);
+
+        httpd_uri_t roi_uri = {
+            .uri = "/roi", .method = HTTP_GET, .handler = roi_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &roi_uri);
+
+        httpd_uri_t roi_post_uri = {
+            .uri = "/roi", .method = HTTP_POST, .handler = roi_post_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &roi_post_uri);
+
+        httpd_uri_t bus_uri = {
+            .uri = "/perf/bus", .method = HTTP_GET, .handler = bus_handler, .user_ctx = NULL,
+            .is_websocket = false, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &bus_uri);
+
+        httpd_uri_t ws_uri = {
+            .uri = "/ws", .method = HTTP_GET, .handler = ws_handler, .user_ctx = NULL,
+            .is_websocket = true, .handle_ws_control_frames = false, .supported_subprotocol = NULL
+        };
+        httpd_register_uri_handler(server, &ws_uri);
+
+        if (!s_ws_task) {
+            xTaskCreatePinnedToCore(ws_sender_task, "ws_sender", 4096, NULL, 3, &s_ws_task, 0);
+            bench_register_flags("http_loopback", _bench_http_loopback, NULL, BENCH_F_LOOPBACK);
+            // Server có thể khởi động lại theo mạng: chỉ đăng ký 1 lần
+            event_bus_subscribe(BUS_MASK(BUS_EV_FACE_MATCHED) | BUS_MASK(BUS_EV_VISITOR) | BUS_MASK(BUS_EV_DOOR_STATE) |
+                                BUS_MASK(BUS_EV_COMMAND), ws_bus_handler, NULL, "ws");
+        }
+
+        return ESP_OK;
+    }
+    return ESP_FAIL;
+}
+
+extern "C" void stop_http_server(void) { if (server) httpd_stop(server); }
+// Không chặn: copy vào hàng đợi của từng client rồi đánh thức task gửi
+extern "C" void ws_send_message(const char *msg) { 
+    if (!ws_queue_push(msg)) return;
+    if (s_ws_task) xTaskNotifyGive(s_ws_task);
 }
\ No newline at end of file
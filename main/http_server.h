@@ -1,18 +1,19 @@
-#ifndef HTTP_SERVER_H
-#define HTTP_SERVER_H
-
-#include "esp_err.h"
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-esp_err_t start_http_server(void);
-void stop_http_server(void);
-void ws_send_message(char *msg);
-
-#ifdef __cplusplus
-}
-#endif
-
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t start_http_server(void);
+void stop_http_server(void);
+// Đẩy 1 tin JSON (< 256 bytes) tới mọi client /ws. Không chặn, gọi được từ mọi task.
+void ws_send_message(const char *msg);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "json_writer.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+void jw_init(json_writer_t *w, char *buf, size_t cap) {
+    w->buf = buf;
+    w->cap = cap;
+    w->len = 0;
+    w->overflow = (cap == 0);
+    w->need_comma = false;
+}
+
+// Chừa 1 byte cho '\0' của jw_finish
+static inline void jw_put(json_writer_t *w, const char *s, size_t n) {
+    if (w->overflow) return;
+    if (w->len + n + 1 > w->cap) { w->overflow = true; return; }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+static inline void jw_putc(json_writer_t *w, char c) {
+    if (w->overflow) return;
+    if (w->len + 2 > w->cap) { w->overflow = true; return; }
+    w->buf[w->len++] = c;
+}
+
+// Dấu phẩy trước phần tử / key thứ 2 trở đi
+static inline void jw_sep(json_writer_t *w) {
+    if (w->need_comma) jw_putc(w, ',');
+}
+
+void jw_obj_begin(json_writer_t *w) { jw_sep(w); jw_putc(w, '{'); w->need_comma = false; }
+void jw_obj_end(json_writer_t *w)   { jw_putc(w, '}'); w->need_comma = true; }
+void jw_arr_begin(json_writer_t *w) { jw_sep(w); jw_putc(w, '['); w->need_comma = false; }
+void jw_arr_end(json_writer_t *w)   { jw_putc(w, ']'); w->need_comma = true; }
+
+static void jw_escaped(json_writer_t *w, const char *s) {
+    static const char HEX[] = "0123456789abcdef";
+    jw_putc(w, '"');
+    const char *run = s;     // Copy nguyên cụm ký tự không cần escape
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        jw_put(w, run, s - run);
+        switch (c) {
+        case '"':  jw_put(w, "\\\"", 2); break;
+        case '\\': jw_put(w, "\\\\", 2); break;
+        case '\n': jw_put(w, "\\n", 2); break;
+        case '\r': jw_put(w, "\\r", 2); break;
+        case '\t': jw_put(w, "\\t", 2); break;
+        case '\b': jw_put(w, "\\b", 2); break;
+        case '\f': jw_put(w, "\\f", 2); break;
+        default: {
+            char u[6] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF] };
+            jw_put(w, u, 6);
+        }
+        }
+        run = s + 1;
+    }
+    jw_put(w, run, s - run);
+    jw_putc(w, '"');
+}
+
+void jw_key(json_writer_t *w, const char *key) {
+    jw_sep(w);
+    jw_escaped(w, key);
+    jw_putc(w, ':');
+    w->need_comma = false;
+}
+
+void jw_str(json_writer_t *w, const char *s) {
+    jw_sep(w);
+    if (s) jw_escaped(w, s);
+    else jw_put(w, "null", 4);
+    w->need_comma = true;
+}
+
+// Ghi số nguyên không dấu, trả số chữ số
+static int jw_utoa(char *out, uint64_t v) {
+    char tmp[20];
+    int n = 0;
+    do { tmp[n++] = '0' + (v % 10); v /= 10; } while (v);
+    for (int i = 0; i < n; i++) out[i] = tmp[n - 1 - i];
+    return n;
+}
+
+void jw_int(json_writer_t *w, int64_t v) {
+    char num[21];
+    int n = 0;
+    uint64_t u = (uint64_t)v;
+    if (v < 0) { num[n++] = '-'; u = 0 - u; }
+    n += jw_utoa(num + n, u);
+    jw_sep(w);
+    jw_put(w, num, n);
+    w->need_comma = true;
+}
+
+void jw_float(json_writer_t *w, double v, int decimals) {
+    static const uint64_t POW10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+    if (!isfinite(v)) { jw_null(w); return; }
+    if (decimals < 0) decimals = 0;
+    if (decimals > 9) decimals = 9;
+
+    char num[40];
+    int n = 0;
+    double a = fabs(v);
+    uint64_t scale = POW10[decimals];
+    if (a * (double)scale >= 9.2e18) {
+        // a * 10^decimals vượt int64 của llround: hiếm, để snprintf lo
+        n = snprintf(num, sizeof(num), "%.*g", decimals + 1, v);
+    } else {
+        uint64_t r = (uint64_t)llround(a * scale);
+        uint64_t ip = r / scale, frac = r % scale;
+        if (v < 0 && r != 0) num[n++] = '-';
+        n += jw_utoa(num + n, ip);
+        if (frac) {
+            // Bỏ số 0 ở cuối phần lẻ
+            int d = decimals;
+            while (frac % 10 == 0) { frac /= 10; d--; }
+            num[n++] = '.';
+            char digits[10];
+            int k = jw_utoa(digits, frac);
+            for (int i = k; i < d; i++) num[n++] = '0';
+            memcpy(num + n, digits, k);
+            n += k;
+        }
+    }
+    jw_sep(w);
+    jw_put(w, num, n);
+    w->need_comma = true;
+}
+
+void jw_bool(json_writer_t *w, bool v) {
+    jw_sep(w);
+    if (v) jw_put(w, "true", 4);
+    else jw_put(w, "false", 5);
+    w->need_comma = true;
+}
+
+void jw_null(json_writer_t *w) {
+    jw_sep(w);
+    jw_put(w, "null", 4);
+    w->need_comma = true;
+}
+
+void jw_kv_str(json_writer_t *w, const char *key, const char *s)              { jw_key(w, key); jw_str(w, s); }
+void jw_kv_int(json_writer_t *w, const char *key, int64_t v)                  { jw_key(w, key); jw_int(w, v); }
+void jw_kv_float(json_writer_t *w, const char *key, double v, int decimals)   { jw_key(w, key); jw_float(w, v, decimals); }
+
+const char *jw_finish(json_writer_t *w, size_t *out_len) {
+    if (w->overflow) return NULL;
+    w->buf[w->len] = '\0';
+    if (out_len) *out_len = w->len;
+    return w->buf;
+}
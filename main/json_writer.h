@@ -0,0 +1,54 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+// Ghi JSON tuần tự thẳng vào buffer của người gọi: không malloc, không cây node như cJSON.
+// Hết chỗ thì đánh dấu overflow, các lệnh ghi sau bị bỏ qua, jw_finish trả NULL.
+//
+// Quy ước chung cho các hàm trạng thái `size_t xxx_json(char *buf, size_t len)` của mọi module:
+// trả độ dài JSON đã ghi (không kể '\0'), 0 nếu buf không đủ (nội dung buf khi đó là JSON dở, không được gửi).
+// http_server trả 500 khi nhận 0; "chưa có dữ liệu" phải ghi ra JSON hợp lệ (vd. null), không trả 0.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    char *buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+    bool need_comma;
+} json_writer_t;
+
+void jw_init(json_writer_t *w, char *buf, size_t cap);
+
+void jw_obj_begin(json_writer_t *w);
+void jw_obj_end(json_writer_t *w);
+void jw_arr_begin(json_writer_t *w);
+void jw_arr_end(json_writer_t *w);
+
+void jw_key(json_writer_t *w, const char *key);
+void jw_str(json_writer_t *w, const char *s);          // Có escape ", \ và ký tự điều khiển
+void jw_int(json_writer_t *w, int64_t v);
+// Số thực dạng thập phân cố định, tối đa `decimals` (<= 9) chữ số lẻ, bỏ số 0 thừa. NaN/Inf -> null.
+void jw_float(json_writer_t *w, double v, int decimals);
+void jw_bool(json_writer_t *w, bool v);
+void jw_null(json_writer_t *w);
+
+// Cặp key/value thường dùng
+void jw_kv_str(json_writer_t *w, const char *key, const char *s);
+void jw_kv_int(json_writer_t *w, const char *key, int64_t v);
+void jw_kv_float(json_writer_t *w, const char *key, double v, int decimals);
+
+// Kết thúc chuỗi. Trả buf (len ra out_len nếu khác NULL), hoặc NULL nếu tràn.
+const char *jw_finish(json_writer_t *w, size_t *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,220 @@
+#include "lan_auth.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include "mbedtls/md.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "bench.h"
+
+static const char *TAG = "LAN_AUTH";
+
+static uint8_t s_key[LAN_AUTH_KEY_LEN];
+static bool s_has_key = false;
+
+// Challenge đang chờ (chỉ trong RAM: khởi động lại thì mọi challenge cũ mất hiệu lực).
+// Cấp / tiêu từ task httpd (/api/nonce, /api/cmd) và task BTC (xác thực BLE bulk) -> giữ s_lock.
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static struct {
+    char nonce[LAN_AUTH_NONCE_LEN + 1];
+    int64_t issued_us;      // 0 = trống
+} s_challenges[LAN_AUTH_CHALLENGES];
+
+static int hex_val(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool hex_decode(const char *hex, uint8_t *out, size_t out_len) {
+    if (!hex || strlen(hex) != out_len * 2) return false;
+    for (size_t i = 0; i < out_len; i++) {
+        int hi = hex_val(hex[2 * i]), lo = hex_val(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return true;
+}
+
+int lan_auth_canonical(char *buf, size_t len, const char *cmd, int64_t ts, const char *nonce) {
+    return snprintf(buf, len, "%s|%lld|%s", cmd, (long long)ts, nonce);
+}
+
+bool lan_auth_check_signature(const uint8_t *key, size_t key_len, const char *msg, size_t msg_len, const char *sig_hex) {
+    uint8_t expect[32], got[32];
+    if (!hex_decode(sig_hex, got, sizeof(got))) return false;
+    if (mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), key, key_len,
+                        (const unsigned char *)msg, msg_len, expect) != 0) {
+        return false;
+    }
+    // So sánh thời gian hằng: không lộ vị trí byte sai qua thời gian phản hồi
+    uint8_t diff = 0;
+    for (size_t i = 0; i < sizeof(expect); i++) diff |= expect[i] ^ got[i];
+    return diff == 0;
+}
+
+static bool nonce_valid(const char *nonce) {
+    size_t n = nonce ? strlen(nonce) : 0;
+    if (n != LAN_AUTH_NONCE_LEN) return false;
+    for (size_t i = 0; i < n; i++) if (hex_val(nonce[i]) < 0) return false;
+    return true;
+}
+
+static bool challenge_live(int i, int64_t now_us) {
+    return s_challenges[i].issued_us && now_us - s_challenges[i].issued_us <= LAN_AUTH_CHALLENGE_TTL_MS * 1000LL;
+}
+
+void lan_auth_issue_nonce(char *out) {
+    uint8_t rnd[LAN_AUTH_NONCE_LEN / 2];
+    esp_fill_random(rnd, sizeof(rnd));
+    for (size_t i = 0; i < sizeof(rnd); i++) snprintf(out + 2 * i, 3, "%02x", rnd[i]);
+
+    // Ô trống / hết hạn trước, không có thì thay challenge cũ nhất
+    int64_t now = esp_timer_get_time();
+    int slot = 0;
+    taskENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < LAN_AUTH_CHALLENGES; i++) {
+        if (!challenge_live(i, now)) { slot = i; break; }
+        if (s_challenges[i].issued_us < s_challenges[slot].issued_us) slot = i;
+    }
+    memcpy(s_challenges[slot].nonce, out, LAN_AUTH_NONCE_LEN + 1);
+    s_challenges[slot].issued_us = now;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+// Tìm và huỷ challenge: mỗi challenge chỉ mở được 1 lệnh
+static bool challenge_consume(const char *nonce) {
+    int64_t now = esp_timer_get_time();
+    bool found = false;
+    taskENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < LAN_AUTH_CHALLENGES && !found; i++) {
+        if (!challenge_live(i, now) || strcmp(s_challenges[i].nonce, nonce) != 0) continue;
+        s_challenges[i].issued_us = 0;
+        found = true;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return found;
+}
+
+lan_auth_result_t lan_auth_verify(const char *cmd, int64_t ts, const char *nonce, const char *sig_hex) {
+    if (!s_has_key) return LAN_AUTH_NO_KEY;
+    if (!cmd || !sig_hex || !nonce_valid(nonce) || ts <= 0) return LAN_AUTH_BAD_REQUEST;
+
+    // 1. Chữ ký trước: request không ký không được tiêu challenge hay đụng đồng hồ
+    char msg[128];
+    int len = lan_auth_canonical(msg, sizeof(msg), cmd, ts, nonce);
+    if (len <= 0 || len >= (int)sizeof(msg)) return LAN_AUTH_BAD_REQUEST;
+    if (!lan_auth_check_signature(s_key, sizeof(s_key), msg, len, sig_hex)) return LAN_AUTH_BAD_SIGNATURE;
+
+    // 2. Chống phát lại: nonce phải là challenge khoá vừa cấp, chưa dùng
+    if (!challenge_consume(nonce)) return LAN_AUTH_REPLAY;
+
+    // 3. Thời gian. Chưa SNTP (LAN không Internet): lệnh gắn challenge mới là lệnh App vừa ký -> tin ts
+    time_t now = time(NULL);
+    if (now < 1700000000) {
+        struct timeval tv = { .tv_sec = (time_t)ts, .tv_usec = 0 };
+        settimeofday(&tv, NULL);
+        ESP_LOGW(TAG, "Clock set from challenge-bound command");
+        return LAN_AUTH_OK;
+    }
+    if (ts > now + LAN_AUTH_WINDOW_S || ts < now - LAN_AUTH_WINDOW_S) return LAN_AUTH_EXPIRED;
+    return LAN_AUTH_OK;
+}
+
+bool lan_auth_check_mac(const char *nonce, const uint8_t *data, size_t len, const uint8_t *mac) {
+    if (!s_has_key || !nonce_valid(nonce) || !mac) return false;
+    uint8_t expect[32];
+    mbedtls_md_context_t ctx;
+    mbedtls_md_init(&ctx);
+    int rc = mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    if (rc == 0) rc = mbedtls_md_hmac_starts(&ctx, s_key, sizeof(s_key));
+    if (rc == 0) rc = mbedtls_md_hmac_update(&ctx, (const unsigned char *)nonce, LAN_AUTH_NONCE_LEN);
+    if (rc == 0 && len) rc = mbedtls_md_hmac_update(&ctx, data, len);
+    if (rc == 0) rc = mbedtls_md_hmac_finish(&ctx, expect);
+    mbedtls_md_free(&ctx);
+    if (rc != 0) return false;
+    uint8_t diff = 0;
+    for (size_t i = 0; i < sizeof(expect); i++) diff |= expect[i] ^ mac[i];
+    return diff == 0;
+}
+
+const char *lan_auth_result_name(lan_auth_result_t r) {
+    switch (r) {
+    case LAN_AUTH_OK:            return "ok";
+    case LAN_AUTH_NO_KEY:        return "no_key";
+    case LAN_AUTH_BAD_REQUEST:   return "bad_request";
+    case LAN_AUTH_BAD_SIGNATURE: return "bad_signature";
+    case LAN_AUTH_EXPIRED:       return "expired";
+    case LAN_AUTH_REPLAY:        return "replay";
+    }
+    return "unknown";
+}
+
+bool lan_auth_has_key(void) { return s_has_key; }
+
+esp_err_t lan_auth_save_key_hex(const char *hex, const char *rekey_sig) {
+    uint8_t key[LAN_AUTH_KEY_LEN];
+    if (!hex_decode(hex, key, sizeof(key))) return ESP_ERR_INVALID_ARG;
+    // BLE provisioning không xác thực: có khoá rồi thì chỉ người giữ khoá cũ mới đổi được
+    if (s_has_key) {
+        char msg[8 + LAN_AUTH_KEY_LEN * 2];
+        int n = snprintf(msg, sizeof(msg), "rekey|%s", hex);
+        if (!rekey_sig || !lan_auth_check_signature(s_key, sizeof(s_key), msg, n, rekey_sig)) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    nvs_handle_t h;
+    esp_err_t err = nvs_open("nvs", NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+    err = nvs_set_blob(h, "lan_key", key, sizeof(key));
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    if (err == ESP_OK) {
+        memcpy(s_key, key, sizeof(s_key));
+        s_has_key = true;
+    }
+    return err;
+}
+
+// BENCHMARK: 1 lần kiểm tra chữ ký (HMAC-SHA256 + so sánh), không đụng cache nonce
+typedef struct {
+    uint8_t key[LAN_AUTH_KEY_LEN];
+    char msg[64];
+    int msg_len;
+    char sig[65];
+} lan_bench_ctx_t;
+
+static lan_bench_ctx_t s_bench;
+
+static void lan_bench_verify(void *ctx) {
+    lan_bench_ctx_t *b = (lan_bench_ctx_t *)ctx;
+    lan_auth_check_signature(b->key, sizeof(b->key), b->msg, b->msg_len, b->sig);
+}
+
+static void lan_bench_setup(void) {
+    for (int i = 0; i < LAN_AUTH_KEY_LEN; i++) s_bench.key[i] = (uint8_t)(i * 37 + 11);
+    s_bench.msg_len = lan_auth_canonical(s_bench.msg, sizeof(s_bench.msg), "open", 1700000000LL,
+                                         "0123456789abcdef0123456789abcdef");
+    uint8_t mac[32];
+    mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), s_bench.key, sizeof(s_bench.key),
+                    (const unsigned char *)s_bench.msg, s_bench.msg_len, mac);
+    for (int i = 0; i < 32; i++) snprintf(s_bench.sig + 2 * i, 3, "%02x", mac[i]);
+    bench_register("lan_verify", lan_bench_verify, &s_bench);
+}
+
+void lan_auth_init(void) {
+    nvs_handle_t h;
+    if (nvs_open("nvs", NVS_READONLY, &h) == ESP_OK) {
+        size_t len = sizeof(s_key);
+        s_has_key = (nvs_get_blob(h, "lan_key", s_key, &len) == ESP_OK && len == sizeof(s_key));
+        nvs_close(h);
+    }
+    ESP_LOGI(TAG, "LAN control key %s", s_has_key ? "loaded" : "not provisioned (signed API disabled)");
+    lan_bench_setup();
+}
@@ -0,0 +1,70 @@
+#ifndef LAN_AUTH_H
+#define LAN_AUTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Khoá bí mật dùng chung với App (nạp qua BLE provisioning, trường "lan_key" dạng hex)
+#define LAN_AUTH_KEY_LEN        32
+// Lệch giờ tối đa cho phép giữa App và khoá (s), chỉ kiểm khi khoá đã có giờ
+#define LAN_AUTH_WINDOW_S       30
+// Challenge do khoá cấp (GET /api/nonce): 16 byte ngẫu nhiên dạng hex, dùng 1 lần.
+// Chống phát lại không dựa vào đồng hồ: lệnh cũ bắt được mang nonce không còn chờ -> bị từ chối,
+// kể cả sau khi khởi động lại chưa có SNTP.
+#define LAN_AUTH_NONCE_LEN      32
+#define LAN_AUTH_CHALLENGES     8       // Challenge chưa dùng tối đa (đầy -> thay cái cũ nhất)
+#define LAN_AUTH_CHALLENGE_TTL_MS 30000 // Tính theo esp_timer, không theo giờ thực
+
+// GET /open không ký: mặc định trả 403, cửa chỉ mở qua /api/cmd đã ký (hoặc cloud / khuôn mặt).
+// Đặt 1 khi build để bật lại cho script thử nghiệm trong LAN tin cậy.
+#ifndef LAN_ALLOW_UNSIGNED_OPEN
+#define LAN_ALLOW_UNSIGNED_OPEN 0
+#endif
+
+typedef enum {
+    LAN_AUTH_OK = 0,
+    LAN_AUTH_NO_KEY,        // Chưa nạp khoá
+    LAN_AUTH_BAD_REQUEST,   // Thiếu trường / nonce sai định dạng
+    LAN_AUTH_BAD_SIGNATURE,
+    LAN_AUTH_EXPIRED,       // ts lệch quá LAN_AUTH_WINDOW_S
+    LAN_AUTH_REPLAY,        // nonce không phải challenge đang chờ (đã dùng, hết hạn, không do khoá cấp)
+} lan_auth_result_t;
+
+// Nạp khoá từ NVS + đăng ký benchmark
+void lan_auth_init(void);
+bool lan_auth_has_key(void);
+// 64 ký tự hex -> 32 byte, lưu NVS. Chỉ nhận khi chưa có khoá; đổi khoá phải kèm
+// rekey_sig = hex HMAC-SHA256(khoá cũ, "rekey|<hex mới>"), thiếu / sai -> ESP_ERR_INVALID_STATE.
+esp_err_t lan_auth_save_key_hex(const char *hex, const char *rekey_sig);
+
+// Chuỗi được ký: "<cmd>|<ts>|<nonce>", chữ ký = hex thường của HMAC-SHA256(key, chuỗi)
+int lan_auth_canonical(char *buf, size_t len, const char *cmd, int64_t ts, const char *nonce);
+
+// Kiểm tra chữ ký (so sánh thời gian hằng). Không phụ thuộc trạng thái -> kiểm thử được trên host.
+bool lan_auth_check_signature(const uint8_t *key, size_t key_len, const char *msg, size_t msg_len, const char *sig_hex);
+
+// Cấp challenge mới vào out (LAN_AUTH_NONCE_LEN + 1 byte)
+void lan_auth_issue_nonce(char *out);
+
+// Kiểm tra đầy đủ 1 lệnh: chữ ký, nonce là challenge đang chờ (dùng xong thì huỷ), thời gian.
+// Khoá chưa có giờ (chưa SNTP): lệnh hợp lệ đặt đồng hồ theo ts (an toàn vì lệnh gắn challenge mới).
+lan_auth_result_t lan_auth_verify(const char *cmd, int64_t ts, const char *nonce, const char *sig_hex);
+
+// Chữ ký cho dữ liệu dài gắn với 1 challenge đã cấp (vd. gallery nạp qua BLE):
+// mac (32 byte) = HMAC-SHA256(key, nonce || data). Không tiêu challenge (phiên đã qua lan_auth_verify).
+// false nếu chưa có khoá / nonce sai định dạng / sai chữ ký. So sánh thời gian hằng.
+bool lan_auth_check_mac(const char *nonce, const uint8_t *data, size_t len, const uint8_t *mac);
+
+const char *lan_auth_result_name(lan_auth_result_t r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -8,7 +8,7 @@
 #include "esp_wifi.h"
 #include "esp_netif.h"
 #include "esp_spiffs.h"
-#include "mdns.h" 
+#include "event_store.h"
 
 #include "wifi_manager.h"
 #include "camera_init.h"
@@ -16,46 +16,74 @@
 #include "face_detect.h"     
 #include "lock_ctrl.h"       
 #include "supabase_client.h" 
-#include "global_state.h" 
+#include "perf_monitor.h"
+#include "mem_pool.h"
+#include "camera_ctrl.h"
+#include "boot_mgr.h"
+#include "net_supervisor.h"
+#include "lan_auth.h"
+#include "access_stats.h"
+#include "face_roi.h"
+#include "uplink_sched.h"
+#include "event_bus.h"
+#include "bench_console.h"
 
 static const char *TAG = "MAIN";
 SemaphoreHandle_t xCameraMutex = NULL;
-extern void init_ble_server(void);
 
-// Khởi tạo biến cờ toàn cục
-volatile bool g_is_enrolling = false;
-
-static void init_spiffs(void) {
+static esp_err_t init_spiffs(void) {
     esp_vfs_spiffs_conf_t conf = { .base_path = "/spiffs", .partition_label = "spiffs", .max_files = 5, .format_if_mount_failed = true };
-    if (esp_vfs_spiffs_register(&conf) != ESP_OK) ESP_LOGE(TAG, "Failed to mount SPIFFS");
+    esp_err_t err = esp_vfs_spiffs_register(&conf);
+    if (err != ESP_OK) { ESP_LOGE(TAG, "Failed to mount SPIFFS"); return err; }
+    // Kho sự kiện local: nạp segment + chỉ mục trước khi AI ghi sự kiện đầu tiên
+    return event_store_init();
 }
 
-// --- [BẮT ĐẦU] ĐOẠN CODE MDNS MỚI THÊM VÀO ---
-void start_mdns_service()
-{
-    // 1. Khởi tạo mDNS
-    esp_err_t err = mdns_init();
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "MDNS Init failed: %d", err);
-        return;
-    }
-
-    // 2. http://khoathongminh.local
-    mdns_hostname_set("khoathongminh");
+// --- CÁC BƯỚC KHỞI ĐỘNG (chạy song song theo phụ thuộc) ---
+enum {
+    STAGE_SPIFFS = 0,
+    STAGE_CAMERA,
+    STAGE_AI,
+    STAGE_RECOGNITION,
+    STAGE_NET,
+    STAGE_COUNT
+};
+
+static esp_err_t stage_camera(void) {
+    esp_err_t err = init_camera();
+    if (err != ESP_OK) return err;
+    xCameraMutex = xSemaphoreCreateMutex();
+    camera_ctrl_init();
+    return ESP_OK;
+}
 
-    // 3. Đặt tên mô tả (Instance Name)
-    mdns_instance_name_set("Smart Lock Web Server");
+// Nạp model + gallery trên flash: không cần camera hay mạng
+static esp_err_t stage_ai(void) {
+    return init_face_detection();
+}
 
-    // 4. Đăng ký dịch vụ HTTP để máy tính/điện thoại dễ tìm thấy (ZeroConf)
-    mdns_service_add(NULL, "_http", "_tcp", 80, NULL, 0);
+// Nhận diện chạy ngay với gallery local, không chờ WiFi / cloud
+static esp_err_t stage_recognition(void) {
+    start_face_recognition_task();
+    return ESP_OK;
+}
 
-    ESP_LOGI(TAG, "mDNS da khoi dong! Truy cap tai: http://khoathongminh.local");
+// WiFi / BLE / HTTP / cloud do supervisor quản lý, có thể mất và có lại bất cứ lúc nào
+static esp_err_t stage_net(void) {
+    return net_supervisor_start(BOOT_DEP(STAGE_AI));
 }
-// --- [KẾT THÚC] ĐOẠN CODE MDNS MỚI THÊM VÀO ---
+
+static const boot_stage_t BOOT_STAGES[STAGE_COUNT] = {
+    [STAGE_SPIFFS]      = { "boot_spiffs", init_spiffs,       0,                                          3072, 5, tskNO_AFFINITY },
+    [STAGE_CAMERA]      = { "boot_camera", stage_camera,      0,                                          4096, 6, 1 },
+    [STAGE_AI]          = { "boot_ai",     stage_ai,          0,                                          8192, 6, 1 },
+    [STAGE_RECOGNITION] = { "boot_recog",  stage_recognition, BOOT_DEP(STAGE_CAMERA) | BOOT_DEP(STAGE_AI), 3072, 6, 1 },
+    [STAGE_NET]         = { "boot_net",    stage_net,         0,                                          3072, 5, 0 },
+};
 
 void app_main(void)
 {
-    // 1. Khởi tạo NVS (Bộ nhớ lưu cấu hình)
+    // 1. Khởi tạo NVS (Bộ nhớ lưu cấu hình) - mọi bước khác đều cần
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
       ESP_ERROR_CHECK(nvs_flash_erase());
@@ -63,89 +91,65 @@ void app_main(void)
     }
     ESP_ERROR_CHECK(ret);
 
-    // 2. Khởi tạo các thành phần phần cứng cơ bản
-    init_spiffs();
-    
-    // Khởi tạo hệ thống khóa (Relay, Sensor, Nút bấm)
+    // Bật trace & lấy mẫu CPU/stack sớm nhất có thể để thấy cả giai đoạn khởi động
+    perf_monitor_init();
+
+    // Cấp phát trước các pool buffer lớn (RGB, embedding, JSON) khi heap còn liền mạch
+    mem_pool_init();
+
+    // Bus sự kiện: trước mọi module subscribe / publish
+    event_bus_init();
+
+    // Khởi tạo hệ thống khóa (Relay, Sensor, Nút bấm) - nhanh, làm ngay để nút EXIT dùng được
     lock_init(); 
 
-    if(init_camera() == ESP_OK) {
-        xCameraMutex = xSemaphoreCreateMutex();
-        init_face_detection();
-    }
+    // Hàng đợi log cloud + nhật ký local: sẵn sàng trước khi nhận diện có thể mở cửa
+    // (mọi request cloud xin lượt qua uplink_sched)
+    uplink_sched_init();
+    access_stats_init();
+    supabase_outbox_init();
 
-    // 3. Load cấu hình WiFi & Database
-    char dummy[10];
-    bool has_wifi = (wifi_load_config(dummy, dummy) == ESP_OK);
-    bool has_sup  = (supabase_load_config() == ESP_OK);
-
-    // 4. Logic kết nối mạng
-    if (has_wifi && has_sup) {
-        ESP_LOGI(TAG, "Found Config. Connecting to WiFi...");
-        
-        if (wifi_init_sta() == ESP_OK) {
-            ESP_LOGI(TAG, "WiFi Connected! Starting Services...");
-            
-            // --- [BẮT ĐẦU] GỌI HÀM MDNS TẠI ĐÂY ---
-            start_mdns_service(); 
-            // --- [KẾT THÚC] ---
-
-            esp_netif_ip_info_t ip_info;
-            esp_netif_t* netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
-            if (netif) {
-                esp_netif_get_ip_info(netif, &ip_info);
-                printf("Web Interface: http://" IPSTR "\n", IP2STR(&ip_info.ip));
-            }
+    // Khoá ký lệnh LAN (/api/cmd)
+    lan_auth_init();
 
-            supabase_init();
-            supabase_sync_users();
-            start_http_server();
-            start_face_recognition_task();
-
-            // Biến đếm để quản lý thời gian check lệnh remote
-            int cmd_check_tick = 0; 
-
-            // VÒNG LẶP CHÍNH (ONLINE MODE) 
-            while (1) {
-                // A. LOGIC NÚT BẤM CẢM ỨNG
-                if (lock_get_button_status() == 1) {
-                    ESP_LOGI(TAG, "Phat hien nut bam EXIT -> Mo khoa!");
-                    lock_open_door(); // Gọi hàm mở khóa (đã có logic tự đóng)
-                    
-                    // Chống rung: Chờ nhả tay ra mới chạy tiếp
-                    while (lock_get_button_status() == 1) {
-                        vTaskDelay(pdMS_TO_TICKS(100));
-                    }
-                }
-
-                // B. LOGIC REMOTE COMMAND (Chạy mỗi 3 giây)
-                if (cmd_check_tick >= 30) { 
-                    check_remote_command(); 
-                    cmd_check_tick = 0;
-                }
-                cmd_check_tick++;
-
-                vTaskDelay(pdMS_TO_TICKS(100)); 
-            }
-        } else {
-            ESP_LOGE(TAG, "WiFi Connection Failed. Switching to BLE...");
-            init_ble_server();
-        }
-    } else {
-        ESP_LOGW(TAG, "Missing Configuration (WiFi: %d, Supabase: %d)", has_wifi, has_sup);
-        ESP_LOGW(TAG, "Starting BLE Provisioning Mode...");
-        init_ble_server();
-    }
+    // Vùng nhận diện + cỡ mặt theo từng khoá (trước khi task AI chạy)
+    face_roi_init();
+
+    // 2. Khởi động song song: camera + AI -> nhận diện, supervisor mạng (WiFi / BLE / HTTP / cloud) độc lập
+    boot_start(BOOT_STAGES, STAGE_COUNT);
+
+    // Lệnh "bench" qua serial (CONFIG_BENCH_CONSOLE)
+    bench_console_start();
+
+    // 3. Vòng lặp chính: chỉ phục vụ nút EXIT, không phụ thuộc trạng thái mạng
+    bool profile_logged = false;
 
-    // --- VÒNG LẶP DỰ PHÒNG (OFFLINE / BLE MODE) ---
-    while(1) {
+    while (1) {
+        // A. LOGIC NÚT BẤM CẢM ỨNG
         if (lock_get_button_status() == 1) {
-            ESP_LOGI(TAG, "(Offline Mode) Phat hien nut bam EXIT -> Mo khoa!");
-            lock_open_door();
+            ESP_LOGI(TAG, "Phat hien nut bam EXIT -> Mo khoa!");
+            bus_event_t ev = { .type = BUS_EV_COMMAND };
+            ev.command.cmd = BUS_CMD_OPEN;
+            ev.command.source = BUS_SRC_BUTTON;
+            ev.command.ref = -1;
+            // lock_ctrl mở khóa (đã có logic tự đóng). Bus đầy (hiếm): thử lại thay vì bỏ lần bấm
+            for (int tries = 0; !event_bus_publish(&ev) && tries < 20; tries++) {
+                vTaskDelay(pdMS_TO_TICKS(10));
+            }
+            
+            // Chống rung: Chờ nhả tay ra mới chạy tiếp
             while (lock_get_button_status() == 1) {
                 vTaskDelay(pdMS_TO_TICKS(100));
             }
         }
-        vTaskDelay(pdMS_TO_TICKS(100));
+
+        if (!profile_logged && boot_all_done()) {
+            profile_logged = true;
+            char profile[768];
+            boot_profile_json(profile, sizeof(profile));
+            ESP_LOGI(TAG, "Boot profile: %s", profile);
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(100)); 
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,154 @@
+#include "mem_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+
+static const char *TAG = "MEM_POOL";
+
+// Bitmap 32 bit cho mỗi lớp -> tối đa 32 khối / lớp
+#define MEM_POOL_MAX_BLOCKS 32
+
+typedef struct {
+    const char *name;
+    size_t block_size;
+    int count;
+    uint32_t caps;
+
+    uint8_t *arena;          // Vùng nhớ liên tục count * block_size
+    uint32_t used_mask;      // Bit i = 1 -> khối i đang dùng
+    size_t requested[MEM_POOL_MAX_BLOCKS]; // Kích thước thực sự được xin (tính phân mảnh trong)
+
+    // Thống kê
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t fallbacks;      // Hết khối -> phải xin heap
+    int peak_in_use;
+} mem_pool_t;
+
+static mem_pool_t s_pools[MEM_POOL_CLASS_COUNT] = {
+#define MEM_POOL_INIT(n, size, cnt, cap) { .name = #n, .block_size = (size), .count = (cnt), .caps = (cap) },
+    MEM_POOL_CLASSES(MEM_POOL_INIT)
+#undef MEM_POOL_INIT
+};
+
+static uint32_t s_oversize = 0;   // Yêu cầu lớn hơn mọi lớp
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void mem_pool_init(void) {
+    for (int c = 0; c < MEM_POOL_CLASS_COUNT; c++) {
+        mem_pool_t *p = &s_pools[c];
+        if (p->arena) continue;
+        if (p->count > MEM_POOL_MAX_BLOCKS) p->count = MEM_POOL_MAX_BLOCKS;
+
+        p->arena = (uint8_t *)heap_caps_malloc(p->block_size * p->count, p->caps);
+        if (!p->arena) {
+            // Không đủ bộ nhớ: lớp này sẽ luôn fallback về heap, hệ thống vẫn chạy được
+            ESP_LOGE(TAG, "Arena %s (%d x %u) alloc failed", p->name, p->count, (unsigned)p->block_size);
+            p->count = 0;
+            continue;
+        }
+        ESP_LOGI(TAG, "Class %-6s: %2d x %6u bytes", p->name, p->count, (unsigned)p->block_size);
+    }
+}
+
+void *mem_pool_alloc(size_t size) {
+    if (size == 0) return NULL;
+
+    for (int c = 0; c < MEM_POOL_CLASS_COUNT; c++) {
+        mem_pool_t *p = &s_pools[c];
+        if (size > p->block_size) continue;
+
+        void *ptr = NULL;
+        taskENTER_CRITICAL(&s_lock);
+        for (int i = 0; i < p->count; i++) {
+            if (!(p->used_mask & (1UL << i))) {
+                p->used_mask |= (1UL << i);
+                p->requested[i] = size;
+                p->allocs++;
+                int in_use = __builtin_popcount(p->used_mask);
+                if (in_use > p->peak_in_use) p->peak_in_use = in_use;
+                ptr = p->arena + (size_t)i * p->block_size;
+                break;
+            }
+        }
+        if (!ptr) p->fallbacks++;
+        taskEXIT_CRITICAL(&s_lock);
+
+        if (ptr) return ptr;
+        // Lớp vừa khít đã hết: không lấn sang lớp lớn hơn (tránh chiếm khối RGB/LARGE)
+        break;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    if (size > s_pools[MEM_POOL_CLASS_COUNT - 1].block_size) s_oversize++;
+    taskEXIT_CRITICAL(&s_lock);
+    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+}
+
+void mem_pool_free(void *ptr) {
+    if (!ptr) return;
+    uint8_t *b = (uint8_t *)ptr;
+
+    for (int c = 0; c < MEM_POOL_CLASS_COUNT; c++) {
+        mem_pool_t *p = &s_pools[c];
+        if (!p->arena) continue;
+        if (b < p->arena || b >= p->arena + p->block_size * p->count) continue;
+
+        int i = (b - p->arena) / p->block_size;
+        taskENTER_CRITICAL(&s_lock);
+        if (p->used_mask & (1UL << i)) {
+            p->used_mask &= ~(1UL << i);
+            p->requested[i] = 0;
+            p->frees++;
+        } else {
+            ESP_LOGE(TAG, "Double free in class %s block %d", p->name, i);
+        }
+        taskEXIT_CRITICAL(&s_lock);
+        return;
+    }
+    // Không thuộc arena nào -> khối fallback
+    heap_caps_free(ptr);
+}
+
+size_t mem_pool_report_json(char *buf, size_t len) {
+    size_t off = snprintf(buf, len, "{\"classes\":[");
+
+    for (int c = 0; c < MEM_POOL_CLASS_COUNT && off < len; c++) {
+        mem_pool_t *p = &s_pools[c];
+        taskENTER_CRITICAL(&s_lock);
+        int in_use = __builtin_popcount(p->used_mask);
+        size_t req_total = 0;
+        for (int i = 0; i < p->count; i++) req_total += p->requested[i];
+        uint32_t allocs = p->allocs, frees = p->frees, fallbacks = p->fallbacks;
+        int peak = p->peak_in_use;
+        taskEXIT_CRITICAL(&s_lock);
+
+        // Phân mảnh trong: phần khối đã cấp nhưng không dùng tới
+        float internal_frag = in_use ? 1.0f - (float)req_total / (float)(in_use * p->block_size) : 0.0f;
+        off += snprintf(buf + off, len - off,
+                        "%s{\"name\":\"%s\",\"block\":%u,\"count\":%d,\"in_use\":%d,\"peak\":%d,"
+                        "\"allocs\":%lu,\"frees\":%lu,\"fallbacks\":%lu,\"internal_frag\":%.2f}",
+                        c ? "," : "", p->name, (unsigned)p->block_size, p->count, in_use, peak,
+                        (unsigned long)allocs, (unsigned long)frees, (unsigned long)fallbacks, internal_frag);
+    }
+
+    // Phân mảnh ngoài của heap: 1 - (khối trống lớn nhất / tổng trống)
+    size_t int_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    size_t int_big = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    size_t ps_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    size_t ps_big = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+    if (off < len) {
+        off += snprintf(buf + off, len - off,
+                        "],\"oversize\":%lu,\"heap\":{"
+                        "\"internal\":{\"free\":%u,\"largest\":%u,\"min_free\":%u,\"frag\":%.2f},"
+                        "\"psram\":{\"free\":%u,\"largest\":%u,\"min_free\":%u,\"frag\":%.2f}}}",
+                        (unsigned long)s_oversize,
+                        (unsigned)int_free, (unsigned)int_big, (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+                        int_free ? 1.0f - (float)int_big / (float)int_free : 0.0f,
+                        (unsigned)ps_free, (unsigned)ps_big, (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM),
+                        ps_free ? 1.0f - (float)ps_big / (float)ps_free : 0.0f);
+    }
+    return off < len ? off : 0;
+}
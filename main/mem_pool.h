@@ -0,0 +1,51 @@
+#ifndef MEM_POOL_H
+#define MEM_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_heap_caps.h"
+#include "face_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Kích thước khối dùng chung với code gọi
+#define MEM_POOL_RGB_SIZE     (320 * 240 * 3)   // 1 frame QVGA RGB888
+#define MEM_POOL_LARGE_SIZE   (128 * 1024)      // Buffer tải danh sách user khi sync
+
+// CẤU HÌNH CÁC LỚP SLAB (compile-time)
+// X(tên, kích thước khối, số khối, vùng nhớ)
+// Mỗi lớp được cấp phát 1 lần lúc khởi động -> không bị phân mảnh theo thời gian chạy
+#define MEM_POOL_CLASSES(X) \
+    X(SMALL,  1024,                 8, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) /* JSON log, ack */        \
+    X(EMBED,  FACE_EMBED_BYTES,     8, MALLOC_CAP_SPIRAM)                     /* 1 embedding */          \
+    X(MEDIUM, 16 * 1024,            2, MALLOC_CAP_SPIRAM)                     /* polling, JSON face */   \
+    X(RGB,    MEM_POOL_RGB_SIZE,    1, MALLOC_CAP_SPIRAM)                     /* giải nén JPEG (task AI) */\
+    X(LARGE,  MEM_POOL_LARGE_SIZE,  1, MALLOC_CAP_SPIRAM)                     /* sync users */
+
+typedef enum {
+#define MEM_POOL_ENUM(name, size, count, caps) MEM_POOL_##name,
+    MEM_POOL_CLASSES(MEM_POOL_ENUM)
+#undef MEM_POOL_ENUM
+    MEM_POOL_CLASS_COUNT
+} mem_pool_class_t;
+
+// Khởi tạo toàn bộ các lớp (gọi 1 lần trong app_main, trước camera/AI)
+void mem_pool_init(void);
+
+// Lấy khối nhỏ nhất đủ chứa size. Nếu lớp đó hết khối hoặc size quá lớn
+// thì rơi về heap_caps_malloc (PSRAM) và được tính là "fallback" trong thống kê.
+void *mem_pool_alloc(size_t size);
+
+// Trả khối về pool (hoặc free() nếu là khối fallback). Chấp nhận NULL.
+void mem_pool_free(void *ptr);
+
+// Báo cáo thống kê + phân mảnh heap dạng JSON. Trả về số byte đã ghi.
+size_t mem_pool_report_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
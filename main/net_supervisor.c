@@ -0,0 +1,228 @@
+#include "net_supervisor.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_netif.h"
+#include "mdns.h"
+
+#include "wifi_manager.h"
+#include "http_server.h"
+#include "supabase_client.h"
+#include "ble_server.h"
+#include "ble_bulk.h"
+#include "boot_mgr.h"
+#include "perf_monitor.h"
+#include "access_stats.h"
+#include "face_detect.h"
+#include "uplink_sched.h"
+
+static const char *TAG = "NET_SUP";
+
+static const char *STATE_NAMES[NET_STATE_COUNT] = { "offline", "connecting", "online", "provisioning" };
+
+static TaskHandle_t s_task = NULL;
+static volatile net_state_t s_state = NET_STATE_OFFLINE;
+static volatile bool s_config_changed = false;
+static int s_fail_count = 0;
+static uint32_t s_connects = 0;
+static int64_t s_state_since_ms = 0;
+static int64_t s_offline_total_ms = 0;
+
+// Các dịch vụ chỉ khởi động 1 lần, sống qua các lần mất / có lại mạng
+static bool s_mdns_started = false;
+static bool s_http_started = false;
+static bool s_cloud_synced = false;
+static uint32_t s_sync_deps = 0;
+
+static void net_set_state(net_state_t st) {
+    if (st == s_state) return;
+    int64_t now = esp_timer_get_time() / 1000;
+    if (s_state != NET_STATE_ONLINE) s_offline_total_ms += now - s_state_since_ms;
+    ESP_LOGI(TAG, "%s -> %s", STATE_NAMES[s_state], STATE_NAMES[st]);
+    s_state = st;
+    s_state_since_ms = now;
+
+    char msg[64];
+    snprintf(msg, sizeof(msg), "{\"type\":\"net\",\"state\":\"%s\"}", STATE_NAMES[st]);
+    ws_send_message(msg);
+}
+
+// --- MDNS ---
+static void start_mdns_service(void)
+{
+    // 1. Khởi tạo mDNS
+    esp_err_t err = mdns_init();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "MDNS Init failed: %d", err);
+        return;
+    }
+
+    // 2. http://khoathongminh.local
+    mdns_hostname_set("khoathongminh");
+
+    // 3. Đặt tên mô tả (Instance Name)
+    mdns_instance_name_set("Smart Lock Web Server");
+
+    // 4. Đăng ký dịch vụ HTTP để máy tính/điện thoại dễ tìm thấy (ZeroConf)
+    mdns_service_add(NULL, "_http", "_tcp", 80, NULL, 0);
+
+    // 5. Dịch vụ điều khiển LAN: App tìm khoá qua _smartlock._tcp, xin challenge ở nonce rồi gửi lệnh đã ký tới path
+    mdns_txt_item_t lan_txt[] = {
+        { "path", "/api/cmd" },
+        { "nonce", "/api/nonce" },
+        { "auth", "hmac-sha256" },
+        { "id",   "S3_LOCK_01" },
+    };
+    mdns_service_add(NULL, "_smartlock", "_tcp", 80, lan_txt, sizeof(lan_txt) / sizeof(lan_txt[0]));
+
+    ESP_LOGI(TAG, "mDNS da khoi dong! Truy cap tai: http://khoathongminh.local");
+}
+
+// Vừa có IP: bật các dịch vụ mạng (lần đầu) và tắt BLE để nhường sóng cho WiFi
+static void net_on_online(void) {
+    esp_netif_ip_info_t ip_info;
+    esp_netif_t* netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    if (netif && esp_netif_get_ip_info(netif, &ip_info) == ESP_OK) {
+        printf("Web Interface: http://" IPSTR "\n", IP2STR(&ip_info.ip));
+    }
+
+    if (!s_mdns_started) { start_mdns_service(); s_mdns_started = true; }
+    if (!s_http_started) { s_http_started = (start_http_server() == ESP_OK); }
+    if (ble_server_is_running()) deinit_ble_server();
+
+    if (!s_cloud_synced && boot_wait(s_sync_deps, portMAX_DELAY)) {
+        PERF_TRACE_BEGIN(t_cloud);
+        supabase_init();
+        supabase_sync_users();
+        PERF_TRACE_END(t_cloud, "net_cloud_sync");
+        s_cloud_synced = true;
+        boot_milestone(BOOT_MS_CLOUD_SYNCED);
+    }
+}
+
+static void net_supervisor_task(void *pvParameters) {
+    bool configured = false;
+    bool sta_started = false;   // Sau lần đầu, wifi_manager tự kết nối lại (backoff) - supervisor chỉ theo dõi
+    s_state_since_ms = esp_timer_get_time() / 1000;
+
+    while (1) {
+        if (s_config_changed) {
+            s_config_changed = false;
+            configured = false;
+            sta_started = false;
+            s_fail_count = 0;
+        }
+
+        // 1. Nạp cấu hình; thiếu thì chỉ bật BLE và chờ App
+        if (!configured) {
+            char ssid[33], pass[65];
+            bool has_wifi = (wifi_load_config(ssid, pass) == ESP_OK);
+            bool has_sup  = (supabase_load_config() == ESP_OK);
+            if (!has_wifi || !has_sup) {
+                ESP_LOGW(TAG, "Missing Configuration (WiFi: %d, Supabase: %d)", has_wifi, has_sup);
+                net_set_state(NET_STATE_PROVISIONING);
+                init_ble_server();
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                continue;
+            }
+            configured = true;
+            // Cấu hình mới: buộc kết nối lại với SSID mới dù đang online
+            if (s_state == NET_STATE_ONLINE) net_set_state(NET_STATE_OFFLINE);
+        }
+
+        // 2. Chưa có mạng -> khởi động STA (lần đầu / cấu hình mới) hoặc chờ wifi_manager kết nối lại
+        if (s_state != NET_STATE_ONLINE || !wifi_is_connected()) {
+            esp_err_t err = ESP_OK;
+            if (!sta_started) {
+                net_set_state(NET_STATE_CONNECTING);
+                PERF_TRACE_BEGIN(t_wifi);
+                err = wifi_init_sta();
+                PERF_TRACE_END(t_wifi, "net_wifi_connect");
+                sta_started = true;
+                if (err != ESP_OK) s_fail_count++;
+            } else if (!wifi_is_connected()) {
+                err = ESP_ERR_TIMEOUT;
+            }
+
+            if (err != ESP_OK) {
+                net_set_state(NET_STATE_OFFLINE);
+                if (s_fail_count >= NET_BLE_AFTER_FAILS && !ble_server_is_running()) {
+                    ESP_LOGE(TAG, "WiFi unavailable. Starting BLE Provisioning Mode...");
+                    init_ble_server();
+                }
+                face_adapt_persist_if_due(false);
+                // Kiểm tra lại sau, hoặc dậy sớm khi BLE nhận cấu hình mới
+                ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(NET_OFFLINE_POLL_MS));
+                continue;
+            }
+
+            s_fail_count = 0;
+            s_connects++;
+            net_set_state(NET_STATE_ONLINE);
+            net_on_online();
+        }
+
+        // 3. Online: hỏi lệnh remote định kỳ, đẩy bản tóm tắt thống kê / mẫu mặt đã học khi tới hạn
+        check_remote_command();
+        if (access_stats_publish_due()) supabase_publish_stats();
+        access_stats_save_if_due();
+        face_adapt_persist_if_due(true);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(NET_CMD_POLL_MS));
+    }
+}
+
+esp_err_t net_supervisor_start(uint32_t sync_deps) {
+    if (s_task) return ESP_OK;
+    s_sync_deps = sync_deps;
+    if (xTaskCreatePinnedToCore(net_supervisor_task, "net_sup", 8192, NULL, 4, &s_task, 0) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void net_supervisor_config_changed(void) {
+    s_config_changed = true;
+    if (s_task) xTaskNotifyGive(s_task);
+}
+
+net_state_t net_supervisor_get_state(void) { return s_state; }
+
+size_t net_supervisor_status_json(char *buf, size_t len) {
+    int64_t now = esp_timer_get_time() / 1000;
+    int64_t offline_ms = s_offline_total_ms + (s_state != NET_STATE_ONLINE ? now - s_state_since_ms : 0);
+    int n = snprintf(buf, len,
+                     "{\"state\":\"%s\",\"since_ms\":%lld,\"connects\":%lu,\"fails\":%d,\"offline_ms\":%lld,"
+                     "\"ble\":%s,\"outbox\":",
+                     STATE_NAMES[s_state], now - s_state_since_ms, (unsigned long)s_connects, s_fail_count,
+                     offline_ms, ble_server_is_running() ? "true" : "false");
+    if (n <= 0 || (size_t)n >= len) return 0;
+    size_t off = n;
+    size_t ob = supabase_outbox_status_json(buf + off, len - off);
+    if (ob == 0) return 0;
+    off += ob;
+    n = snprintf(buf + off, len - off, ",\"wifi\":");
+    if (n <= 0 || (size_t)n >= len - off) return 0;
+    off += n;
+    size_t ws = wifi_stats_json(buf + off, len - off);
+    if (ws == 0) return 0;
+    off += ws;
+    n = snprintf(buf + off, len - off, ",\"ble_bulk\":");
+    if (n <= 0 || (size_t)n >= len - off) return 0;
+    off += n;
+    size_t bb = ble_bulk_stats_json(buf + off, len - off);
+    if (bb == 0) return 0;
+    off += bb;
+    n = snprintf(buf + off, len - off, ",\"uplink\":");
+    if (n <= 0 || (size_t)n >= len - off) return 0;
+    off += n;
+    size_t ul = uplink_stats_json(buf + off, len - off);
+    if (ul == 0) return 0;
+    off += ul;
+    if (off + 2 > len) return 0;
+    buf[off++] = '}';
+    buf[off] = '\0';
+    return off;
+}
@@ -0,0 +1,44 @@
+#ifndef NET_SUPERVISOR_H
+#define NET_SUPERVISOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Trạng thái mạng do supervisor quản lý. Nhận diện, khóa và nhật ký local không phụ thuộc trạng thái này.
+typedef enum {
+    NET_STATE_OFFLINE = 0,      // Có cấu hình nhưng chưa kết nối được, đang chờ thử lại
+    NET_STATE_CONNECTING,
+    NET_STATE_ONLINE,           // Có IP: HTTP, mDNS, cloud đang chạy
+    NET_STATE_PROVISIONING,     // Thiếu cấu hình: chỉ bật BLE chờ App
+    NET_STATE_COUNT
+} net_state_t;
+
+// Chu kỳ kiểm tra lại liên kết khi offline (việc kết nối lại do wifi_manager tự làm) (ms)
+#define NET_OFFLINE_POLL_MS      1000
+// Sau bao nhiêu lần kết nối thất bại liên tiếp thì bật BLE để App sửa cấu hình
+#define NET_BLE_AFTER_FAILS      1
+// Chu kỳ hỏi lệnh remote khi online (ms)
+#define NET_CMD_POLL_MS          3000
+
+// Tạo task supervisor, trả về ngay. Đồng bộ cloud chờ các bước boot trong sync_deps (gallery đã nạp).
+esp_err_t net_supervisor_start(uint32_t sync_deps);
+
+// BLE vừa lưu cấu hình mới -> nạp lại và kết nối (không cần khởi động lại)
+void net_supervisor_config_changed(void);
+
+net_state_t net_supervisor_get_state(void);
+
+// Trạng thái dạng JSON cho GET /net
+size_t net_supervisor_status_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
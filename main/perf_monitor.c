@@ -0,0 +1,217 @@
+#include "perf_monitor.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_cpu.h"
+
+static const char *TAG = "PERF";
+
+// RING BUFFER TRACE
+typedef struct {
+    const char *name;
+    int64_t ts_us;
+    uint32_t dur_us;
+    uint8_t core;
+    char task[16];
+} perf_event_t;
+
+static perf_event_t *s_events = NULL;
+static uint32_t s_head = 0;   // Vị trí ghi tiếp theo
+static uint32_t s_count = 0;  // Số sự kiện hợp lệ trong ring
+static portMUX_TYPE s_trace_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// KẾT QUẢ LẤY MẪU TASK
+static perf_task_info_t s_tasks[PERF_MAX_TASKS];
+static int s_task_count = 0;
+static portMUX_TYPE s_task_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void perf_trace_record(const char *name, int64_t start_us, int64_t end_us) {
+    if (!s_events) return;
+
+    // Copy tên task ra ngoài vùng critical để giữ critical section ngắn nhất có thể
+    char task[16];
+    strlcpy(task, pcTaskGetName(NULL), sizeof(task));
+    uint8_t core = (uint8_t)esp_cpu_get_core_id();
+
+    taskENTER_CRITICAL(&s_trace_lock);
+    perf_event_t *ev = &s_events[s_head];
+    ev->name = name;
+    ev->ts_us = start_us;
+    ev->dur_us = (uint32_t)(end_us - start_us);
+    ev->core = core;
+    memcpy(ev->task, task, sizeof(task));
+    s_head = (s_head + 1) % PERF_TRACE_CAPACITY;
+    if (s_count < PERF_TRACE_CAPACITY) s_count++;
+    taskEXIT_CRITICAL(&s_trace_lock);
+}
+
+void perf_trace_clear(void) {
+    taskENTER_CRITICAL(&s_trace_lock);
+    s_head = 0;
+    s_count = 0;
+    taskEXIT_CRITICAL(&s_trace_lock);
+}
+
+esp_err_t perf_trace_export(perf_write_fn write, void *ctx) {
+    if (!s_events) return ESP_ERR_INVALID_STATE;
+
+    // Bảng tên task -> tid (Chrome Trace cần tid dạng số)
+    char tids[PERF_MAX_TASKS][16];
+    int tid_count = 0;
+    char line[192];
+
+    const char *head = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    if (write(ctx, head, strlen(head)) != 0) return ESP_FAIL;
+
+    taskENTER_CRITICAL(&s_trace_lock);
+    uint32_t count = s_count;
+    uint32_t start = (s_head + PERF_TRACE_CAPACITY - s_count) % PERF_TRACE_CAPACITY;
+    taskEXIT_CRITICAL(&s_trace_lock);
+
+    bool first = true;
+    for (uint32_t i = 0; i < count; i++) {
+        perf_event_t ev;
+        // Copy từng sự kiện dưới lock vì ring có thể bị ghi đè trong lúc xuất
+        taskENTER_CRITICAL(&s_trace_lock);
+        ev = s_events[(start + i) % PERF_TRACE_CAPACITY];
+        taskEXIT_CRITICAL(&s_trace_lock);
+        if (!ev.name) continue;
+
+        int tid = -1;
+        for (int t = 0; t < tid_count; t++) {
+            if (strcmp(tids[t], ev.task) == 0) { tid = t; break; }
+        }
+        if (tid < 0 && tid_count < PERF_MAX_TASKS) {
+            strlcpy(tids[tid_count], ev.task, sizeof(tids[0]));
+            tid = tid_count++;
+        }
+
+        int n = snprintf(line, sizeof(line),
+                         "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lu,\"pid\":%u,\"tid\":%d}",
+                         first ? "" : ",", ev.name, (long long)ev.ts_us, (unsigned long)ev.dur_us, ev.core, tid);
+        if (write(ctx, line, n) != 0) return ESP_FAIL;
+        first = false;
+    }
+
+    // Metadata: đặt tên "process" theo core và "thread" theo tên task
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        int n = snprintf(line, sizeof(line),
+                         "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Core %d\"}}",
+                         first ? "" : ",", core, core);
+        if (write(ctx, line, n) != 0) return ESP_FAIL;
+        first = false;
+        for (int t = 0; t < tid_count; t++) {
+            n = snprintf(line, sizeof(line),
+                         ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                         core, t, tids[t]);
+            if (write(ctx, line, n) != 0) return ESP_FAIL;
+        }
+    }
+
+    if (write(ctx, "]}", 2) != 0) return ESP_FAIL;
+    return ESP_OK;
+}
+
+// LẤY MẪU RUN-TIME STATS
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+static void perf_sample(void) {
+    static TaskStatus_t status[PERF_MAX_TASKS];
+    // Bộ đếm lần lấy mẫu trước để tính delta theo từng task
+    static TaskHandle_t prev_handle[PERF_MAX_TASKS];
+    static configRUN_TIME_COUNTER_TYPE prev_runtime[PERF_MAX_TASKS];
+    static int prev_count = 0;
+    static configRUN_TIME_COUNTER_TYPE prev_total = 0;
+
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t n = uxTaskGetSystemState(status, PERF_MAX_TASKS, &total);
+    if (n == 0) {
+        ESP_LOGW(TAG, "Too many tasks for PERF_MAX_TASKS (%d)", PERF_MAX_TASKS);
+        return;
+    }
+    configRUN_TIME_COUNTER_TYPE total_delta = total - prev_total;
+
+    perf_task_info_t snap[PERF_MAX_TASKS];
+    // Mẫu lần này ghi riêng: bảng prev phải giữ nguyên suốt vòng tra (thứ tự task có thể đổi)
+    TaskHandle_t cur_handle[PERF_MAX_TASKS];
+    configRUN_TIME_COUNTER_TYPE cur_runtime[PERF_MAX_TASKS];
+    for (UBaseType_t i = 0; i < n; i++) {
+        configRUN_TIME_COUNTER_TYPE before = 0;
+        for (int p = 0; p < prev_count; p++) {
+            if (prev_handle[p] == status[i].xHandle) { before = prev_runtime[p]; break; }
+        }
+        // Handle được tái dùng cho task mới: bộ đếm nhỏ hơn lần trước -> coi như task mới
+        if (status[i].ulRunTimeCounter < before) before = 0;
+        strlcpy(snap[i].name, status[i].pcTaskName, sizeof(snap[i].name));
+        snap[i].priority = (uint8_t)status[i].uxCurrentPriority;
+#if CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+        snap[i].core = (status[i].xCoreID == tskNO_AFFINITY) ? 0xFF : (uint8_t)status[i].xCoreID;
+#else
+        snap[i].core = 0xFF;
+#endif
+        // % của 1 core: task ghim core chạy full = 100%
+        snap[i].cpu_percent = total_delta ? (float)(status[i].ulRunTimeCounter - before) * 100.0f / (float)total_delta : 0.0f;
+        // ESP-IDF: StackType_t là uint8_t nên high-water mark đã tính theo byte
+        snap[i].stack_free_min = status[i].usStackHighWaterMark;
+
+        cur_handle[i] = status[i].xHandle;
+        cur_runtime[i] = status[i].ulRunTimeCounter;
+    }
+    memcpy(prev_handle, cur_handle, sizeof(cur_handle[0]) * n);
+    memcpy(prev_runtime, cur_runtime, sizeof(cur_runtime[0]) * n);
+    prev_count = n;
+    prev_total = total;
+
+    taskENTER_CRITICAL(&s_task_lock);
+    memcpy(s_tasks, snap, sizeof(perf_task_info_t) * n);
+    s_task_count = n;
+    taskEXIT_CRITICAL(&s_task_lock);
+}
+
+static void perf_sampler_task(void *pvParameters) {
+    while (1) {
+        perf_sample();
+        vTaskDelay(pdMS_TO_TICKS(PERF_SAMPLE_PERIOD_MS));
+    }
+}
+#endif
+
+size_t perf_tasks_to_json(char *buf, size_t len) {
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    perf_task_info_t snap[PERF_MAX_TASKS];
+    taskENTER_CRITICAL(&s_task_lock);
+    int n = s_task_count;
+    memcpy(snap, s_tasks, sizeof(perf_task_info_t) * n);
+    taskEXIT_CRITICAL(&s_task_lock);
+
+    size_t off = snprintf(buf, len, "{\"period_ms\":%d,\"tasks\":[", PERF_SAMPLE_PERIOD_MS);
+    for (int i = 0; i < n && off < len; i++) {
+        off += snprintf(buf + off, len - off,
+                        "%s{\"name\":\"%s\",\"core\":%d,\"prio\":%u,\"cpu\":%.1f,\"stack_free_min\":%lu}",
+                        i ? "," : "", snap[i].name, snap[i].core == 0xFF ? -1 : snap[i].core,
+                        snap[i].priority, snap[i].cpu_percent, (unsigned long)snap[i].stack_free_min);
+    }
+    if (off < len) off += snprintf(buf + off, len - off, "]}");
+    return off < len ? off : 0;
+#else
+    return snprintf(buf, len, "{\"error\":\"CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS is disabled\"}");
+#endif
+}
+
+void perf_monitor_init(void) {
+    if (s_events) return;
+    // Ring buffer ~16KB, đặt ở PSRAM để không chiếm RAM nội
+    s_events = (perf_event_t *)heap_caps_calloc(PERF_TRACE_CAPACITY, sizeof(perf_event_t), MALLOC_CAP_SPIRAM);
+    if (!s_events) {
+        ESP_LOGE(TAG, "Alloc trace buffer failed");
+        return;
+    }
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    xTaskCreatePinnedToCore(perf_sampler_task, "perf_sampler", 4096, NULL, 1, NULL, 0);
+    ESP_LOGI(TAG, "Perf monitor started (trace %d events, sample %d ms)", PERF_TRACE_CAPACITY, PERF_SAMPLE_PERIOD_MS);
+#else
+    ESP_LOGW(TAG, "Run-time stats disabled in sdkconfig, only trace events are recorded");
+#endif
+}
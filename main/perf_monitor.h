@@ -0,0 +1,72 @@
+#ifndef PERF_MONITOR_H
+#define PERF_MONITOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Số sự kiện trace giữ trong ring buffer (ghi đè cái cũ nhất khi đầy)
+#define PERF_TRACE_CAPACITY      512
+// Số task tối đa trong một lần lấy mẫu run-time stats
+#define PERF_MAX_TASKS           32
+// Chu kỳ lấy mẫu CPU / stack (ms)
+#define PERF_SAMPLE_PERIOD_MS    5000
+
+// Thông tin 1 task sau mỗi lần lấy mẫu
+typedef struct {
+    char name[16];
+    uint8_t core;           // 0, 1 hoặc 0xFF (không ghim core)
+    uint8_t priority;
+    float cpu_percent;      // % CPU trong chu kỳ lấy mẫu vừa rồi
+    uint32_t stack_free_min; // Stack high-water mark (bytes còn trống ít nhất)
+} perf_task_info_t;
+
+// Hàm ghi dữ liệu ra ngoài (HTTP chunk, UART...). Trả về 0 nếu thành công.
+typedef int (*perf_write_fn)(void *ctx, const char *data, size_t len);
+
+// Khởi tạo ring buffer trace và task lấy mẫu
+void perf_monitor_init(void);
+
+// Ghi 1 sự kiện trace đã hoàn tất (name phải là chuỗi hằng)
+void perf_trace_record(const char *name, int64_t start_us, int64_t end_us);
+
+// Xuất bảng task (CPU %, stack) dạng JSON vào buf. Trả về số byte đã ghi.
+size_t perf_tasks_to_json(char *buf, size_t len);
+
+// Xuất toàn bộ ring buffer theo định dạng Chrome Trace (chrome://tracing, Perfetto)
+esp_err_t perf_trace_export(perf_write_fn write, void *ctx);
+
+// Xoá ring buffer trace
+void perf_trace_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Macro đo 1 đoạn code trong C: PERF_TRACE_BEGIN(t); ... PERF_TRACE_END(t, "decode");
+#define PERF_TRACE_BEGIN(var)        int64_t var = esp_timer_get_time()
+#define PERF_TRACE_END(var, name)    perf_trace_record((name), (var), esp_timer_get_time())
+
+#ifdef __cplusplus
+// Bản C++: tự ghi khi ra khỏi scope. VD: PERF_SCOPE("detect");
+class PerfScope {
+public:
+    explicit PerfScope(const char *name) : name_(name), start_(esp_timer_get_time()) {}
+    ~PerfScope() { perf_trace_record(name_, start_, esp_timer_get_time()); }
+    PerfScope(const PerfScope &) = delete;
+    PerfScope &operator=(const PerfScope &) = delete;
+private:
+    const char *name_;
+    int64_t start_;
+};
+#define PERF_SCOPE_CAT2(a, b) a##b
+#define PERF_SCOPE_CAT(a, b)  PERF_SCOPE_CAT2(a, b)
+#define PERF_SCOPE(name)      PerfScope PERF_SCOPE_CAT(_perf_scope_, __LINE__)(name)
+#endif
+
+#endif
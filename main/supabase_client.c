@@ -1,324 +1,1025 @@
-#include "supabase_client.h"
-#include "esp_http_client.h"
-#include "esp_log.h"
-#include "cJSON.h"
-#include "esp_sntp.h"
-#include "esp_crt_bundle.h"
-#include "esp_heap_caps.h"
-#include "lock_ctrl.h"
-#include "esp_camera.h"
-#include "esp_timer.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
-#include "nvs_flash.h"
-#include "nvs.h"
-#include <string.h>
-#include "global_state.h"
-
-static const char *TAG = "SUPABASE";
-
-char SUPABASE_URL[128] = {0};
-char SUPABASE_KEY[1024] = {0}; 
-
-extern SemaphoreHandle_t xCameraMutex;
-extern void face_api_add_user_from_cloud(int face_id, float *embedding_buffer, int len);
-extern bool app_extract_face_feature(camera_fb_t *fb, float *out_buf);
-
-// 1. NVS CONFIG
-esp_err_t supabase_load_config(void) {
-    nvs_handle_t my_handle;
-    if (nvs_open("nvs", NVS_READONLY, &my_handle) != ESP_OK) return ESP_FAIL;
-    size_t url_len = sizeof(SUPABASE_URL); size_t key_len = sizeof(SUPABASE_KEY);
-    if (nvs_get_str(my_handle, "sup_url", SUPABASE_URL, &url_len) != ESP_OK ||
-        nvs_get_str(my_handle, "sup_key", SUPABASE_KEY, &key_len) != ESP_OK) { nvs_close(my_handle); return ESP_FAIL; }
-    nvs_close(my_handle); ESP_LOGI(TAG, "Loaded Config: URL=%s", SUPABASE_URL); return ESP_OK;
-}
-
-esp_err_t supabase_save_config(const char *url, const char *key) {
-    nvs_handle_t my_handle;
-    if (nvs_open("nvs", NVS_READWRITE, &my_handle) != ESP_OK) return ESP_FAIL;
-    nvs_set_str(my_handle, "sup_url", url); nvs_set_str(my_handle, "sup_key", key);
-    esp_err_t err = nvs_commit(my_handle); nvs_close(my_handle); return err;
-}
-
-// 2. HTTP CLIENT
-static esp_http_client_handle_t _init_client(const char *endpoint, esp_http_client_method_t method, int rx_buf, int tx_buf, bool keep_alive) {
-    if (strlen(SUPABASE_URL) < 5) { ESP_LOGE(TAG, "Missing Supabase URL!"); return NULL; }
-    char url[300]; snprintf(url, sizeof(url), "%s%s", SUPABASE_URL, endpoint);
-    
-    // Tăng buffer handle response header
-    if (tx_buf < 8192) tx_buf = 8192; 
-    if (rx_buf < 20480) rx_buf = 20480; 
-
-    esp_http_client_config_t config = { .url = url, .method = method, .crt_bundle_attach = esp_crt_bundle_attach, .timeout_ms = 20000, .buffer_size = rx_buf, .buffer_size_tx = tx_buf, .keep_alive_enable = keep_alive, .user_data = NULL, .disable_auto_redirect = false, };
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (!client) return NULL;
-    esp_http_client_set_header(client, "apikey", SUPABASE_KEY);
-    char auth_header[1200]; snprintf(auth_header, sizeof(auth_header), "Bearer %s", SUPABASE_KEY);
-    esp_http_client_set_header(client, "Authorization", auth_header);
-    if (method == HTTP_METHOD_POST || method == HTTP_METHOD_PATCH) esp_http_client_set_header(client, "Content-Type", "application/json");
-    esp_http_client_set_header(client, "Prefer", "return=representation"); 
-    return client;
-}
-
-void supabase_init(void) {
-    esp_sntp_setoperatingmode(SNTP_OPMODE_POLL); esp_sntp_setservername(0, "pool.ntp.org"); esp_sntp_init();
-    setenv("TZ", "CET-7CEST,M3.5.0,M10.5.0/3", 1); tzset();
-}
-
-esp_err_t supabase_upload_image(camera_fb_t *fb, char *filename_out) {
-    if (strlen(filename_out) == 0) snprintf(filename_out, 64, "log_%lu.jpg", (unsigned long)xTaskGetTickCount());
-    char endpoint[128]; snprintf(endpoint, sizeof(endpoint), "/storage/v1/object/access_faces/%s", filename_out);
-    esp_http_client_handle_t client = _init_client(endpoint, HTTP_METHOD_POST, 4096, fb->len + 4096, false);
-    if (!client) return ESP_FAIL;
-    esp_http_client_set_header(client, "Content-Type", "image/jpeg");
-    esp_http_client_set_post_field(client, (const char *)fb->buf, fb->len);
-    esp_err_t err = esp_http_client_perform(client);
-    if (err == ESP_OK) ESP_LOGI(TAG, "📸 Image Uploaded: %s", filename_out);
-    else ESP_LOGE(TAG, "Upload Failed: %s", esp_err_to_name(err));
-    esp_http_client_cleanup(client);
-    return err;
-}
-
-// ---> ĐÃ SỬA: Chuyển sang POST và truyền face_id vào Database
-esp_err_t supabase_upload_face(int face_id, float *embedding, int len) {
-    ESP_LOGI(TAG, "Uploading New Face to Cloud. Face ID: %d", face_id);
-    char endpoint[64] = "/rest/v1/users"; // URL gốc của bảng users
-    
-    // Dùng HTTP_METHOD_POST để tạo dòng mới
-    esp_http_client_handle_t client = _init_client(endpoint, HTTP_METHOD_POST, 4096, 8192, false);
-    if (!client) return ESP_FAIL;
-
-    cJSON *root = cJSON_CreateObject();
-    
-    // Gắn Face ID vào Database
-    cJSON_AddNumberToObject(root, "face_id", face_id);
-
-    cJSON *emb_array = cJSON_CreateArray();
-    for (int i = 0; i < len; i++) cJSON_AddItemToArray(emb_array, cJSON_CreateNumber(embedding[i]));
-    cJSON_AddItemToObject(root, "embedding", emb_array);
-
-    char *json_str = cJSON_PrintUnformatted(root);
-    esp_http_client_set_post_field(client, json_str, strlen(json_str));
-    esp_err_t err = esp_http_client_perform(client);
-
-    if (err == ESP_OK) {
-        int status = esp_http_client_get_status_code(client);
-        // Status 201 là Created (Tạo thành công)
-        if (status == 201 || status == 200 || status == 204) ESP_LOGI(TAG, "New Face Inserted to Cloud!");
-        else { ESP_LOGE(TAG, "Insert Face Error: %d", status); err = ESP_FAIL; }
-    } else ESP_LOGE(TAG, "Insert Face Failed: %s", esp_err_to_name(err));
-
-    cJSON_Delete(root); free(json_str); esp_http_client_cleanup(client);
-    return err;
-}
-
-esp_err_t supabase_log_access(int face_id, float score, const char *image_filename) {
-    esp_http_client_handle_t client = _init_client("/rest/v1/access_logs", HTTP_METHOD_POST, 0, 0, false);
-    if (!client) return ESP_FAIL;
-    cJSON *root = cJSON_CreateObject();
-    cJSON_AddStringToObject(root, "device_id", "S3_LOCK_01");
-    if(face_id >= 0) {
-        cJSON_AddNumberToObject(root, "face_id", face_id); 
-        char desc[64]; snprintf(desc, sizeof(desc), "Face ID Match (%.2f)", score);
-        cJSON_AddStringToObject(root, "description", desc);
-        cJSON_AddNumberToObject(root, "score", score);
-    } else cJSON_AddStringToObject(root, "description", "Remote Unlock via App");
-    if (image_filename && strlen(image_filename) > 0) cJSON_AddStringToObject(root, "image_url", image_filename);
-    char *json_str = cJSON_PrintUnformatted(root);
-    esp_http_client_set_post_field(client, json_str, strlen(json_str));
-    esp_http_client_perform(client);
-    cJSON_Delete(root); free(json_str); esp_http_client_cleanup(client);
-    return ESP_OK;
-}
-
-// ---> ĐÃ SỬA: Thêm &limit=100 và select=face_id
-void supabase_sync_users(void) {
-    ESP_LOGI(TAG, "Syncing Users from Table 'users'...");
-    esp_http_client_handle_t client = _init_client("/rest/v1/users?select=face_id,embedding&limit=100", HTTP_METHOD_GET, 20480, 0, false);
-    if (!client) return;
-
-    // Mở kết nối thủ công
-    esp_err_t err = esp_http_client_open(client, 0);
-    if (err == ESP_OK) {
-        // Lấy Content-Length
-        int content_len = esp_http_client_fetch_headers(client);
-        
-        // Nếu length <= 0 (Chunked Encoding), ta giả định buffer thật lớn (128KB)
-        int total_to_read = content_len;
-        if (total_to_read <= 0) {
-            ESP_LOGW(TAG, "Content length unknown (Chunked). Using 128KB Buffer from PSRAM.");
-            total_to_read = 128 * 1024; 
-        }
-
-        // Cấp phát bộ nhớ trong SPIRAM
-        char *buf = (char *)heap_caps_malloc(total_to_read + 1, MALLOC_CAP_SPIRAM);
-        if (buf) {
-            int total_read = 0;
-            while (1) {
-                int r = esp_http_client_read_response(client, buf + total_read, total_to_read - total_read);
-                if (r < 0) {
-                    ESP_LOGE(TAG, "Read Error");
-                    break;
-                }
-                if (r == 0) {
-                    break;
-                }
-                total_read += r;
-                // Tránh tràn buffer
-                if (total_read >= total_to_read) break; 
-            }
-            buf[total_read] = 0; // Kết thúc chuỗi
-
-            if (total_read > 0) {
-                ESP_LOGI(TAG, "Downloaded %d bytes. Parsing JSON...", total_read);
-                cJSON *root = cJSON_Parse(buf);
-                if (root) {
-                    if (cJSON_IsArray(root)) {
-                        int count = cJSON_GetArraySize(root);
-                        ESP_LOGI(TAG, "FOUND %d USERS in Database!", count);
-                        
-                        for (int i = 0; i < count; i++) {
-                            cJSON *item = cJSON_GetArrayItem(root, i);
-                            // SỬA: Parse trường "face_id"
-                            cJSON *id_json = cJSON_GetObjectItem(item, "face_id");
-                            cJSON *emb_json = cJSON_GetObjectItem(item, "embedding");
-                            
-                            if (id_json && emb_json && !cJSON_IsNull(emb_json)) {
-                                int uid = id_json->valueint;
-                                // Embedding có thể là String hoặc JSON Array
-                                cJSON *emb_array = cJSON_IsString(emb_json) ? cJSON_Parse(emb_json->valuestring) : emb_json;
-                                
-                                if (cJSON_IsArray(emb_array)) {
-                                    int dims = cJSON_GetArraySize(emb_array);
-                                    if (dims == 512) {
-                                        float *emb_buf = (float *)malloc(512 * sizeof(float));
-                                        for(int j=0; j<512; j++) {
-                                            emb_buf[j] = (float)cJSON_GetArrayItem(emb_array, j)->valuedouble;
-                                        }
-                                        face_api_add_user_from_cloud(uid, emb_buf, 512);
-                                        free(emb_buf);
-                                    }
-                                    if (cJSON_IsString(emb_json)) cJSON_Delete(emb_array);
-                                }
-                            }
-                        }
-                    } else {
-                        ESP_LOGE(TAG, "JSON is not an array");
-                    }
-                    cJSON_Delete(root);
-                } else {
-                    ESP_LOGE(TAG, "cJSON Parse Failed (JSON Broken or Empty)");
-                }
-            } else {
-                ESP_LOGW(TAG, "Response Empty (0 bytes)");
-            }
-            free(buf);
-        } else {
-            ESP_LOGE(TAG, "Malloc Failed (Out of PSRAM?)");
-        }
-    } else {
-        ESP_LOGE(TAG, "HTTP Open Failed: %s", esp_err_to_name(err));
-    }
-    esp_http_client_cleanup(client);
-}
-
-static void mark_command_executed(int cmd_id) {
-    char endpoint[64]; snprintf(endpoint, sizeof(endpoint), "/rest/v1/device_commands?id=eq.%d", cmd_id);
-    esp_http_client_handle_t client = _init_client(endpoint, HTTP_METHOD_PATCH, 0, 0, false);
-    if (client) {
-        const char *json = "{\"status\":\"executed\"}";
-        esp_http_client_set_post_field(client, json, strlen(json));
-        esp_http_client_perform(client);
-        esp_http_client_cleanup(client);
-    }
-}
-
-static void perform_enrollment(int user_id) {
-    ESP_LOGW(TAG, "START ENROLLMENT ID: %d", user_id);
-    g_is_enrolling = true; 
-    vTaskDelay(pdMS_TO_TICKS(1500)); 
-
-    if (xSemaphoreTake(xCameraMutex, pdMS_TO_TICKS(5000))) { 
-        camera_fb_t *fb = esp_camera_fb_get();
-        if (fb) {
-            ESP_LOGI(TAG, "Captured. Extracting Features...");
-            char filename[64];
-            snprintf(filename, sizeof(filename), "face_%d_%lu.jpg", user_id, (unsigned long)xTaskGetTickCount());
-            supabase_upload_image(fb, filename);
-
-            float *new_embedding = (float *)malloc(512 * sizeof(float));
-            if (new_embedding) {
-                if (app_extract_face_feature(fb, new_embedding)) {
-                    ESP_LOGI(TAG, "Face Detected. Updating User on Cloud...");
-                    supabase_upload_face(user_id, new_embedding, 512);
-                    face_api_add_user_from_cloud(user_id, new_embedding, 512);
-                } else {
-                    ESP_LOGE(TAG, "No Face Detected");
-                }
-                free(new_embedding);
-            }
-            esp_camera_fb_return(fb);
-        } else ESP_LOGE(TAG, "Capture Failed");
-        xSemaphoreGive(xCameraMutex); 
-    } else ESP_LOGE(TAG, "Camera Busy");
-
-    g_is_enrolling = false;
-    ESP_LOGI(TAG, "Enrollment Finished");
-}
-
-void check_remote_command(void) {
-    // Tăng buffer rx_buf lên để chứa đủ JSON payload từ Flutter
-    esp_http_client_handle_t client = _init_client("/rest/v1/device_commands?select=id,command,payload&status=eq.pending&device_id=eq.S3_LOCK_01", HTTP_METHOD_GET, 8192, 0, false);
-    if (!client) return;
-
-    esp_err_t err = esp_http_client_open(client, 0);
-    if (err == ESP_OK) {
-        esp_http_client_fetch_headers(client);
-        
-        // Không dùng get_content_length vì dễ bị lỗi với Chunked Encoding
-        char *buf = (char *)heap_caps_malloc(8192, MALLOC_CAP_SPIRAM); // Dùng PSRAM cho an toàn
-        if (buf) {
-            int read_len = esp_http_client_read_response(client, buf, 8191);
-            if (read_len > 0) {
-                buf[read_len] = 0;
-                cJSON *root = cJSON_Parse(buf);
-                if (cJSON_IsArray(root) && cJSON_GetArraySize(root) > 0) {
-                    cJSON *item = cJSON_GetArrayItem(root, 0);
-                    
-                    cJSON *id_obj = cJSON_GetObjectItem(item, "id");
-                    cJSON *cmd_obj = cJSON_GetObjectItem(item, "command");
-
-                    if (id_obj && cmd_obj) {
-                        int id = id_obj->valueint;
-                        char *cmd = cmd_obj->valuestring;
-                        ESP_LOGW(TAG, "🔥 NHẬN LỆNH MỚI: %s (ID: %d)", cmd, id);
-
-                        if (strcmp(cmd, "OPEN") == 0) {
-                            lock_open_door(); // Gọi hàm điều khiển Relay
-                            
-                            // Log và upload ảnh (giữ nguyên logic của bạn)
-                            char img[64] = {0};
-                            if (xSemaphoreTake(xCameraMutex, pdMS_TO_TICKS(1000))) {
-                                camera_fb_t *fb = esp_camera_fb_get();
-                                if (fb) { 
-                                    supabase_upload_image(fb, img); 
-                                    esp_camera_fb_return(fb); 
-                                }
-                                xSemaphoreGive(xCameraMutex);
-                            }
-                            supabase_log_access(-1, 1.0, img);
-                            mark_command_executed(id); // Quan trọng: Đổi pending -> executed
-                        }
-                        // Xử lý các lệnh khác (ENROLL...)
-                    }
-                }
-                cJSON_Delete(root);
-            }
-            free(buf);
-        }
-    } else {
-        ESP_LOGE(TAG, "Lỗi kết nối Polling: %s", esp_err_to_name(err));
-    }
-    esp_http_client_cleanup(client);
+#include "supabase_client.h"
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "esp_sntp.h"
+#include "esp_crt_bundle.h"
+#include "esp_heap_caps.h"
+#include "esp_camera.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <strings.h>
+#include <time.h>
+#include "face_detect.h"
+#include "perf_monitor.h"
+#include "mem_pool.h"
+#include "http_server.h"
+#include "wifi_manager.h"
+#include "json_writer.h"
+#include "bench.h"
+#include "access_stats.h"
+#include "mbedtls/base64.h"
+#include "uplink_sched.h"
+#include "face_thumb.h"
+#include "event_bus.h"
+
+static const char *TAG = "SUPABASE";
+
+char SUPABASE_URL[128] = {0};
+char SUPABASE_KEY[1024] = {0}; 
+
+extern SemaphoreHandle_t xCameraMutex;
+
+// 1. NVS CONFIG
+esp_err_t supabase_load_config(void) {
+    nvs_handle_t my_handle;
+    if (nvs_open("nvs", NVS_READONLY, &my_handle) != ESP_OK) return ESP_FAIL;
+    size_t url_len = sizeof(SUPABASE_URL); size_t key_len = sizeof(SUPABASE_KEY);
+    if (nvs_get_str(my_handle, "sup_url", SUPABASE_URL, &url_len) != ESP_OK ||
+        nvs_get_str(my_handle, "sup_key", SUPABASE_KEY, &key_len) != ESP_OK) { nvs_close(my_handle); return ESP_FAIL; }
+    nvs_close(my_handle); ESP_LOGI(TAG, "Loaded Config: URL=%s", SUPABASE_URL); return ESP_OK;
+}
+
+esp_err_t supabase_save_config(const char *url, const char *key) {
+    nvs_handle_t my_handle;
+    if (nvs_open("nvs", NVS_READWRITE, &my_handle) != ESP_OK) return ESP_FAIL;
+    nvs_set_str(my_handle, "sup_url", url); nvs_set_str(my_handle, "sup_key", key);
+    esp_err_t err = nvs_commit(my_handle); nvs_close(my_handle); return err;
+}
+
+// 2. HTTP CLIENT
+// endpoint là đường dẫn sau SUPABASE_URL, hoặc URL đầy đủ (Location do server trả về)
+static esp_http_client_handle_t _init_client_cb(const char *endpoint, esp_http_client_method_t method, int rx_buf, int tx_buf, bool keep_alive,
+                                                http_event_handle_cb event_handler, void *user_data) {
+    if (strlen(SUPABASE_URL) < 5) { ESP_LOGE(TAG, "Missing Supabase URL!"); return NULL; }
+    char url[300]; snprintf(url, sizeof(url), "%s%s", strncmp(endpoint, "http", 4) == 0 ? "" : SUPABASE_URL, endpoint);
+    
+    // Tăng buffer handle response header
+    if (tx_buf < 8192) tx_buf = 8192; 
+    if (rx_buf < 20480) rx_buf = 20480; 
+
+    esp_http_client_config_t config = { .url = url, .method = method, .crt_bundle_attach = esp_crt_bundle_attach, .timeout_ms = 20000, .buffer_size = rx_buf, .buffer_size_tx = tx_buf, .keep_alive_enable = keep_alive, .event_handler = event_handler, .user_data = user_data, .disable_auto_redirect = false, };
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (!client) return NULL;
+    esp_http_client_set_header(client, "apikey", SUPABASE_KEY);
+    char auth_header[1200]; snprintf(auth_header, sizeof(auth_header), "Bearer %s", SUPABASE_KEY);
+    esp_http_client_set_header(client, "Authorization", auth_header);
+    if (method == HTTP_METHOD_POST || method == HTTP_METHOD_PATCH) esp_http_client_set_header(client, "Content-Type", "application/json");
+    esp_http_client_set_header(client, "Prefer", "return=representation"); 
+    return client;
+}
+
+static esp_http_client_handle_t _init_client(const char *endpoint, esp_http_client_method_t method, int rx_buf, int tx_buf, bool keep_alive) {
+    return _init_client_cb(endpoint, method, rx_buf, tx_buf, keep_alive, NULL, NULL);
+}
+
+// Mọi request xin lượt của uplink_sched: lệnh remote không phải xếp sau 1 upload lớn
+static esp_err_t _perform(esp_http_client_handle_t client, uplink_class_t cls, size_t bytes) {
+    if (uplink_acquire(cls, bytes, UPLINK_WAIT_MS) != ESP_OK) return ESP_ERR_TIMEOUT;
+    esp_err_t err = esp_http_client_perform(client);
+    uplink_release();
+    return err;
+}
+
+void supabase_init(void) {
+    esp_sntp_setoperatingmode(SNTP_OPMODE_POLL); esp_sntp_setservername(0, "pool.ntp.org"); esp_sntp_init();
+    setenv("TZ", "CET-7CEST,M3.5.0,M10.5.0/3", 1); tzset();
+}
+
+// 3. UPLOAD ẢNH: ghi body theo khúc từ buffer ảnh có sẵn, buffer TX của client giữ cố định
+// (trước đây buffer_size_tx = jpg_len + 4096 -> mỗi lần chụp lại cấp thêm 1 vùng cỡ cả frame)
+static struct {
+    uint32_t ok;
+    uint32_t failed;
+    uint32_t retries;
+    uint32_t resumed;       // Lần PATCH TUS tiếp tục từ offset > 0
+    uint64_t bytes;
+    uint32_t last_kbps;
+    uint32_t last_ms;
+} s_up;
+
+// Xin lượt theo từng khúc: lớp ưu tiên cao hơn chen vào giữa các khúc, token bucket tính theo khúc
+static esp_err_t _write_body(esp_http_client_handle_t client, const uint8_t *data, size_t len, uplink_class_t cls) {
+    size_t sent = 0;
+    while (sent < len) {
+        size_t n = len - sent;
+        if (n > SUPABASE_UPLOAD_CHUNK) n = SUPABASE_UPLOAD_CHUNK;
+        if (uplink_acquire(cls, n, UPLINK_WAIT_MS) != ESP_OK) return ESP_ERR_TIMEOUT;
+        int w = esp_http_client_write(client, (const char *)data + sent, n);
+        uplink_release();
+        if (w <= 0) return ESP_FAIL;
+        sent += w;
+    }
+    return ESP_OK;
+}
+
+// Mở request, stream body, đọc header phản hồi. Trả status HTTP qua *status.
+static esp_err_t _send_streamed(esp_http_client_handle_t client, const uint8_t *data, size_t len, uplink_class_t cls, int *status) {
+    if (uplink_acquire(cls, 0, UPLINK_WAIT_MS) != ESP_OK) return ESP_ERR_TIMEOUT;
+    esp_err_t err = esp_http_client_open(client, len);
+    uplink_release();
+    if (err != ESP_OK) return err;
+    err = _write_body(client, data, len, cls);
+    if (err == ESP_OK && esp_http_client_fetch_headers(client) < 0) err = ESP_FAIL;
+    *status = esp_http_client_get_status_code(client);
+    esp_http_client_close(client);
+    return err;
+}
+
+static esp_err_t _upload_simple(const uint8_t *jpg, size_t jpg_len, const char *filename, uplink_class_t cls) {
+    char endpoint[128]; snprintf(endpoint, sizeof(endpoint), "/storage/v1/object/access_faces/%s", filename);
+    esp_err_t err = ESP_FAIL;
+    for (int attempt = 0; attempt <= SUPABASE_UPLOAD_RETRIES; attempt++) {
+        if (attempt > 0) { s_up.retries++; vTaskDelay(pdMS_TO_TICKS(500 << attempt)); }
+        esp_http_client_handle_t client = _init_client(endpoint, HTTP_METHOD_POST, 4096, SUPABASE_UPLOAD_TX_BUF, false);
+        if (!client) return ESP_FAIL;
+        esp_http_client_set_header(client, "Content-Type", "image/jpeg");
+        int status = 0;
+        err = _send_streamed(client, jpg, jpg_len, cls, &status);
+        esp_http_client_cleanup(client);
+        if (err == ESP_OK && status < 300) return ESP_OK;
+        if (err == ESP_OK) {
+            ESP_LOGE(TAG, "Upload Error: %d", status);
+            err = ESP_FAIL;
+            if (status < 500) break;   // 4xx: thử lại cũng vô ích
+        }
+    }
+    return err;
+}
+
+// TUS (Supabase resumable upload): tạo phiên -> PATCH từ offset; đứt giữa chừng thì HEAD hỏi
+// server đã nhận bao nhiêu byte rồi gửi tiếp phần còn lại thay vì gửi lại cả ảnh.
+typedef struct {
+    char location[256];
+    long offset;
+} tus_hdr_t;
+
+static esp_err_t _tus_event(esp_http_client_event_t *evt) {
+    tus_hdr_t *h = (tus_hdr_t *)evt->user_data;
+    if (evt->event_id != HTTP_EVENT_ON_HEADER || !h) return ESP_OK;
+    if (strcasecmp(evt->header_key, "Location") == 0) strlcpy(h->location, evt->header_value, sizeof(h->location));
+    else if (strcasecmp(evt->header_key, "Upload-Offset") == 0) h->offset = strtol(evt->header_value, NULL, 10);
+    return ESP_OK;
+}
+
+static void _tus_headers(esp_http_client_handle_t client) {
+    esp_http_client_set_header(client, "Tus-Resumable", "1.0.0");
+    esp_http_client_set_header(client, "x-upsert", "true");
+}
+
+static size_t _b64(const char *in, char *out, size_t out_len) {
+    size_t olen = 0;
+    if (mbedtls_base64_encode((unsigned char *)out, out_len, &olen, (const unsigned char *)in, strlen(in)) != 0) return 0;
+    return olen;
+}
+
+static esp_err_t _upload_tus(const uint8_t *jpg, size_t jpg_len, const char *filename, uplink_class_t cls) {
+    tus_hdr_t h = { .location = {0}, .offset = 0 };
+
+    // 1. Tạo phiên upload
+    esp_http_client_handle_t client = _init_client_cb("/storage/v1/upload/resumable", HTTP_METHOD_POST, 4096, SUPABASE_UPLOAD_TX_BUF, false, _tus_event, &h);
+    if (!client) return ESP_FAIL;
+    _tus_headers(client);
+    esp_http_client_delete_header(client, "Content-Type");
+    char len_str[16]; snprintf(len_str, sizeof(len_str), "%u", (unsigned)jpg_len);
+    esp_http_client_set_header(client, "Upload-Length", len_str);
+    char b_bucket[24], b_name[96], meta[sizeof(b_bucket) + sizeof(b_name) + 64];  // + tên trường, contentType
+    _b64("access_faces", b_bucket, sizeof(b_bucket));
+    _b64(filename, b_name, sizeof(b_name));
+    snprintf(meta, sizeof(meta), "bucketName %s,objectName %s,contentType aW1hZ2UvanBlZw==", b_bucket, b_name);
+    esp_http_client_set_header(client, "Upload-Metadata", meta);
+    esp_err_t err = _perform(client, cls, 0);
+    int status = esp_http_client_get_status_code(client);
+    esp_http_client_cleanup(client);
+    if (err != ESP_OK || status != 201 || h.location[0] == '\0') {
+        ESP_LOGE(TAG, "TUS create failed: %s / %d", esp_err_to_name(err), status);
+        return ESP_FAIL;
+    }
+
+    // 2. Gửi phần còn thiếu, tối đa SUPABASE_UPLOAD_RETRIES lần nối lại
+    char location[256]; strlcpy(location, h.location, sizeof(location));
+    size_t offset = 0;
+    for (int attempt = 0; attempt <= SUPABASE_UPLOAD_RETRIES; attempt++) {
+        if (attempt > 0) {
+            s_up.retries++;
+            vTaskDelay(pdMS_TO_TICKS(500 << attempt));
+            // Hỏi server offset hiện tại
+            h.offset = -1;
+            client = _init_client_cb(location, HTTP_METHOD_HEAD, 4096, SUPABASE_UPLOAD_TX_BUF, false, _tus_event, &h);
+            if (!client) return ESP_FAIL;
+            _tus_headers(client);
+            err = _perform(client, cls, 0);
+            esp_http_client_cleanup(client);
+            if (err != ESP_OK || h.offset < 0 || (size_t)h.offset > jpg_len) continue;
+            offset = h.offset;
+            if (offset == jpg_len) return ESP_OK;
+            if (offset > 0) s_up.resumed++;
+        }
+        h.offset = -1;
+        client = _init_client_cb(location, HTTP_METHOD_PATCH, 4096, SUPABASE_UPLOAD_TX_BUF, false, _tus_event, &h);
+        if (!client) return ESP_FAIL;
+        _tus_headers(client);
+        char off_str[16]; snprintf(off_str, sizeof(off_str), "%u", (unsigned)offset);
+        esp_http_client_set_header(client, "Upload-Offset", off_str);
+        esp_http_client_set_header(client, "Content-Type", "application/offset+octet-stream");
+        err = _send_streamed(client, jpg + offset, jpg_len - offset, cls, &status);
+        esp_http_client_cleanup(client);
+        if (err == ESP_OK && status == 204 && h.offset == (long)jpg_len) return ESP_OK;
+        ESP_LOGW(TAG, "TUS PATCH @%u failed: %s / %d", (unsigned)offset, esp_err_to_name(err), status);
+        if (err == ESP_OK && status >= 400 && status < 500 && status != 409) return ESP_FAIL;
+    }
+    return ESP_FAIL;
+}
+
+static esp_err_t _upload_jpeg(const uint8_t *jpg, size_t jpg_len, char *filename_out, uplink_class_t cls) {
+    if (strlen(filename_out) == 0) snprintf(filename_out, 64, "log_%lu.jpg", (unsigned long)xTaskGetTickCount());
+    PERF_TRACE_BEGIN(t_upload);
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t err = jpg_len >= SUPABASE_UPLOAD_TUS_MIN ? _upload_tus(jpg, jpg_len, filename_out, cls)
+                                                       : _upload_simple(jpg, jpg_len, filename_out, cls);
+    uint32_t ms = (uint32_t)((esp_timer_get_time() - t0) / 1000);
+    PERF_TRACE_END(t_upload, "upload_image");
+    if (err == ESP_OK) {
+        s_up.ok++;
+        s_up.bytes += jpg_len;
+        s_up.last_ms = ms;
+        s_up.last_kbps = ms ? (uint32_t)((uint64_t)jpg_len * 8 / ms) : 0;
+        ESP_LOGI(TAG, "📸 Image Uploaded: %s (%u B, %lu ms, %lu kbit/s)", filename_out, (unsigned)jpg_len,
+                 (unsigned long)ms, (unsigned long)s_up.last_kbps);
+    } else {
+        s_up.failed++;
+        ESP_LOGE(TAG, "Upload Failed: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+esp_err_t supabase_upload_image(camera_fb_t *fb, char *filename_out) {
+    return _upload_jpeg(fb->buf, fb->len, filename_out, UPLINK_FULL);
+}
+
+// Ghi thẳng vào khối pool: {"face_id":..,"<key>":[..]} không dựng cây cJSON FACE_EMBED_DIM node.
+// face_id < 0: không ghi face_id (đã lọc trên URL)
+static const char *_face_json(char *buf, int face_id, const char *key, const float *embedding, int len, size_t *out_len) {
+    json_writer_t w;
+    jw_init(&w, buf, SUPABASE_FACE_JSON_MAX);
+    jw_obj_begin(&w);
+    if (face_id >= 0) jw_kv_int(&w, "face_id", face_id);   // Gắn Face ID vào Database
+    jw_key(&w, key);
+    jw_arr_begin(&w);
+    for (int i = 0; i < len; i++) jw_float(&w, embedding[i], 6);
+    jw_arr_end(&w);
+    jw_obj_end(&w);
+    return jw_finish(&w, out_len);
+}
+
+// ---> ĐÃ SỬA: Chuyển sang POST và truyền face_id vào Database
+esp_err_t supabase_upload_face(int face_id, float *embedding, int len) {
+    ESP_LOGI(TAG, "Uploading New Face to Cloud. Face ID: %d", face_id);
+    char endpoint[64] = "/rest/v1/users"; // URL gốc của bảng users
+    
+    // Dùng HTTP_METHOD_POST để tạo dòng mới
+    esp_http_client_handle_t client = _init_client(endpoint, HTTP_METHOD_POST, 4096, 8192, false);
+    if (!client) return ESP_FAIL;
+
+    char *buf = (char *)mem_pool_alloc(SUPABASE_FACE_JSON_MAX);
+    if (!buf) { esp_http_client_cleanup(client); return ESP_ERR_NO_MEM; }
+    size_t json_len = 0;
+    const char *json_str = _face_json(buf, face_id, "embedding", embedding, len, &json_len);
+    if (!json_str) {
+        ESP_LOGE(TAG, "Face JSON larger than %u bytes", (unsigned)SUPABASE_FACE_JSON_MAX);
+        mem_pool_free(buf); esp_http_client_cleanup(client); return ESP_ERR_NO_MEM;
+    }
+    esp_http_client_set_post_field(client, json_str, json_len);
+    PERF_TRACE_BEGIN(t_upload);
+    esp_err_t err = _perform(client, UPLINK_BULK, json_len);
+    PERF_TRACE_END(t_upload, "upload_face");
+
+    if (err == ESP_OK) {
+        int status = esp_http_client_get_status_code(client);
+        // Status 201 là Created (Tạo thành công)
+        if (status == 201 || status == 200 || status == 204) ESP_LOGI(TAG, "New Face Inserted to Cloud!");
+        else { ESP_LOGE(TAG, "Insert Face Error: %d", status); err = ESP_FAIL; }
+    } else ESP_LOGE(TAG, "Insert Face Failed: %s", esp_err_to_name(err));
+
+    mem_pool_free(buf); esp_http_client_cleanup(client);
+    return err;
+}
+
+esp_err_t supabase_upload_face_adapted(int face_id, const float *embedding, int len) {
+    char endpoint[64];
+    snprintf(endpoint, sizeof(endpoint), "/rest/v1/users?face_id=eq.%d", face_id);
+    esp_http_client_handle_t client = _init_client(endpoint, HTTP_METHOD_PATCH, 0, 0, false);
+    if (!client) return ESP_FAIL;
+
+    char *buf = (char *)mem_pool_alloc(SUPABASE_FACE_JSON_MAX);
+    if (!buf) { esp_http_client_cleanup(client); return ESP_ERR_NO_MEM; }
+    size_t json_len = 0;
+    const char *json_str = _face_json(buf, -1, "embedding_adapted", embedding, len, &json_len);
+    esp_err_t err = ESP_ERR_NO_MEM;
+    if (json_str) {
+        esp_http_client_set_header(client, "Prefer", "return=minimal");
+        esp_http_client_set_post_field(client, json_str, json_len);
+        PERF_TRACE_BEGIN(t_adapt);
+        err = _perform(client, UPLINK_BULK, json_len);
+        PERF_TRACE_END(t_adapt, "upload_face_adapted");
+        int status = esp_http_client_get_status_code(client);
+        if (err == ESP_OK && status >= 300) { ESP_LOGE(TAG, "Adapted Face Error: %d", status); err = ESP_FAIL; }
+    }
+    mem_pool_free(buf); esp_http_client_cleanup(client);
+    return err;
+}
+
+// Không malloc: chỉ ghi vào buf của người gọi
+size_t supabase_access_log_json(ev_source_t src, int face_id, float score, const char *image_filename, time_t created_at,
+                                char *buf, size_t len) {
+    json_writer_t w;
+    jw_init(&w, buf, len);
+    jw_obj_begin(&w);
+    jw_kv_str(&w, "device_id", "S3_LOCK_01");
+    if (created_at > 0) {
+        // Sự kiện xảy ra lúc offline: giữ đúng thời điểm mở cửa thay vì thời điểm gửi
+        char iso[32]; struct tm tm_utc; gmtime_r(&created_at, &tm_utc);
+        strftime(iso, sizeof(iso), "%Y-%m-%dT%H:%M:%SZ", &tm_utc);
+        jw_kv_str(&w, "created_at", iso);
+    }
+    if (face_id >= 0) {
+        jw_kv_int(&w, "face_id", face_id);
+        char desc[64]; snprintf(desc, sizeof(desc), "Face ID Match (%.2f)", score);
+        jw_kv_str(&w, "description", desc);
+        jw_kv_float(&w, "score", score, 4);
+    } else if (src == EV_SRC_FACE) {
+        // Người lạ (visitor_cache): 1 dòng cho mỗi lần xuất hiện, không phải mỗi frame
+        char desc[64]; snprintf(desc, sizeof(desc), "Unknown Visitor (%.2f)", score);
+        jw_kv_str(&w, "description", desc);
+        jw_kv_float(&w, "score", score, 4);
+    } else if (src == EV_SRC_LAN) jw_kv_str(&w, "description", "LAN Unlock via App");
+    else if (src == EV_SRC_WEB) jw_kv_str(&w, "description", "Unlock via Web");
+    else jw_kv_str(&w, "description", "Remote Unlock via App");
+    if (image_filename && image_filename[0]) jw_kv_str(&w, "image_url", image_filename);
+    jw_obj_end(&w);
+    size_t n = 0;
+    return jw_finish(&w, &n) ? n : 0;
+}
+
+// created_at = 0 -> để server tự điền thời điểm nhận
+static esp_err_t _post_access_log(ev_source_t src, int face_id, float score, const char *image_filename, time_t created_at) {
+    char json[SUPABASE_LOG_JSON_MAX];
+    size_t json_len = supabase_access_log_json(src, face_id, score, image_filename, created_at, json, sizeof(json));
+    if (!json_len) return ESP_ERR_NO_MEM;
+    esp_http_client_handle_t client = _init_client("/rest/v1/access_logs", HTTP_METHOD_POST, 0, 0, false);
+    if (!client) return ESP_FAIL;
+    esp_http_client_set_post_field(client, json, json_len);
+    PERF_TRACE_BEGIN(t_upload);
+    esp_err_t err = _perform(client, UPLINK_LOG, json_len);
+    PERF_TRACE_END(t_upload, "upload_log");
+    if (err == ESP_OK && esp_http_client_get_status_code(client) >= 300) {
+        ESP_LOGE(TAG, "Log Error: %d", esp_http_client_get_status_code(client));
+        err = ESP_FAIL;
+    }
+    esp_http_client_cleanup(client);
+    return err;
+}
+
+esp_err_t supabase_log_access(int face_id, float score, const char *image_filename) {
+    return _post_access_log(face_id >= 0 ? EV_SRC_FACE : EV_SRC_REMOTE, face_id, score, image_filename, 0);
+}
+
+// OUTBOX: hàng đợi gửi cloud bất đồng bộ + kho sự kiện local
+// Người gọi (AI, HTTP, nút bấm) chỉ copy sự kiện vào hàng đợi; task outbox ghi vào event_store
+// rồi giữ sự kiện trong RAM cho tới khi có mạng. Offline thì nhận diện vẫn chạy y như online.
+typedef struct {
+    ev_source_t source;
+    int face_id;
+    float score;
+    time_t ts;              // 0 nếu chưa đồng bộ giờ SNTP
+    uint32_t snap;          // Mã ảnh do event_store cấp -> tên ảnh trên Storage
+    uint8_t *jpg;           // Ảnh bằng chứng (PSRAM): thumbnail mặt hoặc bản copy frame, NULL nếu không có
+    size_t jpg_len;
+    uint8_t *full;          // Frame gốc gửi kèm theo lịch thưa (face_thumb), NULL nếu không
+    size_t full_len;
+    char image[32];         // Tên ảnh trên Storage sau khi đã upload
+} outbox_item_t;
+
+static QueueHandle_t s_outbox_in = NULL;
+static outbox_item_t s_pending[SUPABASE_OUTBOX_LEN];   // Chỉ task outbox đọc/ghi
+static int s_pending_head = 0;
+static int s_pending_count = 0;
+static volatile uint32_t s_outbox_sent = 0;
+static volatile uint32_t s_outbox_dropped = 0;
+static volatile uint32_t s_outbox_posts = 0;    // POST access_logs (mỗi POST gộp nhiều sự kiện)
+
+static void _outbox_item_free(outbox_item_t *it) {
+    if (it->jpg) heap_caps_free(it->jpg);
+    if (it->full) heap_caps_free(it->full);
+    it->jpg = NULL;
+    it->full = NULL;
+}
+
+// Giờ hệ thống chỉ tin được sau khi SNTP đã đồng bộ (> 2023)
+static time_t _valid_time_now(void) {
+    time_t now = time(NULL);
+    return now > 1700000000 ? now : 0;
+}
+
+static esp_err_t _outbox_push(outbox_item_t *it) {
+    if (!s_outbox_in) { _outbox_item_free(it); return ESP_ERR_INVALID_STATE; }
+    if (xQueueSend(s_outbox_in, it, 0) != pdTRUE) {
+        _outbox_item_free(it);
+        s_outbox_dropped++;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static uint8_t *_copy_fb(const camera_fb_t *fb, size_t *out_len) {
+    *out_len = 0;
+    if (!fb || fb->len == 0) return NULL;
+    uint8_t *copy = (uint8_t *)heap_caps_malloc(fb->len, MALLOC_CAP_SPIRAM);
+    if (copy) { memcpy(copy, fb->buf, fb->len); *out_len = fb->len; }
+    return copy;
+}
+
+esp_err_t supabase_log_access_async(ev_source_t src, int face_id, float score, const camera_fb_t *fb) {
+    if (!s_outbox_in) return ESP_ERR_INVALID_STATE;
+    outbox_item_t it = {
+        .source = src, .face_id = face_id, .score = score,
+        .ts = _valid_time_now(), .snap = 0,
+        .jpg = NULL, .jpg_len = 0, .full = NULL, .full_len = 0, .image = {0},
+    };
+    it.jpg = _copy_fb(fb, &it.jpg_len);
+    return _outbox_push(&it);
+}
+
+esp_err_t supabase_log_access_thumb(int face_id, float score, uint8_t *thumb, size_t thumb_len, const camera_fb_t *full_fb) {
+    outbox_item_t it = {
+        .source = EV_SRC_FACE, .face_id = face_id, .score = score,
+        .ts = _valid_time_now(), .snap = 0,
+        .jpg = thumb, .jpg_len = thumb_len, .full = NULL, .full_len = 0, .image = {0},
+    };
+    it.full = _copy_fb(full_fb, &it.full_len);
+    return _outbox_push(&it);
+}
+
+static outbox_item_t *_pending_at(int k) {
+    return &s_pending[(s_pending_head + k) % SUPABASE_OUTBOX_LEN];
+}
+
+// 1 POST mảng cho n sự kiện đầu hàng chờ (PostgREST chèn nhiều dòng trong 1 request)
+static esp_err_t _post_access_logs(int n) {
+    size_t cap = SUPABASE_LOG_JSON_MAX * SUPABASE_LOG_BATCH_MAX;
+    char *json = (char *)mem_pool_alloc(cap);
+    if (!json) return ESP_ERR_NO_MEM;
+    size_t off = 0;
+    json[off++] = '[';
+    for (int k = 0; k < n; k++) {
+        const outbox_item_t *it = _pending_at(k);
+        if (k) json[off++] = ',';
+        size_t m = supabase_access_log_json(it->source, it->face_id, it->score, it->image, it->ts, json + off, cap - off - 1);
+        if (!m) { mem_pool_free(json); return ESP_ERR_NO_MEM; }
+        off += m;
+    }
+    json[off++] = ']';
+
+    esp_err_t err = ESP_FAIL;
+    esp_http_client_handle_t client = _init_client("/rest/v1/access_logs", HTTP_METHOD_POST, 0, 0, false);
+    if (client) {
+        esp_http_client_set_header(client, "Prefer", "return=minimal");
+        esp_http_client_set_post_field(client, json, off);
+        PERF_TRACE_BEGIN(t_upload);
+        err = _perform(client, UPLINK_LOG, off);
+        PERF_TRACE_END(t_upload, "upload_log");
+        if (err == ESP_OK && esp_http_client_get_status_code(client) >= 300) {
+            ESP_LOGE(TAG, "Log Error: %d", esp_http_client_get_status_code(client));
+            err = ESP_FAIL;
+        }
+        esp_http_client_cleanup(client);
+    }
+    if (err == ESP_OK) s_outbox_posts++;
+    mem_pool_free(json);
+    return err;
+}
+
+// Ảnh bằng chứng của sự kiện đầu -> 1 POST gộp log của nó và các sự kiện liền sau không còn ảnh chờ
+// -> frame gốc sau cùng (lớp ưu tiên thấp nhất). Trả số sự kiện đã xong, 0 nếu lỗi.
+static int _outbox_send_batch(void) {
+    outbox_item_t *head = _pending_at(0);
+    if (head->jpg) {
+        char img_name[64] = {0};
+        if (head->snap) event_snapshot_name(head->snap, img_name, sizeof(img_name));
+        uplink_class_t cls = head->jpg_len <= FACE_THUMB_JPG_MAX ? UPLINK_THUMB : UPLINK_FULL;
+        if (_upload_jpeg(head->jpg, head->jpg_len, img_name, cls) != ESP_OK) return 0;
+        // Ảnh đã lên: lần thử lại sau chỉ cần gửi log
+        strlcpy(head->image, img_name, sizeof(head->image));
+        heap_caps_free(head->jpg);
+        head->jpg = NULL;
+    }
+    int n = 1;
+    while (n < s_pending_count && n < SUPABASE_LOG_BATCH_MAX && !_pending_at(n)->jpg) n++;
+    if (_post_access_logs(n) != ESP_OK) return 0;
+
+    for (int k = 0; k < n; k++) {
+        outbox_item_t *it = _pending_at(k);
+        if (!it->full || !it->image[0]) continue;
+        // Frame gốc đặt tên theo ảnh bằng chứng: ev_1a2b.jpg -> ev_1a2b_full.jpg (app tự suy ra, không cần thêm cột)
+        // Chỉ là phần phụ: lỗi thì bỏ, log đã lên rồi
+        char full_name[64];
+        snprintf(full_name, sizeof(full_name), "%.*s_full.jpg", (int)strcspn(it->image, "."), it->image);
+        if (_upload_jpeg(it->full, it->full_len, full_name, UPLINK_FULL) != ESP_OK) ESP_LOGW(TAG, "Full frame dropped");
+        heap_caps_free(it->full);
+        it->full = NULL;
+    }
+    return n;
+}
+
+static void outbox_task(void *pvParameters) {
+    int attempts = 0;
+    TickType_t wait = portMAX_DELAY;
+
+    while (1) {
+        // 1. Nhận sự kiện mới -> ghi event_store -> đưa vào hàng chờ gửi
+        outbox_item_t it;
+        if (xQueueReceive(s_outbox_in, &it, wait) == pdTRUE) {
+            event_rec_t rec;
+            if (event_store_append(it.source, it.face_id, it.score, it.ts, it.jpg != NULL, &rec) == ESP_OK) {
+                it.snap = rec.snap;
+                access_stats_record(&rec);
+            }
+            if (s_pending_count == SUPABASE_OUTBOX_LEN) {
+                // Offline quá lâu: bỏ sự kiện cũ nhất (vẫn còn trong event_store)
+                _outbox_item_free(&s_pending[s_pending_head]);
+                s_pending_head = (s_pending_head + 1) % SUPABASE_OUTBOX_LEN;
+                s_pending_count--;
+                s_outbox_dropped++;
+                attempts = 0;
+            }
+            s_pending[(s_pending_head + s_pending_count) % SUPABASE_OUTBOX_LEN] = it;
+            s_pending_count++;
+            // Hàng chờ vừa có việc: không chờ vô hạn sự kiện kế (đang lùi sau lỗi thì giữ nhịp lùi)
+            if (wait == portMAX_DELAY) wait = 0;
+            continue;   // Gom hết sự kiện đang chờ trước khi gửi
+        }
+
+        // 2. Gửi sự kiện cũ nhất khi có mạng
+        if (s_pending_count == 0) { wait = portMAX_DELAY; continue; }
+        if (!wifi_is_connected() || strlen(SUPABASE_URL) < 5) { wait = pdMS_TO_TICKS(1000); continue; }
+
+        int done = _outbox_send_batch();
+        if (done > 0) {
+            s_outbox_sent += done;
+        } else if (++attempts >= SUPABASE_OUTBOX_MAX_ATTEMPTS) {
+            s_outbox_dropped++;
+            done = 1;
+        }
+        if (done > 0) {
+            for (int k = 0; k < done; k++) {
+                _outbox_item_free(_pending_at(0));
+                s_pending_head = (s_pending_head + 1) % SUPABASE_OUTBOX_LEN;
+                s_pending_count--;
+            }
+            attempts = 0;
+            wait = 0;
+        } else {
+            // Lỗi mạng/server: lùi dần 2s, 4s, 8s...
+            wait = pdMS_TO_TICKS(1000 << attempts);
+        }
+    }
+}
+
+// BENCHMARK: json_writer so với cJSON trên đúng 2 payload gửi lên cloud (/bench?name=json_...)
+#define JSON_BENCH_EMB_DIM FACE_EMBED_DIM
+
+typedef struct {
+    char *buf;              // Buffer đích cấp 1 lần ở vòng khởi động (PSRAM)
+    float emb[JSON_BENCH_EMB_DIM];
+} json_bench_ctx_t;
+
+static json_bench_ctx_t *s_json_bench = NULL;
+
+static char *_json_bench_buf(void) {
+    if (!s_json_bench) {
+        s_json_bench = (json_bench_ctx_t *)heap_caps_calloc(1, sizeof(json_bench_ctx_t), MALLOC_CAP_SPIRAM);
+        if (!s_json_bench) return NULL;
+        s_json_bench->buf = (char *)heap_caps_malloc(SUPABASE_FACE_JSON_MAX, MALLOC_CAP_SPIRAM);
+        for (int i = 0; i < JSON_BENCH_EMB_DIM; i++) s_json_bench->emb[i] = ((i * 37) % 200 - 100) / 1000.0f;
+    }
+    return s_json_bench->buf;
+}
+
+static void _bench_log_writer(void *ctx) {
+    char json[SUPABASE_LOG_JSON_MAX];
+    supabase_access_log_json(EV_SRC_FACE, 3, 0.8731f, "log_123456.jpg", 1760000000, json, sizeof(json));
+}
+
+// Đếm malloc của cJSON để /bench báo được allocs/iter. Hook chỉ bật trong 1 vòng benchmark cJSON,
+// xong trả về malloc/free mặc định: request cloud thật không đi qua bộ đếm.
+static void *_cjson_counted_malloc(size_t sz) {
+    bench_count_alloc();
+    return malloc(sz);
+}
+
+static void _cjson_count_begin(void) {
+    cJSON_Hooks hooks = { .malloc_fn = _cjson_counted_malloc, .free_fn = free };
+    cJSON_InitHooks(&hooks);
+}
+
+static void _cjson_count_end(void) {
+    cJSON_InitHooks(NULL);
+}
+
+// Cách cũ: dựng cây cJSON rồi in vào buffer cố định
+static void _bench_log_cjson(void *ctx) {
+    char json[SUPABASE_LOG_JSON_MAX];
+    time_t ts = 1760000000;
+    char iso[32]; struct tm tm_utc; gmtime_r(&ts, &tm_utc);
+    strftime(iso, sizeof(iso), "%Y-%m-%dT%H:%M:%SZ", &tm_utc);
+    char desc[64]; snprintf(desc, sizeof(desc), "Face ID Match (%.2f)", 0.8731f);
+    _cjson_count_begin();
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "device_id", "S3_LOCK_01");
+    cJSON_AddStringToObject(root, "created_at", iso);
+    cJSON_AddNumberToObject(root, "face_id", 3);
+    cJSON_AddStringToObject(root, "description", desc);
+    cJSON_AddNumberToObject(root, "score", 0.8731f);
+    cJSON_AddStringToObject(root, "image_url", "log_123456.jpg");
+    cJSON_PrintPreallocated(root, json, sizeof(json), false);
+    cJSON_Delete(root);
+    _cjson_count_end();
+}
+
+static void _bench_face_writer(void *ctx) {
+    char *buf = _json_bench_buf();
+    if (!buf) return;
+    json_writer_t w;
+    jw_init(&w, buf, SUPABASE_FACE_JSON_MAX);
+    jw_obj_begin(&w);
+    jw_kv_int(&w, "face_id", 7);
+    jw_key(&w, "embedding");
+    jw_arr_begin(&w);
+    for (int i = 0; i < JSON_BENCH_EMB_DIM; i++) jw_float(&w, s_json_bench->emb[i], 6);
+    jw_arr_end(&w);
+    jw_obj_end(&w);
+    jw_finish(&w, NULL);
+}
+
+static void _bench_face_cjson(void *ctx) {
+    char *buf = _json_bench_buf();
+    if (!buf) return;
+    _cjson_count_begin();
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "face_id", 7);
+    cJSON *emb_array = cJSON_CreateArray();
+    for (int i = 0; i < JSON_BENCH_EMB_DIM; i++) cJSON_AddItemToArray(emb_array, cJSON_CreateNumber(s_json_bench->emb[i]));
+    cJSON_AddItemToObject(root, "embedding", emb_array);
+    cJSON_PrintPreallocated(root, buf, SUPABASE_FACE_JSON_MAX, false);
+    cJSON_Delete(root);
+    _cjson_count_end();
+}
+
+// Parse phản hồi users của sync (embedding dạng chuỗi như PostgREST trả về) + tách từng embedding
+#define JSON_BENCH_SYNC_USERS 4
+
+static bool _parse_embedding(const cJSON *json, float *out);
+static char *s_sync_sample = NULL;
+
+static bool _sync_sample_build(void) {
+    if (s_sync_sample) return true;
+    size_t cap = JSON_BENCH_SYNC_USERS * (JSON_BENCH_EMB_DIM * 12 + 128) + 8;
+    char *p = (char *)heap_caps_malloc(cap, MALLOC_CAP_SPIRAM);
+    if (!p || !_json_bench_buf()) { heap_caps_free(p); return false; }
+    size_t off = snprintf(p, cap, "[");
+    for (int u = 0; u < JSON_BENCH_SYNC_USERS; u++) {
+        off += snprintf(p + off, cap - off, "%s{\"id\":%d,\"face_id\":%d,\"name\":\"User %d\",\"embedding\":\"[",
+                        u ? "," : "", u + 1, u + 1, u + 1);
+        for (int i = 0; i < JSON_BENCH_EMB_DIM; i++) {
+            off += snprintf(p + off, cap - off, "%s%.6f", i ? "," : "", s_json_bench->emb[i]);
+        }
+        off += snprintf(p + off, cap - off, "]\",\"embedding_adapted\":null}");
+    }
+    snprintf(p + off, cap - off, "]");
+    s_sync_sample = p;
+    return true;
+}
+
+static void _bench_sync_parse(void *ctx) {
+    if (!_sync_sample_build()) return;
+    _cjson_count_begin();
+    cJSON *root = cJSON_Parse(s_sync_sample);
+    const cJSON *item;
+    cJSON_ArrayForEach(item, root) {
+        _parse_embedding(cJSON_GetObjectItem(item, "embedding"), s_json_bench->emb);
+    }
+    cJSON_Delete(root);
+    _cjson_count_end();
+}
+
+static void _json_bench_init(void) {
+    bench_register("json_log_writer", _bench_log_writer, NULL);
+    bench_register("json_log_cjson", _bench_log_cjson, NULL);
+    bench_register("json_face_writer", _bench_face_writer, NULL);
+    bench_register("json_face_cjson", _bench_face_cjson, NULL);
+    bench_register("json_sync_parse", _bench_sync_parse, NULL);
+}
+
+static void enroll_bus_handler(const bus_event_t *ev, void *ctx);
+
+void supabase_outbox_init(void) {
+    if (s_outbox_in) return;
+    _json_bench_init();
+    s_outbox_in = xQueueCreate(8, sizeof(outbox_item_t));
+    xTaskCreatePinnedToCore(outbox_task, "cloud_outbox", 6144, NULL, 3, NULL, 0);
+    event_bus_subscribe(BUS_MASK(BUS_EV_ENROLL_REQUEST), enroll_bus_handler, NULL, "cloud_enroll");
+}
+
+size_t supabase_outbox_status_json(char *buf, size_t len) {
+    int n = snprintf(buf, len, "{\"pending\":%d,\"queued\":%u,\"sent\":%lu,\"dropped\":%lu,\"log_posts\":%lu,"
+                     "\"upload\":{\"ok\":%lu,\"failed\":%lu,\"retries\":%lu,\"resumed\":%lu,\"bytes\":%llu,"
+                     "\"last_ms\":%lu,\"last_kbps\":%lu}}",
+                     s_pending_count, s_outbox_in ? (unsigned)uxQueueMessagesWaiting(s_outbox_in) : 0,
+                     (unsigned long)s_outbox_sent, (unsigned long)s_outbox_dropped, (unsigned long)s_outbox_posts,
+                     (unsigned long)s_up.ok, (unsigned long)s_up.failed, (unsigned long)s_up.retries,
+                     (unsigned long)s_up.resumed, (unsigned long long)s_up.bytes,
+                     (unsigned long)s_up.last_ms, (unsigned long)s_up.last_kbps);
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
+
+// Embedding có thể là String hoặc JSON Array. false nếu thiếu / sai số chiều
+static bool _parse_embedding(const cJSON *json, float *out) {
+    if (!json || cJSON_IsNull(json)) return false;
+    cJSON *arr = cJSON_IsString(json) ? cJSON_Parse(json->valuestring) : (cJSON *)json;
+    bool ok = cJSON_IsArray(arr) && cJSON_GetArraySize(arr) == FACE_EMBED_DIM;
+    if (ok) {
+        int j = 0;
+        const cJSON *v;
+        cJSON_ArrayForEach(v, arr) out[j++] = (float)v->valuedouble;
+    }
+    if (cJSON_IsString(json)) cJSON_Delete(arr);
+    return ok;
+}
+
+// ---> ĐÃ SỬA: Thêm &limit=100 và select=face_id
+void supabase_sync_users(void) {
+    ESP_LOGI(TAG, "Syncing Users from Table 'users'...");
+    // select=*: embedding_adapted là cột tuỳ chọn, bảng chưa có cột này vẫn đồng bộ được
+    esp_http_client_handle_t client = _init_client("/rest/v1/users?select=*&limit=100", HTTP_METHOD_GET, 20480, 0, false);
+    if (!client) return;
+
+    PERF_TRACE_BEGIN(t_sync);
+    // Tải danh sách là việc nền: giữ lượt lúc tải, trả trước khi parse
+    esp_err_t err = uplink_acquire(UPLINK_BULK, 0, UPLINK_WAIT_MS);
+    bool held = err == ESP_OK;
+    // Mở kết nối thủ công
+    if (err == ESP_OK) err = esp_http_client_open(client, 0);
+    if (err == ESP_OK) {
+        // Lấy Content-Length
+        int content_len = esp_http_client_fetch_headers(client);
+        
+        // Nếu length <= 0 (Chunked Encoding), dùng nguyên khối LARGE của pool (128KB)
+        int total_to_read = content_len;
+        if (total_to_read <= 0) {
+            ESP_LOGW(TAG, "Content length unknown (Chunked). Using 128KB pool buffer.");
+            total_to_read = MEM_POOL_LARGE_SIZE - 1; 
+        }
+
+        // Lấy từ pool (PSRAM), quá 128KB thì pool tự rơi về heap
+        char *buf = (char *)mem_pool_alloc(total_to_read + 1);
+        if (buf) {
+            int total_read = 0;
+            while (1) {
+                int r = esp_http_client_read_response(client, buf + total_read, total_to_read - total_read);
+                if (r < 0) {
+                    ESP_LOGE(TAG, "Read Error");
+                    break;
+                }
+                if (r == 0) {
+                    break;
+                }
+                total_read += r;
+                // Tránh tràn buffer
+                if (total_read >= total_to_read) break; 
+            }
+            buf[total_read] = 0; // Kết thúc chuỗi
+            if (held) { uplink_release(); held = false; }
+
+            if (total_read > 0) {
+                ESP_LOGI(TAG, "Downloaded %d bytes. Parsing JSON...", total_read);
+                cJSON *root = cJSON_Parse(buf);
+                if (root) {
+                    if (cJSON_IsArray(root)) {
+                        int count = cJSON_GetArraySize(root);
+                        ESP_LOGI(TAG, "FOUND %d USERS in Database!", count);
+                        
+                        for (int i = 0; i < count; i++) {
+                            cJSON *item = cJSON_GetArrayItem(root, i);
+                            // SỬA: Parse trường "face_id"
+                            cJSON *id_json = cJSON_GetObjectItem(item, "face_id");
+                            cJSON *emb_json = cJSON_GetObjectItem(item, "embedding");
+                            
+                            if (id_json && emb_json && !cJSON_IsNull(emb_json)) {
+                                int uid = id_json->valueint;
+                                float *emb_buf = (float *)mem_pool_alloc(FACE_EMBED_BYTES);
+                                if (emb_buf) {
+                                    // Mẫu gốc trước, rồi mới tới mẫu đã học (nếu có)
+                                    if (_parse_embedding(emb_json, emb_buf)) {
+                                        face_api_add_user_from_cloud(uid, emb_buf, FACE_EMBED_DIM);
+                                        if (_parse_embedding(cJSON_GetObjectItem(item, "embedding_adapted"), emb_buf)) {
+                                            face_api_adapted_from_cloud(uid, emb_buf, FACE_EMBED_DIM);
+                                        }
+                                    }
+                                    mem_pool_free(emb_buf);
+                                }
+                            }
+                        }
+                    } else {
+                        ESP_LOGE(TAG, "JSON is not an array");
+                    }
+                    cJSON_Delete(root);
+                } else {
+                    ESP_LOGE(TAG, "cJSON Parse Failed (JSON Broken or Empty)");
+                }
+            } else {
+                ESP_LOGW(TAG, "Response Empty (0 bytes)");
+            }
+            mem_pool_free(buf);
+        } else {
+            ESP_LOGE(TAG, "Malloc Failed (Out of PSRAM?)");
+        }
+    } else {
+        ESP_LOGE(TAG, "HTTP Open Failed: %s", esp_err_to_name(err));
+    }
+    if (held) uplink_release();
+    esp_http_client_cleanup(client);
+    PERF_TRACE_END(t_sync, "sync_users");
+}
+
+// Upsert 1 dòng/thiết bị vào bảng device_stats (device_id khoá chính, summary jsonb)
+esp_err_t supabase_publish_stats(void) {
+    char *body = (char *)mem_pool_alloc(SUPABASE_STATS_JSON_MAX);
+    if (!body) return ESP_ERR_NO_MEM;
+    int n = snprintf(body, SUPABASE_STATS_JSON_MAX, "{\"device_id\":\"S3_LOCK_01\",\"summary\":");
+    size_t s = access_stats_json(body + n, SUPABASE_STATS_JSON_MAX - n - 1);
+    if (s == 0) { mem_pool_free(body); return ESP_ERR_NO_MEM; }
+    n += s;
+    body[n++] = '}';
+    body[n] = '\0';
+
+    esp_err_t err = ESP_FAIL;
+    esp_http_client_handle_t client = _init_client("/rest/v1/device_stats?on_conflict=device_id", HTTP_METHOD_POST, 0, 0, false);
+    if (client) {
+        esp_http_client_set_header(client, "Prefer", "resolution=merge-duplicates,return=minimal");
+        esp_http_client_set_post_field(client, body, n);
+        PERF_TRACE_BEGIN(t_stats);
+        err = _perform(client, UPLINK_LOG, n);
+        PERF_TRACE_END(t_stats, "publish_stats");
+        int status = esp_http_client_get_status_code(client);
+        if (err == ESP_OK && status >= 300) { ESP_LOGE(TAG, "Stats Error: %d", status); err = ESP_FAIL; }
+        esp_http_client_cleanup(client);
+    }
+    mem_pool_free(body);
+    return err;
+}
+
+static void mark_command_executed(int cmd_id) {
+    char endpoint[64]; snprintf(endpoint, sizeof(endpoint), "/rest/v1/device_commands?id=eq.%d", cmd_id);
+    esp_http_client_handle_t client = _init_client(endpoint, HTTP_METHOD_PATCH, 0, 0, false);
+    if (client) {
+        const char *json = "{\"status\":\"executed\"}";
+        esp_http_client_set_post_field(client, json, strlen(json));
+        _perform(client, UPLINK_CMD, strlen(json));
+        esp_http_client_cleanup(client);
+    }
+}
+
+// Lệnh ENROLL từ App: pipeline nhận diện gom embedding từ frame live (không dừng nhận diện),
+// ở đây chỉ upload ảnh + embedding và cập nhật gallery local
+static void perform_enrollment(int user_id) {
+    ESP_LOGW(TAG, "START ENROLLMENT ID: %d", user_id);
+    char msg[80];
+    snprintf(msg, sizeof(msg), "{\"type\":\"enroll\",\"state\":\"started\",\"id\":%d}", user_id);
+    ws_send_message(msg);
+
+    float *new_embedding = (float *)mem_pool_alloc(FACE_EMBED_BYTES);
+    if (!new_embedding) { ESP_LOGE(TAG, "Enroll: Alloc Failed"); return; }
+
+    camera_fb_t photo;
+    if (face_enroll(FACE_ENROLL_TIMEOUT_MS, new_embedding, &photo) == ESP_OK) {
+        ESP_LOGI(TAG, "Face Detected. Updating User on Cloud...");
+        snprintf(msg, sizeof(msg), "{\"type\":\"enroll\",\"state\":\"uploading\",\"id\":%d}", user_id);
+        ws_send_message(msg);
+        if (photo.buf) {
+            char filename[64];
+            snprintf(filename, sizeof(filename), "face_%d_%lu.jpg", user_id, (unsigned long)xTaskGetTickCount());
+            supabase_upload_image(&photo, filename);
+            heap_caps_free(photo.buf);
+        }
+        supabase_upload_face(user_id, new_embedding, FACE_EMBED_DIM);
+        face_api_add_user_from_cloud(user_id, new_embedding, FACE_EMBED_DIM);
+        snprintf(msg, sizeof(msg), "{\"type\":\"enroll\",\"state\":\"success\",\"id\":%d}", user_id);
+        ws_send_message(msg);
+    } else {
+        ESP_LOGE(TAG, "No Face Detected");
+        snprintf(msg, sizeof(msg), "{\"type\":\"enroll\",\"state\":\"failed\",\"id\":%d}", user_id);
+        ws_send_message(msg);
+    }
+    mem_pool_free(new_embedding);
+    ESP_LOGI(TAG, "Enrollment Finished");
+}
+
+static TaskHandle_t s_enroll_task = NULL;
+
+static void cloud_enroll_task(void *pvParameters) {
+    perform_enrollment((int)(intptr_t)pvParameters);
+    s_enroll_task = NULL;
+    vTaskDelete(NULL);
+}
+
+// ENROLL có user_id (từ App): face_enroll chặn tới 10s -> chạy task riêng, không giữ task bus
+static void enroll_bus_handler(const bus_event_t *ev, void *ctx) {
+    if (ev->enroll.user_id < 0) return;
+    if (s_enroll_task) { ESP_LOGW(TAG, "Enroll busy, drop ID %ld", (long)ev->enroll.user_id); return; }
+    if (xTaskCreatePinnedToCore(cloud_enroll_task, "cloud_enroll", 6144, (void *)(intptr_t)ev->enroll.user_id,
+                                4, &s_enroll_task, 0) != pdPASS) {
+        s_enroll_task = NULL;
+        ESP_LOGE(TAG, "Enroll task create failed");
+    }
+}
+
+void check_remote_command(void) {
+    // Tăng buffer rx_buf lên để chứa đủ JSON payload từ Flutter
+    esp_http_client_handle_t client = _init_client("/rest/v1/device_commands?select=id,command,payload&status=eq.pending&device_id=eq.S3_LOCK_01", HTTP_METHOD_GET, 8192, 0, false);
+    if (!client) return;
+
+    // Lớp ưu tiên cao nhất: chỉ giữ lượt lúc hỏi, trả trước khi thực thi lệnh
+    esp_err_t err = uplink_acquire(UPLINK_CMD, 0, UPLINK_WAIT_MS);
+    bool held = err == ESP_OK;
+    if (err == ESP_OK) err = esp_http_client_open(client, 0);
+    if (err == ESP_OK) {
+        esp_http_client_fetch_headers(client);
+        
+        // Không dùng get_content_length vì dễ bị lỗi với Chunked Encoding
+        char *buf = (char *)mem_pool_alloc(8192); // Khối MEDIUM của pool (PSRAM)
+        if (buf) {
+            int read_len = esp_http_client_read_response(client, buf, 8191);
+            uplink_release();
+            held = false;
+            if (read_len > 0) {
+                buf[read_len] = 0;
+                cJSON *root = cJSON_Parse(buf);
+                if (cJSON_IsArray(root) && cJSON_GetArraySize(root) > 0) {
+                    cJSON *item = cJSON_GetArrayItem(root, 0);
+                    
+                    cJSON *id_obj = cJSON_GetObjectItem(item, "id");
+                    cJSON *cmd_obj = cJSON_GetObjectItem(item, "command");
+
+                    if (id_obj && cmd_obj) {
+                        int id = id_obj->valueint;
+                        char *cmd = cmd_obj->valuestring;
+                        ESP_LOGW(TAG, "🔥 NHẬN LỆNH MỚI: %s (ID: %d)", cmd, id);
+
+                        if (strcmp(cmd, "OPEN") == 0) {
+                            bus_event_t ev = { .type = BUS_EV_COMMAND };
+                            ev.command.cmd = BUS_CMD_OPEN;
+                            ev.command.source = EV_SRC_REMOTE;
+                            ev.command.ref = id;
+                            // lock_ctrl điều khiển Relay. Bus đầy: để lệnh pending, lượt poll sau làm lại
+                            if (!event_bus_publish(&ev)) {
+                                ESP_LOGW(TAG, "Bus đầy, giữ lệnh %d cho lượt sau", id);
+                            } else {
+                                // Log và ảnh đi qua outbox (không giữ camera trong lúc upload)
+                                camera_fb_t *fb = NULL;
+                                if (xCameraMutex && xSemaphoreTake(xCameraMutex, pdMS_TO_TICKS(1000))) {
+                                    fb = esp_camera_fb_get();
+                                    xSemaphoreGive(xCameraMutex);
+                                }
+                                supabase_log_access_async(EV_SRC_REMOTE, -1, 1.0f, fb);
+                                if (fb) esp_camera_fb_return(fb);
+                                mark_command_executed(id); // Quan trọng: Đổi pending -> executed
+                            }
+                        } else if (strcmp(cmd, "ENROLL") == 0) {
+                            // payload: {"user_id": N} (App tạo user trước rồi mới gửi lệnh)
+                            cJSON *uid = cJSON_GetObjectItem(cJSON_GetObjectItem(item, "payload"), "user_id");
+                            if (cJSON_IsNumber(uid)) {
+                                bus_event_t ev = { .type = BUS_EV_ENROLL_REQUEST };
+                                ev.enroll.user_id = uid->valueint;
+                                event_bus_publish(&ev);
+                            }
+                            mark_command_executed(id);
+                        }
+                    }
+                }
+                cJSON_Delete(root);
+            }
+            mem_pool_free(buf);
+        }
+    } else {
+        ESP_LOGE(TAG, "Lỗi kết nối Polling: %s", esp_err_to_name(err));
+    }
+    if (held) uplink_release();
+    esp_http_client_cleanup(client);
 }
\ No newline at end of file
@@ -1,35 +1,74 @@
-#ifndef SUPABASE_CLIENT_H
-#define SUPABASE_CLIENT_H
-
-#include "esp_err.h"
-#include "esp_camera.h"
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-// BIẾN CẤU HÌNH ĐỘNG (Dynamic Config) 
-extern char SUPABASE_URL[128];
-extern char SUPABASE_KEY[1024]; 
-
-// Hàm khởi tạo (Sync giờ)
-void supabase_init(void);
-
-// Hàm quản lý cấu hình NVS
-esp_err_t supabase_load_config(void);
-esp_err_t supabase_save_config(const char *url, const char *key);
-
-// Các hàm nghiệp vụ
-esp_err_t supabase_log_access(int face_id, float score, const char *image_filename);
-void supabase_sync_users(void);
-esp_err_t supabase_upload_image(camera_fb_t *fb, char *filename_out);
-void check_remote_command(void);
-
-// Hàm này bị thiếu dẫn đến lỗi build
-esp_err_t supabase_upload_face(int face_id, float *embedding, int len);
-
-#ifdef __cplusplus
-}
-#endif
-
+#ifndef SUPABASE_CLIENT_H
+#define SUPABASE_CLIENT_H
+
+#include "esp_err.h"
+#include "esp_camera.h"
+#include <stddef.h>
+#include <time.h>
+#include "event_store.h"
+#include "face_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// BIẾN CẤU HÌNH ĐỘNG (Dynamic Config) 
+extern char SUPABASE_URL[128];
+extern char SUPABASE_KEY[1024]; 
+
+// Hàm khởi tạo (Sync giờ)
+void supabase_init(void);
+
+// Hàm quản lý cấu hình NVS
+esp_err_t supabase_load_config(void);
+esp_err_t supabase_save_config(const char *url, const char *key);
+
+// Các hàm nghiệp vụ
+esp_err_t supabase_log_access(int face_id, float score, const char *image_filename);
+void supabase_sync_users(void);
+esp_err_t supabase_upload_image(camera_fb_t *fb, char *filename_out);
+void check_remote_command(void);
+
+// OUTBOX: ghi log không chặn, giữ sự kiện khi offline và gửi lại khi có mạng
+#define SUPABASE_OUTBOX_LEN          16        // Số sự kiện tối đa chờ gửi (kèm ảnh)
+#define SUPABASE_OUTBOX_MAX_ATTEMPTS 5
+#define SUPABASE_LOG_BATCH_MAX       8         // Gộp tối đa chừng này dòng access_logs vào 1 POST
+
+void supabase_outbox_init(void);
+// Copy ảnh (nếu có) rồi trả về ngay; fb có thể trả lại camera ngay sau khi gọi
+esp_err_t supabase_log_access_async(ev_source_t src, int face_id, float score, const camera_fb_t *fb);
+// Ảnh bằng chứng là thumbnail mặt đã nén (outbox nhận quyền sở hữu, heap_caps_free).
+// full_fb != NULL: copy thêm frame gốc, upload thành <tên ảnh>_full.jpg
+esp_err_t supabase_log_access_thumb(int face_id, float score, uint8_t *thumb, size_t thumb_len, const camera_fb_t *full_fb);
+size_t supabase_outbox_status_json(char *buf, size_t len);
+
+// UPLOAD ẢNH: stream từ buffer ảnh theo khúc, buffer TX cố định (không phụ thuộc cỡ frame)
+#define SUPABASE_UPLOAD_CHUNK        4096
+#define SUPABASE_UPLOAD_TX_BUF       8192                // Đủ cho header Authorization (JWT dài)
+#define SUPABASE_UPLOAD_TUS_MIN      (64 * 1024)         // Từ cỡ này dùng upload resumable (TUS)
+#define SUPABASE_UPLOAD_RETRIES      3
+
+// JSON gửi lên Supabase được ghi bằng json_writer vào buffer cố định, không malloc
+#define SUPABASE_LOG_JSON_MAX        384                 // 1 dòng access_logs (stack)
+#define SUPABASE_FACE_JSON_MAX       (16 * 1024)         // face_id + embedding FACE_EMBED_DIM float (mem_pool)
+
+// Dựng body JSON của 1 dòng access_logs. Trả số byte, 0 nếu không đủ chỗ.
+size_t supabase_access_log_json(ev_source_t src, int face_id, float score, const char *image_filename, time_t created_at,
+                                char *buf, size_t len);
+
+// Bản tóm tắt access_stats -> bảng device_stats (upsert theo device_id)
+#define SUPABASE_STATS_JSON_MAX      2048
+esp_err_t supabase_publish_stats(void);
+
+// Hàm này bị thiếu dẫn đến lỗi build
+esp_err_t supabase_upload_face(int face_id, float *embedding, int len);
+
+// Mẫu đã học (face_detect cập nhật mẫu) -> cột embedding_adapted của users (PATCH theo face_id).
+// Cột embedding giữ nguyên embedding lúc enroll làm mẫu gốc.
+esp_err_t supabase_upload_face_adapted(int face_id, const float *embedding, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "uplink_sched.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "bench.h"
+
+static const char *TAG = "UPLINK";
+
+static const char *CLASS_NAMES[UPLINK_CLASS_COUNT] = { "cmd", "log", "thumb", "full", "bulk" };
+
+typedef struct {
+    // Token bucket (rate 0 = không giới hạn)
+    uint32_t rate_bps;
+    uint32_t burst;
+    int64_t tokens;         // Có thể âm: request lớn hơn burst -> request sau chờ bù
+    int64_t refill_us;
+    // Hàng chờ link
+    SemaphoreHandle_t wake; // Trao lượt cho 1 task đang chờ của lớp này
+    uint16_t depth;         // Số task đang chờ
+    uint16_t max_depth;
+    // Thống kê
+    uint32_t requests;
+    uint64_t bytes;
+    uint64_t wait_us;       // Chờ token + chờ link
+    uint32_t max_wait_us;
+    uint32_t shaped;        // Lần phải chờ token
+    uint32_t timeouts;
+} uplink_cls_t;
+
+static uplink_cls_t s_cls[UPLINK_CLASS_COUNT];
+static SemaphoreHandle_t s_mutex = NULL;    // Bảo vệ toàn bộ trạng thái dưới đây
+static bool s_busy = false;                 // Link đang có người dùng (kể cả lúc đang trao lượt)
+static TaskHandle_t s_owner = NULL;         // NULL trong lúc trao lượt cho task đang chờ
+static int s_nest = 0;
+
+// BENCHMARK: xin + trả lượt khi link trống (chi phí lập lịch thêm vào mỗi request cloud).
+// Lượt đo được tính vào thống kê lớp cmd.
+static void _bench_turn(void *ctx) {
+    if (uplink_acquire(UPLINK_CMD, 0, 1000) == ESP_OK) uplink_release();
+}
+
+void uplink_sched_init(void) {
+    if (s_mutex) return;
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex) { ESP_LOGE(TAG, "Alloc Fail"); return; }
+    for (int i = 0; i < UPLINK_CLASS_COUNT; i++) {
+        s_cls[i].wake = xSemaphoreCreateCounting(16, 0);
+        if (!s_cls[i].wake) { ESP_LOGE(TAG, "Alloc Fail"); vSemaphoreDelete(s_mutex); s_mutex = NULL; return; }
+    }
+    s_cls[UPLINK_FULL].rate_bps = UPLINK_FULL_BPS;
+    s_cls[UPLINK_FULL].burst = UPLINK_FULL_BURST;
+    s_cls[UPLINK_BULK].rate_bps = UPLINK_BULK_BPS;
+    s_cls[UPLINK_BULK].burst = UPLINK_BULK_BURST;
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < UPLINK_CLASS_COUNT; i++) {
+        s_cls[i].tokens = s_cls[i].burst;
+        s_cls[i].refill_us = now;
+    }
+    bench_register("uplink_turn", _bench_turn, NULL);
+}
+
+// Gọi khi giữ s_mutex. Trả thời gian phải chờ (us) trước khi gửi `bytes`; token trừ luôn.
+static int64_t _take_tokens(uplink_cls_t *c, size_t bytes, int64_t now) {
+    if (!c->rate_bps || !bytes) return 0;
+    c->tokens += (now - c->refill_us) * c->rate_bps / 1000000;
+    if (c->tokens > c->burst) c->tokens = c->burst;
+    c->refill_us = now;
+    int64_t need = bytes < c->burst ? (int64_t)bytes : (int64_t)c->burst;
+    int64_t wait_us = c->tokens >= need ? 0 : (need - c->tokens) * 1000000 / c->rate_bps;
+    c->tokens -= bytes;
+    return wait_us;
+}
+
+static void _record(uplink_cls_t *c, size_t bytes, int64_t t0) {
+    uint32_t waited = (uint32_t)(esp_timer_get_time() - t0);
+    c->requests++;
+    c->bytes += bytes;
+    c->wait_us += waited;
+    if (waited > c->max_wait_us) c->max_wait_us = waited;
+}
+
+esp_err_t uplink_acquire(uplink_class_t cls, size_t bytes, uint32_t timeout_ms) {
+    if (!s_mutex) return ESP_OK;
+    if ((unsigned)cls >= UPLINK_CLASS_COUNT) cls = UPLINK_BULK;
+    uplink_cls_t *c = &s_cls[cls];
+    TaskHandle_t me = xTaskGetCurrentTaskHandle();
+    int64_t t0 = esp_timer_get_time();
+    int64_t deadline = t0 + (int64_t)timeout_ms * 1000;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (s_owner == me) {
+        // Lồng nhau trong lượt của chính mình: không xếp hàng, không trừ token
+        s_nest++;
+        _record(c, bytes, t0);
+        xSemaphoreGive(s_mutex);
+        return ESP_OK;
+    }
+    // 1. Token bucket: chờ ngoài link, không chặn lớp khác
+    int64_t shape_us = _take_tokens(c, bytes, t0);
+    if (shape_us > 0) {
+        c->shaped++;
+        if (t0 + shape_us > deadline) {
+            c->tokens += bytes;
+            c->timeouts++;
+            xSemaphoreGive(s_mutex);
+            return ESP_ERR_TIMEOUT;
+        }
+        xSemaphoreGive(s_mutex);
+        vTaskDelay(pdMS_TO_TICKS(shape_us / 1000) + 1);
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+    }
+
+    // 2. Link trống thì lấy luôn, không thì xếp hàng theo lớp
+    if (!s_busy) {
+        s_busy = true;
+        s_owner = me;
+        s_nest = 1;
+        _record(c, bytes, t0);
+        xSemaphoreGive(s_mutex);
+        return ESP_OK;
+    }
+    c->depth++;
+    if (c->depth > c->max_depth) c->max_depth = c->depth;
+    xSemaphoreGive(s_mutex);
+
+    int64_t left_us = deadline - esp_timer_get_time();
+    bool got = left_us > 0 && xSemaphoreTake(c->wake, pdMS_TO_TICKS(left_us / 1000) + 1) == pdTRUE;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    // Hết giờ đúng lúc được trao lượt: release đã giảm depth và give trong mutex -> vẫn nhận
+    if (!got) got = xSemaphoreTake(c->wake, 0) == pdTRUE;
+    if (got) {
+        s_owner = me;
+        s_nest = 1;
+        _record(c, bytes, t0);
+    } else {
+        c->depth--;
+        c->tokens += bytes;
+        c->timeouts++;
+    }
+    xSemaphoreGive(s_mutex);
+    return got ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+void uplink_release(void) {
+    if (!s_mutex) return;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (s_owner == xTaskGetCurrentTaskHandle() && --s_nest > 0) {
+        xSemaphoreGive(s_mutex);
+        return;
+    }
+    s_owner = NULL;
+    s_nest = 0;
+    s_busy = false;
+    // Trao thẳng cho lớp ưu tiên cao nhất đang chờ (link vẫn bận tới khi task đó nhận)
+    for (int i = 0; i < UPLINK_CLASS_COUNT; i++) {
+        if (s_cls[i].depth == 0) continue;
+        s_cls[i].depth--;
+        s_busy = true;
+        xSemaphoreGive(s_cls[i].wake);
+        break;
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+size_t uplink_stats_json(char *buf, size_t len) {
+    if (!s_mutex) return 0;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int n = snprintf(buf, len, "{\"busy\":%s,\"classes\":[", s_busy ? "true" : "false");
+    size_t off = (n > 0 && (size_t)n < len) ? n : 0;
+    for (int i = 0; off && i < UPLINK_CLASS_COUNT; i++) {
+        const uplink_cls_t *c = &s_cls[i];
+        n = snprintf(buf + off, len - off,
+                     "%s{\"class\":\"%s\",\"requests\":%lu,\"bytes\":%llu,\"depth\":%u,\"max_depth\":%u,"
+                     "\"avg_wait_ms\":%lu,\"max_wait_ms\":%lu,\"shaped\":%lu,\"timeouts\":%lu}",
+                     i ? "," : "", CLASS_NAMES[i], (unsigned long)c->requests, (unsigned long long)c->bytes,
+                     c->depth, c->max_depth,
+                     (unsigned long)(c->requests ? c->wait_us / c->requests / 1000 : 0),
+                     (unsigned long)(c->max_wait_us / 1000), (unsigned long)c->shaped, (unsigned long)c->timeouts);
+        off = (n > 0 && (size_t)n < len - off) ? off + n : 0;
+    }
+    xSemaphoreGive(s_mutex);
+    if (off == 0 || off + 3 > len) return 0;
+    buf[off++] = ']';
+    buf[off++] = '}';
+    buf[off] = '\0';
+    return off;
+}
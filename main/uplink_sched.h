@@ -0,0 +1,48 @@
+#ifndef UPLINK_SCHED_H
+#define UPLINK_SCHED_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// LẬP LỊCH ĐƯỜNG LÊN: mọi request cloud xin lượt trước khi gửi, mỗi lúc 1 request dùng link.
+// Lượt trống được trao cho lớp ưu tiên cao nhất đang chờ; ảnh lớn gửi theo khúc và xin lượt
+// từng khúc -> lệnh remote chỉ phải chờ tối đa 1 khúc. Lớp nặng còn bị giới hạn byte/s (token bucket).
+typedef enum {
+    UPLINK_CMD = 0,         // Hỏi / xác nhận lệnh remote
+    UPLINK_LOG,             // Dòng access_logs, bản tóm tắt thống kê
+    UPLINK_THUMB,           // Ảnh bằng chứng (thumbnail mặt)
+    UPLINK_FULL,            // Frame gốc, ảnh enroll
+    UPLINK_BULK,            // Đồng bộ users, upload embedding
+    UPLINK_CLASS_COUNT
+} uplink_class_t;
+
+#define UPLINK_WAIT_MS          30000           // Chờ lượt tối đa, quá thì bỏ request này
+#define UPLINK_FULL_BPS         (48 * 1024)     // Token bucket lớp FULL (byte/s)
+#define UPLINK_FULL_BURST       (16 * 1024)
+#define UPLINK_BULK_BPS         (24 * 1024)     // Token bucket lớp BULK (byte/s)
+#define UPLINK_BULK_BURST       (16 * 1024)
+
+void uplink_sched_init(void);
+
+// Chờ tới lượt dùng link. bytes: số byte sắp gửi (trừ token), 0 nếu chỉ nhận.
+// Task đang giữ lượt gọi lồng nhau (vd. xác nhận lệnh trong lúc poll) thì được ngay.
+// ESP_ERR_TIMEOUT nếu chờ quá timeout_ms.
+esp_err_t uplink_acquire(uplink_class_t cls, size_t bytes, uint32_t timeout_ms);
+
+// Trả lượt (trao cho lớp ưu tiên cao nhất đang chờ)
+void uplink_release(void);
+
+// {"busy":..,"classes":[{"class":"cmd","requests":..,"bytes":..,"depth":..,"max_depth":..,
+//   "avg_wait_ms":..,"max_wait_ms":..,"shaped":..,"timeouts":..},...]}
+size_t uplink_stats_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
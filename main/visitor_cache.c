@@ -0,0 +1,198 @@
+#include "visitor_cache.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "bench.h"
+
+static const char *TAG = "VISITOR";
+
+typedef struct {
+    uint32_t id;            // 0 = ô trống
+    uint16_t n;             // Số mẫu đã gộp vào tâm (tối đa VISITOR_CENTROID_MAX_N)
+    int64_t last_seen_ms;
+    int64_t last_event_ms;
+} visitor_cluster_t;
+
+typedef struct {
+    uint32_t observed;
+    uint32_t events;
+    uint32_t suppressed;
+    uint32_t evicted;
+    uint32_t expired;
+} visitor_stats_t;
+
+// Bộ cụm: cache thật và cache riêng của benchmark dùng chung code
+typedef struct {
+    visitor_cluster_t clusters[VISITOR_CLUSTERS];
+    float *centroids;       // [VISITOR_CLUSTERS][FACE_EMBED_DIM], chuẩn hoá
+    uint32_t next_id;
+    visitor_stats_t stats;
+} visitor_cache_t;
+
+static visitor_cache_t s_cache;
+
+static float _dot(const float *a, const float *b) {
+    float s = 0.0f;
+    for (int i = 0; i < FACE_EMBED_DIM; i++) s += a[i] * b[i];
+    return s;
+}
+
+static bool _cache_init(visitor_cache_t *c) {
+    memset(c->clusters, 0, sizeof(c->clusters));
+    memset(&c->stats, 0, sizeof(c->stats));
+    c->next_id = 1;
+    if (!c->centroids) {
+        c->centroids = (float *)heap_caps_malloc(VISITOR_CLUSTERS * FACE_EMBED_BYTES, MALLOC_CAP_SPIRAM);
+    }
+    return c->centroids != NULL;
+}
+
+// Tâm mới = chuẩn hoá(tâm * n + e): trung bình chạy, n chặn trên để cụm không "đóng băng"
+static void _centroid_update(float *cen, uint16_t *n, const float *e) {
+    float w = (float)*n;
+    float sum = 0.0f;
+    for (int i = 0; i < FACE_EMBED_DIM; i++) {
+        cen[i] = cen[i] * w + e[i];
+        sum += cen[i] * cen[i];
+    }
+    float inv = sum > 0.0f ? 1.0f / sqrtf(sum) : 0.0f;
+    for (int i = 0; i < FACE_EMBED_DIM; i++) cen[i] *= inv;
+    if (*n < VISITOR_CENTROID_MAX_N) (*n)++;
+}
+
+static bool _cache_observe(visitor_cache_t *c, const float *emb, int64_t now_ms, visitor_hit_t *out) {
+    if (!c->centroids) return false;
+    c->stats.observed++;
+
+    // 1 lượt qua các cụm: hết hạn thì giải phóng, còn lại tìm cụm giống nhất + ô để thay nếu cần
+    int best = -1, free_slot = -1, lru = -1;
+    float best_sim = VISITOR_MIN_SIM;
+    for (int i = 0; i < VISITOR_CLUSTERS; i++) {
+        visitor_cluster_t *k = &c->clusters[i];
+        if (k->id && now_ms - k->last_seen_ms > VISITOR_TTL_MS) {
+            k->id = 0;
+            c->stats.expired++;
+        }
+        if (!k->id) {
+            if (free_slot < 0) free_slot = i;
+            continue;
+        }
+        if (lru < 0 || k->last_seen_ms < c->clusters[lru].last_seen_ms) lru = i;
+        float sim = _dot(emb, c->centroids + (size_t)i * FACE_EMBED_DIM);
+        if (sim >= best_sim) { best_sim = sim; best = i; }
+    }
+
+    if (best >= 0) {
+        visitor_cluster_t *k = &c->clusters[best];
+        _centroid_update(c->centroids + (size_t)best * FACE_EMBED_DIM, &k->n, emb);
+        k->last_seen_ms = now_ms;
+        out->id = k->id;
+        out->is_new = false;
+        out->sim = best_sim;
+        out->event = (now_ms - k->last_event_ms >= VISITOR_EVENT_WINDOW_MS);
+        if (out->event) { k->last_event_ms = now_ms; c->stats.events++; }
+        else c->stats.suppressed++;
+        return true;
+    }
+
+    // Người lạ mới: ô trống, hoặc thay cụm lâu không thấy nhất
+    int slot = free_slot;
+    if (slot < 0) { slot = lru; c->stats.evicted++; }
+    visitor_cluster_t *k = &c->clusters[slot];
+    memcpy(c->centroids + (size_t)slot * FACE_EMBED_DIM, emb, FACE_EMBED_BYTES);
+    k->id = c->next_id++;
+    if (c->next_id == 0) c->next_id = 1;
+    k->n = 1;
+    k->last_seen_ms = now_ms;
+    k->last_event_ms = now_ms;
+    c->stats.events++;
+    out->id = k->id;
+    out->is_new = true;
+    out->sim = 0.0f;
+    out->event = true;
+    return true;
+}
+
+bool visitor_cache_observe(const float *emb, int64_t now_ms, visitor_hit_t *out) {
+    return _cache_observe(&s_cache, emb, now_ms, out);
+}
+
+size_t visitor_cache_stats_json(char *buf, size_t len) {
+    int live = 0;
+    for (int i = 0; i < VISITOR_CLUSTERS; i++) if (s_cache.clusters[i].id) live++;
+    visitor_stats_t st = s_cache.stats;
+    int n = snprintf(buf, len,
+                     "{\"clusters\":%d,\"max\":%d,\"observed\":%lu,\"events\":%lu,\"suppressed\":%lu,"
+                     "\"evicted\":%lu,\"expired\":%lu}",
+                     live, VISITOR_CLUSTERS, (unsigned long)st.observed, (unsigned long)st.events,
+                     (unsigned long)st.suppressed, (unsigned long)st.evicted, (unsigned long)st.expired);
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
+
+// BENCHMARK: cache đầy VISITOR_CLUSTERS người lạ.
+// visitor_hit: mặt quen (quét hết cụm + cập nhật tâm). visitor_new: xoay vòng CLUSTERS + 1 người
+// -> LRU luôn trượt, mỗi vòng quét hết cụm + thay cụm cũ nhất (trường hợp xấu nhất).
+#define VISITOR_BENCH_PROBES   (VISITOR_CLUSTERS + 1)
+
+typedef struct {
+    visitor_cache_t hit_cache;
+    visitor_cache_t new_cache;
+    float *probes;          // [VISITOR_BENCH_PROBES][FACE_EMBED_DIM]
+    uint32_t iter;
+    int64_t now_ms;
+} visitor_bench_t;
+
+static visitor_bench_t s_bench;
+
+// Vector chuẩn hoá giả ngẫu nhiên (LCG) theo seed; 2 vector khác seed gần như trực giao
+static void _bench_vec(float *v, uint32_t seed) {
+    float sum = 0.0f;
+    for (int i = 0; i < FACE_EMBED_DIM; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        v[i] = (float)(seed >> 8) / (float)(1 << 23) - 1.0f;
+        sum += v[i] * v[i];
+    }
+    float inv = 1.0f / sqrtf(sum);
+    for (int i = 0; i < FACE_EMBED_DIM; i++) v[i] *= inv;
+}
+
+static bool _bench_prepare(void) {
+    if (s_bench.probes) return true;
+    if (!_cache_init(&s_bench.hit_cache) || !_cache_init(&s_bench.new_cache)) return false;
+    float *probes = (float *)heap_caps_malloc(VISITOR_BENCH_PROBES * FACE_EMBED_BYTES, MALLOC_CAP_SPIRAM);
+    if (!probes) return false;
+    visitor_hit_t hit;
+    for (int i = 0; i < VISITOR_BENCH_PROBES; i++) {
+        float *p = probes + (size_t)i * FACE_EMBED_DIM;
+        _bench_vec(p, 1000 + i);
+        if (i < VISITOR_CLUSTERS) {
+            _cache_observe(&s_bench.hit_cache, p, i, &hit);
+            _cache_observe(&s_bench.new_cache, p, i, &hit);
+        }
+    }
+    s_bench.now_ms = VISITOR_CLUSTERS;
+    s_bench.probes = probes;
+    return true;
+}
+
+static void _bench_hit(void *ctx) {
+    if (!_bench_prepare()) return;
+    visitor_hit_t hit;
+    _cache_observe(&s_bench.hit_cache, s_bench.probes, ++s_bench.now_ms, &hit);
+}
+
+static void _bench_new(void *ctx) {
+    if (!_bench_prepare()) return;
+    visitor_hit_t hit;
+    uint32_t k = (VISITOR_CLUSTERS + s_bench.iter++) % VISITOR_BENCH_PROBES;
+    _cache_observe(&s_bench.new_cache, s_bench.probes + (size_t)k * FACE_EMBED_DIM, ++s_bench.now_ms, &hit);
+}
+
+void visitor_cache_init(void) {
+    if (!_cache_init(&s_cache)) { ESP_LOGE(TAG, "Alloc Fail"); return; }
+    bench_register("visitor_hit", _bench_hit, NULL);
+    bench_register("visitor_new", _bench_new, NULL);
+}
@@ -0,0 +1,42 @@
+#ifndef VISITOR_CACHE_H
+#define VISITOR_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "face_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NGƯỜI LẠ: gom embedding mặt không khớp ai thành cụm (leader clustering theo cosine).
+// Mỗi người lạ chỉ sinh 1 sự kiện + 1 thumbnail / VISITOR_EVENT_WINDOW_MS dù đứng trước camera bao lâu.
+// Bộ nhớ cố định: VISITOR_CLUSTERS tâm cụm, đầy thì bỏ cụm lâu không thấy nhất.
+#define VISITOR_CLUSTERS          16
+#define VISITOR_MIN_SIM           0.55f                 // Cosine với tâm cụm >= ngưỡng -> cùng người
+#define VISITOR_TTL_MS            (30 * 60 * 1000)      // Không thấy lại quá lâu -> cụm hết hạn
+#define VISITOR_EVENT_WINDOW_MS   (10 * 60 * 1000)      // Người lạ quay lại sau khoảng này -> sự kiện mới
+#define VISITOR_CENTROID_MAX_N    16                    // Trọng số tối đa của tâm: vẫn theo kịp thay đổi chậm
+
+typedef struct {
+    uint32_t id;            // Mã người lạ, tăng dần từ 1 (không lưu qua khởi động lại)
+    bool event;             // true: cần ghi sự kiện + ảnh cho lần này
+    bool is_new;            // Cụm vừa tạo
+    float sim;              // Độ giống tâm cụm (0 nếu cụm mới)
+} visitor_hit_t;
+
+// Cấp bộ nhớ tâm cụm (PSRAM) + đăng ký benchmark
+void visitor_cache_init(void);
+
+// emb: FACE_EMBED_DIM float đã chuẩn hoá. now_ms: đồng hồ đơn điệu. false nếu chưa init.
+bool visitor_cache_observe(const float *emb, int64_t now_ms, visitor_hit_t *out);
+
+// {"clusters":..,"max":..,"observed":..,"events":..,"suppressed":..,"evicted":..,"expired":..}
+size_t visitor_cache_stats_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
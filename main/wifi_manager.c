@@ -1,136 +1,363 @@
-#include "wifi_manager.h"
-#include <string.h>
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/event_groups.h"
-#include "esp_system.h"
-#include "esp_wifi.h"
-#include "esp_event.h"
-#include "esp_log.h"
-#include "nvs_flash.h"
-#include "nvs.h"
-
-static const char *TAG = "WIFI_MGR";
-
-// Sự kiện để chờ kết nối
-static EventGroupHandle_t s_wifi_event_group;
-#define WIFI_CONNECTED_BIT BIT0
-#define WIFI_FAIL_BIT      BIT1
-
-static int s_retry_num = 0;
-#define MAXIMUM_RETRY 5
-
-// XỬ LÝ NVS (LƯU TRỮ)
-
-esp_err_t wifi_load_config(char *ssid, char *password) {
-    nvs_handle_t my_handle;
-    esp_err_t err = nvs_open("nvs", NVS_READONLY, &my_handle);
-    if (err != ESP_OK) return err;
-
-    size_t ssid_len = 32; // Độ dài tối đa của SSID
-    size_t pass_len = 64; // Độ dài tối đa của Pass
-
-    // Đọc dữ liệu từ key "wifi_ssid" và "wifi_pass"
-    if (nvs_get_str(my_handle, "wifi_ssid", ssid, &ssid_len) != ESP_OK ||
-        nvs_get_str(my_handle, "wifi_pass", password, &pass_len) != ESP_OK) {
-        nvs_close(my_handle);
-        return ESP_FAIL; // Chưa có cấu hình
-    }
-
-    nvs_close(my_handle);
-    return ESP_OK;
-}
-
-esp_err_t wifi_save_config(const char *ssid, const char *password) {
-    nvs_handle_t my_handle;
-    esp_err_t err = nvs_open("nvs", NVS_READWRITE, &my_handle);
-    if (err != ESP_OK) return err;
-
-    // Ghi dữ liệu
-    err |= nvs_set_str(my_handle, "wifi_ssid", ssid);
-    err |= nvs_set_str(my_handle, "wifi_pass", password);
-    err |= nvs_commit(my_handle); // Bắt buộc commit 
-
-    nvs_close(my_handle);
-    return err;
-}
-
-// LOGIC WIFI STATION 
-
-static void wifi_event_handler(void* arg, esp_event_base_t event_base,
-                                int32_t event_id, void* event_data) {
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        esp_wifi_connect();
-    } 
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        if (s_retry_num < MAXIMUM_RETRY) {
-            esp_wifi_connect();
-            s_retry_num++;
-            ESP_LOGW(TAG, "Retrying to connect to the AP (%d/%d)", s_retry_num, MAXIMUM_RETRY);
-        } else {
-            xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
-        }
-    } 
-    else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
-        ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
-        ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
-        s_retry_num = 0;
-        xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
-    }
-}
-
-esp_err_t wifi_init_sta(void) {
-    // 1. Load Config từ NVS trước
-    char ssid[33] = {0};
-    char password[65] = {0};
-
-    if (wifi_load_config(ssid, password) != ESP_OK) {
-        ESP_LOGE(TAG, "No WiFi config found in NVS. Please provision via BLE.");
-        return ESP_FAIL; 
-    }
-
-    ESP_LOGI(TAG, "Loaded WiFi Config: SSID=%s", ssid);
-
-    // 2. Khởi tạo WiFi Stack
-    s_wifi_event_group = xEventGroupCreate();
-    ESP_ERROR_CHECK(esp_netif_init());
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
-    esp_netif_create_default_wifi_sta();
-
-    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
-
-    esp_event_handler_instance_t instance_any_id;
-    esp_event_handler_instance_t instance_got_ip;
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL, &instance_any_id));
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL, &instance_got_ip));
-
-    // 3. Set Config
-    wifi_config_t wifi_config = {0};
-    strncpy((char *)wifi_config.sta.ssid, ssid, sizeof(wifi_config.sta.ssid));
-    strncpy((char *)wifi_config.sta.password, password, sizeof(wifi_config.sta.password));
-    wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
-
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
-    ESP_ERROR_CHECK(esp_wifi_start());
-
-    // 4. Chờ kết quả
-    ESP_LOGI(TAG, "Connecting to WiFi...");
-    EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group,
-            WIFI_CONNECTED_BIT | WIFI_FAIL_BIT,
-            pdFALSE, pdFALSE, pdMS_TO_TICKS(10000)); // Timeout 10s
-
-    if (bits & WIFI_CONNECTED_BIT) {
-        return ESP_OK;
-    } else {
-        ESP_LOGE(TAG, "Failed to connect to WiFi.");
-        return ESP_FAIL;
-    }
-}
-
-bool wifi_is_connected(void) {
-    if (s_wifi_event_group == NULL) return false;
-    EventBits_t bits = xEventGroupGetBits(s_wifi_event_group);
-    return (bits & WIFI_CONNECTED_BIT);
+#include "wifi_manager.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_system.h"
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "esp_netif_net_stack.h"
+#include "lwip/dhcp.h"
+#include <time.h>
+
+static const char *TAG = "WIFI_MGR";
+
+// Sự kiện để chờ kết nối
+static EventGroupHandle_t s_wifi_event_group;
+#define WIFI_CONNECTED_BIT BIT0
+#define WIFI_FAIL_BIT      BIT1
+
+// Số lần thử liên tiếp trước khi báo WIFI_FAIL_BIT cho người đang chờ (vẫn thử lại tiếp sau đó)
+static int s_retry_num = 0;
+#define MAXIMUM_RETRY 5
+
+// Stack WiFi chỉ khởi tạo 1 lần; các lần gọi wifi_init_sta sau chỉ nạp lại cấu hình và kết nối lại
+static bool s_stack_ready = false;
+static esp_netif_t *s_sta_netif = NULL;
+static esp_timer_handle_t s_retry_timer = NULL;
+
+// CACHE KẾT NỐI NHANH (NVS): BSSID + kênh để bỏ qua quét, lease DHCP để bỏ qua DHCP
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t has_lease;
+    uint32_t ip, netmask, gw, dns;
+    uint32_t lease_s;       // Thời hạn router cấp (DHCP option 51), 0 = không rõ -> không dùng lại
+    int64_t lease_time;     // Epoch (s) lúc DHCP cấp lease, 0 nếu lúc đó chưa có giờ
+} wifi_link_cache_t;
+
+static wifi_link_cache_t s_cache;
+static bool s_cache_valid = false;
+static int64_t s_lease_uptime_s = -1;   // Lease xác nhận bởi DHCP trong lần chạy này (uptime)
+static int s_fast_fails = 0;
+static bool s_attempt_fast = false;     // Lần thử hiện tại dùng BSSID/kênh đã cache
+static bool s_static_ip = false;        // Đang dùng lại lease cũ (DHCP client tắt)
+static bool s_dhcp_renewing = false;    // Đã có IP nhờ lease cache, DHCP client vừa chạy lại (chờ ACK)
+static bool s_link_cached_lease = false;    // Kết nối hiện tại lên IP bằng lease cache
+
+// THỐNG KÊ
+static int64_t s_attempt_start_us = 0;
+static int64_t s_down_since_us = 0;
+static uint32_t s_connects = 0, s_fast_connects = 0, s_disconnects = 0;
+static int64_t s_last_connect_ms = 0, s_connect_total_ms = 0;
+static int64_t s_last_down_ms = 0, s_down_total_ms = 0;
+static int s_last_reason = 0;
+
+// XỬ LÝ NVS (LƯU TRỮ)
+
+esp_err_t wifi_load_config(char *ssid, char *password) {
+    nvs_handle_t my_handle;
+    esp_err_t err = nvs_open("nvs", NVS_READONLY, &my_handle);
+    if (err != ESP_OK) return err;
+
+    size_t ssid_len = 32; // Độ dài tối đa của SSID
+    size_t pass_len = 64; // Độ dài tối đa của Pass
+
+    // Đọc dữ liệu từ key "wifi_ssid" và "wifi_pass"
+    if (nvs_get_str(my_handle, "wifi_ssid", ssid, &ssid_len) != ESP_OK ||
+        nvs_get_str(my_handle, "wifi_pass", password, &pass_len) != ESP_OK) {
+        nvs_close(my_handle);
+        return ESP_FAIL; // Chưa có cấu hình
+    }
+
+    nvs_close(my_handle);
+    return ESP_OK;
+}
+
+esp_err_t wifi_save_config(const char *ssid, const char *password) {
+    nvs_handle_t my_handle;
+    esp_err_t err = nvs_open("nvs", NVS_READWRITE, &my_handle);
+    if (err != ESP_OK) return err;
+
+    // Ghi dữ liệu
+    err |= nvs_set_str(my_handle, "wifi_ssid", ssid);
+    err |= nvs_set_str(my_handle, "wifi_pass", password);
+    // Mạng mới -> cache BSSID / lease cũ không còn đúng
+    nvs_erase_key(my_handle, "wifi_link");
+    s_cache_valid = false;
+    s_lease_uptime_s = -1;
+    err |= nvs_commit(my_handle); // Bắt buộc commit 
+
+    nvs_close(my_handle);
+    return err;
+}
+
+static void wifi_cache_load(void) {
+    nvs_handle_t h;
+    if (nvs_open("nvs", NVS_READONLY, &h) != ESP_OK) return;
+    size_t len = sizeof(s_cache);
+    s_cache_valid = (nvs_get_blob(h, "wifi_link", &s_cache, &len) == ESP_OK && len == sizeof(s_cache));
+    nvs_close(h);
+}
+
+static void wifi_cache_save(const wifi_link_cache_t *c) {
+    // Chỉ ghi flash khi thực sự đổi (AP khác, IP / thời hạn khác, hoặc mốc lease cũ quá 1/4 thời hạn)
+    if (s_cache_valid && memcmp(c, &s_cache, offsetof(wifi_link_cache_t, lease_s) + sizeof(c->lease_s)) == 0 &&
+        c->lease_time - s_cache.lease_time < (int64_t)c->lease_s / 4) {
+        return;
+    }
+    nvs_handle_t h;
+    if (nvs_open("nvs", NVS_READWRITE, &h) != ESP_OK) return;
+    if (nvs_set_blob(h, "wifi_link", c, sizeof(*c)) == ESP_OK) nvs_commit(h);
+    nvs_close(h);
+    s_cache = *c;
+    s_cache_valid = true;
+}
+
+// Lease cũ chỉ dùng lại tới T1 (nửa thời hạn router cấp): còn xa hạn, router chưa thể cấp IP cho máy khác
+static bool wifi_lease_reusable(void) {
+    if (!s_cache_valid || !s_cache.has_lease || s_cache.lease_s == 0) return false;
+    int64_t window_s = s_cache.lease_s / 2;
+    int64_t up_s = esp_timer_get_time() / 1000000;
+    if (s_lease_uptime_s >= 0) return up_s - s_lease_uptime_s < window_s;
+    time_t now = time(NULL);
+    return now > 1700000000 && s_cache.lease_time > 0 && now - s_cache.lease_time < window_s;
+}
+
+// Thời hạn lease DHCP vừa cấp (option 51), 0 nếu DHCP chưa BOUND. Đọc ngoài task tcpip: chỉ 1 word
+static uint32_t wifi_dhcp_lease_s(void) {
+    struct netif *nif = (struct netif *)esp_netif_get_netif_impl(s_sta_netif);
+    struct dhcp *d = nif ? netif_dhcp_data(nif) : NULL;
+    return (d && d->state == DHCP_STATE_BOUND) ? d->offered_t0_lease : 0;
+}
+
+// Lease do DHCP cấp: lưu IP / DNS / thời hạn để lần kết nối lại sau bỏ qua DHCP
+static void wifi_cache_set_lease(wifi_link_cache_t *c, const esp_netif_ip_info_t *ip, int64_t now_us) {
+    esp_netif_dns_info_t dns = {0};
+    esp_netif_get_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns);
+    c->has_lease = 1;
+    c->ip = ip->ip.addr;
+    c->netmask = ip->netmask.addr;
+    c->gw = ip->gw.addr;
+    c->dns = dns.ip.u_addr.ip4.addr;
+    c->lease_s = wifi_dhcp_lease_s();
+    time_t t = time(NULL);
+    c->lease_time = t > 1700000000 ? t : 0;
+    s_lease_uptime_s = now_us / 1000000;
+}
+
+// 1 lần thử kết nối: dùng cache nếu còn tin được, không thì quét đủ kênh + DHCP
+static void wifi_connect_attempt(void) {
+    wifi_config_t cfg;
+    if (esp_wifi_get_config(WIFI_IF_STA, &cfg) != ESP_OK) return;
+
+    s_attempt_fast = s_cache_valid && s_fast_fails < WIFI_FAST_MAX_FAILS;
+    cfg.sta.bssid_set = s_attempt_fast;
+    if (s_attempt_fast) {
+        memcpy(cfg.sta.bssid, s_cache.bssid, sizeof(cfg.sta.bssid));
+        cfg.sta.channel = s_cache.channel;
+    } else {
+        cfg.sta.channel = 0;
+    }
+    esp_wifi_set_config(WIFI_IF_STA, &cfg);
+
+    bool use_static = s_attempt_fast && wifi_lease_reusable();
+    if (use_static && !s_static_ip) {
+        esp_netif_dhcpc_stop(s_sta_netif);
+        esp_netif_ip_info_t ip = { .ip.addr = s_cache.ip, .netmask.addr = s_cache.netmask, .gw.addr = s_cache.gw };
+        esp_netif_set_ip_info(s_sta_netif, &ip);
+        esp_netif_dns_info_t dns = { .ip.u_addr.ip4.addr = s_cache.dns, .ip.type = ESP_IPADDR_TYPE_V4 };
+        esp_netif_set_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns);
+        s_static_ip = true;
+    } else if (!use_static && s_static_ip) {
+        esp_netif_dhcpc_start(s_sta_netif);
+        s_static_ip = false;
+    }
+
+    s_attempt_start_us = esp_timer_get_time();
+    esp_wifi_connect();
+}
+
+static void wifi_retry_cb(void *arg) { wifi_connect_attempt(); }
+
+// Backoff mũ có jitter: 0, ~250ms, ~500ms, ~1s ... tối đa ~WIFI_BACKOFF_MAX_MS, thử mãi không bỏ cuộc
+static uint64_t wifi_backoff_us(int attempt) {
+    if (attempt == 0) return 0;
+    uint64_t ms = WIFI_BACKOFF_BASE_MS << (attempt - 1 < 8 ? attempt - 1 : 8);
+    if (ms > WIFI_BACKOFF_MAX_MS) ms = WIFI_BACKOFF_MAX_MS;
+    // Jitter 50-100% để nhiều thiết bị không cùng dồn vào AP vừa khởi động lại
+    ms = ms / 2 + esp_random() % (ms / 2 + 1);
+    return ms * 1000;
+}
+
+// LOGIC WIFI STATION 
+
+static void wifi_event_handler(void* arg, esp_event_base_t event_base,
+                                int32_t event_id, void* event_data) {
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        s_down_since_us = esp_timer_get_time();
+        wifi_connect_attempt();
+    } 
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        wifi_event_sta_disconnected_t *d = (wifi_event_sta_disconnected_t *) event_data;
+        s_last_reason = d->reason;
+        if (xEventGroupGetBits(s_wifi_event_group) & WIFI_CONNECTED_BIT) {
+            s_disconnects++;
+            s_down_since_us = esp_timer_get_time();
+            ESP_LOGW(TAG, "Disconnected (reason %d)", d->reason);
+        }
+        xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+        s_dhcp_renewing = false;
+
+        // AP đổi kênh / BSSID (mesh, router mới) -> thôi dùng cache, quét đủ kênh
+        if (s_attempt_fast) s_fast_fails++;
+
+        if (s_retry_num == MAXIMUM_RETRY) xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
+        uint64_t delay_us = wifi_backoff_us(s_retry_num);
+        s_retry_num++;
+        ESP_LOGW(TAG, "Retrying to connect to the AP (#%d in %llu ms)", s_retry_num, delay_us / 1000);
+        esp_timer_stop(s_retry_timer);
+        if (delay_us == 0) wifi_connect_attempt();
+        else esp_timer_start_once(s_retry_timer, delay_us);
+    } 
+    else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
+        int64_t now = esp_timer_get_time();
+        wifi_link_cache_t c = s_cache_valid ? s_cache : (wifi_link_cache_t){0};
+
+        // DHCP chạy lại sau lần lên IP bằng lease cache đã được ACK: lưu lease mới, không tính là 1 lần kết nối
+        if (s_dhcp_renewing) {
+            s_dhcp_renewing = false;
+            wifi_cache_set_lease(&c, &event->ip_info, now);
+            wifi_cache_save(&c);
+            ESP_LOGI(TAG, "DHCP lease confirmed: " IPSTR " (%lu s)", IP2STR(&event->ip_info.ip), (unsigned long)c.lease_s);
+            return;
+        }
+
+        s_last_connect_ms = (now - s_attempt_start_us) / 1000;
+        s_connect_total_ms += s_last_connect_ms;
+        s_connects++;
+        if (s_attempt_fast) s_fast_connects++;
+        if (s_down_since_us) {
+            s_last_down_ms = (now - s_down_since_us) / 1000;
+            s_down_total_ms += s_last_down_ms;
+            s_down_since_us = 0;
+        }
+        ESP_LOGI(TAG, "Got IP: " IPSTR " (%s%s, connect %lld ms, down %lld ms)", IP2STR(&event->ip_info.ip),
+                 s_attempt_fast ? "cached BSSID" : "full scan", s_static_ip ? " + cached lease" : "",
+                 s_last_connect_ms, s_last_down_ms);
+        s_retry_num = 0;
+        s_fast_fails = 0;
+
+        // Cập nhật cache: BSSID/kênh luôn, lease chỉ khi do DHCP cấp
+        wifi_ap_record_t ap;
+        if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK) {
+            memcpy(c.bssid, ap.bssid, sizeof(c.bssid));
+            c.channel = ap.primary;
+        }
+        s_link_cached_lease = s_static_ip;
+        if (s_static_ip) {
+            // Lease cache chỉ để có IP ngay. Bật lại DHCP client để router gia hạn / thu hồi đúng hạn:
+            // IP tạm về 0 tới khi ACK (1 RTT với CONFIG_LWIP_DHCP_RESTORE_LAST_IP: REQUEST thẳng IP cũ)
+            esp_netif_dhcpc_start(s_sta_netif);
+            s_static_ip = false;
+            s_dhcp_renewing = true;
+        } else {
+            wifi_cache_set_lease(&c, &event->ip_info, now);
+        }
+        wifi_cache_save(&c);
+
+        xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+    }
+}
+
+esp_err_t wifi_init_sta(void) {
+    // 1. Load Config từ NVS trước
+    char ssid[33] = {0};
+    char password[65] = {0};
+
+    if (wifi_load_config(ssid, password) != ESP_OK) {
+        ESP_LOGE(TAG, "No WiFi config found in NVS. Please provision via BLE.");
+        return ESP_FAIL; 
+    }
+
+    ESP_LOGI(TAG, "Loaded WiFi Config: SSID=%s", ssid);
+
+    // 2. Khởi tạo WiFi Stack (lần đầu)
+    bool first = !s_stack_ready;
+    if (first) {
+        s_wifi_event_group = xEventGroupCreate();
+        ESP_ERROR_CHECK(esp_netif_init());
+        ESP_ERROR_CHECK(esp_event_loop_create_default());
+        s_sta_netif = esp_netif_create_default_wifi_sta();
+
+        wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+        ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+
+        esp_event_handler_instance_t instance_any_id;
+        esp_event_handler_instance_t instance_got_ip;
+        ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL, &instance_any_id));
+        ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL, &instance_got_ip));
+
+        const esp_timer_create_args_t targs = { .callback = wifi_retry_cb, .name = "wifi_retry" };
+        ESP_ERROR_CHECK(esp_timer_create(&targs, &s_retry_timer));
+        wifi_cache_load();
+        s_stack_ready = true;
+    } else {
+        // Cấu hình mới qua BLE: bỏ lịch thử lại cũ, ngắt kết nối rồi thử ngay với SSID mới
+        esp_timer_stop(s_retry_timer);
+        esp_wifi_disconnect();
+    }
+    xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT);
+    s_retry_num = 0;
+    s_fast_fails = 0;
+
+    // 3. Set Config
+    wifi_config_t wifi_config = {0};
+    strncpy((char *)wifi_config.sta.ssid, ssid, sizeof(wifi_config.sta.ssid));
+    strncpy((char *)wifi_config.sta.password, password, sizeof(wifi_config.sta.password));
+    wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
+
+    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
+    if (first) ESP_ERROR_CHECK(esp_wifi_start());   // STA_START -> wifi_connect_attempt()
+    else wifi_connect_attempt();
+
+    // 4. Chờ kết quả (hết giờ vẫn tiếp tục thử lại nền)
+    ESP_LOGI(TAG, "Connecting to WiFi...");
+    EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group,
+            WIFI_CONNECTED_BIT | WIFI_FAIL_BIT,
+            pdFALSE, pdFALSE, pdMS_TO_TICKS(10000)); // Timeout 10s
+
+    if (bits & WIFI_CONNECTED_BIT) {
+        return ESP_OK;
+    } else {
+        ESP_LOGE(TAG, "Failed to connect to WiFi (still retrying in background).");
+        return ESP_FAIL;
+    }
+}
+
+size_t wifi_stats_json(char *buf, size_t len) {
+    int64_t down_now_ms = s_down_since_us ? (esp_timer_get_time() - s_down_since_us) / 1000 : 0;
+    int n = snprintf(buf, len,
+                     "{\"connects\":%lu,\"fast_connects\":%lu,\"disconnects\":%lu,\"last_connect_ms\":%lld,"
+                     "\"avg_connect_ms\":%lld,\"last_down_ms\":%lld,\"down_total_ms\":%lld,\"down_now_ms\":%lld,"
+                     "\"retry\":%d,\"last_reason\":%d,\"cached_lease\":%s,\"lease_s\":%lu}",
+                     (unsigned long)s_connects, (unsigned long)s_fast_connects, (unsigned long)s_disconnects,
+                     s_last_connect_ms, s_connects ? s_connect_total_ms / s_connects : 0,
+                     s_last_down_ms, s_down_total_ms + down_now_ms, down_now_ms,
+                     s_retry_num, s_last_reason, s_link_cached_lease ? "true" : "false",
+                     (unsigned long)(s_cache_valid ? s_cache.lease_s : 0));
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
+
+bool wifi_is_connected(void) {
+    if (s_wifi_event_group == NULL) return false;
+    EventBits_t bits = xEventGroupGetBits(s_wifi_event_group);
+    return (bits & WIFI_CONNECTED_BIT);
 }
\ No newline at end of file
@@ -1,20 +1,34 @@
-#ifndef WIFI_MANAGER_H
-#define WIFI_MANAGER_H
-
-#include "esp_err.h"
-#include "esp_netif.h"
-#include <stdbool.h>
-
-// Hàm khởi tạo WiFi Station 
-esp_err_t wifi_init_sta(void);
-
-// Kiểm tra nhanh trạng thái kết nối
-bool wifi_is_connected(void);
-
-// Hàm lưu SSID và Password vào NVS (Flash)
-esp_err_t wifi_save_config(const char *ssid, const char *password);
-
-// Hàm đọc cấu hình từ NVS
-esp_err_t wifi_load_config(char *ssid, char *password);
-
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+#include "esp_err.h"
+#include "esp_netif.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Backoff kết nối lại: gấp đôi từ BASE tới MAX (có jitter), không giới hạn số lần
+#define WIFI_BACKOFF_BASE_MS   250
+#define WIFI_BACKOFF_MAX_MS    5000
+// Lease DHCP đã cache được dùng lại (bỏ qua DHCP lúc kết nối lại) tới T1 = nửa thời hạn router cấp
+// (option 51); ngay sau khi có IP, DHCP client chạy lại nền để router gia hạn / cấp lại đúng hạn.
+
+// Kết nối bằng BSSID/kênh cache thất bại bấy nhiêu lần liên tiếp -> quét đủ kênh + DHCP
+#define WIFI_FAST_MAX_FAILS    2
+
+// Hàm khởi tạo WiFi Station. Trả về sau khi có IP hoặc hết 10s; từ đó tự kết nối lại mãi.
+// Gọi lại khi đổi cấu hình.
+esp_err_t wifi_init_sta(void);
+
+// Kiểm tra nhanh trạng thái kết nối
+bool wifi_is_connected(void);
+
+// Hàm lưu SSID và Password vào NVS (Flash)
+esp_err_t wifi_save_config(const char *ssid, const char *password);
+
+// Hàm đọc cấu hình từ NVS
+esp_err_t wifi_load_config(char *ssid, char *password);
+
+// Thống kê kết nối (thời gian kết nối, thời gian mất mạng) dạng JSON
+size_t wifi_stats_json(char *buf, size_t len);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "ws_queue.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_heap_caps.h"
+
+typedef struct {
+    int fd;                 // -1 = slot trống
+    uint8_t head;
+    uint8_t count;
+    uint32_t dropped;
+    uint16_t len[WS_QUEUE_LEN];
+    uint32_t seq[WS_QUEUE_LEN];
+} ws_client_t;
+
+static ws_client_t s_clients[WS_MAX_CLIENTS];
+static char *s_msgs = NULL;         // WS_MAX_CLIENTS * WS_QUEUE_LEN * WS_MSG_MAX_LEN (PSRAM)
+static uint32_t s_next_seq = 0;     // Tăng dưới khoá, không bao giờ trùng giữa các tin còn trong hàng
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static inline char *_slot(int client, int idx) {
+    return s_msgs + ((size_t)client * WS_QUEUE_LEN + idx) * WS_MSG_MAX_LEN;
+}
+
+bool ws_queue_init(void) {
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) s_clients[i].fd = -1;
+    if (!s_msgs) {
+        s_msgs = (char *)heap_caps_calloc(WS_MAX_CLIENTS * WS_QUEUE_LEN, WS_MSG_MAX_LEN, MALLOC_CAP_SPIRAM);
+    }
+    return s_msgs != NULL;
+}
+
+void ws_queue_add(int fd) {
+    taskENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (s_clients[i].fd == fd) break;
+        if (s_clients[i].fd < 0) {
+            s_clients[i].fd = fd;
+            s_clients[i].head = 0;
+            s_clients[i].count = 0;
+            s_clients[i].dropped = 0;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void ws_queue_remove(int fd) {
+    taskENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (s_clients[i].fd == fd) s_clients[i].fd = -1;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+int ws_queue_clients(void) {
+    int n = 0;
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) if (s_clients[i].fd >= 0) n++;
+    return n;
+}
+
+uint32_t ws_queue_dropped(void) {
+    uint32_t dropped = 0;
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) dropped += s_clients[i].dropped;
+    return dropped;
+}
+
+bool ws_queue_push(const char *msg) {
+    if (!msg || !s_msgs) return false;
+    size_t len = strnlen(msg, WS_MSG_MAX_LEN);
+    if (len == 0 || len == WS_MSG_MAX_LEN) return false;
+
+    taskENTER_CRITICAL(&s_lock);
+    uint32_t seq = ++s_next_seq;
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        ws_client_t *c = &s_clients[i];
+        if (c->fd < 0) continue;
+        if (c->count == WS_QUEUE_LEN) {
+            // Client chậm: bỏ tin cũ nhất thay vì chặn người gửi
+            c->head = (c->head + 1) % WS_QUEUE_LEN;
+            c->count--;
+            c->dropped++;
+        }
+        int slot = (c->head + c->count) % WS_QUEUE_LEN;
+        memcpy(_slot(i, slot), msg, len);
+        c->len[slot] = len;
+        c->seq[slot] = seq;
+        c->count++;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return true;
+}
+
+size_t ws_queue_peek(int client, int *fd, char *out, uint32_t *seq) {
+    ws_client_t *c = &s_clients[client];
+    size_t len = 0;
+    taskENTER_CRITICAL(&s_lock);
+    *fd = c->fd;
+    if (c->fd >= 0 && c->count > 0) {
+        len = c->len[c->head];
+        *seq = c->seq[c->head];
+        memcpy(out, _slot(client, c->head), len);
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return len;
+}
+
+bool ws_queue_pop(int client, int fd, uint32_t seq) {
+    ws_client_t *c = &s_clients[client];
+    bool popped = false;
+    taskENTER_CRITICAL(&s_lock);
+    if (c->fd == fd && c->count > 0 && c->seq[c->head] == seq) {
+        c->head = (c->head + 1) % WS_QUEUE_LEN;
+        c->count--;
+        popped = true;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return popped;
+}
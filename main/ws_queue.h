@@ -0,0 +1,43 @@
+#ifndef WS_QUEUE_H
+#define WS_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// HÀNG ĐỢI WEBSOCKET: mỗi client 1 vòng tin chờ gửi (PSRAM), người phát không bao giờ bị chặn.
+// Đầy -> bỏ tin cũ nhất của client đó. Task gửi: peek (copy tin đầu) -> gửi ngoài khoá -> pop theo seq.
+#define WS_MAX_CLIENTS        4
+#define WS_QUEUE_LEN          8     // Tin nhắn chờ gửi tối đa / client (đầy -> bỏ tin cũ nhất)
+#define WS_MSG_MAX_LEN        256
+
+// Cấp vùng tin nhắn, xoá danh sách client. false nếu hết PSRAM.
+bool ws_queue_init(void);
+
+void ws_queue_add(int fd);
+void ws_queue_remove(int fd);
+int ws_queue_clients(void);
+
+// Tổng tin bị bỏ (mọi client)
+uint32_t ws_queue_dropped(void);
+
+// Chép msg vào hàng đợi của mọi client. false nếu rỗng / dài quá WS_MSG_MAX_LEN - 1.
+bool ws_queue_push(const char *msg);
+
+// Copy tin đầu hàng của slot client (out: WS_MSG_MAX_LEN). Trả độ dài, 0 nếu không có tin.
+// *fd = -1 nếu slot trống. *seq: định danh tin, dùng cho ws_queue_pop.
+size_t ws_queue_peek(int client, int *fd, char *out, uint32_t *seq);
+
+// Bỏ tin vừa gửi. Chỉ bỏ khi đầu hàng vẫn là tin seq: trong lúc gửi, người phát có thể
+// đã đẩy nó ra vì đầy -> false, tin đầu mới chưa gửi được giữ lại.
+bool ws_queue_pop(int client, int fd, uint32_t seq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
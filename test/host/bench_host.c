@@ -0,0 +1,119 @@
+// Benchmark host cho các module C thuần: bench.c thật (phân vị, lượt chạy nền, JSON như /bench?job=1),
+// đồng hồ chu kỳ thay bằng clock_gettime. Kết quả so giữa 2 commit bằng tools/bench_compare.py:
+//   ./build_host/bench_host 500 > new.json && python3 tools/bench_compare.py old.json new.json
+// Số đo trên host chỉ để so host với host (không so với firmware).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+#include "perf_monitor.h"
+#include "json_writer.h"
+#include "ble_frame.h"
+#include "event_bus.h"
+#include "uplink_sched.h"
+
+#define EMB_DIM         512
+#define BLE_TOTAL       (16 * 1024)
+#define BLE_CHUNK       180
+
+// perf_monitor.c không build trên host: bench_run ghi trace vào đây, bỏ qua
+void perf_trace_record(const char *name, int64_t start_us, int64_t end_us) {}
+
+static float s_emb[EMB_DIM];
+static char s_json[EMB_DIM * 12 + 64];
+
+// Như json_face_writer trên thiết bị: {"face_id":..,"embedding":[512 số, 6 chữ số thập phân]}
+static void _bench_face_writer(void *ctx) {
+    json_writer_t w;
+    jw_init(&w, s_json, sizeof(s_json));
+    jw_obj_begin(&w);
+    jw_kv_int(&w, "face_id", 7);
+    jw_key(&w, "embedding");
+    jw_arr_begin(&w);
+    for (int i = 0; i < EMB_DIM; i++) jw_float(&w, s_emb[i], 6);
+    jw_arr_end(&w);
+    jw_obj_end(&w);
+    jw_finish(&w, NULL);
+}
+
+// 1 dòng access_logs (cỡ như supabase_access_log_json)
+static void _bench_log_row(void *ctx) {
+    json_writer_t w;
+    jw_init(&w, s_json, sizeof(s_json));
+    jw_obj_begin(&w);
+    jw_kv_str(&w, "device_id", "S3_LOCK_01");
+    jw_kv_str(&w, "created_at", "2026-10-19T10:10:00Z");
+    jw_kv_int(&w, "face_id", 3);
+    jw_kv_str(&w, "description", "Face ID Match (0.87)");
+    jw_key(&w, "score");
+    jw_float(&w, 0.8731, 4);
+    jw_kv_str(&w, "image_url", "log_123456.jpg");
+    jw_obj_end(&w);
+    jw_finish(&w, NULL);
+}
+
+static uint8_t s_ble_data[BLE_TOTAL];
+static uint8_t s_ble_buf[BLE_TOTAL];
+static uint8_t s_ble_raw[BLE_FRAME_HDR_LEN + BLE_CHUNK];
+static uint32_t s_ble_crc;
+
+// 1 khung DATA: mã hoá + tách
+static void _bench_ble_codec(void *ctx) {
+    ble_frame_t f;
+    size_t n = ble_frame_encode(s_ble_raw, sizeof(s_ble_raw), BLE_FRAME_DATA, BLE_OP_GALLERY_PUSH, 0, s_ble_data, BLE_CHUNK);
+    ble_frame_decode(s_ble_raw, n, &f);
+}
+
+static void _ble_feed(ble_rx_t *rx, uint8_t type, uint32_t off, const uint8_t *p, uint16_t len) {
+    ble_frame_t f;
+    size_t n = ble_frame_encode(s_ble_raw, sizeof(s_ble_raw), type, BLE_OP_GALLERY_PUSH, off, p, len);
+    if (ble_frame_decode(s_ble_raw, n, &f)) ble_rx_feed(rx, &f, BLE_TOTAL);
+}
+
+// Phía nhận trọn 1 lần đẩy gallery 16 KB: START, DATA theo khúc MTU, END (kiểm CRC-32)
+static void _bench_ble_rx(void *ctx) {
+    ble_rx_t rx = { 0 };
+    uint8_t start[8];
+    ble_rx_attach(&rx, s_ble_buf, sizeof(s_ble_buf));
+    ble_put_u32(start, BLE_TOTAL);
+    ble_put_u32(start + 4, s_ble_crc);
+    _ble_feed(&rx, BLE_FRAME_START, 0, start, sizeof(start));
+    for (uint32_t off = 0; off < BLE_TOTAL; off += BLE_CHUNK) {
+        uint16_t len = off + BLE_CHUNK > BLE_TOTAL ? BLE_TOTAL - off : BLE_CHUNK;
+        _ble_feed(&rx, BLE_FRAME_DATA, off, s_ble_data + off, len);
+    }
+    _ble_feed(&rx, BLE_FRAME_END, 0, NULL, 0);
+}
+
+int main(int argc, char **argv) {
+    uint32_t iters = argc > 1 ? (uint32_t)atoi(argv[1]) : 200;
+    for (int i = 0; i < EMB_DIM; i++) s_emb[i] = ((i * 37) % 200 - 100) / 1000.0f;
+    for (int i = 0; i < BLE_TOTAL; i++) s_ble_data[i] = (uint8_t)(i * 7 + (i >> 3));
+    s_ble_crc = ble_crc32(0, s_ble_data, BLE_TOTAL);
+
+    bench_register("json_face_writer", _bench_face_writer, NULL);
+    bench_register("json_log_row", _bench_log_row, NULL);
+    bench_register("ble_frame_codec", _bench_ble_codec, NULL);
+    bench_register("ble_rx_16k", _bench_ble_rx, NULL);
+    event_bus_init();               // bus_dispatch
+    uplink_sched_init();            // uplink_turn
+
+    // Cùng đường với /bench?name=all: lượt chạy nền + hỏi trạng thái
+    if (bench_job_start(iters, BENCH_F_LOOPBACK | BENCH_F_MODEL) != ESP_OK) {
+        fprintf(stderr, "bench_job_start failed\n");
+        return 1;
+    }
+    while (bench_job_running()) usleep(10 * 1000);
+
+    char *doc = (char *)malloc(BENCH_JOB_JSON_MAX);
+    size_t len = doc ? bench_job_json(doc, BENCH_JOB_JSON_MAX) : 0;
+    if (!len) {
+        fprintf(stderr, "bench_job_json failed\n");
+        free(doc);
+        return 1;
+    }
+    printf("%s\n", doc);
+    free(doc);
+    return 0;
+}
@@ -0,0 +1,18 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+// Assert tối giản cho test host: ghi lỗi, chạy tiếp, mã thoát != 0 nếu có lỗi
+static int g_test_fails = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            g_test_fails++; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() (printf("%s\n", g_test_fails ? "FAIL" : "OK"), g_test_fails ? 1 : 0)
+
+#endif
@@ -0,0 +1,6 @@
+// bench_register cho test không link bench.c: module tự đăng ký benchmark lúc init, ở đây bỏ qua
+#include "bench.h"
+
+esp_err_t bench_register(const char *name, bench_fn_t fn, void *ctx) { return ESP_OK; }
+esp_err_t bench_register_flags(const char *name, bench_fn_t fn, void *ctx, uint32_t flags) { return ESP_OK; }
+void bench_count_alloc(void) {}
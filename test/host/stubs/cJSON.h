@@ -0,0 +1,62 @@
+// Stub cJSON cho build host: đúng tập con API mà module dùng (parse / đọc cây / dựng + in gọn),
+// cùng tên trường và cờ kiểu như cJSON 1.7 (component espressif/cjson của firmware)
+#ifndef HOST_CJSON_H
+#define HOST_CJSON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define cJSON_Invalid   0
+#define cJSON_False     (1 << 0)
+#define cJSON_True      (1 << 1)
+#define cJSON_NULL      (1 << 2)
+#define cJSON_Number    (1 << 3)
+#define cJSON_String    (1 << 4)
+#define cJSON_Array     (1 << 5)
+#define cJSON_Object    (1 << 6)
+
+typedef struct cJSON {
+    struct cJSON *next;
+    struct cJSON *prev;
+    struct cJSON *child;
+    int type;
+    char *valuestring;
+    int valueint;
+    double valuedouble;
+    char *string;
+} cJSON;
+
+typedef struct {
+    void *(*malloc_fn)(size_t sz);
+    void (*free_fn)(void *ptr);
+} cJSON_Hooks;
+
+void cJSON_InitHooks(cJSON_Hooks *hooks);
+
+cJSON *cJSON_Parse(const char *value);
+void cJSON_Delete(cJSON *item);
+bool cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const bool format);
+
+int cJSON_GetArraySize(const cJSON *array);
+cJSON *cJSON_GetArrayItem(const cJSON *array, int index);
+cJSON *cJSON_GetObjectItem(const cJSON *object, const char *string);     // Không phân biệt hoa thường
+
+bool cJSON_IsNull(const cJSON *item);
+bool cJSON_IsNumber(const cJSON *item);
+bool cJSON_IsString(const cJSON *item);
+bool cJSON_IsArray(const cJSON *item);
+bool cJSON_IsObject(const cJSON *item);
+
+cJSON *cJSON_CreateObject(void);
+cJSON *cJSON_CreateArray(void);
+cJSON *cJSON_CreateNumber(double num);
+cJSON *cJSON_CreateString(const char *string);
+bool cJSON_AddItemToArray(cJSON *array, cJSON *item);
+bool cJSON_AddItemToObject(cJSON *object, const char *string, cJSON *item);
+cJSON *cJSON_AddNumberToObject(cJSON *object, const char *name, double number);
+cJSON *cJSON_AddStringToObject(cJSON *object, const char *name, const char *string);
+
+#define cJSON_ArrayForEach(element, array) \
+    for (element = (array != NULL) ? (array)->child : NULL; element != NULL; element = element->next)
+
+#endif
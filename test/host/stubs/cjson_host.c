@@ -0,0 +1,292 @@
+// Cài đặt host cho stub cJSON: parser đệ quy xuống, in gọn (format bị bỏ qua)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include "cJSON.h"
+
+#define CJSON_HOST_NEST_MAX     64
+
+static void *(*s_malloc)(size_t) = malloc;
+static void (*s_free)(void *) = free;
+
+void cJSON_InitHooks(cJSON_Hooks *hooks) {
+    s_malloc = hooks && hooks->malloc_fn ? hooks->malloc_fn : malloc;
+    s_free = hooks && hooks->free_fn ? hooks->free_fn : free;
+}
+
+static cJSON *_new(int type) {
+    cJSON *c = (cJSON *)s_malloc(sizeof(cJSON));
+    if (c) {
+        memset(c, 0, sizeof(*c));
+        c->type = type;
+    }
+    return c;
+}
+
+static char *_strdup(const char *s, size_t len) {
+    char *d = (char *)s_malloc(len + 1);
+    if (d) {
+        memcpy(d, s, len);
+        d[len] = '\0';
+    }
+    return d;
+}
+
+void cJSON_Delete(cJSON *item) {
+    while (item) {
+        cJSON *next = item->next;
+        cJSON_Delete(item->child);
+        if (item->valuestring) s_free(item->valuestring);
+        if (item->string) s_free(item->string);
+        s_free(item);
+        item = next;
+    }
+}
+
+// PARSE
+typedef struct {
+    const char *p;
+    int depth;
+} parser_t;
+
+static void _skip_ws(parser_t *ps) {
+    while (*ps->p == ' ' || *ps->p == '\t' || *ps->p == '\n' || *ps->p == '\r') ps->p++;
+}
+
+static size_t _utf8(unsigned cp, char *out) {
+    if (cp < 0x80) { out[0] = (char)cp; return 1; }
+    if (cp < 0x800) { out[0] = (char)(0xC0 | cp >> 6); out[1] = (char)(0x80 | (cp & 0x3F)); return 2; }
+    out[0] = (char)(0xE0 | cp >> 12);
+    out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[2] = (char)(0x80 | (cp & 0x3F));
+    return 3;
+}
+
+// Chuỗi JSON (đang đứng ở dấu ") -> bản copy đã bỏ escape
+static char *_parse_str(parser_t *ps) {
+    const char *s = ++ps->p;
+    size_t cap = 0;
+    while (s[cap] && s[cap] != '"') cap += s[cap] == '\\' && s[cap + 1] ? 2 : 1;
+    if (s[cap] != '"') return NULL;
+    char *out = (char *)s_malloc(cap + 1), *o = out;
+    if (!out) return NULL;
+    while (*ps->p != '"') {
+        char ch = *ps->p++;
+        if (ch != '\\') { *o++ = ch; continue; }
+        ch = *ps->p++;
+        switch (ch) {
+        case 'b': *o++ = '\b'; break;
+        case 'f': *o++ = '\f'; break;
+        case 'n': *o++ = '\n'; break;
+        case 'r': *o++ = '\r'; break;
+        case 't': *o++ = '\t'; break;
+        case 'u': {
+            unsigned cp = 0;
+            if (sscanf(ps->p, "%4x", &cp) != 1) { s_free(out); return NULL; }
+            ps->p += 4;
+            o += _utf8(cp, o);      // \uXXXX chiếm 6 byte nguồn, tối đa 3 byte UTF-8
+            break;
+        }
+        default: *o++ = ch; break;
+        }
+    }
+    ps->p++;
+    *o = '\0';
+    return out;
+}
+
+static cJSON *_parse_value(parser_t *ps);
+
+static cJSON *_parse_container(parser_t *ps, bool object) {
+    cJSON *c = _new(object ? cJSON_Object : cJSON_Array), *tail = NULL;
+    if (!c || ++ps->depth > CJSON_HOST_NEST_MAX) { cJSON_Delete(c); return NULL; }
+    ps->p++;
+    _skip_ws(ps);
+    if (*ps->p == (object ? '}' : ']')) { ps->p++; ps->depth--; return c; }
+    for (;;) {
+        char *key = NULL;
+        _skip_ws(ps);
+        if (object) {
+            if (*ps->p != '"' || !(key = _parse_str(ps))) break;
+            _skip_ws(ps);
+            if (*ps->p++ != ':') { s_free(key); break; }
+        }
+        cJSON *v = _parse_value(ps);
+        if (!v) { if (key) s_free(key); break; }
+        v->string = key;
+        if (tail) { tail->next = v; v->prev = tail; } else c->child = v;
+        tail = v;
+        _skip_ws(ps);
+        if (*ps->p == ',') { ps->p++; continue; }
+        if (*ps->p == (object ? '}' : ']')) { ps->p++; ps->depth--; return c; }
+        break;
+    }
+    cJSON_Delete(c);
+    return NULL;
+}
+
+static cJSON *_parse_value(parser_t *ps) {
+    _skip_ws(ps);
+    const char *p = ps->p;
+    if (*p == '{' || *p == '[') return _parse_container(ps, *p == '{');
+    if (*p == '"') {
+        char *s = _parse_str(ps);
+        cJSON *c = s ? _new(cJSON_String) : NULL;
+        if (c) c->valuestring = s; else if (s) s_free(s);
+        return c;
+    }
+    if (strncmp(p, "null", 4) == 0) { ps->p += 4; return _new(cJSON_NULL); }
+    if (strncmp(p, "true", 4) == 0) { ps->p += 4; cJSON *c = _new(cJSON_True); if (c) c->valueint = 1; return c; }
+    if (strncmp(p, "false", 5) == 0) { ps->p += 5; return _new(cJSON_False); }
+    char *end;
+    double d = strtod(p, &end);
+    if (end == p) return NULL;
+    ps->p = end;
+    return cJSON_CreateNumber(d);
+}
+
+cJSON *cJSON_Parse(const char *value) {
+    if (!value) return NULL;
+    parser_t ps = { .p = value, .depth = 0 };
+    cJSON *c = _parse_value(&ps);
+    if (!c) return NULL;
+    _skip_ws(&ps);
+    if (*ps.p) { cJSON_Delete(c); return NULL; }    // Rác sau giá trị
+    return c;
+}
+
+// ĐỌC CÂY
+int cJSON_GetArraySize(const cJSON *array) {
+    int n = 0;
+    for (const cJSON *c = array ? array->child : NULL; c; c = c->next) n++;
+    return n;
+}
+
+cJSON *cJSON_GetArrayItem(const cJSON *array, int index) {
+    cJSON *c = array && index >= 0 ? array->child : NULL;
+    while (c && index-- > 0) c = c->next;
+    return c;
+}
+
+cJSON *cJSON_GetObjectItem(const cJSON *object, const char *string) {
+    if (!object || !string) return NULL;
+    for (cJSON *c = object->child; c; c = c->next) {
+        if (c->string && strcasecmp(c->string, string) == 0) return c;
+    }
+    return NULL;
+}
+
+bool cJSON_IsNull(const cJSON *item) { return item && (item->type & 0xFF) == cJSON_NULL; }
+bool cJSON_IsNumber(const cJSON *item) { return item && (item->type & 0xFF) == cJSON_Number; }
+bool cJSON_IsString(const cJSON *item) { return item && (item->type & 0xFF) == cJSON_String; }
+bool cJSON_IsArray(const cJSON *item) { return item && (item->type & 0xFF) == cJSON_Array; }
+bool cJSON_IsObject(const cJSON *item) { return item && (item->type & 0xFF) == cJSON_Object; }
+
+// DỰNG CÂY
+cJSON *cJSON_CreateObject(void) { return _new(cJSON_Object); }
+cJSON *cJSON_CreateArray(void) { return _new(cJSON_Array); }
+
+cJSON *cJSON_CreateNumber(double num) {
+    cJSON *c = _new(cJSON_Number);
+    if (c) {
+        c->valuedouble = num;
+        c->valueint = num >= 2147483647.0 ? 2147483647 : num <= -2147483648.0 ? (-2147483647 - 1) : (int)num;
+    }
+    return c;
+}
+
+cJSON *cJSON_CreateString(const char *string) {
+    cJSON *c = _new(cJSON_String);
+    if (c && !(c->valuestring = _strdup(string, strlen(string)))) { s_free(c); c = NULL; }
+    return c;
+}
+
+bool cJSON_AddItemToArray(cJSON *array, cJSON *item) {
+    if (!array || !item) return false;
+    cJSON *tail = array->child;
+    while (tail && tail->next) tail = tail->next;
+    if (tail) { tail->next = item; item->prev = tail; } else array->child = item;
+    return true;
+}
+
+bool cJSON_AddItemToObject(cJSON *object, const char *string, cJSON *item) {
+    if (!object || !item || !(item->string = _strdup(string, strlen(string)))) return false;
+    return cJSON_AddItemToArray(object, item);
+}
+
+cJSON *cJSON_AddNumberToObject(cJSON *object, const char *name, double number) {
+    cJSON *c = cJSON_CreateNumber(number);
+    if (!cJSON_AddItemToObject(object, name, c)) { cJSON_Delete(c); return NULL; }
+    return c;
+}
+
+cJSON *cJSON_AddStringToObject(cJSON *object, const char *name, const char *string) {
+    cJSON *c = cJSON_CreateString(string);
+    if (!cJSON_AddItemToObject(object, name, c)) { cJSON_Delete(c); return NULL; }
+    return c;
+}
+
+// IN GỌN
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t off;
+    bool ok;
+} printer_t;
+
+static void _put(printer_t *pr, const char *s, size_t n) {
+    if (!pr->ok || pr->off + n >= pr->len) { pr->ok = false; return; }
+    memcpy(pr->buf + pr->off, s, n);
+    pr->off += n;
+}
+
+static void _put_str(printer_t *pr, const char *s) {
+    _put(pr, "\"", 1);
+    for (; *s; s++) {
+        char esc[8];
+        unsigned char ch = (unsigned char)*s;
+        if (ch == '"' || ch == '\\') { esc[0] = '\\'; esc[1] = (char)ch; _put(pr, esc, 2); }
+        else if (ch < 0x20) _put(pr, esc, snprintf(esc, sizeof(esc), "\\u%04x", ch));
+        else _put(pr, s, 1);
+    }
+    _put(pr, "\"", 1);
+}
+
+static void _print(printer_t *pr, const cJSON *c) {
+    char num[32];
+    switch (c->type & 0xFF) {
+    case cJSON_NULL: _put(pr, "null", 4); break;
+    case cJSON_True: _put(pr, "true", 4); break;
+    case cJSON_False: _put(pr, "false", 5); break;
+    case cJSON_String: _put_str(pr, c->valuestring); break;
+    case cJSON_Number:
+        if (!isfinite(c->valuedouble)) _put(pr, "null", 4);
+        else if (c->valuedouble == (double)c->valueint) _put(pr, num, snprintf(num, sizeof(num), "%d", c->valueint));
+        else _put(pr, num, snprintf(num, sizeof(num), "%.17g", c->valuedouble));
+        break;
+    case cJSON_Array:
+    case cJSON_Object: {
+        bool object = (c->type & 0xFF) == cJSON_Object;
+        _put(pr, object ? "{" : "[", 1);
+        for (const cJSON *e = c->child; e; e = e->next) {
+            if (e != c->child) _put(pr, ",", 1);
+            if (object) { _put_str(pr, e->string ? e->string : ""); _put(pr, ":", 1); }
+            _print(pr, e);
+        }
+        _put(pr, object ? "}" : "]", 1);
+        break;
+    }
+    default: pr->ok = false; break;
+    }
+}
+
+bool cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const bool format) {
+    if (!item || !buffer || length <= 0) return false;
+    printer_t pr = { .buf = buffer, .len = (size_t)length, .off = 0, .ok = true };
+    _print(&pr, item);
+    if (!pr.ok) return false;
+    buffer[pr.off] = '\0';
+    return true;
+}
@@ -0,0 +1,25 @@
+// Stub esp_app_desc cho build host: bench_build_json ghi "host" thay cho thông tin firmware
+#ifndef HOST_ESP_APP_DESC_H
+#define HOST_ESP_APP_DESC_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+typedef struct {
+    const char *project_name;
+    const char *version;
+    const char *idf_ver;
+    const char *date;
+    const char *time;
+} esp_app_desc_t;
+
+static inline const esp_app_desc_t *esp_app_get_description(void) {
+    static const esp_app_desc_t desc = { "smart_lock_host", "host", "host", __DATE__, __TIME__ };
+    return &desc;
+}
+
+static inline int esp_app_get_elf_sha256(char *dst, size_t size) {
+    return snprintf(dst, size, "host");
+}
+
+#endif
@@ -0,0 +1,21 @@
+// Stub esp_camera cho build host: chỉ kiểu frame (test tự cấp buffer JPEG)
+#ifndef HOST_ESP_CAMERA_H
+#define HOST_ESP_CAMERA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum { PIXFORMAT_RGB565, PIXFORMAT_JPEG } pixformat_t;
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t width;
+    size_t height;
+    pixformat_t format;
+} camera_fb_t;
+
+camera_fb_t *esp_camera_fb_get(void);
+void esp_camera_fb_return(camera_fb_t *fb);
+
+#endif
@@ -0,0 +1,14 @@
+// Stub esp_cpu cho build host: "chu kỳ" = ns đồng hồ đơn điệu (esp_rom_get_cpu_ticks_per_us = 1000)
+#ifndef HOST_ESP_CPU_H
+#define HOST_ESP_CPU_H
+
+#include <stdint.h>
+#include <time.h>
+
+static inline uint32_t esp_cpu_get_cycle_count(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+#endif
@@ -0,0 +1,9 @@
+// Stub esp_crt_bundle cho build host (client host không có TLS)
+#ifndef HOST_ESP_CRT_BUNDLE_H
+#define HOST_ESP_CRT_BUNDLE_H
+
+#include "esp_err.h"
+
+esp_err_t esp_crt_bundle_attach(void *conf);
+
+#endif
@@ -0,0 +1,295 @@
+// Cài đặt host cho stub esp_http_client: 1 kết nối TCP mỗi request, Connection: close
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "esp_http_client.h"
+#include "esp_crt_bundle.h"
+
+#define HOST_HTTP_MAX_HEADERS   16
+#define HOST_HTTP_LINE_MAX      2048
+
+struct esp_http_client {
+    char host[128];
+    char port[8];
+    char path[512];
+    esp_http_client_method_t method;
+    int timeout_ms;
+    http_event_handle_cb handler;
+    void *user_data;
+    char *hdr_key[HOST_HTTP_MAX_HEADERS];
+    char *hdr_val[HOST_HTTP_MAX_HEADERS];
+    const char *post;
+    int post_len;
+    int fd;
+    int status;
+    bool chunked;
+    long content_len;       // -1: không có Content-Length
+    long body_left;         // Còn lại của body (hoặc của chunk hiện tại)
+    bool body_done;
+    char rx[HOST_HTTP_LINE_MAX];
+    int rx_pos;
+    int rx_len;
+};
+
+static const char *METHOD_NAMES[] = { "GET", "POST", "PUT", "PATCH", "DELETE", "HEAD" };
+
+esp_err_t esp_crt_bundle_attach(void *conf) { return ESP_OK; }
+
+// Chỉ http://host[:port]/path
+static bool _parse_url(esp_http_client_handle_t c, const char *url) {
+    if (strncmp(url, "http://", 7) != 0) return false;
+    const char *p = url + 7;
+    size_t host_len = strcspn(p, ":/");
+    if (host_len == 0 || host_len >= sizeof(c->host)) return false;
+    memcpy(c->host, p, host_len);
+    c->host[host_len] = '\0';
+    p += host_len;
+    strcpy(c->port, "80");
+    if (*p == ':') {
+        size_t n = strcspn(++p, "/");
+        if (n == 0 || n >= sizeof(c->port)) return false;
+        memcpy(c->port, p, n);
+        c->port[n] = '\0';
+        p += n;
+    }
+    snprintf(c->path, sizeof(c->path), "%s", *p ? p : "/");
+    return true;
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config) {
+    esp_http_client_handle_t c = (esp_http_client_handle_t)calloc(1, sizeof(*c));
+    if (!c) return NULL;
+    if (!config->url || !_parse_url(c, config->url)) { free(c); return NULL; }
+    c->method = config->method;
+    c->timeout_ms = config->timeout_ms > 0 ? config->timeout_ms : 5000;
+    c->handler = config->event_handler;
+    c->user_data = config->user_data;
+    c->fd = -1;
+    return c;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t c, const char *key, const char *value) {
+    int free_slot = -1;
+    for (int i = 0; i < HOST_HTTP_MAX_HEADERS; i++) {
+        if (c->hdr_key[i] && strcasecmp(c->hdr_key[i], key) == 0) {
+            free(c->hdr_val[i]);
+            c->hdr_val[i] = strdup(value);
+            return ESP_OK;
+        }
+        if (!c->hdr_key[i] && free_slot < 0) free_slot = i;
+    }
+    if (free_slot < 0) return ESP_ERR_NO_MEM;
+    c->hdr_key[free_slot] = strdup(key);
+    c->hdr_val[free_slot] = strdup(value);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_delete_header(esp_http_client_handle_t c, const char *key) {
+    for (int i = 0; i < HOST_HTTP_MAX_HEADERS; i++) {
+        if (c->hdr_key[i] && strcasecmp(c->hdr_key[i], key) == 0) {
+            free(c->hdr_key[i]);
+            free(c->hdr_val[i]);
+            c->hdr_key[i] = c->hdr_val[i] = NULL;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t c, const char *data, int len) {
+    c->post = data;
+    c->post_len = len;
+    return ESP_OK;
+}
+
+static void _event(esp_http_client_handle_t c, esp_http_client_event_id_t id, char *key, char *val, void *data, int len) {
+    if (!c->handler) return;
+    esp_http_client_event_t evt = { .event_id = id, .client = c, .data = data, .data_len = len,
+                                    .user_data = c->user_data, .header_key = key, .header_value = val };
+    c->handler(&evt);
+}
+
+static bool _send_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t w = send(fd, buf, len, MSG_NOSIGNAL);
+        if (w <= 0) return false;
+        buf += w;
+        len -= (size_t)w;
+    }
+    return true;
+}
+
+esp_err_t esp_http_client_open(esp_http_client_handle_t c, int write_len) {
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM }, *res = NULL;
+    if (getaddrinfo(c->host, c->port, &hints, &res) != 0) return ESP_FAIL;
+    c->fd = -1;
+    for (struct addrinfo *a = res; a && c->fd < 0; a = a->ai_next) {
+        int fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd < 0) continue;
+        struct timeval tv = { .tv_sec = c->timeout_ms / 1000, .tv_usec = (c->timeout_ms % 1000) * 1000 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) c->fd = fd;
+        else close(fd);
+    }
+    freeaddrinfo(res);
+    if (c->fd < 0) return ESP_FAIL;
+    _event(c, HTTP_EVENT_ON_CONNECTED, NULL, NULL, NULL, 0);
+
+    char head[HOST_HTTP_LINE_MAX * 2];
+    int n = snprintf(head, sizeof(head), "%s %s HTTP/1.1\r\nHost: %s:%s\r\nConnection: close\r\n",
+                     METHOD_NAMES[c->method], c->path, c->host, c->port);
+    for (int i = 0; i < HOST_HTTP_MAX_HEADERS; i++) {
+        if (c->hdr_key[i] && n < (int)sizeof(head)) {
+            n += snprintf(head + n, sizeof(head) - n, "%s: %s\r\n", c->hdr_key[i], c->hdr_val[i]);
+        }
+    }
+    if (write_len > 0 || c->method == HTTP_METHOD_POST || c->method == HTTP_METHOD_PATCH) {
+        if (n < (int)sizeof(head)) n += snprintf(head + n, sizeof(head) - n, "Content-Length: %d\r\n", write_len);
+    }
+    if (n + 2 >= (int)sizeof(head)) { esp_http_client_close(c); return ESP_ERR_NO_MEM; }
+    memcpy(head + n, "\r\n", 2);
+    if (!_send_all(c->fd, head, n + 2)) { esp_http_client_close(c); return ESP_FAIL; }
+    _event(c, HTTP_EVENT_HEADERS_SENT, NULL, NULL, NULL, 0);
+    c->status = 0;
+    c->rx_pos = c->rx_len = 0;
+    return ESP_OK;
+}
+
+int esp_http_client_write(esp_http_client_handle_t c, const char *buffer, int len) {
+    if (c->fd < 0) return -1;
+    return _send_all(c->fd, buffer, len) ? len : -1;
+}
+
+// Đọc qua bộ đệm rx: tối đa len byte, 0 = server đóng, -1 = lỗi / hết giờ
+static int _recv(esp_http_client_handle_t c, char *out, int len) {
+    if (c->rx_pos == c->rx_len) {
+        ssize_t r = recv(c->fd, c->rx, sizeof(c->rx), 0);
+        if (r <= 0) return r == 0 ? 0 : -1;
+        c->rx_pos = 0;
+        c->rx_len = (int)r;
+    }
+    int n = c->rx_len - c->rx_pos < len ? c->rx_len - c->rx_pos : len;
+    memcpy(out, c->rx + c->rx_pos, n);
+    c->rx_pos += n;
+    return n;
+}
+
+// 1 dòng header (bỏ CRLF). false nếu kết nối đứt hoặc dòng quá dài
+static bool _read_line(esp_http_client_handle_t c, char *line, size_t cap) {
+    size_t n = 0;
+    for (;;) {
+        char ch;
+        if (_recv(c, &ch, 1) != 1) return false;
+        if (ch == '\n') break;
+        if (n + 1 >= cap) return false;
+        line[n++] = ch;
+    }
+    if (n > 0 && line[n - 1] == '\r') n--;
+    line[n] = '\0';
+    return true;
+}
+
+// Kích thước chunk kế tiếp; chunk 0 -> hết body
+static bool _next_chunk(esp_http_client_handle_t c) {
+    char line[64];
+    if (!_read_line(c, line, sizeof(line))) return false;
+    if (line[0] == '\0' && !_read_line(c, line, sizeof(line))) return false;   // CRLF sau chunk trước
+    c->body_left = strtol(line, NULL, 16);
+    if (c->body_left == 0) c->body_done = true;
+    return true;
+}
+
+int64_t esp_http_client_fetch_headers(esp_http_client_handle_t c) {
+    char line[HOST_HTTP_LINE_MAX];
+    if (c->fd < 0 || !_read_line(c, line, sizeof(line))) return ESP_FAIL;
+    if (sscanf(line, "HTTP/%*d.%*d %d", &c->status) != 1) return ESP_FAIL;
+    c->chunked = false;
+    c->content_len = -1;
+    for (;;) {
+        if (!_read_line(c, line, sizeof(line))) return ESP_FAIL;
+        if (line[0] == '\0') break;
+        char *colon = strchr(line, ':');
+        if (!colon) continue;
+        *colon = '\0';
+        char *val = colon + 1;
+        while (*val == ' ') val++;
+        if (strcasecmp(line, "Content-Length") == 0) c->content_len = strtol(val, NULL, 10);
+        else if (strcasecmp(line, "Transfer-Encoding") == 0 && strcasecmp(val, "chunked") == 0) c->chunked = true;
+        _event(c, HTTP_EVENT_ON_HEADER, line, val, NULL, 0);
+    }
+    c->body_done = c->method == HTTP_METHOD_HEAD || c->status == 204 || c->status == 304;
+    c->body_left = c->chunked ? 0 : c->content_len;
+    if (!c->body_done && c->chunked && !_next_chunk(c)) return ESP_FAIL;
+    if (c->body_done || c->chunked || c->content_len < 0) return 0;
+    return c->content_len;
+}
+
+int esp_http_client_read_response(esp_http_client_handle_t c, char *buffer, int len) {
+    int total = 0;
+    while (total < len && !c->body_done) {
+        if (c->chunked && c->body_left == 0) {
+            if (!_next_chunk(c)) return -1;
+            continue;
+        }
+        int want = len - total;
+        if (c->body_left >= 0 && c->body_left < want) want = (int)c->body_left;
+        int r = _recv(c, buffer + total, want);
+        if (r < 0) return -1;
+        if (r == 0) {
+            if (c->body_left > 0 && (c->chunked || c->content_len >= 0)) return -1;  // Đứt giữa body
+            c->body_done = true;
+            break;
+        }
+        total += r;
+        if (c->body_left >= 0) {
+            c->body_left -= r;
+            if (c->body_left == 0 && !c->chunked) c->body_done = true;
+        }
+    }
+    return total;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t c) {
+    return c->status;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t c) {
+    if (c->fd >= 0) {
+        close(c->fd);
+        c->fd = -1;
+        _event(c, HTTP_EVENT_DISCONNECTED, NULL, NULL, NULL, 0);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_perform(esp_http_client_handle_t c) {
+    esp_err_t err = esp_http_client_open(c, c->post ? c->post_len : 0);
+    if (err != ESP_OK) return err;
+    if (c->post && esp_http_client_write(c, c->post, c->post_len) < 0) err = ESP_FAIL;
+    if (err == ESP_OK && esp_http_client_fetch_headers(c) < 0) err = ESP_FAIL;
+    char buf[1024];
+    int r = 0;
+    while (err == ESP_OK && (r = esp_http_client_read_response(c, buf, sizeof(buf))) > 0) {
+        _event(c, HTTP_EVENT_ON_DATA, NULL, NULL, buf, r);
+    }
+    if (r < 0) err = ESP_FAIL;
+    if (err == ESP_OK) _event(c, HTTP_EVENT_ON_FINISH, NULL, NULL, NULL, 0);
+    esp_http_client_close(c);
+    return err;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t c) {
+    if (!c) return ESP_OK;
+    esp_http_client_close(c);
+    for (int i = 0; i < HOST_HTTP_MAX_HEADERS; i++) {
+        free(c->hdr_key[i]);
+        free(c->hdr_val[i]);
+    }
+    free(c);
+    return ESP_OK;
+}
@@ -0,0 +1,7 @@
+// Stub esp_netif cho build host: header module mạng include nhưng test host không dùng
+#ifndef HOST_ESP_NETIF_H
+#define HOST_ESP_NETIF_H
+
+#include "esp_err.h"
+
+#endif
@@ -0,0 +1,9 @@
+// Stub esp_rom_sys cho build host: khớp đơn vị của esp_cpu_get_cycle_count (ns)
+#ifndef HOST_ESP_ROM_SYS_H
+#define HOST_ESP_ROM_SYS_H
+
+#include <stdint.h>
+
+static inline uint32_t esp_rom_get_cpu_ticks_per_us(void) { return 1000; }
+
+#endif
@@ -0,0 +1,11 @@
+// Stub esp_sntp cho build host: giờ hệ thống của máy đã đúng sẵn
+#ifndef HOST_ESP_SNTP_H
+#define HOST_ESP_SNTP_H
+
+#define SNTP_OPMODE_POLL    0
+
+static inline void esp_sntp_setoperatingmode(int mode) {}
+static inline void esp_sntp_setservername(int idx, const char *server) {}
+static inline void esp_sntp_init(void) {}
+
+#endif
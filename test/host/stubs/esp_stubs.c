@@ -0,0 +1,92 @@
+// Cài đặt host cho các stub ESP-IDF (esp_timer, esp_random, NVS, esp_err_to_name)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "nvs.h"
+
+int64_t host_timer_offset_us = 0;
+
+int64_t esp_timer_get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000 + host_timer_offset_us;
+}
+
+void esp_fill_random(void *buf, size_t len) {
+    FILE *f = fopen("/dev/urandom", "rb");
+    if (!f || fread(buf, 1, len, f) != len) {
+        for (size_t i = 0; i < len; i++) ((uint8_t *)buf)[i] = (uint8_t)rand();
+    }
+    if (f) fclose(f);
+}
+
+uint32_t esp_random(void) {
+    uint32_t v;
+    esp_fill_random(&v, sizeof(v));
+    return v;
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+    case ESP_OK:                return "ESP_OK";
+    case ESP_FAIL:              return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_TIMEOUT:       return "ESP_ERR_TIMEOUT";
+    default:                    return "ESP_ERR";
+    }
+}
+
+#define NVS_STUB_KEYS   8
+#define NVS_STUB_BLOB   64
+
+static struct {
+    char key[16];
+    uint8_t val[NVS_STUB_BLOB];
+    size_t len;
+} s_nvs[NVS_STUB_KEYS];
+
+esp_err_t nvs_open(const char *ns, nvs_open_mode_t mode, nvs_handle_t *out) {
+    *out = 1;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t h) {}
+
+esp_err_t nvs_commit(nvs_handle_t h) { return ESP_OK; }
+
+esp_err_t nvs_get_blob(nvs_handle_t h, const char *key, void *out, size_t *len) {
+    for (int i = 0; i < NVS_STUB_KEYS; i++) {
+        if (strcmp(s_nvs[i].key, key) != 0) continue;
+        if (*len < s_nvs[i].len) return ESP_ERR_INVALID_SIZE;
+        memcpy(out, s_nvs[i].val, s_nvs[i].len);
+        *len = s_nvs[i].len;
+        return ESP_OK;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t h, const char *key, const void *val, size_t len) {
+    if (len > NVS_STUB_BLOB || strlen(key) >= sizeof(s_nvs[0].key)) return ESP_ERR_INVALID_ARG;
+    int slot = -1;
+    for (int i = 0; i < NVS_STUB_KEYS && slot < 0; i++) if (strcmp(s_nvs[i].key, key) == 0) slot = i;
+    for (int i = 0; i < NVS_STUB_KEYS && slot < 0; i++) if (s_nvs[i].key[0] == '\0') slot = i;
+    if (slot < 0) return ESP_ERR_NO_MEM;
+    strcpy(s_nvs[slot].key, key);
+    memcpy(s_nvs[slot].val, val, len);
+    s_nvs[slot].len = len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_str(nvs_handle_t h, const char *key, char *out, size_t *len) {
+    return nvs_get_blob(h, key, out, len);
+}
+
+esp_err_t nvs_set_str(nvs_handle_t h, const char *key, const char *val) {
+    return nvs_set_blob(h, key, val, strlen(val) + 1);
+}
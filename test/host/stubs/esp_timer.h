@@ -0,0 +1,12 @@
+// Stub esp_timer cho build host: đồng hồ đơn điệu + độ lệch test chỉnh được
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+
+// Chỉ có trên host: cộng thêm vào esp_timer_get_time (giả lập thời gian trôi)
+extern int64_t host_timer_offset_us;
+
+#endif
@@ -0,0 +1,215 @@
+// Cài đặt host cho stub task / semaphore / queue FreeRTOS (pthread)
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+};
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t *items;
+    UBaseType_t len;
+    UBaseType_t size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+struct host_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max;
+};
+
+static __thread struct host_task *t_self = NULL;
+
+static struct host_task *_task_new(void) {
+    struct host_task *t = (struct host_task *)calloc(1, sizeof(*t));
+    if (!t) return NULL;
+    pthread_mutex_init(&t->lock, NULL);
+    pthread_cond_init(&t->cond, NULL);
+    return t;
+}
+
+// Hạn chờ tuyệt đối cho pthread_cond_timedwait (CLOCK_REALTIME)
+static struct timespec _deadline(TickType_t ticks) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ticks / 1000;
+    ts.tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) { ts.tv_sec++; ts.tv_nsec -= 1000000000L; }
+    return ts;
+}
+
+static void *_task_main(void *p) {
+    t_self = (struct host_task *)p;
+    t_self->fn(t_self->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *out, BaseType_t core) {
+    struct host_task *t = _task_new();
+    if (!t) return pdFAIL;
+    t->fn = fn;
+    t->arg = arg;
+    if (pthread_create(&t->thread, NULL, _task_main, t) != 0) { free(t); return pdFAIL; }
+    pthread_detach(t->thread);
+    if (out) *out = t;
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // Handle giữ lại: task khác có thể vẫn đang trỏ tới (notify muộn)
+    if (!task) pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    usleep((useconds_t)ticks * 1000);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (!t_self) t_self = _task_new();      // Thread không tạo qua xTaskCreate (vd. main)
+    return t_self;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    struct host_task *t = xTaskGetCurrentTaskHandle();
+    struct timespec until = _deadline(ticks);
+    pthread_mutex_lock(&t->lock);
+    while (t->notify == 0) {
+        if (ticks == portMAX_DELAY) pthread_cond_wait(&t->cond, &t->lock);
+        else if (pthread_cond_timedwait(&t->cond, &t->lock, &until) == ETIMEDOUT) break;
+    }
+    uint32_t v = t->notify;
+    if (v) t->notify = clear ? 0 : v - 1;
+    pthread_mutex_unlock(&t->lock);
+    return v;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+    struct host_sem *s = (struct host_sem *)calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->cond, NULL);
+    s->count = initial;
+    s->max = max;
+    return s;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    struct timespec until = _deadline(ticks);
+    pthread_mutex_lock(&sem->lock);
+    while (sem->count == 0) {
+        if (ticks == 0) break;
+        if (ticks == portMAX_DELAY) pthread_cond_wait(&sem->cond, &sem->lock);
+        else if (pthread_cond_timedwait(&sem->cond, &sem->lock, &until) == ETIMEDOUT) break;
+    }
+    BaseType_t got = sem->count > 0;
+    if (got) sem->count--;
+    pthread_mutex_unlock(&sem->lock);
+    return got ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    pthread_mutex_lock(&sem->lock);
+    BaseType_t ok = sem->count < sem->max;
+    if (ok) {
+        sem->count++;
+        pthread_cond_signal(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+    free(sem);
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t item_size) {
+    struct host_queue *q = (struct host_queue *)calloc(1, sizeof(*q));
+    if (!q) return NULL;
+    q->items = (uint8_t *)malloc((size_t)len * item_size);
+    if (!q->items) { free(q); return NULL; }
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->cond, NULL);
+    q->len = len;
+    q->size = item_size;
+    return q;
+}
+
+// Người gửi / người nhận chờ chung 1 cond: broadcast sau mỗi thay đổi
+static BaseType_t _queue_wait(struct host_queue *q, bool for_space, TickType_t ticks) {
+    struct timespec until = _deadline(ticks);
+    while (for_space ? q->count == q->len : q->count == 0) {
+        if (ticks == 0) return pdFALSE;
+        if (ticks == portMAX_DELAY) pthread_cond_wait(&q->cond, &q->lock);
+        else if (pthread_cond_timedwait(&q->cond, &q->lock, &until) == ETIMEDOUT) {
+            return (for_space ? q->count < q->len : q->count > 0) ? pdTRUE : pdFALSE;
+        }
+    }
+    return pdTRUE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks) {
+    pthread_mutex_lock(&q->lock);
+    BaseType_t ok = _queue_wait(q, true, ticks);
+    if (ok) {
+        memcpy(q->items + (size_t)((q->head + q->count) % q->len) * q->size, item, q->size);
+        q->count++;
+        pthread_cond_broadcast(&q->cond);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *out, TickType_t ticks) {
+    pthread_mutex_lock(&q->lock);
+    BaseType_t ok = _queue_wait(q, false, ticks);
+    if (ok) {
+        memcpy(out, q->items + (size_t)q->head * q->size, q->size);
+        q->head = (q->head + 1) % q->len;
+        q->count--;
+        pthread_cond_broadcast(&q->cond);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t n = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
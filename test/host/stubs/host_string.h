@@ -0,0 +1,21 @@
+// Bổ sung <string.h> cho build host: newlib của ESP-IDF có strlcpy, glibc < 2.38 thì không.
+// Nạp trước mọi file (-include) của target cần tới.
+#ifndef HOST_STRING_H
+#define HOST_STRING_H
+
+#include <string.h>
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+static inline size_t host_strlcpy(char *dst, const char *src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#define strlcpy host_strlcpy
+#endif
+
+#endif
@@ -0,0 +1,5 @@
+// Stub sdkconfig cho build host: giá trị mặc định của menuconfig (không CONFIG_* nào được bật)
+#ifndef HOST_SDKCONFIG_H
+#define HOST_SDKCONFIG_H
+
+#endif
@@ -0,0 +1,361 @@
+// supabase_client.c thật chạy trên host với esp_http_client qua socket (stubs/esp_http_client_host.c),
+// điều khiển bằng lệnh từng dòng trên stdin, mỗi lệnh trả 1 dòng JSON trên stdout.
+// test_supabase_mock.py chạy chương trình này với tools/supabase_mock.py:
+//   supabase_host http://127.0.0.1:<port> <key>
+// Lệnh:
+//   wifi 0|1                        Mạng có / mất (outbox giữ sự kiện khi mất)
+//   log <face_id> [thumb] [full]    Sự kiện vào outbox: face_id < 0 = lệnh remote; thumb/full = cỡ ảnh (byte)
+//   flush <ms>                      Chờ outbox gửi xong mọi sự kiện (cả log của lệnh OPEN) -> trạng thái outbox
+//   status                          supabase_outbox_status_json
+//   image <bytes> <tên>             supabase_upload_image (nhỏ: POST, lớn: TUS)
+//   poll                            check_remote_command -> lệnh mở / enroll đã phát lên bus
+//   enroll_wait <ms>                Chờ perform_enrollment xong -> các trạng thái WS đã gửi
+//   sync <face_id>                  supabase_sync_users -> id đã nạp, embedding[1] của face_id
+//   adapt <face_id> <hệ số>         supabase_upload_face_adapted(mẫu enroll * hệ số)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "cJSON.h"
+#include "esp_timer.h"
+#include "esp_camera.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "supabase_client.h"
+#include "face_detect.h"
+#include "access_stats.h"
+#include "perf_monitor.h"
+#include "mem_pool.h"
+#include "event_bus.h"
+#include "uplink_sched.h"
+
+#define HOST_SCORE          0.8731f
+#define HOST_PHOTO_BYTES    9000
+#define HOST_GALLERY_MAX    128
+#define HOST_STATES_MAX     8
+
+// --- Các module firmware không build trên host: thay bằng bản ghi nhận tối thiểu ---
+
+SemaphoreHandle_t xCameraMutex = NULL;      // Không có camera: lệnh remote gửi log không ảnh
+
+camera_fb_t *esp_camera_fb_get(void) { return NULL; }
+void esp_camera_fb_return(camera_fb_t *fb) {}
+
+void perf_trace_record(const char *name, int64_t start_us, int64_t end_us) {}
+
+static atomic_bool s_wifi = true;
+bool wifi_is_connected(void) { return atomic_load(&s_wifi); }
+
+void access_stats_record(const event_rec_t *r) {}
+size_t access_stats_json(char *buf, size_t len) { return (size_t)snprintf(buf, len, "{}") < len ? 2 : 0; }
+
+static uint32_t s_seq = 0;
+esp_err_t event_store_append(ev_source_t src, int face_id, float score, time_t ts, bool snapshot, event_rec_t *out) {
+    s_seq++;
+    if (out) {
+        memset(out, 0, sizeof(*out));
+        out->ts = (uint32_t)ts;
+        out->seq = s_seq;
+        out->snap = snapshot ? 0x1000 + s_seq : 0;
+        out->score = score;
+        out->face_id = (int16_t)face_id;
+        out->source = (uint8_t)src;
+    }
+    return ESP_OK;
+}
+
+// Như event_store.c
+void event_snapshot_name(uint32_t snap, char *out, size_t len) {
+    snprintf(out, len, "ev_%08lx.jpg", (unsigned long)snap);
+}
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Gallery nhận từ cloud: embedding[1] của mẫu gốc / mẫu đã học (đủ để so với giá trị test gửi lên)
+static struct {
+    int id;
+    float base1;
+    float adapted1;
+    bool adapted;
+} s_gallery[HOST_GALLERY_MAX];
+static int s_gallery_n = 0;
+
+static int _gallery_slot(int face_id) {
+    for (int i = 0; i < s_gallery_n; i++) if (s_gallery[i].id == face_id) return i;
+    if (s_gallery_n == HOST_GALLERY_MAX) return -1;
+    s_gallery[s_gallery_n].id = face_id;
+    s_gallery[s_gallery_n].adapted = false;
+    return s_gallery_n++;
+}
+
+void face_api_add_user_from_cloud(int face_id, float *embedding_buffer, int len) {
+    pthread_mutex_lock(&s_lock);
+    int i = _gallery_slot(face_id);
+    if (i >= 0 && len > 1) s_gallery[i].base1 = embedding_buffer[1];
+    pthread_mutex_unlock(&s_lock);
+}
+
+void face_api_adapted_from_cloud(int face_id, float *embedding_buffer, int len) {
+    pthread_mutex_lock(&s_lock);
+    int i = _gallery_slot(face_id);
+    if (i >= 0 && len > 1) {
+        s_gallery[i].adapted1 = embedding_buffer[1];
+        s_gallery[i].adapted = true;
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+// Mẫu enroll cố định (như benchmark json_face_writer)
+static void _enroll_embedding(float *emb, float scale) {
+    for (int i = 0; i < FACE_EMBED_DIM; i++) emb[i] = scale * (((i * 37) % 200 - 100) / 1000.0f);
+}
+
+esp_err_t face_enroll(uint32_t timeout_ms, float *embedding, camera_fb_t *photo) {
+    _enroll_embedding(embedding, 1.0f);
+    if (photo) {
+        memset(photo, 0, sizeof(*photo));
+        photo->buf = (uint8_t *)heap_caps_malloc(HOST_PHOTO_BYTES, MALLOC_CAP_SPIRAM);
+        if (photo->buf) {
+            memset(photo->buf, 0xAB, HOST_PHOTO_BYTES);
+            photo->len = HOST_PHOTO_BYTES;
+            photo->format = PIXFORMAT_JPEG;
+        }
+    }
+    return ESP_OK;
+}
+
+// Trạng thái enroll mà App nhận qua WS
+static char s_states[HOST_STATES_MAX][16];
+static int s_states_n = 0;
+
+void ws_send_message(const char *msg) {
+    cJSON *root = cJSON_Parse(msg);
+    cJSON *state = cJSON_GetObjectItem(root, "state");
+    pthread_mutex_lock(&s_lock);
+    if (cJSON_IsString(state) && s_states_n < HOST_STATES_MAX) {
+        snprintf(s_states[s_states_n++], sizeof(s_states[0]), "%s", state->valuestring);
+    }
+    pthread_mutex_unlock(&s_lock);
+    cJSON_Delete(root);
+}
+
+// --- Lệnh ---
+
+// Lệnh mở / enroll phát lên bus từ check_remote_command (chỉ task bus ghi)
+static struct { uint8_t source; int32_t ref; } s_opens[16];
+static int s_opens_n = 0;
+static int32_t s_enrolls[16];
+static int s_enrolls_n = 0;
+
+static void _bus_record(const bus_event_t *ev, void *ctx) {
+    pthread_mutex_lock(&s_lock);
+    if (ev->type == BUS_EV_COMMAND && s_opens_n < 16) {
+        s_opens[s_opens_n].source = ev->command.source;
+        s_opens[s_opens_n++].ref = ev->command.ref;
+    } else if (ev->type == BUS_EV_ENROLL_REQUEST && s_enrolls_n < 16) {
+        s_enrolls[s_enrolls_n++] = ev->enroll.user_id;
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+// Task bus phát theo thứ tự: PING được trả lời thì mọi sự kiện publish trước đó đã tới người nghe
+static void _bus_barrier(void) {
+    bus_event_t ev = { .type = BUS_EV_PING };
+    ev.ping.task = xTaskGetCurrentTaskHandle();
+    if (event_bus_publish(&ev)) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+}
+
+static int s_logged = 0;     // Sự kiện đã vào outbox từ lệnh log
+
+// Giá trị của "key" trong JSON trạng thái outbox (cây cJSON, key con dạng "upload.ok")
+static double _status_num(const char *status, const char *key) {
+    cJSON *root = cJSON_Parse(status);
+    char path[32];
+    snprintf(path, sizeof(path), "%s", key);
+    char *dot = strchr(path, '.');
+    cJSON *node = root;
+    if (dot) { *dot = '\0'; node = cJSON_GetObjectItem(node, path); key = dot + 1; }
+    cJSON *v = cJSON_GetObjectItem(node, key);
+    double d = cJSON_IsNumber(v) ? v->valuedouble : -1;
+    cJSON_Delete(root);
+    return d;
+}
+
+static void _print_status(void) {
+    char buf[512];
+    size_t n = supabase_outbox_status_json(buf, sizeof(buf));
+    printf("%.*s\n", (int)n, n ? buf : "null");
+}
+
+static void cmd_log(int face_id, size_t thumb_len, size_t full_len) {
+    esp_err_t err;
+    if (face_id < 0) {
+        err = supabase_log_access_async(EV_SRC_REMOTE, -1, 1.0f, NULL);
+    } else if (thumb_len) {
+        uint8_t *thumb = (uint8_t *)heap_caps_malloc(thumb_len, MALLOC_CAP_SPIRAM);
+        camera_fb_t full = { 0 };
+        if (full_len) full.buf = (uint8_t *)heap_caps_malloc(full_len, MALLOC_CAP_SPIRAM);
+        if (!thumb || (full_len && !full.buf)) { printf("{\"err\":%d}\n", ESP_ERR_NO_MEM); return; }
+        memset(thumb, 0x11, thumb_len);
+        if (full.buf) { memset(full.buf, 0x22, full_len); full.len = full_len; full.format = PIXFORMAT_JPEG; }
+        err = supabase_log_access_thumb(face_id, HOST_SCORE, thumb, thumb_len, full.buf ? &full : NULL);
+        heap_caps_free(full.buf);      // Outbox đã copy frame gốc
+    } else {
+        err = supabase_log_access_async(EV_SRC_FACE, face_id, HOST_SCORE, NULL);
+    }
+    if (err == ESP_OK) s_logged++;
+    printf("{\"err\":%d}\n", err);
+}
+
+static void cmd_flush(int timeout_ms) {
+    char buf[512];
+    int64_t until = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    while (esp_timer_get_time() < until) {
+        size_t n = supabase_outbox_status_json(buf, sizeof(buf));
+        // Lệnh OPEN tự log bên trong supabase_client (không qua s_logged): chờ cả hàng đợi rỗng
+        if (n && _status_num(buf, "sent") + _status_num(buf, "dropped") >= s_logged &&
+            _status_num(buf, "pending") == 0 && _status_num(buf, "queued") == 0) break;
+        usleep(20 * 1000);
+    }
+    _print_status();
+}
+
+static void cmd_image(size_t bytes, const char *name) {
+    camera_fb_t fb = { 0 };
+    fb.buf = (uint8_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    if (!fb.buf) { printf("{\"err\":%d}\n", ESP_ERR_NO_MEM); return; }
+    for (size_t i = 0; i < bytes; i++) fb.buf[i] = (uint8_t)i;
+    fb.len = bytes;
+    fb.format = PIXFORMAT_JPEG;
+    char filename[64];
+    snprintf(filename, sizeof(filename), "%s", name);
+    esp_err_t err = supabase_upload_image(&fb, filename);
+    heap_caps_free(fb.buf);
+    printf("{\"err\":%d}\n", err);
+}
+
+static void cmd_poll(void) {
+    int opens0, enrolls0;
+    pthread_mutex_lock(&s_lock);
+    opens0 = s_opens_n;
+    enrolls0 = s_enrolls_n;
+    pthread_mutex_unlock(&s_lock);
+    check_remote_command();
+    _bus_barrier();
+    pthread_mutex_lock(&s_lock);
+    printf("{\"opens\":[");
+    for (int i = opens0; i < s_opens_n; i++) {
+        printf("%s{\"source\":%u,\"ref\":%ld}", i > opens0 ? "," : "", s_opens[i].source, (long)s_opens[i].ref);
+    }
+    printf("],\"enrolls\":[");
+    for (int i = enrolls0; i < s_enrolls_n; i++) printf("%s%ld", i > enrolls0 ? "," : "", (long)s_enrolls[i]);
+    printf("]}\n");
+    pthread_mutex_unlock(&s_lock);
+}
+
+static bool _enroll_finished(void) {
+    for (int i = 0; i < s_states_n; i++) {
+        if (strcmp(s_states[i], "success") == 0 || strcmp(s_states[i], "failed") == 0) return true;
+    }
+    return false;
+}
+
+static void cmd_enroll_wait(int timeout_ms) {
+    int64_t until = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    for (;;) {
+        pthread_mutex_lock(&s_lock);
+        bool done = _enroll_finished();
+        pthread_mutex_unlock(&s_lock);
+        if (done || esp_timer_get_time() >= until) break;
+        usleep(20 * 1000);
+    }
+    usleep(50 * 1000);      // cloud_enroll_task tự xoá sau trạng thái cuối
+    pthread_mutex_lock(&s_lock);
+    printf("{\"states\":[");
+    for (int i = 0; i < s_states_n; i++) printf("%s\"%s\"", i ? "," : "", s_states[i]);
+    printf("]}\n");
+    s_states_n = 0;
+    pthread_mutex_unlock(&s_lock);
+}
+
+static void cmd_sync(int probe_id) {
+    pthread_mutex_lock(&s_lock);
+    s_gallery_n = 0;
+    pthread_mutex_unlock(&s_lock);
+    supabase_sync_users();
+    pthread_mutex_lock(&s_lock);
+    printf("{\"ids\":[");
+    for (int i = 0; i < s_gallery_n; i++) printf("%s%d", i ? "," : "", s_gallery[i].id);
+    printf("],\"adapted\":[");
+    bool first = true;
+    for (int i = 0; i < s_gallery_n; i++) {
+        if (!s_gallery[i].adapted) continue;
+        printf("%s%d", first ? "" : ",", s_gallery[i].id);
+        first = false;
+    }
+    printf("],\"v1\":");
+    int slot = -1;
+    for (int i = 0; i < s_gallery_n; i++) if (s_gallery[i].id == probe_id) slot = i;
+    if (slot < 0) printf("null");
+    else printf("%.6f", s_gallery[slot].adapted ? s_gallery[slot].adapted1 : s_gallery[slot].base1);
+    printf("}\n");
+    pthread_mutex_unlock(&s_lock);
+}
+
+static void cmd_adapt(int face_id, float scale) {
+    float *emb = (float *)mem_pool_alloc(FACE_EMBED_BYTES);
+    if (!emb) { printf("{\"err\":%d}\n", ESP_ERR_NO_MEM); return; }
+    _enroll_embedding(emb, scale);
+    esp_err_t err = supabase_upload_face_adapted(face_id, emb, FACE_EMBED_DIM);
+    mem_pool_free(emb);
+    printf("{\"err\":%d}\n", err);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <supabase url> <key>\n", argv[0]);
+        return 2;
+    }
+    snprintf(SUPABASE_URL, sizeof(SUPABASE_URL), "%s", argv[1]);
+    snprintf(SUPABASE_KEY, sizeof(SUPABASE_KEY), "%s", argv[2]);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    mem_pool_init();
+    event_bus_init();
+    uplink_sched_init();
+    supabase_outbox_init();
+    event_bus_subscribe(BUS_MASK(BUS_EV_COMMAND) | BUS_MASK(BUS_EV_ENROLL_REQUEST), _bus_record, NULL, "host");
+
+    char line[256], name[64];
+    while (fgets(line, sizeof(line), stdin)) {
+        int a = 0, b = 0;
+        unsigned long x = 0, y = 0;
+        float f = 0;
+        if (sscanf(line, "wifi %d", &a) == 1) {
+            atomic_store(&s_wifi, a != 0);
+            printf("{\"ok\":true}\n");
+        } else if (sscanf(line, "log %d %lu %lu", &a, &x, &y) >= 1) {
+            cmd_log(a, x, y);
+        } else if (sscanf(line, "flush %d", &a) == 1) {
+            cmd_flush(a);
+        } else if (strncmp(line, "status", 6) == 0) {
+            _print_status();
+        } else if (sscanf(line, "image %lu %63s", &x, name) == 2) {
+            cmd_image(x, name);
+        } else if (strncmp(line, "poll", 4) == 0) {
+            cmd_poll();
+        } else if (sscanf(line, "enroll_wait %d", &a) == 1) {
+            cmd_enroll_wait(a);
+        } else if (sscanf(line, "sync %d", &a) == 1) {
+            cmd_sync(a);
+        } else if (sscanf(line, "adapt %d %f", &b, &f) == 2) {
+            cmd_adapt(b, f);
+        } else {
+            printf("{\"error\":\"unknown command\"}\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,177 @@
+// Khung BLE bulk: mã hoá / tách khung, CRC-32, ghép dữ liệu phía nhận (resume, lỗ hổng, lặp, quá cỡ, sai CRC)
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "ble_frame.h"
+
+#define TOTAL       1000
+#define CHUNK       180
+#define MAX_TOTAL   4096
+
+static uint8_t s_data[TOTAL];
+
+static ble_frame_t mk(uint8_t *raw, size_t cap, uint8_t type, uint8_t op, uint32_t off, const uint8_t *p, uint16_t len) {
+    ble_frame_t f;
+    size_t n = ble_frame_encode(raw, cap, type, op, off, p, len);
+    CHECK(n == (size_t)BLE_FRAME_HDR_LEN + len);
+    CHECK(ble_frame_decode(raw, n, &f));
+    return f;
+}
+
+static ble_rx_result_t feed_start(ble_rx_t *rx, uint8_t op, uint32_t total, uint32_t crc) {
+    uint8_t raw[BLE_FRAME_HDR_LEN + 8], p[8];
+    ble_put_u32(p, total);
+    ble_put_u32(p + 4, crc);
+    ble_frame_t f = mk(raw, sizeof(raw), BLE_FRAME_START, op, 0, p, 8);
+    return ble_rx_feed(rx, &f, MAX_TOTAL);
+}
+
+static ble_rx_result_t feed_data(ble_rx_t *rx, uint32_t off, uint16_t len) {
+    uint8_t raw[BLE_FRAME_HDR_LEN + CHUNK * 2];
+    ble_frame_t f = mk(raw, sizeof(raw), BLE_FRAME_DATA, BLE_OP_GALLERY_PUSH, off, s_data + off, len);
+    return ble_rx_feed(rx, &f, MAX_TOTAL);
+}
+
+static ble_rx_result_t feed_end(ble_rx_t *rx) {
+    uint8_t raw[BLE_FRAME_HDR_LEN];
+    ble_frame_t f = mk(raw, sizeof(raw), BLE_FRAME_END, BLE_OP_GALLERY_PUSH, 0, NULL, 0);
+    return ble_rx_feed(rx, &f, MAX_TOTAL);
+}
+
+static uint16_t chunk_at(uint32_t off) {
+    return off + CHUNK > TOTAL ? TOTAL - off : CHUNK;
+}
+
+static void test_codec(void) {
+    uint8_t raw[32], p[4] = { 1, 2, 3, 4 };
+    ble_frame_t f;
+    size_t n = ble_frame_encode(raw, sizeof(raw), BLE_FRAME_DATA, BLE_OP_LOG_PULL, 0x01020304, p, 4);
+    CHECK(n == 12);
+    CHECK(ble_frame_decode(raw, n, &f));
+    CHECK(f.type == BLE_FRAME_DATA && f.op == BLE_OP_LOG_PULL && f.len == 4 && f.offset == 0x01020304);
+    CHECK(memcmp(f.payload, p, 4) == 0);
+
+    CHECK(ble_frame_encode(raw, 11, BLE_FRAME_DATA, 1, 0, p, 4) == 0);    // Không đủ chỗ
+    CHECK(!ble_frame_decode(raw, BLE_FRAME_HDR_LEN - 1, &f));              // Ngắn hơn header
+    CHECK(!ble_frame_decode(raw, n - 1, &f));                               // len không khớp
+    CHECK(!ble_frame_decode(raw, n + 1, &f));
+    CHECK(!ble_frame_decode(NULL, n, &f));
+    raw[0] = 0;
+    CHECK(!ble_frame_decode(raw, n, &f));                                   // type lạ
+    raw[0] = BLE_FRAME_ERR + 1;
+    CHECK(!ble_frame_decode(raw, n, &f));
+}
+
+static void test_crc32(void) {
+    const uint8_t *v = (const uint8_t *)"123456789";
+    CHECK(ble_crc32(0, v, 9) == 0xCBF43926);                                // Giá trị kiểm tra chuẩn
+    CHECK(ble_crc32(ble_crc32(0, v, 4), v + 4, 5) == 0xCBF43926);           // Gọi nối tiếp
+    CHECK(ble_crc32(0, v, 0) == 0);
+}
+
+static void test_transfer(void) {
+    uint8_t buf[TOTAL];
+    ble_rx_t rx = { 0 };
+    uint32_t crc = ble_crc32(0, s_data, TOTAL);
+    CHECK(feed_start(&rx, BLE_OP_GALLERY_PUSH, TOTAL, crc) == BLE_RX_NEED_BUF);
+    CHECK(feed_data(&rx, 0, CHUNK) == BLE_RX_ERROR && rx.err == BLE_ERR_STATE);  // Chưa có buffer
+    ble_rx_attach(&rx, buf, sizeof(buf));
+    for (uint32_t off = 0; off < TOTAL; off += CHUNK) CHECK(feed_data(&rx, off, chunk_at(off)) == BLE_RX_CONTINUE);
+    CHECK(rx.received == TOTAL);
+    CHECK(feed_end(&rx) == BLE_RX_DONE);
+    CHECK(memcmp(buf, s_data, TOTAL) == 0);
+    CHECK(!rx.active);
+    CHECK(feed_data(&rx, 0, CHUNK) == BLE_RX_ERROR && rx.err == BLE_ERR_STATE);  // Phiên đã đóng
+}
+
+// Mất kết nối giữa chừng: START trùng (cùng total + crc) tiếp tục từ rx.received
+static void test_resume(void) {
+    uint8_t buf[TOTAL];
+    ble_rx_t rx = { 0 };
+    ble_rx_attach(&rx, buf, sizeof(buf));
+    uint32_t crc = ble_crc32(0, s_data, TOTAL);
+    CHECK(feed_start(&rx, BLE_OP_GALLERY_PUSH, TOTAL, crc) == BLE_RX_CONTINUE);
+    CHECK(feed_data(&rx, 0, CHUNK) == BLE_RX_CONTINUE);
+    CHECK(feed_data(&rx, CHUNK, CHUNK) == BLE_RX_CONTINUE);
+
+    CHECK(feed_start(&rx, BLE_OP_GALLERY_PUSH, TOTAL, crc) == BLE_RX_RESUMED);
+    CHECK(rx.received == 2 * CHUNK);
+    for (uint32_t off = rx.received; off < TOTAL; off += CHUNK) CHECK(feed_data(&rx, off, chunk_at(off)) == BLE_RX_CONTINUE);
+    CHECK(feed_end(&rx) == BLE_RX_DONE);
+    CHECK(memcmp(buf, s_data, TOTAL) == 0);
+
+    // Dữ liệu khác (crc khác) -> phiên mới từ 0
+    CHECK(feed_start(&rx, BLE_OP_GALLERY_PUSH, TOTAL, crc) == BLE_RX_CONTINUE);
+    CHECK(feed_data(&rx, 0, CHUNK) == BLE_RX_CONTINUE);
+    CHECK(feed_start(&rx, BLE_OP_GALLERY_PUSH, TOTAL, crc ^ 1) == BLE_RX_CONTINUE);
+    CHECK(rx.received == 0 && rx.crc == (crc ^ 1));
+}
+
+static void test_gap_and_duplicate(void) {
+    uint8_t buf[TOTAL];
+    ble_rx_t rx = { 0 };
+    ble_rx_attach(&rx, buf, sizeof(buf));
+    CHECK(feed_start(&rx, BLE_OP_GALLERY_PUSH, TOTAL, ble_crc32(0, s_data, TOTAL)) == BLE_RX_CONTINUE);
+    CHECK(feed_data(&rx, 0, CHUNK) == BLE_RX_CONTINUE);
+    CHECK(feed_data(&rx, 2 * CHUNK, CHUNK) == BLE_RX_GAP);      // Mất khung CHUNK..2*CHUNK
+    CHECK(rx.received == CHUNK);
+    CHECK(feed_data(&rx, 0, CHUNK) == BLE_RX_CONTINUE);         // Khung lặp: bỏ qua
+    CHECK(rx.received == CHUNK);
+    CHECK(feed_end(&rx) == BLE_RX_GAP);                         // END sớm: báo thiếu
+    CHECK(rx.active);
+
+    // Bên gửi lùi về offset đã ACK nhưng cắt khung khác: phần chồng lấn bỏ, phần mới nhận
+    CHECK(feed_data(&rx, CHUNK / 2, CHUNK) == BLE_RX_CONTINUE);
+    CHECK(rx.received == CHUNK + CHUNK / 2);
+    for (uint32_t off = rx.received; off < TOTAL; off += CHUNK) CHECK(feed_data(&rx, off, chunk_at(off)) == BLE_RX_CONTINUE);
+    CHECK(feed_end(&rx) == BLE_RX_DONE);
+    CHECK(memcmp(buf, s_data, TOTAL) == 0);
+}
+
+static void test_oversize(void) {
+    uint8_t buf[TOTAL];
+    ble_rx_t rx = { 0 };
+    ble_rx_attach(&rx, buf, sizeof(buf));
+    CHECK(feed_start(&rx, BLE_OP_GALLERY_PUSH, MAX_TOTAL + 1, 0) == BLE_RX_ERROR && rx.err == BLE_ERR_TOO_LARGE);
+    CHECK(feed_start(&rx, BLE_OP_GALLERY_PUSH, 0, 0) == BLE_RX_ERROR && rx.err == BLE_ERR_TOO_LARGE);
+    CHECK(feed_start(&rx, BLE_OP_GALLERY_PUSH, TOTAL * 2, 0) == BLE_RX_NEED_BUF);   // Buffer nhỏ hơn total
+
+    // DATA vượt total đã khai báo
+    ble_rx_reset(&rx);
+    CHECK(feed_start(&rx, BLE_OP_GALLERY_PUSH, CHUNK, 0) == BLE_RX_CONTINUE);
+    CHECK(feed_data(&rx, 0, CHUNK + 1) == BLE_RX_ERROR && rx.err == BLE_ERR_TOO_LARGE);
+    CHECK(rx.received == 0);
+
+    // START payload sai độ dài
+    uint8_t raw[BLE_FRAME_HDR_LEN + 4], p[4] = { 0 };
+    ble_frame_t f = mk(raw, sizeof(raw), BLE_FRAME_START, BLE_OP_GALLERY_PUSH, 0, p, 4);
+    CHECK(ble_rx_feed(&rx, &f, MAX_TOTAL) == BLE_RX_ERROR && rx.err == BLE_ERR_BAD_FRAME);
+    f.type = BLE_FRAME_ACK;
+    CHECK(ble_rx_feed(&rx, &f, MAX_TOTAL) == BLE_RX_ERROR && rx.err == BLE_ERR_BAD_FRAME);
+}
+
+static void test_crc_mismatch(void) {
+    uint8_t buf[TOTAL];
+    ble_rx_t rx = { 0 };
+    ble_rx_attach(&rx, buf, sizeof(buf));
+    uint32_t crc = ble_crc32(0, s_data, TOTAL);
+    CHECK(feed_start(&rx, BLE_OP_GALLERY_PUSH, TOTAL, crc ^ 0x80000000) == BLE_RX_CONTINUE);
+    for (uint32_t off = 0; off < TOTAL; off += CHUNK) feed_data(&rx, off, chunk_at(off));
+    CHECK(feed_end(&rx) == BLE_RX_ERROR && rx.err == BLE_ERR_CRC);
+    CHECK(!rx.active);
+    CHECK(feed_end(&rx) == BLE_RX_ERROR && rx.err == BLE_ERR_STATE);
+    // Không resume được phiên hỏng: START lại nhận từ đầu
+    CHECK(feed_start(&rx, BLE_OP_GALLERY_PUSH, TOTAL, crc) == BLE_RX_CONTINUE && rx.received == 0);
+}
+
+int main(void) {
+    for (int i = 0; i < TOTAL; i++) s_data[i] = (uint8_t)(i * 7 + (i >> 3));
+    test_codec();
+    test_crc32();
+    test_transfer();
+    test_resume();
+    test_gap_and_duplicate();
+    test_oversize();
+    test_crc_mismatch();
+    return TEST_RESULT();
+}
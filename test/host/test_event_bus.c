@@ -0,0 +1,53 @@
+// Bus sự kiện: sự kiện thường không lấn vào phần ring dành cho lệnh mở cửa
+#include <stdio.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include "host_test.h"
+#include "event_bus.h"
+
+static atomic_int s_entered;
+static atomic_int s_release;
+static atomic_int s_opens;
+
+// Handler đầu tiên giữ task bus lại -> ring chỉ đầy lên, không ai đọc
+static void blocking_handler(const bus_event_t *ev, void *ctx) {
+    if (ev->type == BUS_EV_COMMAND) atomic_fetch_add(&s_opens, 1);
+    atomic_store(&s_entered, 1);
+    while (!atomic_load(&s_release)) usleep(1000);
+}
+
+static bool publish(uint8_t type) {
+    bus_event_t ev = { .type = type };
+    if (type == BUS_EV_COMMAND) {
+        ev.command.cmd = BUS_CMD_OPEN;
+        ev.command.ref = -1;
+    }
+    return event_bus_publish(&ev);
+}
+
+static void test_reserved_slots(void) {
+    event_bus_init();
+    CHECK(event_bus_subscribe(BUS_MASK_ALL, blocking_handler, NULL, "block") == ESP_OK);
+
+    CHECK(publish(BUS_EV_VISITOR));
+    for (int i = 0; i < 1000 && !atomic_load(&s_entered); i++) usleep(1000);
+    CHECK(atomic_load(&s_entered));              // Sự kiện 1 đã rời ring, task bus đang bị giữ
+
+    int visitors = 0;
+    while (visitors < EVENT_BUS_RING_LEN && publish(BUS_EV_VISITOR)) visitors++;
+    CHECK(visitors == EVENT_BUS_RING_LEN - EVENT_BUS_RESERVED);
+    CHECK(!publish(BUS_EV_DOOR_STATE));
+
+    for (int i = 0; i < EVENT_BUS_RESERVED; i++) CHECK(publish(i % 2 ? BUS_EV_FACE_MATCHED : BUS_EV_COMMAND));
+    CHECK(!publish(BUS_EV_COMMAND));             // Hết cả phần dành riêng: người gọi phải xử lý false
+
+    atomic_store(&s_release, 1);
+    for (int i = 0; i < 1000 && atomic_load(&s_opens) < EVENT_BUS_RESERVED / 2; i++) usleep(1000);
+    CHECK(atomic_load(&s_opens) == EVENT_BUS_RESERVED / 2);
+    CHECK(publish(BUS_EV_VISITOR));              // Ring đã được đọc hết
+}
+
+int main(void) {
+    test_reserved_slots();
+    return TEST_RESULT();
+}
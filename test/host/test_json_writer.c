@@ -0,0 +1,97 @@
+// json_writer: số thực (cả khi a * 10^decimals vượt int64), số nguyên biên, escape chuỗi, tràn buffer
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "host_test.h"
+#include "json_writer.h"
+
+static const char *fmt_float(double v, int decimals) {
+    static char buf[64];
+    json_writer_t w;
+    jw_init(&w, buf, sizeof(buf));
+    jw_float(&w, v, decimals);
+    return jw_finish(&w, NULL);
+}
+
+// Số in ra phải đọc lại được và gần giá trị gốc (sai số tương đối)
+static void check_roundtrip(double v, int decimals) {
+    const char *s = fmt_float(v, decimals);
+    CHECK(s != NULL);
+    if (!s) return;
+    char *end;
+    double back = strtod(s, &end);
+    CHECK(*end == '\0');
+    double tol = fmax(fabs(v) * 1e-9, 0.5 * pow(10, -decimals));
+    if (fabs(back - v) > tol) fprintf(stderr, "jw_float(%.17g, %d) = %s\n", v, decimals, s);
+    CHECK(fabs(back - v) <= tol);
+}
+
+static void test_float(void) {
+    CHECK(strcmp(fmt_float(0.5, 2), "0.5") == 0);
+    CHECK(strcmp(fmt_float(-0.25, 2), "-0.25") == 0);
+    CHECK(strcmp(fmt_float(3.0, 6), "3") == 0);
+    CHECK(strcmp(fmt_float(0.0625, 3), "0.063") == 0);
+    CHECK(strcmp(fmt_float(-0.0001, 3), "0") == 0);                // Làm tròn về 0: không in "-0"
+    CHECK(strcmp(fmt_float(0.000001, 6), "0.000001") == 0);
+    CHECK(strcmp(fmt_float(123.456789, 6), "123.456789") == 0);
+    CHECK(strcmp(fmt_float(NAN, 2), "null") == 0);
+    CHECK(strcmp(fmt_float(INFINITY, 2), "null") == 0);
+    CHECK(strcmp(fmt_float(9.1e9, 9), "9100000000") == 0);        // Sát ngưỡng, vẫn dạng cố định
+
+    // a * 10^decimals vượt int64: trước đây jw_float(1e12, 9) in "9223372036.854775808"
+    check_roundtrip(1e12, 9);
+    check_roundtrip(-1e12, 9);
+    check_roundtrip(9.3e9, 9);
+    check_roundtrip(1e15, 0);
+    check_roundtrip(1e300, 6);
+    check_roundtrip(-4.5e18, 1);
+    for (int d = 0; d <= 9; d++) check_roundtrip(12345.678901234, d);
+}
+
+static void test_int_and_doc(void) {
+    char buf[256];
+    json_writer_t w;
+    jw_init(&w, buf, sizeof(buf));
+    jw_obj_begin(&w);
+    jw_kv_int(&w, "min", INT64_MIN);
+    jw_kv_int(&w, "max", INT64_MAX);
+    jw_kv_str(&w, "s", "a\"b\\c\n\t\x01");
+    jw_kv_str(&w, "n", NULL);
+    jw_key(&w, "arr");
+    jw_arr_begin(&w);
+    jw_bool(&w, true);
+    jw_null(&w);
+    jw_float(&w, 1.5, 1);
+    jw_arr_end(&w);
+    jw_obj_end(&w);
+    size_t len = 0;
+    const char *s = jw_finish(&w, &len);
+    const char *expect = "{\"min\":-9223372036854775808,\"max\":9223372036854775807,"
+                         "\"s\":\"a\\\"b\\\\c\\n\\t\\u0001\",\"n\":null,\"arr\":[true,null,1.5]}";
+    CHECK(s && strcmp(s, expect) == 0);
+    CHECK(len == strlen(expect));
+}
+
+static void test_overflow(void) {
+    char buf[8];
+    json_writer_t w;
+    jw_init(&w, buf, sizeof(buf));
+    jw_str(&w, "1234567");                                      // 9 byte + '\0' > 8
+    CHECK(jw_finish(&w, NULL) == NULL);
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_str(&w, "12345");                                        // Vừa khít 7 + '\0'
+    CHECK(jw_finish(&w, NULL) != NULL && strcmp(buf, "\"12345\"") == 0);
+
+    jw_init(&w, buf, 0);
+    CHECK(jw_finish(&w, NULL) == NULL);
+}
+
+int main(void) {
+    test_float();
+    test_int_and_doc();
+    test_overflow();
+    return TEST_RESULT();
+}
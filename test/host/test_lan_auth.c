@@ -0,0 +1,212 @@
+// LAN control API: chữ ký HMAC-SHA256 (vector RFC 4231), challenge dùng 1 lần, phát lại khi chưa có giờ,
+// chữ ký dữ liệu dài (nạp gallery qua BLE)
+// time()/settimeofday() được thay bằng __wrap_* (link --wrap) để điều khiển đồng hồ hệ thống giả.
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include "mbedtls/md.h"
+#include "host_test.h"
+#include "esp_timer.h"
+#include "lan_auth.h"
+
+#define SYNCED_NOW      1800000000
+
+static time_t s_now = SYNCED_NOW;
+static int s_settime_calls = 0;
+
+time_t __wrap_time(time_t *t) {
+    if (t) *t = s_now;
+    return s_now;
+}
+
+int __wrap_settimeofday(const struct timeval *tv, const struct timezone *tz) {
+    s_settime_calls++;
+    s_now = tv->tv_sec;
+    return 0;
+}
+
+static const char *KEY_HEX = "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f";
+static uint8_t s_key[LAN_AUTH_KEY_LEN];
+
+static void hmac_hex(const uint8_t *key, size_t key_len, const char *msg, char out[65]) {
+    uint8_t mac[32];
+    mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), key, key_len,
+                    (const unsigned char *)msg, strlen(msg), mac);
+    for (int i = 0; i < 32; i++) snprintf(out + 2 * i, 3, "%02x", mac[i]);
+}
+
+// Ký lệnh như App: HMAC(key, "<cmd>|<ts>|<nonce>")
+static void sign(const char *cmd, int64_t ts, const char *nonce, char sig[65]) {
+    char msg[128];
+    lan_auth_canonical(msg, sizeof(msg), cmd, ts, nonce);
+    hmac_hex(s_key, sizeof(s_key), msg, sig);
+}
+
+static lan_auth_result_t send_cmd(const char *cmd, int64_t ts, const char *nonce) {
+    char sig[65];
+    sign(cmd, ts, nonce, sig);
+    return lan_auth_verify(cmd, ts, nonce, sig);
+}
+
+static void test_signature_vectors(void) {
+    // RFC 4231 test case 1 + 2
+    uint8_t k1[20];
+    memset(k1, 0x0b, sizeof(k1));
+    const char *m1 = "Hi There";
+    const char *s1 = "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7";
+    CHECK(lan_auth_check_signature(k1, sizeof(k1), m1, strlen(m1), s1));
+
+    const char *m2 = "what do ya want for nothing?";
+    const char *s2 = "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843";
+    CHECK(lan_auth_check_signature((const uint8_t *)"Jefe", 4, m2, strlen(m2), s2));
+    CHECK(lan_auth_check_signature((const uint8_t *)"Jefe", 4, m2, strlen(m2),
+                                   "5BDCC146BF60754E6A042426089575C75A003F089D2739839DEC58B964EC3843"));
+
+    char bad[65];
+    strcpy(bad, s2);
+    bad[63] = bad[63] == '3' ? '4' : '3';                               // Sai byte cuối
+    CHECK(!lan_auth_check_signature((const uint8_t *)"Jefe", 4, m2, strlen(m2), bad));
+    CHECK(!lan_auth_check_signature((const uint8_t *)"Jefe", 4, m2, strlen(m2) - 1, s2));   // Sai thông điệp
+    CHECK(!lan_auth_check_signature((const uint8_t *)"Jeff", 4, m2, strlen(m2), s2));       // Sai khoá
+    CHECK(!lan_auth_check_signature((const uint8_t *)"Jefe", 4, m2, strlen(m2), "5bdc"));   // Ngắn
+    strcpy(bad, s2);
+    bad[10] = 'g';
+    CHECK(!lan_auth_check_signature((const uint8_t *)"Jefe", 4, m2, strlen(m2), bad));      // Không phải hex
+    CHECK(!lan_auth_check_signature((const uint8_t *)"Jefe", 4, m2, strlen(m2), NULL));
+}
+
+static void test_no_key(void) {
+    char nonce[LAN_AUTH_NONCE_LEN + 1];
+    lan_auth_issue_nonce(nonce);
+    CHECK(!lan_auth_has_key());
+    CHECK(lan_auth_verify("open", SYNCED_NOW, nonce, "00") == LAN_AUTH_NO_KEY);
+    CHECK(lan_auth_save_key_hex("zz", NULL) == ESP_ERR_INVALID_ARG);
+    CHECK(lan_auth_save_key_hex(KEY_HEX, NULL) == ESP_OK);
+    CHECK(lan_auth_has_key());
+}
+
+// Đã có khoá: BLE không xác thực không được ghi đè, đổi khoá phải ký bằng khoá cũ
+static void test_rekey(void) {
+    const char *new_hex = "ff0102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f";
+    char msg[80], sig[65], n[LAN_AUTH_NONCE_LEN + 1];
+    CHECK(lan_auth_save_key_hex(new_hex, NULL) == ESP_ERR_INVALID_STATE);
+    snprintf(msg, sizeof(msg), "rekey|%s", new_hex);
+    hmac_hex((const uint8_t *)"wrong", 5, msg, sig);
+    CHECK(lan_auth_save_key_hex(new_hex, sig) == ESP_ERR_INVALID_STATE);
+
+    // Khoá cũ vẫn dùng được sau các lần bị từ chối
+    lan_auth_issue_nonce(n);
+    CHECK(send_cmd("open", SYNCED_NOW, n) == LAN_AUTH_OK);
+
+    hmac_hex(s_key, sizeof(s_key), msg, sig);
+    CHECK(lan_auth_save_key_hex(new_hex, sig) == ESP_OK);
+    lan_auth_issue_nonce(n);
+    CHECK(send_cmd("open", SYNCED_NOW, n) == LAN_AUTH_BAD_SIGNATURE);  // Khoá cũ hết hiệu lực
+    s_key[0] = 0xff;
+    lan_auth_issue_nonce(n);
+    CHECK(send_cmd("open", SYNCED_NOW, n) == LAN_AUTH_OK);
+    CHECK(lan_auth_save_key_hex(new_hex, sig) == ESP_ERR_INVALID_STATE); // Chữ ký cũ (khoá trước) không dùng lại được
+}
+
+static void test_challenge_single_use(void) {
+    char n1[LAN_AUTH_NONCE_LEN + 1], n2[LAN_AUTH_NONCE_LEN + 1];
+    lan_auth_issue_nonce(n1);
+    lan_auth_issue_nonce(n2);
+    CHECK(strlen(n1) == LAN_AUTH_NONCE_LEN && strcmp(n1, n2) != 0);
+
+    CHECK(send_cmd("open", SYNCED_NOW, n1) == LAN_AUTH_OK);
+    CHECK(send_cmd("open", SYNCED_NOW, n1) == LAN_AUTH_REPLAY);        // Phát lại nguyên lệnh
+    CHECK(send_cmd("open", SYNCED_NOW + 1, n1) == LAN_AUTH_REPLAY);    // Ký lại, nonce cũ
+
+    // Nonce App tự đặt (đúng định dạng nhưng khoá không cấp)
+    CHECK(send_cmd("open", SYNCED_NOW, "0123456789abcdef0123456789abcdef") == LAN_AUTH_REPLAY);
+    CHECK(send_cmd("open", SYNCED_NOW, "0123456789abcdef") == LAN_AUTH_BAD_REQUEST);
+    CHECK(send_cmd("open", 0, n2) == LAN_AUTH_BAD_REQUEST);
+
+    // Chữ ký sai không được tiêu challenge
+    char sig[65];
+    sign("open", SYNCED_NOW, n2, sig);
+    sig[0] = sig[0] == 'a' ? 'b' : 'a';
+    CHECK(lan_auth_verify("open", SYNCED_NOW, n2, sig) == LAN_AUTH_BAD_SIGNATURE);
+    CHECK(lan_auth_verify("close", SYNCED_NOW, n2, sig) == LAN_AUTH_BAD_SIGNATURE);
+    CHECK(send_cmd("open", SYNCED_NOW, n2) == LAN_AUTH_OK);
+}
+
+static void test_challenge_expiry_and_eviction(void) {
+    char n[LAN_AUTH_NONCE_LEN + 1];
+    lan_auth_issue_nonce(n);
+    host_timer_offset_us += (LAN_AUTH_CHALLENGE_TTL_MS + 1) * 1000LL;
+    CHECK(send_cmd("open", SYNCED_NOW, n) == LAN_AUTH_REPLAY);
+
+    // Đầy: challenge cũ nhất bị thay
+    char all[LAN_AUTH_CHALLENGES + 1][LAN_AUTH_NONCE_LEN + 1];
+    for (int i = 0; i <= LAN_AUTH_CHALLENGES; i++) {
+        lan_auth_issue_nonce(all[i]);
+        host_timer_offset_us += 1000;
+    }
+    CHECK(send_cmd("open", SYNCED_NOW, all[0]) == LAN_AUTH_REPLAY);
+    for (int i = 1; i <= LAN_AUTH_CHALLENGES; i++) CHECK(send_cmd("open", SYNCED_NOW, all[i]) == LAN_AUTH_OK);
+}
+
+static void test_clock_window(void) {
+    char n[LAN_AUTH_NONCE_LEN + 1];
+    lan_auth_issue_nonce(n);
+    CHECK(send_cmd("open", SYNCED_NOW - LAN_AUTH_WINDOW_S - 1, n) == LAN_AUTH_EXPIRED);
+    lan_auth_issue_nonce(n);
+    CHECK(send_cmd("open", SYNCED_NOW + LAN_AUTH_WINDOW_S + 1, n) == LAN_AUTH_EXPIRED);
+    lan_auth_issue_nonce(n);
+    CHECK(send_cmd("open", SYNCED_NOW + LAN_AUTH_WINDOW_S, n) == LAN_AUTH_OK);
+    CHECK(s_settime_calls == 0);
+}
+
+// Khởi động lại không có SNTP: lệnh cũ bắt được (ts cũ, nonce cũ) không được đặt giờ hay mở cửa
+static void test_replay_after_reboot_without_clock(void) {
+    char n[LAN_AUTH_NONCE_LEN + 1], sig[65];
+    const int64_t old_ts = SYNCED_NOW - 3600;
+    s_now = old_ts;
+    lan_auth_issue_nonce(n);
+    sign("open", old_ts, n, sig);
+    CHECK(lan_auth_verify("open", old_ts, n, sig) == LAN_AUTH_OK);     // Lệnh gốc, kẻ tấn công ghi lại
+
+    s_now = 1000;                                                      // Sau reboot: chưa có giờ
+    s_settime_calls = 0;
+    CHECK(lan_auth_verify("open", old_ts, n, sig) == LAN_AUTH_REPLAY);
+    CHECK(s_settime_calls == 0 && s_now == 1000);
+
+    // App gửi lệnh mới gắn challenge vừa cấp: được mở, đồng hồ lấy theo ts của App
+    lan_auth_issue_nonce(n);
+    CHECK(send_cmd("open", SYNCED_NOW, n) == LAN_AUTH_OK);
+    CHECK(s_settime_calls == 1 && s_now == SYNCED_NOW);
+}
+
+// Dữ liệu dài (gallery qua BLE): HMAC(key, nonce || data), không tiêu challenge
+static void test_blob_mac(void) {
+    const char *nonce = "00112233445566778899aabbccddeeff";
+    uint8_t data[300], mac[32], buf[LAN_AUTH_NONCE_LEN + sizeof(data)];
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)(i * 13);
+    memcpy(buf, nonce, LAN_AUTH_NONCE_LEN);
+    memcpy(buf + LAN_AUTH_NONCE_LEN, data, sizeof(data));
+    mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), s_key, sizeof(s_key), buf, sizeof(buf), mac);
+
+    CHECK(lan_auth_check_mac(nonce, data, sizeof(data), mac));
+    CHECK(!lan_auth_check_mac(nonce, data, sizeof(data) - 1, mac));
+    CHECK(!lan_auth_check_mac("ffeeddccbbaa99887766554433221100", data, sizeof(data), mac));
+    CHECK(!lan_auth_check_mac("0011", data, sizeof(data), mac));
+    data[100] ^= 1;
+    CHECK(!lan_auth_check_mac(nonce, data, sizeof(data), mac));
+}
+
+int main(void) {
+    for (int i = 0; i < LAN_AUTH_KEY_LEN; i++) s_key[i] = (uint8_t)i;
+    test_signature_vectors();
+    test_no_key();
+    test_challenge_single_use();
+    test_challenge_expiry_and_eviction();
+    test_clock_window();
+    test_replay_after_reboot_without_clock();
+    test_blob_mac();
+    test_rekey();
+    CHECK(strcmp(lan_auth_result_name(LAN_AUTH_REPLAY), "replay") == 0);
+    return TEST_RESULT();
+}
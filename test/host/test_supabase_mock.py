@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+"""supabase_client.c chạy với tools/supabase_mock.py (không cần project Supabase thật).
+
+Firmware ở đây là chương trình supabase_host (test/host/supabase_host.c): supabase_client.c thật build trên host,
+esp_http_client qua socket. Test gửi lệnh từng dòng (log, flush, image, poll, sync...) rồi kiểm dữ liệu / thống kê
+mà mock nhận được. Các trường hợp:
+  - outbox: gộp access_logs thành mảng (tối đa SUPABASE_LOG_BATCH_MAX), ảnh bằng chứng trước, lỗi thì giữ lại cả lô
+  - upload ảnh: nhỏ -> POST object, lớn -> TUS; đứt giữa PATCH -> HEAD hỏi offset rồi gửi tiếp phần còn lại
+  - lệnh remote: OPEN / ENROLL từ device_commands, PATCH executed, users POST + PATCH embedding_adapted, sync lại
+
+ctest truyền đường dẫn supabase_host; chạy tay:
+    python3 test/host/test_supabase_mock.py build_host/supabase_host -v
+"""
+import http.client
+import json
+import os
+import re
+import subprocess
+import sys
+import threading
+import time
+import unittest
+from http.server import ThreadingHTTPServer
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "tools"))
+import supabase_mock  # noqa: E402
+
+FIRMWARE = None         # Đường dẫn supabase_host (đối số đầu tiên)
+KEY = "test-key"
+EMBED_DIM = 512
+CMD_TIMEOUT_S = 60
+
+# supabase_client.h
+SUPABASE_LOG_BATCH_MAX = 8
+SUPABASE_UPLOAD_CHUNK = 4096
+SUPABASE_UPLOAD_TUS_MIN = 64 * 1024
+
+BUS_SRC_REMOTE = 1      # ev_source_t EV_SRC_REMOTE
+SNAPSHOT_NAME = re.compile(r"^ev_[0-9a-f]{8}\.jpg$")
+
+
+def enroll_embedding(scale=1.0):
+    """Mẫu mà face_enroll giả của supabase_host trả về."""
+    return [scale * ((i * 37) % 200 - 100) / 1000.0 for i in range(EMBED_DIM)]
+
+
+class Firmware:
+    """1 tiến trình supabase_host: mỗi lệnh 1 dòng stdin, trả 1 dòng JSON."""
+
+    def __init__(self, port):
+        self.proc = subprocess.Popen([FIRMWARE, "http://127.0.0.1:%d" % port, KEY], stdin=subprocess.PIPE,
+                                     stdout=subprocess.PIPE, text=True)
+
+    def call(self, *args):
+        self.proc.stdin.write(" ".join(str(a) for a in args) + "\n")
+        self.proc.stdin.flush()
+        line = self.proc.stdout.readline()
+        if not line:
+            raise RuntimeError("supabase_host exited (%s)" % self.proc.poll())
+        return json.loads(line)
+
+    def close(self):
+        self.proc.stdin.close()
+        try:
+            self.proc.wait(timeout=CMD_TIMEOUT_S)
+        except subprocess.TimeoutExpired:
+            self.proc.kill()
+            self.proc.wait()
+        self.proc.stdout.close()
+
+    def log(self, face_id, thumb=0, full=0):
+        return self.call("log", face_id, thumb, full)["err"]
+
+    def flush(self, timeout_ms=20000):
+        return self.call("flush", timeout_ms)
+
+    def upload(self, size, name):
+        return self.call("image", size, name)["err"] == 0
+
+
+class MockTestCase(unittest.TestCase):
+    users = 4
+
+    def setUp(self):
+        handler = type("Handler", (supabase_mock.Handler,), {
+            "store": supabase_mock.Store(self.users, EMBED_DIM, 1), "key": KEY, "quiet": True})
+        self.store = handler.store
+        self.server = ThreadingHTTPServer(("127.0.0.1", 0), handler)
+        self.server.daemon_threads = True
+        self.thread = threading.Thread(target=self.server.serve_forever, daemon=True)
+        self.thread.start()
+        self.port = self.server.server_address[1]
+        self.fw = Firmware(self.port)
+
+    def tearDown(self):
+        self.fw.close()
+        self.server.shutdown()
+        self.server.server_close()
+
+    def configure(self, **cfg):
+        self.store.config.update(cfg)
+
+    def stats(self, op):
+        return self.store.stats_json().get(op, {"count": 0, "bytes_in": 0, "status": {}})
+
+    def rows(self, table):
+        return self.store.tables[table]
+
+    def wait_for(self, cond, timeout_s=10):
+        until = time.monotonic() + timeout_s
+        while not cond():
+            self.assertLess(time.monotonic(), until, "timed out")
+            time.sleep(0.02)
+
+    def request(self, method, path, body=None, headers=None):
+        """Request trực tiếp (không qua firmware): đặt lệnh, thử key sai."""
+        h = {"apikey": KEY, "Authorization": "Bearer " + KEY, "Content-Type": "application/json"}
+        h.update(headers or {})
+        conn = http.client.HTTPConnection("127.0.0.1", self.port, timeout=10)
+        try:
+            conn.request(method, path, body=body, headers=h)
+            r = conn.getresponse()
+            r.read()
+            return r.status
+        finally:
+            conn.close()
+
+
+class OutboxTest(MockTestCase):
+    def test_lone_event_is_sent(self):
+        self.assertEqual(self.fw.log(5), 0)
+        self.assertEqual(self.fw.flush()["sent"], 1)
+        self.assertEqual([r["face_id"] for r in self.rows("access_logs")], [5])
+
+    def test_batches_rows_into_array_posts(self):
+        # Offline: sự kiện dồn lại, có mạng thì gửi theo lô
+        self.fw.call("wifi", 0)
+        for i in range(SUPABASE_LOG_BATCH_MAX + 2):
+            self.assertEqual(self.fw.log(i % 3), 0)
+        self.fw.call("wifi", 1)
+        status = self.fw.flush()
+        self.assertEqual((status["sent"], status["pending"], status["log_posts"]), (SUPABASE_LOG_BATCH_MAX + 2, 0, 2))
+        self.assertEqual(self.stats("log_access")["count"], 2)               # 8 + 2
+        self.assertEqual(self.stats("log_access")["status"], {"201": 2})
+        rows = self.rows("access_logs")
+        self.assertEqual([r["face_id"] for r in rows], [i % 3 for i in range(SUPABASE_LOG_BATCH_MAX + 2)])
+        # Thời điểm do khoá ghi lúc sự kiện xảy ra (đã có giờ hệ thống), không phải giờ nhận của server
+        self.assertTrue(all(re.match(r"^\d{4}-\d\d-\d\dT\d\d:\d\d:\d\dZ$", r["created_at"]) for r in rows))
+        self.assertEqual(rows[0]["description"], "Face ID Match (0.87)")
+        self.assertEqual(rows[0]["score"], 0.8731)
+
+    def test_image_splits_batch_and_names_full_frame(self):
+        self.fw.call("wifi", 0)
+        self.assertEqual(self.fw.log(1, 3000, 20000), 0)
+        self.assertEqual(self.fw.log(2), 0)
+        self.assertEqual(self.fw.log(3), 0)
+        self.assertEqual(self.fw.log(4, 3000), 0)
+        self.assertEqual(self.fw.log(-1), 0)
+        self.fw.call("wifi", 1)
+        self.assertEqual(self.fw.flush()["sent"], 5)
+        self.assertEqual(self.stats("log_access")["count"], 2)
+        self.assertEqual(self.stats("upload_image")["count"], 3)              # 2 ảnh bằng chứng + 1 frame gốc
+        rows = self.rows("access_logs")
+        self.assertEqual([r.get("face_id") for r in rows], [1, 2, 3, 4, None])
+        self.assertEqual(rows[4]["description"], "Remote Unlock via App")
+        images = [r.get("image_url") for r in rows]
+        self.assertEqual([bool(i) for i in images], [True, False, False, True, False])
+        self.assertTrue(SNAPSHOT_NAME.match(images[0]) and SNAPSHOT_NAME.match(images[3]))
+        self.assertEqual(self.store.objects["access_faces/" + images[0]], 3000)
+        self.assertEqual(self.store.objects["access_faces/" + images[0].replace(".jpg", "_full.jpg")], 20000)
+
+    def test_failed_post_keeps_whole_batch_without_reuploading_image(self):
+        self.configure(ops={"log_access": {"error_rate": 1.0}})
+        self.fw.call("wifi", 0)
+        self.assertEqual(self.fw.log(1, 2000), 0)
+        self.assertEqual(self.fw.log(2), 0)
+        self.assertEqual(self.fw.log(3), 0)
+        self.fw.call("wifi", 1)
+        self.wait_for(lambda: self.stats("log_access")["count"] >= 1)
+        self.configure(ops={})                                                # Lượt thử lại (sau 2 s) sẽ thành công
+        status = self.fw.call("status")
+        self.assertEqual((status["pending"], status["sent"]), (3, 0))
+        self.assertEqual(self.rows("access_logs"), [])
+        self.assertEqual(self.fw.flush()["sent"], 3)
+        self.assertEqual(len(self.rows("access_logs")), 3)
+        self.assertEqual(self.stats("upload_image")["count"], 1)              # Ảnh chỉ lên 1 lần
+        self.assertEqual(self.stats("log_access")["status"], {"503": 1, "201": 1})
+
+
+class UploadTest(MockTestCase):
+    def test_small_image_uses_single_post(self):
+        self.assertTrue(self.fw.upload(SUPABASE_UPLOAD_TUS_MIN - 1, "small.jpg"))
+        self.assertEqual(self.stats("upload_image")["count"], 1)
+        self.assertEqual(self.stats("tus_create")["count"], 0)
+        self.assertEqual(self.store.objects["access_faces/small.jpg"], SUPABASE_UPLOAD_TUS_MIN - 1)
+
+    def test_tus_single_patch(self):
+        size = 100 * 1024
+        self.assertTrue(self.fw.upload(size, "big.jpg"))
+        self.assertEqual(self.stats("tus_create")["count"], 1)
+        self.assertEqual(self.stats("tus_patch")["count"], 1)
+        self.assertEqual(self.stats("tus_head")["count"], 0)
+        self.assertEqual(self.store.objects["access_faces/big.jpg"], size)
+
+    def test_tus_resumes_from_server_offset_after_cut(self):
+        size = 100 * 1024
+        self.configure(tus_cut=30000)
+        self.assertTrue(self.fw.upload(size, "cut.jpg"))
+        self.assertEqual(self.stats("tus_create")["count"], 1)
+        self.assertEqual(self.stats("tus_patch")["count"], 2)
+        self.assertEqual(self.stats("tus_head")["count"], 1)
+        self.assertEqual(self.fw.call("status")["upload"]["resumed"], 1)
+        self.assertEqual(self.store.objects["access_faces/cut.jpg"], size)
+        # Lần 2 chỉ gửi phần còn thiếu, không gửi lại cả ảnh
+        self.assertLess(self.stats("tus_patch")["bytes_in"], size + SUPABASE_UPLOAD_CHUNK)
+
+    def test_tus_gives_up_on_client_error(self):
+        self.configure(ops={"tus_create": {"error_rate": 1.0, "error_status": 403}})
+        self.assertFalse(self.fw.upload(SUPABASE_UPLOAD_TUS_MIN, "denied.jpg"))
+        self.assertEqual(self.stats("tus_create")["count"], 1)                # 4xx: không thử lại
+        self.assertEqual(self.stats("tus_patch")["count"], 0)
+        self.assertNotIn("access_faces/denied.jpg", self.store.objects)
+
+
+class CommandTest(MockTestCase):
+    def post_command(self, cmd):
+        self.assertEqual(self.request("POST", "/__mock/command", json.dumps(cmd)), 201)
+
+    def test_open_logs_and_marks_executed(self):
+        self.post_command({"command": "OPEN"})
+        cmd_id = self.rows("device_commands")[0]["id"]
+        self.assertEqual(self.fw.call("poll"), {"opens": [{"source": BUS_SRC_REMOTE, "ref": cmd_id}], "enrolls": []})
+        self.assertEqual(self.rows("device_commands")[0]["status"], "executed")
+        self.assertEqual(self.fw.flush()["sent"], 1)
+        self.assertEqual(self.rows("access_logs")[0]["description"], "Remote Unlock via App")
+        self.assertEqual(self.fw.call("poll")["opens"], [])                   # Không chạy lại lệnh đã xong
+
+    def test_enrollment_round_trip(self):
+        emb = enroll_embedding()
+        self.post_command({"command": "ENROLL", "payload": {"user_id": 42}})
+        self.assertEqual(self.fw.call("poll"), {"opens": [], "enrolls": [42]})
+        self.assertEqual(self.rows("device_commands")[0]["status"], "executed")
+        self.assertEqual(self.fw.call("enroll_wait", 10000)["states"], ["started", "uploading", "success"])
+        self.assertTrue(any(k.startswith("access_faces/face_42_") for k in self.store.objects))
+        self.assertEqual(self.stats("upload_face")["status"], {"201": 1})
+
+        # Thiết bị khác đồng bộ: thấy user mới với đúng embedding
+        synced = self.fw.call("sync", 42)
+        self.assertEqual(sorted(synced["ids"]), list(range(1, self.users + 1)) + [42])
+        self.assertAlmostEqual(synced["v1"], emb[1], places=6)
+
+        # Mẫu đã học: PATCH embedding_adapted, sync ưu tiên mẫu này
+        self.assertEqual(self.fw.call("adapt", 42, 0.5)["err"], 0)
+        self.assertEqual(self.stats("upload_face_adapted")["status"], {"204": 1})
+        synced = self.fw.call("sync", 42)
+        self.assertEqual(synced["adapted"], [42])
+        self.assertAlmostEqual(synced["v1"], enroll_embedding(0.5)[1], places=6)
+
+    def test_enroll_without_user_id_is_dropped(self):
+        self.post_command({"command": "ENROLL", "payload": {}})
+        self.assertEqual(self.fw.call("poll"), {"opens": [], "enrolls": []})
+        self.assertEqual(self.rows("device_commands")[0]["status"], "executed")
+        self.assertEqual(self.stats("upload_face")["count"], 0)
+
+
+class SyncTest(MockTestCase):
+    users = 20
+
+    def test_chunked_sync(self):
+        self.configure(chunked=True, chunk_size=700)
+        self.assertEqual(sorted(self.fw.call("sync", 1)["ids"]), list(range(1, self.users + 1)))
+
+    def test_wrong_key_rejected(self):
+        self.assertEqual(self.request("GET", "/rest/v1/users?select=*&limit=100", headers={"apikey": "nope"}), 401)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2 or not os.path.isfile(sys.argv[1]):
+        sys.exit("usage: test_supabase_mock.py <supabase_host> [unittest args]")
+    FIRMWARE = sys.argv.pop(1)
+    unittest.main()
@@ -0,0 +1,203 @@
+// Hàng đợi websocket: hành vi cơ bản, đua peek/gửi/pop với người phát, tải nhiều client + nhiều người phát
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <time.h>
+#include "host_test.h"
+#include "ws_queue.h"
+
+#define LOAD_PRODUCERS      4
+#define LOAD_MSGS           5000    // Mỗi người phát
+#define LOAD_GAP_US         40      // Nhịp phát của mỗi người phát
+#define SLOW_CLIENT         (WS_MAX_CLIENTS - 1)
+#define SLOW_PERIOD_US      2000    // Client chậm chỉ "ghi được" 1 tin mỗi khoảng này
+
+// Trả mọi slot về trống (ws_queue_add xoá hàng cũ của slot khi cấp lại)
+static void reset(void) {
+    for (int fd = 0; fd < 64; fd++) ws_queue_remove(fd);
+}
+
+static void test_basic(void) {
+    char out[WS_MSG_MAX_LEN];
+    int fd;
+    uint32_t seq;
+    reset();
+    ws_queue_add(10);
+    CHECK(ws_queue_clients() == 1);
+    CHECK(ws_queue_push("a"));
+    CHECK(ws_queue_push("bb"));
+    CHECK(!ws_queue_push(""));
+
+    size_t len = ws_queue_peek(0, &fd, out, &seq);
+    CHECK(fd == 10 && len == 1 && out[0] == 'a');
+    CHECK(ws_queue_pop(0, fd, seq));
+    CHECK(!ws_queue_pop(0, fd, seq));           // Pop lại cùng seq: không đụng tin kế
+    len = ws_queue_peek(0, &fd, out, &seq);
+    CHECK(len == 2 && memcmp(out, "bb", 2) == 0);
+    CHECK(ws_queue_pop(0, fd, seq));
+    CHECK(ws_queue_peek(0, &fd, out, &seq) == 0);
+
+    char big[WS_MSG_MAX_LEN + 1];
+    memset(big, 'x', sizeof(big) - 1);
+    big[WS_MSG_MAX_LEN] = '\0';
+    CHECK(!ws_queue_push(big));
+}
+
+static void test_overflow_drops_oldest(void) {
+    char out[WS_MSG_MAX_LEN];
+    char msg[16];
+    int fd;
+    uint32_t seq;
+    reset();
+    uint32_t dropped0 = ws_queue_dropped();
+    ws_queue_add(11);
+    for (int i = 0; i < WS_QUEUE_LEN + 3; i++) {
+        snprintf(msg, sizeof(msg), "m%d", i);
+        ws_queue_push(msg);
+    }
+    CHECK(ws_queue_dropped() - dropped0 == 3);
+    size_t len = ws_queue_peek(0, &fd, out, &seq);
+    CHECK(len == 2 && memcmp(out, "m3", 2) == 0);
+}
+
+// Người gửi copy tin đầu, trong lúc gửi người phát làm đầy hàng và đẩy tin đó ra.
+// Pop theo seq cũ phải thất bại, tin đầu mới (chưa gửi) phải còn nguyên.
+static void test_pop_after_concurrent_drop(void) {
+    char out[WS_MSG_MAX_LEN];
+    char msg[16];
+    int fd;
+    uint32_t seq;
+    reset();
+    ws_queue_add(12);
+    for (int i = 0; i < WS_QUEUE_LEN; i++) {
+        snprintf(msg, sizeof(msg), "m%d", i);
+        ws_queue_push(msg);
+    }
+    CHECK(ws_queue_peek(0, &fd, out, &seq) == 2 && memcmp(out, "m0", 2) == 0);
+    ws_queue_push("late");                      // Đầy -> m0 bị bỏ, m1 thành đầu hàng
+    CHECK(!ws_queue_pop(0, fd, seq));
+    CHECK(ws_queue_peek(0, &fd, out, &seq) == 2 && memcmp(out, "m1", 2) == 0);
+    CHECK(ws_queue_pop(0, fd, seq));
+    CHECK(ws_queue_peek(0, &fd, out, &seq) == 2 && memcmp(out, "m2", 2) == 0);
+}
+
+static void test_removed_client(void) {
+    char out[WS_MSG_MAX_LEN];
+    int fd;
+    uint32_t seq;
+    reset();
+    ws_queue_add(13);
+    ws_queue_push("x");
+    CHECK(ws_queue_peek(0, &fd, out, &seq) == 1);
+    ws_queue_remove(13);
+    CHECK(!ws_queue_pop(0, fd, seq));
+    CHECK(ws_queue_peek(0, &fd, out, &seq) == 0 && fd == -1);
+}
+
+// TẢI: LOAD_PRODUCERS task phát đồng thời, 1 task gửi rút WS_MAX_CLIENTS client (1 client chậm).
+// Mỗi client phải nhận tin của từng người phát đúng thứ tự, không trùng;
+// số tin thiếu không vượt số tin hàng đợi báo bỏ.
+static atomic_int s_producers_left;
+
+static void *producer(void *arg) {
+    int id = (int)(intptr_t)arg;
+    char msg[32];
+    for (int i = 0; i < LOAD_MSGS; i++) {
+        snprintf(msg, sizeof(msg), "{\"p\":%d,\"n\":%d}", id, i);
+        ws_queue_push(msg);
+        usleep(LOAD_GAP_US);
+    }
+    atomic_fetch_sub(&s_producers_left, 1);
+    return NULL;
+}
+
+typedef struct {
+    int last[LOAD_PRODUCERS];
+    long delivered;
+    int out_of_order;
+} client_log_t;
+
+static client_log_t s_log[WS_MAX_CLIENTS];
+
+static int64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void *sender(void *arg) {
+    char out[WS_MSG_MAX_LEN + 1];
+    int64_t slow_next = 0;
+    while (1) {
+        bool done = atomic_load(&s_producers_left) == 0;
+        bool any = false;
+        for (int c = 0; c < WS_MAX_CLIENTS; c++) {
+            int fd;
+            uint32_t seq;
+            size_t len = ws_queue_peek(c, &fd, out, &seq);
+            if (fd < 0 || len == 0) continue;
+            any = true;
+            // Như ws_socket_writable == false: bỏ qua client chậm, các client khác vẫn được gửi
+            if (c == SLOW_CLIENT) {
+                if (now_us() < slow_next) continue;
+                slow_next = now_us() + SLOW_PERIOD_US;
+            }
+            out[len] = '\0';
+            sched_yield();                      // "Gửi" ngoài khoá: cho người phát chen vào
+            int p, n;
+            if (sscanf(out, "{\"p\":%d,\"n\":%d}", &p, &n) == 2 && p >= 0 && p < LOAD_PRODUCERS) {
+                if (n <= s_log[c].last[p]) s_log[c].out_of_order++;
+                s_log[c].last[p] = n;
+                s_log[c].delivered++;
+            }
+            ws_queue_pop(c, fd, seq);
+        }
+        if (done && !any) break;
+        if (!any) usleep(10);
+    }
+    return NULL;
+}
+
+static void test_load_many_clients(void) {
+    reset();
+    uint32_t dropped0 = ws_queue_dropped();
+    for (int c = 0; c < WS_MAX_CLIENTS; c++) {
+        ws_queue_add(20 + c);
+        for (int p = 0; p < LOAD_PRODUCERS; p++) s_log[c].last[p] = -1;
+    }
+    atomic_store(&s_producers_left, LOAD_PRODUCERS);
+
+    pthread_t prod[LOAD_PRODUCERS], snd;
+    pthread_create(&snd, NULL, sender, NULL);
+    for (int p = 0; p < LOAD_PRODUCERS; p++) pthread_create(&prod[p], NULL, producer, (void *)(intptr_t)p);
+    for (int p = 0; p < LOAD_PRODUCERS; p++) pthread_join(prod[p], NULL);
+    pthread_join(snd, NULL);
+
+    long total = (long)LOAD_PRODUCERS * LOAD_MSGS;
+    long missing = 0;
+    for (int c = 0; c < WS_MAX_CLIENTS; c++) {
+        CHECK(s_log[c].out_of_order == 0);
+        CHECK(s_log[c].delivered <= total);
+        missing += total - s_log[c].delivered;
+    }
+    uint32_t dropped = ws_queue_dropped() - dropped0;
+    CHECK(missing <= (long)dropped);
+    // Client nhanh phải nhận gần đủ dù client chậm bị bỏ tin liên tục
+    CHECK(s_log[0].delivered >= total * 9 / 10);
+    printf("load: %d clients x %ld msgs, delivered slow=%ld fast=%ld, dropped=%lu\n",
+           WS_MAX_CLIENTS, total, s_log[SLOW_CLIENT].delivered, s_log[0].delivered, (unsigned long)dropped);
+}
+
+int main(void) {
+    CHECK(ws_queue_init());
+    test_basic();
+    test_overflow_drops_oldest();
+    test_pop_after_concurrent_drop();
+    test_removed_client();
+    test_load_many_clients();
+    return TEST_RESULT();
+}
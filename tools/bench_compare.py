@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""So sánh 2 lần chạy benchmark của firmware (vd. trước / sau 1 thay đổi).
+
+Mỗi file đầu vào là 1 trong 2 dạng:
+  - JSON của GET /bench?job=1 sau khi chạy xong ({"state":"done","build":{..},"iters":N,"results":[..]}),
+    hoặc của test/host/bench_host (cùng dạng)
+  - log serial của lệnh "bench all [N]"    (các dòng BENCH_BUILD / BENCH_RESULT)
+
+    curl -s "http://<lock-ip>/bench?name=all&iters=300"        # Bắt đầu lượt chạy nền (202)
+    curl -s "http://<lock-ip>/bench?job=1" > new.json           # Hỏi lại tới khi "state":"done"
+    python3 tools/bench_compare.py old.json new.json --threshold 10
+
+Thoát mã 1 nếu có benchmark chậm đi quá ngưỡng (p50 hoặc p99) -> dùng được trong CI.
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path, encoding="utf-8", errors="replace") as f:
+        text = f.read()
+    try:
+        doc = json.loads(text)
+        if doc.get("state") == "running":
+            print("%s: bench job still running (%s/%s)" % (path, doc.get("done"), doc.get("total")), file=sys.stderr)
+        return doc.get("build") or {}, {r["name"]: r for r in doc.get("results", [])}
+    except ValueError:
+        pass
+    build, results = {}, {}
+    for line in text.splitlines():
+        # Log serial có thể có tiền tố (timestamp của monitor, mã màu): tìm từ khoá trong dòng
+        for tag in ("BENCH_BUILD ", "BENCH_RESULT "):
+            pos = line.find(tag)
+            if pos < 0:
+                continue
+            try:
+                obj = json.loads(line[pos + len(tag):].strip())
+            except ValueError:
+                continue
+            if tag == "BENCH_BUILD ":
+                build = obj
+            else:
+                results[obj["name"]] = obj
+    return build, results
+
+
+def pct(old, new):
+    return (new - old) * 100.0 / old if old > 0 else 0.0
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("baseline")
+    ap.add_argument("candidate")
+    ap.add_argument("--threshold", type=float, default=10.0, help="%% chậm đi tối đa trước khi báo lỗi (mặc định 10)")
+    ap.add_argument("--min-us", type=float, default=2.0, help="bỏ qua chênh lệch tuyệt đối nhỏ hơn (us, mặc định 2)")
+    args = ap.parse_args()
+
+    old_build, old = load(args.baseline)
+    new_build, new = load(args.candidate)
+    if not old or not new:
+        print("no benchmark results in %s" % (args.baseline if not old else args.candidate), file=sys.stderr)
+        return 2
+    for label, b in (("baseline", old_build), ("candidate", new_build)):
+        if b:
+            print("%-9s %s %s (idf %s, elf %s, %s)" % (label, b.get("project"), b.get("version"), b.get("idf"),
+                                                       b.get("elf"), b.get("built")))
+
+    print("%-28s %10s %10s %8s %10s %10s %8s %7s" % ("name", "p50 old", "p50 new", "d%", "p99 old", "p99 new", "d%",
+                                                      "allocs"))
+    regressions = []
+    for name in sorted(set(old) | set(new)):
+        if name not in old or name not in new:
+            print("%-28s %s" % (name, "only in candidate" if name in new else "only in baseline"))
+            continue
+        o, n = old[name], new[name]
+        row = []
+        bad = False
+        for key in ("p50_us", "p99_us"):
+            d = pct(o[key], n[key])
+            if d > args.threshold and n[key] - o[key] > args.min_us:
+                bad = True
+            row += [o[key], n[key], d]
+        mark = " <-- slower" if bad else ""
+        print("%-28s %10.2f %10.2f %+7.1f%% %10.2f %10.2f %+7.1f%% %7.2f%s" %
+              (name, row[0], row[1], row[2], row[3], row[4], row[5], n.get("allocs", 0.0), mark))
+        if bad:
+            regressions.append(name)
+
+    if regressions:
+        print("\n%d regression(s) over %.1f%%: %s" % (len(regressions), args.threshold, ", ".join(regressions)))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""Tạo main/bench_face.rgb: ảnh mặt mẫu cho benchmark model (model_detect_*, model_feat_*, face_batch_*).
+
+Ảnh RGB888 thô FACE_W x FACE_H, nhúng vào firmware (EMBED_FILES) và dán vào frame tổng hợp tại
+BENCH_BOX trong face_detect.cpp. Các điểm mốc (mắt, mũi, khoé miệng) vẽ đúng vị trí BENCH_KPT:
+đổi hình học ở đây thì sửa BENCH_KPT / BENCH_BOX theo.
+
+    python3 tools/make_bench_face.py                    # Mặt vẽ tổng hợp (mặc định)
+    python3 tools/make_bench_face.py --ppm face.ppm     # Ảnh thật: PPM P6 đúng FACE_W x FACE_H, đã căn
+                                                        # mắt / mũi / miệng theo KPT bên dưới
+"""
+import argparse
+import os
+
+FACE_W, FACE_H = 80, 100
+# Toạ độ trong ảnh mặt, thứ tự như keypoint của HumanFaceDetect:
+# mắt trái, khoé miệng trái, mũi, mắt phải, khoé miệng phải (= BENCH_KPT - góc BENCH_BOX)
+KPT = [(25, 35), (28, 75), (40, 55), (55, 35), (52, 75)]
+SS = 4  # Lấy mẫu siêu phân giải để biên mềm (detector nhạy với cạnh răng cưa)
+
+SKIN = (224, 172, 140)
+HAIR = (40, 30, 25)
+BG = (120, 120, 120)
+
+
+def ellipse(x, y, cx, cy, rx, ry):
+    return ((x - cx) / rx) ** 2 + ((y - cy) / ry) ** 2
+
+
+def mix(a, b, t):
+    return tuple(a[i] + (b[i] - a[i]) * t for i in range(3))
+
+
+def shade(x, y):
+    (lex, ley), (lmx, lmy), (nx, ny), (rex, rey), (rmx, rmy) = KPT
+    cx, cy = FACE_W / 2, FACE_H * 0.52
+    face = ellipse(x, y, cx, cy, FACE_W * 0.40, FACE_H * 0.44)
+    if y < FACE_H * 0.30 and ellipse(x, y, cx, cy - 4, FACE_W * 0.46, FACE_H * 0.52) < 1.0:
+        return HAIR
+    if face >= 1.0:
+        return HAIR if y < cy and abs(x - cx) < FACE_W * 0.46 else BG
+    # Da sáng ở giữa, tối dần ra viền
+    c = mix(SKIN, (150, 105, 85), face ** 1.5)
+    for ex in (lex, rex):
+        if ellipse(x, y, ex, ley - 8, 8, 2) < 1.0:         # Lông mày
+            return HAIR
+        e = ellipse(x, y, ex, ley, 7, 3.5)
+        if e < 1.0:
+            return (30, 25, 25) if ellipse(x, y, ex, ley, 2.8, 2.8) < 1.0 else (235, 235, 230)
+        if ellipse(x, y, ex, ley + 2, 9, 6) < 1.0:          # Hốc mắt
+            c = mix(c, (120, 85, 70), 0.35)
+    if abs(x - nx) < 2.5 and ley + 4 < y < ny:             # Sống mũi
+        c = mix(c, (240, 195, 165), 0.4)
+    if ellipse(x, y, nx, ny, 7, 3) < 1.0 and y > ny - 1:   # Cánh mũi
+        c = mix(c, (110, 70, 60), 0.6)
+    mcx, mcy = (lmx + rmx) / 2, (lmy + rmy) / 2
+    if ellipse(x, y, mcx, mcy, (rmx - lmx) / 2, 2.2) < 1.0:
+        return (140, 50, 55)
+    if ellipse(x, y, mcx, mcy + 3, (rmx - lmx) / 2 - 2, 2.5) < 1.0:  # Môi dưới
+        c = mix(c, (185, 95, 95), 0.6)
+    return c
+
+
+def render():
+    out = bytearray()
+    for y in range(FACE_H):
+        for x in range(FACE_W):
+            acc = [0.0, 0.0, 0.0]
+            for sy in range(SS):
+                for sx in range(SS):
+                    c = shade(x + (sx + 0.5) / SS, y + (sy + 0.5) / SS)
+                    for i in range(3):
+                        acc[i] += c[i]
+            out += bytes(min(255, int(round(v / (SS * SS)))) for v in acc)
+    return bytes(out)
+
+
+def read_ppm(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    fields, pos = [], 0
+    while len(fields) < 4:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            pos = data.index(b"\n", pos)
+            continue
+        end = pos
+        while not data[end:end + 1].isspace():
+            end += 1
+        fields.append(data[pos:end])
+        pos = end
+    if fields[0] != b"P6" or int(fields[3]) != 255:
+        raise SystemExit("%s: need binary PPM (P6, maxval 255)" % path)
+    w, h = int(fields[1]), int(fields[2])
+    if (w, h) != (FACE_W, FACE_H):
+        raise SystemExit("%s: need %dx%d, got %dx%d" % (path, FACE_W, FACE_H, w, h))
+    return data[pos + 1:pos + 1 + w * h * 3]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--ppm", help="use this aligned face photo instead of the drawn face")
+    ap.add_argument("-o", "--out", default=os.path.join(os.path.dirname(__file__), "..", "main", "bench_face.rgb"))
+    args = ap.parse_args()
+    data = read_ppm(args.ppm) if args.ppm else render()
+    with open(args.out, "wb") as f:
+        f.write(data)
+    print("%s: %dx%d RGB888, %d bytes" % (os.path.normpath(args.out), FACE_W, FACE_H, len(data)))
+
+
+if __name__ == "__main__":
+    main()
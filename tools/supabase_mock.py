@@ -0,0 +1,469 @@
+#!/usr/bin/env python3
+"""Máy chủ giả lập Supabase cho khoá (chạy trên máy trong LAN, không cần project thật).
+
+Chỉ phần PostgREST / Storage mà firmware dùng:
+  GET    /rest/v1/users?select=*&limit=N             supabase_sync_users
+  POST   /rest/v1/users                              supabase_upload_face
+  PATCH  /rest/v1/users?face_id=eq.N                 supabase_upload_face_adapted
+  POST   /rest/v1/access_logs                        log đơn hoặc mảng gộp của outbox
+  POST   /rest/v1/device_stats?on_conflict=device_id supabase_publish_stats (upsert)
+  GET    /rest/v1/device_commands?...status=eq.pending&device_id=eq.X   check_remote_command
+  PATCH  /rest/v1/device_commands?id=eq.N            mark_command_executed
+  POST   /storage/v1/object/<bucket>/<tên>           upload ảnh nhỏ
+  POST   /storage/v1/upload/resumable (+ HEAD/PATCH <Location>)   upload TUS
+
+Điều khiển / đo (JSON):
+  GET  /__mock/stats              số request, byte vào/ra, độ trễ p50/p95/max theo thao tác
+  POST /__mock/reset              xoá thống kê (giữ dữ liệu)
+  GET  /__mock/config             cấu hình lỗi / độ trễ hiện tại
+  POST /__mock/config             {"latency_ms":..,"jitter_ms":..,"error_rate":..,"error_status":..,
+                                   "drop_rate":..,"chunked":..,"chunk_size":..,"rx_kbps":..,"tus_cut":..,
+                                   "ops":{"sync_users":{"error_rate":1.0}}}   (ops: ghi đè theo thao tác)
+  POST /__mock/command            {"command":"OPEN"} | {"command":"ENROLL","payload":{"user_id":5}}
+  GET  /__mock/rows/<bảng>        xem dữ liệu đã nhận
+
+Chạy:
+    python3 tools/supabase_mock.py serve --port 54321 --users 20 --seed 1
+Khoá: nạp URL http://<ip máy>:54321 (BLE / NVS như project thật), key bất kỳ trùng --key nếu có đặt.
+Trên console serial: "cloud sync 20", "cloud image 80000 5"... rồi
+    python3 tools/supabase_mock.py report --url http://127.0.0.1:54321
+supabase_client.c thật (build host: test/host/supabase_host.c) chạy với mock này trong test/host/test_supabase_mock.py (ctest).
+"""
+import argparse
+import base64
+import json
+import random
+import socket
+import sys
+import threading
+import time
+import urllib.parse
+import urllib.request
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+DEFAULT_CONFIG = {
+    "latency_ms": 0,        # Trễ thêm trước khi trả lời
+    "jitter_ms": 0,         # + ngẫu nhiên 0..jitter_ms
+    "error_rate": 0.0,      # Tỉ lệ trả error_status (sau khi đã đọc hết body)
+    "error_status": 503,
+    "drop_rate": 0.0,       # Tỉ lệ đóng kết nối không trả lời
+    "chunked": False,       # Phản hồi GET dạng Transfer-Encoding: chunked (không có Content-Length)
+    "chunk_size": 1024,
+    "rx_kbps": 0,           # Giới hạn tốc độ đọc body (kbit/s, 0 = không giới hạn) -> nghẽn đường lên
+    "tus_cut": 0,           # Cắt kết nối sau N byte của PATCH TUS đầu tiên mỗi phiên (kiểm tra nối lại)
+    "ops": {},
+}
+
+
+class Store:
+    def __init__(self, users, dim, seed):
+        self.lock = threading.Lock()
+        self.rng = random.Random(seed)
+        self.config = json.loads(json.dumps(DEFAULT_CONFIG))
+        self.tables = {"users": [], "access_logs": [], "device_stats": [], "device_commands": []}
+        self.objects = {}       # "bucket/tên" -> số byte
+        self.tus = {}           # id -> {"length", "offset", "name", "cut"}
+        self.next_id = {t: 1 for t in self.tables}
+        self.stats = {}
+        for i in range(users):
+            emb = [round(self.rng.uniform(-0.1, 0.1), 6) for _ in range(dim)]
+            # Kiểu vector của Postgres trả về dạng chuỗi "[..]"
+            self.insert("users", {"face_id": i + 1, "name": "User %d" % (i + 1),
+                                  "embedding": "[" + ",".join("%g" % v for v in emb) + "]",
+                                  "embedding_adapted": None})
+
+    def insert(self, table, row):
+        row = dict(row)
+        row.setdefault("id", self.next_id[table])
+        self.next_id[table] = max(self.next_id[table], row["id"]) + 1
+        row.setdefault("created_at", time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime()))
+        self.tables[table].append(row)
+        return row
+
+    def opt(self, op, key):
+        return self.config.get("ops", {}).get(op, {}).get(key, self.config[key])
+
+    def record(self, op, status, bytes_in, bytes_out, ms):
+        with self.lock:
+            s = self.stats.setdefault(op, {"count": 0, "status": {}, "bytes_in": 0, "bytes_out": 0, "ms": []})
+            s["count"] += 1
+            s["status"][str(status)] = s["status"].get(str(status), 0) + 1
+            s["bytes_in"] += bytes_in
+            s["bytes_out"] += bytes_out
+            s["ms"].append(ms)
+
+    def stats_json(self):
+        out = {}
+        with self.lock:
+            for op, s in sorted(self.stats.items()):
+                ms = sorted(s["ms"])
+                out[op] = {"count": s["count"], "status": s["status"], "bytes_in": s["bytes_in"],
+                           "bytes_out": s["bytes_out"],
+                           "p50_ms": round(ms[len(ms) // 2], 2) if ms else 0,
+                           "p95_ms": round(ms[min(len(ms) - 1, len(ms) * 95 // 100)], 2) if ms else 0,
+                           "max_ms": round(ms[-1], 2) if ms else 0}
+        return out
+
+
+def filters(query):
+    """PostgREST: ?cột=eq.giá_trị (chỉ eq, đủ cho firmware)."""
+    out = {}
+    for k, v in urllib.parse.parse_qsl(query):
+        if v.startswith("eq.") and k not in ("select", "limit", "on_conflict"):
+            out[k] = v[3:]
+    return out
+
+
+def match(row, flt):
+    return all(str(row.get(k)) == v for k, v in flt.items())
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    # Phản hồi ra mạng khi handler xong (sau st.record): khách nhận xong là /__mock/stats đã có request đó
+    wbufsize = -1
+    store = None
+    key = None
+    quiet = False
+
+    def log_message(self, fmt, *args):
+        if not self.quiet:
+            sys.stderr.write("%s %s\n" % (self.address_string(), fmt % args))
+
+    # --- ĐỌC / GHI ---
+    def read_body(self, limit=None):
+        """Đọc body (Content-Length hoặc chunked), có giới hạn tốc độ. limit: cắt sau N byte -> None."""
+        kbps = self.store.config["rx_kbps"]
+        data = bytearray()
+        if self.headers.get("Transfer-Encoding", "").lower() == "chunked":
+            while True:
+                size = int(self.rfile.readline().strip() or b"0", 16)
+                if size == 0:
+                    self.rfile.readline()
+                    break
+                data += self.rfile.read(size)
+                self.rfile.readline()
+            self.in_bytes += len(data)
+            return bytes(data)
+        total = int(self.headers.get("Content-Length") or 0)
+        t0 = time.monotonic()
+        while len(data) < total:
+            piece = self.rfile.read(min(1024, total - len(data)))
+            if not piece:
+                break
+            data += piece
+            self.in_bytes += len(piece)
+            if limit is not None and len(data) >= limit:
+                return None
+            if kbps:
+                ahead = len(data) * 8 / (kbps * 1000.0) - (time.monotonic() - t0)
+                if ahead > 0:
+                    time.sleep(ahead)
+        return bytes(data)
+
+    def send(self, status, body=b"", headers=None, chunked=False):
+        if isinstance(body, (dict, list)):
+            body = json.dumps(body).encode()
+        self.send_response(status)
+        for k, v in (headers or {}).items():
+            self.send_header(k, v)
+        if body and "Content-Type" not in (headers or {}):
+            self.send_header("Content-Type", "application/json")
+        if chunked and body:
+            self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+            size = max(1, int(self.store.config["chunk_size"]))
+            for i in range(0, len(body), size):
+                part = body[i:i + size]
+                self.wfile.write(b"%x\r\n%s\r\n" % (len(part), part))
+            self.wfile.write(b"0\r\n\r\n")
+        else:
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            if body and self.command != "HEAD":
+                self.wfile.write(body)
+        self.out_bytes = len(body)
+        return status
+
+    def drop(self):
+        self.close_connection = True
+        try:
+            self.connection.shutdown(socket.SHUT_RDWR)
+        except OSError:
+            pass
+        return 0
+
+    # --- PHÂN LOẠI THAO TÁC ---
+    def classify(self, path):
+        m = self.command
+        if path.startswith("/__mock/"):
+            return "mock"
+        if path == "/rest/v1/users":
+            return {"GET": "sync_users", "POST": "upload_face", "PATCH": "upload_face_adapted"}.get(m)
+        if path == "/rest/v1/access_logs" and m == "POST":
+            return "log_access"
+        if path == "/rest/v1/device_stats" and m == "POST":
+            return "publish_stats"
+        if path == "/rest/v1/device_commands":
+            return {"GET": "poll_commands", "PATCH": "mark_executed"}.get(m)
+        if path.startswith("/storage/v1/object/") and m == "POST":
+            return "upload_image"
+        if path == "/storage/v1/upload/resumable" and m == "POST":
+            return "tus_create"
+        if path.startswith("/storage/v1/upload/resumable/"):
+            return {"HEAD": "tus_head", "PATCH": "tus_patch"}.get(m)
+        return None
+
+    def handle_any(self):
+        t0 = time.monotonic()
+        self.out_bytes = 0
+        self.in_bytes = 0
+        url = urllib.parse.urlsplit(self.path)
+        op = self.classify(url.path)
+        st = self.store
+        if op == "mock":
+            return self.control(url)
+        if op is None:
+            self.read_body()
+            return self.send(404, {"message": "mock: no route %s %s" % (self.command, url.path)})
+
+        status = 0
+        try:
+            if self.key and self.headers.get("apikey") != self.key:
+                self.read_body()
+                status = self.send(401, {"message": "Invalid API key"})
+                return
+            if st.rng.random() < st.opt(op, "drop_rate"):
+                status = self.drop()
+                return
+            if op == "tus_patch":
+                status = self.tus_patch(url)
+                return
+            body = self.read_body()
+            delay = st.opt(op, "latency_ms") + st.rng.uniform(0, st.opt(op, "jitter_ms"))
+            if delay > 0:
+                time.sleep(delay / 1000.0)
+            if st.rng.random() < st.opt(op, "error_rate"):
+                status = self.send(st.opt(op, "error_status"), {"message": "mock injected error"})
+                return
+            status = getattr(self, "op_" + op)(url, body)
+        finally:
+            st.record(op, status, self.in_bytes, self.out_bytes, (time.monotonic() - t0) * 1000.0)
+
+    do_GET = do_POST = do_PATCH = do_HEAD = handle_any
+
+    def json_body(self, body):
+        try:
+            return json.loads(body or b"null")
+        except ValueError:
+            return None
+
+    def reply_rows(self, rows, status=200):
+        if "return=minimal" in self.headers.get("Prefer", ""):
+            return self.send(204 if status != 201 else 201)
+        return self.send(status, rows)
+
+    # --- POSTGREST ---
+    def op_sync_users(self, url, body):
+        q = dict(urllib.parse.parse_qsl(url.query))
+        flt = filters(url.query)
+        with self.store.lock:
+            rows = [r for r in self.store.tables["users"] if match(r, flt)][:int(q.get("limit", 1000))]
+        return self.send(200, rows, chunked=self.store.opt("sync_users", "chunked"))
+
+    def insert_rows(self, table, body, upsert_key=None):
+        data = self.json_body(body)
+        if isinstance(data, dict):
+            data = [data]
+        if not isinstance(data, list) or not all(isinstance(r, dict) for r in data):
+            return self.send(400, {"message": "mock: body must be an object or array"})
+        out = []
+        with self.store.lock:
+            for r in data:
+                old = [x for x in self.store.tables[table] if upsert_key and x.get(upsert_key) == r.get(upsert_key)]
+                if old:
+                    old[0].update(r)
+                    out.append(old[0])
+                else:
+                    out.append(self.store.insert(table, r))
+        return self.reply_rows(out, 201)
+
+    def update_rows(self, table, url, body):
+        patch = self.json_body(body)
+        if not isinstance(patch, dict):
+            return self.send(400, {"message": "mock: body must be an object"})
+        flt = filters(url.query)
+        with self.store.lock:
+            rows = [r for r in self.store.tables[table] if match(r, flt)]
+            for r in rows:
+                r.update(patch)
+        return self.reply_rows(rows)
+
+    def op_upload_face(self, url, body):
+        return self.insert_rows("users", body)
+
+    def op_upload_face_adapted(self, url, body):
+        return self.update_rows("users", url, body)
+
+    def op_log_access(self, url, body):
+        return self.insert_rows("access_logs", body)
+
+    def op_publish_stats(self, url, body):
+        return self.insert_rows("device_stats", body, upsert_key="device_id")
+
+    def op_poll_commands(self, url, body):
+        flt = filters(url.query)
+        with self.store.lock:
+            rows = [{k: r.get(k) for k in ("id", "command", "payload")}
+                    for r in self.store.tables["device_commands"] if match(r, flt)]
+        return self.send(200, rows, chunked=self.store.opt("poll_commands", "chunked"))
+
+    def op_mark_executed(self, url, body):
+        return self.update_rows("device_commands", url, body)
+
+    # --- STORAGE ---
+    def op_upload_image(self, url, body):
+        key = url.path[len("/storage/v1/object/"):]
+        with self.store.lock:
+            self.store.objects[key] = len(body)
+        return self.send(200, {"Key": key})
+
+    def op_tus_create(self, url, body):
+        meta = {}
+        for part in self.headers.get("Upload-Metadata", "").split(","):
+            k, _, v = part.strip().partition(" ")
+            meta[k] = base64.b64decode(v).decode(errors="replace") if v else ""
+        with self.store.lock:
+            uid = "%08x" % self.store.rng.getrandbits(32)
+            self.store.tus[uid] = {"length": int(self.headers.get("Upload-Length") or 0), "offset": 0,
+                                   "name": "%s/%s" % (meta.get("bucketName"), meta.get("objectName")),
+                                   "cut": bool(self.store.config["tus_cut"])}
+        host = self.headers.get("Host") or "%s:%d" % self.server.server_address
+        return self.send(201, headers={"Location": "http://%s/storage/v1/upload/resumable/%s" % (host, uid),
+                                       "Tus-Resumable": "1.0.0"})
+
+    def tus_session(self, url):
+        return self.store.tus.get(url.path.rsplit("/", 1)[-1])
+
+    def op_tus_head(self, url, body):
+        s = self.tus_session(url)
+        if not s:
+            return self.send(404)
+        return self.send(200, headers={"Upload-Offset": str(s["offset"]), "Upload-Length": str(s["length"]),
+                                       "Tus-Resumable": "1.0.0", "Cache-Control": "no-store"})
+
+    def tus_patch(self, url):
+        st = self.store
+        s = self.tus_session(url)
+        if not s:
+            self.read_body()
+            return self.send(404)
+        if int(self.headers.get("Upload-Offset", -1)) != s["offset"]:
+            self.read_body()
+            return self.send(409, {"message": "offset mismatch"})
+        cut = st.config["tus_cut"] if s["cut"] else None
+        data = self.read_body(limit=cut)
+        if data is None:
+            # Nhận được 1 phần rồi "mất mạng": server giữ phần đã nhận, khách hỏi lại bằng HEAD
+            with st.lock:
+                s["offset"] += cut
+                s["cut"] = False
+            return self.drop()
+        with st.lock:
+            s["offset"] += len(data)
+            if s["offset"] >= s["length"]:
+                st.objects[s["name"]] = s["length"]
+        return self.send(204, headers={"Upload-Offset": str(s["offset"]), "Tus-Resumable": "1.0.0"})
+
+    # --- ĐIỀU KHIỂN ---
+    def control(self, url):
+        st = self.store
+        name = url.path[len("/__mock/"):]
+        body = self.read_body()
+        if name == "stats":
+            return self.send(200, st.stats_json())
+        if name == "reset" and self.command == "POST":
+            with st.lock:
+                st.stats.clear()
+            return self.send(204)
+        if name == "config":
+            if self.command == "POST":
+                cfg = self.json_body(body)
+                if not isinstance(cfg, dict) or any(k not in DEFAULT_CONFIG for k in cfg):
+                    return self.send(400, {"message": "unknown config key", "keys": list(DEFAULT_CONFIG)})
+                with st.lock:
+                    st.config.update(cfg)
+            return self.send(200, st.config)
+        if name == "command" and self.command == "POST":
+            cmd = self.json_body(body) or {}
+            with st.lock:
+                row = st.insert("device_commands", {"device_id": cmd.get("device_id", "S3_LOCK_01"),
+                                                    "command": cmd.get("command", "OPEN"),
+                                                    "payload": cmd.get("payload"), "status": "pending"})
+            return self.send(201, row)
+        if name.startswith("rows/"):
+            table = name[5:]
+            with st.lock:
+                if table == "objects":
+                    return self.send(200, st.objects)
+                if table not in st.tables:
+                    return self.send(404)
+                return self.send(200, st.tables[table])
+        return self.send(404)
+
+
+def serve(args):
+    Handler.store = Store(args.users, args.dim, args.seed)
+    Handler.key = args.key
+    Handler.quiet = args.quiet
+    if args.config:
+        Handler.store.config.update(json.loads(args.config))
+    srv = ThreadingHTTPServer((args.host, args.port), Handler)
+    srv.daemon_threads = True
+    print("Supabase mock on http://%s:%d (%d users, dim %d)" % (args.host, args.port, args.users, args.dim))
+    try:
+        srv.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+def report(args):
+    with urllib.request.urlopen(args.url.rstrip("/") + "/__mock/stats") as r:
+        stats = json.load(r)
+    if args.json:
+        print(json.dumps(stats, indent=2))
+        return
+    print("%-20s %6s %10s %10s %8s %8s %8s  %s" % ("op", "count", "bytes_in", "bytes_out", "p50_ms", "p95_ms",
+                                                   "max_ms", "status"))
+    for op, s in stats.items():
+        print("%-20s %6d %10d %10d %8.1f %8.1f %8.1f  %s" % (op, s["count"], s["bytes_in"], s["bytes_out"],
+                                                             s["p50_ms"], s["p95_ms"], s["max_ms"],
+                                                             " ".join("%s:%d" % kv for kv in sorted(s["status"].items()))))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = ap.add_subparsers(dest="cmd")
+    s = sub.add_parser("serve", help="chạy máy chủ giả lập (mặc định)")
+    s.add_argument("--host", default="0.0.0.0")
+    s.add_argument("--port", type=int, default=54321)
+    s.add_argument("--users", type=int, default=10, help="số user có sẵn cho sync")
+    s.add_argument("--dim", type=int, default=512, help="số chiều embedding (= CONFIG_FACE_EMBED_DIM)")
+    s.add_argument("--seed", type=int, default=1, help="seed cho dữ liệu + lỗi ngẫu nhiên (chạy lặp lại được)")
+    s.add_argument("--key", default=None, help="chỉ nhận request có header apikey này")
+    s.add_argument("--config", default=None, help='cấu hình ban đầu, vd. \'{"latency_ms":200}\'')
+    s.add_argument("--quiet", action="store_true")
+    r = sub.add_parser("report", help="in thống kê của máy chủ đang chạy")
+    r.add_argument("--url", default="http://127.0.0.1:54321")
+    r.add_argument("--json", action="store_true")
+    args = ap.parse_args()
+    if args.cmd == "report":
+        report(args)
+    else:
+        if args.cmd is None:
+            args = ap.parse_args(["serve"] + sys.argv[1:])
+        serve(args)
+
+
+if __name__ == "__main__":
+    main()